@@ -0,0 +1,90 @@
+"""
+Per-call overhead of the methods used in an MPC loop
+
+Times the extension methods and the OSQP interface on a small problem,
+where the calls cost more than the work they do. To compare two builds of
+the extension, save the times of the first one and run the second one
+against them:
+
+    python benchmarks/call_overhead.py --save before.json
+    python benchmarks/call_overhead.py --compare before.json
+
+Only numbers measured on the same machine and Python are comparable, so no
+reference numbers are kept here.
+"""
+import argparse
+import json
+import timeit
+import numpy as np
+from scipy import sparse
+import rlqp as osqp
+
+
+def setup_model(n=10, m=20):
+    np.random.seed(1)
+    P = sparse.random(n, n, density=0.5)
+    P = sparse.csc_matrix(P.dot(P.T) + sparse.eye(n))
+    A = sparse.random(m, n, density=0.5, format='csc')
+    q = np.random.randn(n)
+    l = -1. - np.random.rand(m)
+    u = 1. + np.random.rand(m)
+    model = osqp.OSQP()
+    # A single iteration: the solve costs about as much as the call
+    model.setup(P, q, A, l, u, verbose=False, max_iter=1, polish=False)
+    return model, q, l, u
+
+
+def main(number=20000, repeat=5, save=None, compare=None):
+    model, q, l, u = setup_model()
+    res = model.solve()
+    x, y = res.x, res.y
+    idx = np.array([0, 1])
+    vals = l[idx]
+    ext = model._model
+
+    cases = [
+        ("_model.solve()", lambda: ext.solve()),
+        ("_model.update_lin_cost(q)", lambda: ext.update_lin_cost(q)),
+        ("_model.update_bounds(l, u)", lambda: ext.update_bounds(l, u)),
+        ("_model.update_bounds_idx(l, None, idx)",
+         lambda: ext.update_bounds_idx(vals, None, idx)),
+        ("_model.warm_start(x, y)", lambda: ext.warm_start(x, y)),
+        ("update(q, l, u)", lambda: model.update(q=q, l=l, u=u)),
+        ("update + warm_start + solve",
+         lambda: (model.update(q=q, l=l, u=u), model.warm_start(x=x, y=y),
+                  model.solve())),
+        ("update_solve(q, l, u, x0, y0)",
+         lambda: model.update_solve(q=q, l=l, u=u, x0=x, y0=y)),
+    ]
+
+    before = {}
+    if compare:
+        with open(compare) as f:
+            before = json.load(f)
+
+    times = {}
+    print("%-42s %10s %10s %8s" % ("call", "us/call", "before", "speedup"))
+    for name, fn in cases:
+        t = 1e6 * min(timeit.repeat(fn, number=number, repeat=repeat)) / number
+        times[name] = t
+        if name in before:
+            print("%-42s %10.2f %10.2f %7.2fx" %
+                  (name, t, before[name], before[name] / t))
+        else:
+            print("%-42s %10.2f" % (name, t))
+
+    if save:
+        with open(save, 'w') as f:
+            json.dump(times, f, indent=2)
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[1])
+    parser.add_argument('--number', type=int, default=20000,
+                        help="calls per measurement")
+    parser.add_argument('--save', metavar='FILE',
+                        help="save the times to FILE")
+    parser.add_argument('--compare', metavar='FILE',
+                        help="compare with the times saved in FILE")
+    args = parser.parse_args()
+    main(number=args.number, save=args.save, compare=args.compare)
@@ -0,0 +1,223 @@
+#ifndef OSQPANDERSONPY_H
+#define OSQPANDERSONPY_H
+
+#include "lin_alg.h"
+
+/*****************************************************
+ * Anderson acceleration of the ADMM iteration       *
+ *****************************************************/
+
+/*
+ * The ADMM iteration is a fixed-point map s -> F(s) on s = (x, z, y). After
+ * each iteration the next iterate is extrapolated from the last mem
+ * differences of s and of the residual g = F(s) - s:
+ *
+ *   s+ = F(s) - (dS + dG) gamma
+ *
+ * with gamma solving dG' dG gamma = dG' g (type II) or dS' dG gamma = dS' g
+ * (type I). The solve loop checks the termination criteria on the plain
+ * ADMM iterate F(s) before the extrapolation, so the solution returned is
+ * always an ADMM iterate. If the norm of the residual increases after an
+ * extrapolation, the history is cleared and the iteration restarts from the
+ * plain iterate.
+ */
+#define ANDERSON_NONE    (0)
+#define ANDERSON_TYPE_I  (1)
+#define ANDERSON_TYPE_II (2)
+
+// Default number of differences kept
+#define ANDERSON_MEM (5)
+
+// Regularization of the normal equations, relative to their diagonal
+#define ANDERSON_REG (1e-10)
+
+
+typedef struct {
+    c_int type;             // ANDERSON_TYPE_I or ANDERSON_TYPE_II
+    c_int mem;              // Number of differences kept
+    c_int n, m;             // Dimensions of the problem
+    c_int dim;              // Dimension of s, n + 2 m
+
+    c_int len;              // Number of differences stored
+    c_int head;             // Slot of the next difference
+    c_int has_prev;         // Whether s_prev and g_prev are set
+    c_int extrapolated;     // Whether the current iterate was extrapolated
+    c_float gnorm_prev;     // Norm of the previous residual
+
+    c_float *s, *f, *g;     // Current iterate, its image and residual
+    c_float *s_prev, *g_prev;
+    c_float *dS, *dG;       // Differences, one column of length dim per slot
+    c_float *M, *gamma;     // Normal equations and their solution
+
+    c_int accepted;         // Extrapolated steps in the last solve
+    c_int rejected;         // Restarts in the last solve
+} OSQPAnderson;
+
+
+static void anderson_free(OSQPAnderson *aa) {
+    if (aa) {
+        if (aa->s) c_free(aa->s);
+        if (aa->f) c_free(aa->f);
+        if (aa->g) c_free(aa->g);
+        if (aa->s_prev) c_free(aa->s_prev);
+        if (aa->g_prev) c_free(aa->g_prev);
+        if (aa->dS) c_free(aa->dS);
+        if (aa->dG) c_free(aa->dG);
+        if (aa->M) c_free(aa->M);
+        if (aa->gamma) c_free(aa->gamma);
+        c_free(aa);
+    }
+}
+
+// All the buffers are allocated here and reused by every solve
+static OSQPAnderson *anderson_setup(c_int type, c_int mem, c_int n, c_int m) {
+    OSQPAnderson *aa = (OSQPAnderson *)c_calloc(1, sizeof(OSQPAnderson));
+
+    if (!aa) return OSQP_NULL;
+    aa->type = type;
+    aa->mem = mem;
+    aa->n = n;
+    aa->m = m;
+    aa->dim = n + 2 * m;
+    aa->s      = (c_float *)c_malloc(aa->dim * sizeof(c_float));
+    aa->f      = (c_float *)c_malloc(aa->dim * sizeof(c_float));
+    aa->g      = (c_float *)c_malloc(aa->dim * sizeof(c_float));
+    aa->s_prev = (c_float *)c_malloc(aa->dim * sizeof(c_float));
+    aa->g_prev = (c_float *)c_malloc(aa->dim * sizeof(c_float));
+    aa->dS     = (c_float *)c_malloc(mem * aa->dim * sizeof(c_float));
+    aa->dG     = (c_float *)c_malloc(mem * aa->dim * sizeof(c_float));
+    aa->M      = (c_float *)c_malloc(mem * (mem + 1) * sizeof(c_float));
+    aa->gamma  = (c_float *)c_malloc(mem * sizeof(c_float));
+    if (!aa->s || !aa->f || !aa->g || !aa->s_prev || !aa->g_prev ||
+        !aa->dS || !aa->dG || !aa->M || !aa->gamma) {
+        anderson_free(aa);
+        return OSQP_NULL;
+    }
+    return aa;
+}
+
+static void anderson_restart(OSQPAnderson *aa) {
+    aa->len = 0;
+    aa->head = 0;
+    aa->has_prev = 0;
+    aa->extrapolated = 0;
+}
+
+// s = (x, z, y) of the workspace
+static void anderson_gather(OSQPAnderson *aa, OSQPWorkspace *work, c_float *s) {
+    prea_vec_copy(work->x, s, aa->n);
+    prea_vec_copy(work->z, s + aa->n, aa->m);
+    prea_vec_copy(work->y, s + aa->n + aa->m, aa->m);
+}
+
+static void anderson_scatter(OSQPAnderson *aa, OSQPWorkspace *work, const c_float *s) {
+    prea_vec_copy(s, work->x, aa->n);
+    prea_vec_copy(s + aa->n, work->z, aa->m);
+    prea_vec_copy(s + aa->n + aa->m, work->y, aa->m);
+}
+
+/*
+ * Solve the k x k system stored row-wise in M with the right-hand side in
+ * its last column by Gaussian elimination with partial pivoting. Returns
+ * nonzero if the system is singular.
+ */
+static c_int anderson_lsolve(c_float *M, c_int k, c_float *gamma) {
+    c_int i, j, r, piv;
+    c_float t, *Mi, *Mr;
+
+    for (i = 0; i < k; i++) {
+        piv = i;
+        for (r = i + 1; r < k; r++) {
+            if (c_absval(M[r * (k + 1) + i]) > c_absval(M[piv * (k + 1) + i])) piv = r;
+        }
+        if (M[piv * (k + 1) + i] == 0.0) return 1;
+        if (piv != i) {
+            for (j = 0; j <= k; j++) {
+                t = M[i * (k + 1) + j];
+                M[i * (k + 1) + j] = M[piv * (k + 1) + j];
+                M[piv * (k + 1) + j] = t;
+            }
+        }
+        Mi = M + i * (k + 1);
+        for (r = i + 1; r < k; r++) {
+            Mr = M + r * (k + 1);
+            t = Mr[i] / Mi[i];
+            for (j = i; j <= k; j++) Mr[j] -= t * Mi[j];
+        }
+    }
+    for (i = k - 1; i >= 0; i--) {
+        Mi = M + i * (k + 1);
+        t = Mi[k];
+        for (j = i + 1; j < k; j++) t -= Mi[j] * gamma[j];
+        gamma[i] = t / Mi[i];
+    }
+    return 0;
+}
+
+/*
+ * Extrapolate the next iterate after the ADMM map took the iterate s to the
+ * current values of the workspace.
+ */
+static void anderson_step(OSQPAnderson *aa, OSQPWorkspace *work) {
+    c_int dim = aa->dim;
+    c_int i, j, k, slot;
+    c_float gnorm, reg, *U, *V;
+
+    anderson_gather(aa, work, aa->f);
+    for (i = 0; i < dim; i++) aa->g[i] = aa->f[i] - aa->s[i];
+    gnorm = c_sqrt(vec_prod(aa->g, aa->g, dim));
+
+    // Safeguard: restart from the plain iterate if the residual increased
+    if (aa->extrapolated && gnorm > aa->gnorm_prev) {
+        anderson_restart(aa);
+        aa->rejected++;
+    }
+
+    // New differences overwrite the oldest ones
+    if (aa->has_prev) {
+        slot = aa->head;
+        for (i = 0; i < dim; i++) {
+            aa->dS[slot * dim + i] = aa->s[i] - aa->s_prev[i];
+            aa->dG[slot * dim + i] = aa->g[i] - aa->g_prev[i];
+        }
+        aa->head = (aa->head + 1) % aa->mem;
+        aa->len = c_min(aa->len + 1, aa->mem);
+    }
+    prea_vec_copy(aa->s, aa->s_prev, dim);
+    prea_vec_copy(aa->g, aa->g_prev, dim);
+    aa->has_prev = 1;
+    aa->gnorm_prev = gnorm;
+    aa->extrapolated = 0;
+
+    k = aa->len;
+    if (k == 0) return;
+
+    // Normal equations, rows [U' dG | U' g] with U = dG (type II) or dS (type I)
+    U = aa->type == ANDERSON_TYPE_I ? aa->dS : aa->dG;
+    V = aa->dG;
+    reg = 0.;
+    for (i = 0; i < k; i++) {
+        for (j = 0; j < k; j++) {
+            aa->M[i * (k + 1) + j] = vec_prod(U + i * dim, V + j * dim, dim);
+        }
+        aa->M[i * (k + 1) + k] = vec_prod(U + i * dim, aa->g, dim);
+        reg = c_max(reg, c_absval(aa->M[i * (k + 1) + i]));
+    }
+    for (i = 0; i < k; i++) aa->M[i * (k + 1) + i] += ANDERSON_REG * reg;
+    if (anderson_lsolve(aa->M, k, aa->gamma)) {
+        anderson_restart(aa);
+        aa->rejected++;
+        return;
+    }
+
+    // s+ = F(s) - (dS + dG) gamma
+    for (j = 0; j < k; j++) {
+        vec_add_scaled(aa->f, aa->f, aa->dS + j * dim, dim, -aa->gamma[j]);
+        vec_add_scaled(aa->f, aa->f, aa->dG + j * dim, dim, -aa->gamma[j]);
+    }
+    anderson_scatter(aa, work, aa->f);
+    aa->extrapolated = 1;
+    aa->accepted++;
+}
+
+#endif
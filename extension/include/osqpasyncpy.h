@@ -0,0 +1,204 @@
+#ifndef OSQPASYNCPY_H
+#define OSQPASYNCPY_H
+
+/*****************************************************
+ * Worker pool of the asynchronous solves            *
+ *****************************************************/
+
+/*
+ * Solves submitted with solve_submit run on a pool of native threads, one
+ * per processor, started by the first submission. Each finished solve is
+ * queued and signalled on a file descriptor (an eventfd on Linux, a pipe
+ * elsewhere) that an event loop watches. The loop then calls async_poll,
+ * which builds the results of the finished solves with the GIL held.
+ *
+ * The worker threads never touch the Python API. The OSQP object of a
+ * pending solve is kept alive by a reference taken at submission and
+ * released by async_poll. The object stays busy until async_poll has built
+ * the results, so that no call modifies the workspace in between.
+ *
+ * The deadline of a solve runs from its submission: the time the job waits
+ * for a thread is taken off the budget when a worker starts it.
+ */
+#ifndef _WIN32
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#ifdef __linux__
+#include <sys/eventfd.h>
+#endif
+
+typedef c_int (*async_solve_fn)(OSQP *self);
+
+typedef struct async_job {
+    struct async_job *next;
+    OSQP *self;             // Problem solved
+    long id;                // Identifier returned by solve_submit
+    c_int exitflag;         // Exit flag of the solve
+#ifdef PROFILING
+    OSQPTimer submitted;    // Started at submission
+#endif
+} async_job;
+
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    async_job *queue, *queue_tail;  // Solves waiting for a thread
+    async_job *done, *done_tail;    // Finished solves
+    async_solve_fn solve;   // Function running a solve
+    int started;            // Whether the threads are running
+    int fd_read, fd_write;  // Completion notifications
+    long next_id;           // Identifier of the next job
+} async_pool_t;
+
+static async_pool_t async_pool = {PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER,
+                                  OSQP_NULL, OSQP_NULL, OSQP_NULL, OSQP_NULL,
+                                  OSQP_NULL, 0, -1, -1, 0};
+
+
+static void async_push(async_job **head, async_job **tail, async_job *job) {
+    job->next = OSQP_NULL;
+    if (*tail) {
+        (*tail)->next = job;
+    } else {
+        *head = job;
+    }
+    *tail = job;
+}
+
+static void async_notify(void) {
+#ifdef __linux__
+    uint64_t one = 1;
+#else
+    char one = 1;
+#endif
+    ssize_t r;
+
+    // A full pipe already wakes up the loop
+    do {
+        r = write(async_pool.fd_write, &one, sizeof(one));
+    } while (r < 0 && errno == EINTR);
+}
+
+static void *async_worker(void *arg) {
+    async_job *job;
+#ifdef PROFILING
+    OSQPIteration *it;
+#endif
+
+    (void)arg;
+    for (;;) {
+        pthread_mutex_lock(&async_pool.lock);
+        while (!async_pool.queue) {
+            pthread_cond_wait(&async_pool.cond, &async_pool.lock);
+        }
+        job = async_pool.queue;
+        async_pool.queue = job->next;
+        if (!async_pool.queue) async_pool.queue_tail = OSQP_NULL;
+        pthread_mutex_unlock(&async_pool.lock);
+
+#ifdef PROFILING
+        it = job->self->iteration;
+        if (it && it->deadline > 0.) {
+            it->deadline = c_max(it->deadline - osqp_toc(&job->submitted), 1e-9);
+        }
+#endif
+        job->exitflag = async_pool.solve(job->self);
+
+        pthread_mutex_lock(&async_pool.lock);
+        async_push(&async_pool.done, &async_pool.done_tail, job);
+        pthread_mutex_unlock(&async_pool.lock);
+        async_notify();
+    }
+    return NULL;
+}
+
+// Start the threads and open the file descriptor. Called with the GIL held.
+static c_int async_start(async_solve_fn solve) {
+    pthread_t thread;
+    c_int k, nthreads, nstarted = 0;
+#ifndef __linux__
+    int fds[2];
+#endif
+
+    if (async_pool.started) return 0;
+
+#ifdef __linux__
+    async_pool.fd_read = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (async_pool.fd_read < 0) return 1;
+    async_pool.fd_write = async_pool.fd_read;
+#else
+    if (pipe(fds)) return 1;
+    fcntl(fds[0], F_SETFL, O_NONBLOCK);
+    fcntl(fds[1], F_SETFL, O_NONBLOCK);
+    fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+    fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+    async_pool.fd_read = fds[0];
+    async_pool.fd_write = fds[1];
+#endif
+
+    async_pool.solve = solve;
+    nthreads = parallel_nprocs();
+    for (k = 0; k < nthreads; k++) {
+        if (pthread_create(&thread, NULL, async_worker, NULL)) break;
+        pthread_detach(thread);
+        nstarted++;
+    }
+    if (!nstarted) {
+        close(async_pool.fd_read);
+        if (async_pool.fd_write != async_pool.fd_read) close(async_pool.fd_write);
+        return 1;
+    }
+    async_pool.started = 1;
+    return 0;
+}
+
+// Queue a solve of self. Called with the GIL held.
+static c_int async_submit(OSQP *self, long *id) {
+    async_job *job = (async_job *)c_malloc(sizeof(async_job));
+
+    if (!job) return 1;
+    job->self = self;
+    job->id = *id = async_pool.next_id++;
+    job->exitflag = 0;
+#ifdef PROFILING
+    osqp_tic(&job->submitted);
+#endif
+
+    pthread_mutex_lock(&async_pool.lock);
+    async_push(&async_pool.queue, &async_pool.queue_tail, job);
+    pthread_cond_signal(&async_pool.cond);
+    pthread_mutex_unlock(&async_pool.lock);
+    return 0;
+}
+
+// Take the finished solves and clear the notifications
+static async_job *async_take_done(void) {
+    async_job *done;
+#ifdef __linux__
+    uint64_t count;
+#else
+    char buf[256];
+#endif
+
+    if (!async_pool.started) return OSQP_NULL;
+
+    // Drain the notifications before taking the queue, so that a solve
+    // finishing in between signals again
+#ifdef __linux__
+    while (read(async_pool.fd_read, &count, sizeof(count)) > 0);
+#else
+    while (read(async_pool.fd_read, buf, sizeof(buf)) > 0);
+#endif
+
+    pthread_mutex_lock(&async_pool.lock);
+    done = async_pool.done;
+    async_pool.done = async_pool.done_tail = OSQP_NULL;
+    pthread_mutex_unlock(&async_pool.lock);
+    return done;
+}
+
+#endif  // _WIN32
+
+#endif
@@ -0,0 +1,258 @@
+#ifndef OSQPBANDEDPY_H
+#define OSQPBANDEDPY_H
+
+/*****************************************************
+ * Banded LDL' linear system solver                  *
+ *****************************************************/
+
+/*
+ * Linear system solver for KKT matrices ordered into a narrow band, like
+ * MPC problems ordered stage by stage. Column j of L is stored densely from
+ * the diagonal down to row last[j], the envelope of the lower triangular KKT
+ * matrix, which contains all the fill. For a stage ordering the columns of a
+ * stage only reach the next stage, so the factorization is the block
+ * tridiagonal (Riccati) recursion over the stages and its cost is linear in
+ * the horizon length.
+ *
+ * The solver is set up on top of QDLDL, which keeps assembling the KKT
+ * matrix. The ordering giving the band is applied to the QDLDL solver with
+ * kkt_reorder before the solver is installed.
+ */
+#define BANDED_SOLVER (SUPERNODAL_SOLVER + 3)   // Follows DENSE_SOLVER
+
+
+typedef struct banded banded_solver;
+
+struct banded {
+    enum linsys_solver_type type;
+
+    c_int (*solve)(struct banded * self, c_float * b);
+    void (*free)(struct banded * self);
+    c_int (*update_matrices)(struct banded * self, const csc *P, const csc *A);
+    c_int (*update_rho_vec)(struct banded * self, const c_float * rho_vec);
+
+    c_int nthreads;
+
+    qdldl_solver * kkt;     // KKT matrix and permutation
+    c_int n;                // Dimension of the KKT matrix
+    c_int *last;            // Last row of each column of L
+    c_int *off;             // Offset of each column of L (n + 1)
+    c_float *Lx;            // Columns of L, from the diagonal to the last row
+};
+
+
+/* Symbolic analysis */
+
+static c_int banded_symbolic(banded_solver *s) {
+    csc *KKT = s->kkt->KKT;
+    c_int n = s->n;
+    c_int i, j, p;
+
+    s->last = (c_int *)c_malloc(c_max(n, 1) * sizeof(c_int));
+    s->off  = (c_int *)c_malloc((n + 1) * sizeof(c_int));
+    if (!s->last || !s->off) return 1;
+
+    // Row j of the upper triangular part is column j of the lower one
+    for (j = 0; j < n; j++) s->last[j] = j;
+    for (j = 0; j < n; j++) {
+        for (p = KKT->p[j]; p < KKT->p[j + 1]; p++) {
+            i = KKT->i[p];
+            if (j > s->last[i]) s->last[i] = j;
+        }
+    }
+
+    // The envelope is monotone: the fill of column j reaches the last row
+    // of every previous column
+    s->off[0] = 0;
+    for (j = 0; j < n; j++) {
+        if (j > 0 && s->last[j - 1] > s->last[j]) s->last[j] = s->last[j - 1];
+        s->off[j + 1] = s->off[j] + s->last[j] - j + 1;
+    }
+
+    s->Lx = (c_float *)c_malloc(c_max(s->off[n], 1) * sizeof(c_float));
+    if (!s->Lx) return 1;
+
+    return 0;
+}
+
+
+/* Numerical factorization */
+
+static c_int banded_factor(banded_solver *s) {
+    csc *KKT = s->kkt->KKT;
+    c_float *D = s->kkt->D, *Dinv = s->kkt->Dinv;
+    c_int n = s->n;
+    c_int i, j, k, p, last, npos = 0;
+    c_float d, dinv, t;
+    c_float *Lk, *Lj;
+
+    // Lower triangular part of the permuted KKT matrix
+    for (k = 0; k < s->off[n]; k++) s->Lx[k] = 0.0;
+    for (j = 0; j < n; j++) {
+        for (p = KKT->p[j]; p < KKT->p[j + 1]; p++) {
+            i = KKT->i[p];
+            s->Lx[s->off[i] + j - i] = KKT->x[p];
+        }
+    }
+
+    for (k = 0; k < n; k++) {
+        Lk = s->Lx + s->off[k];
+        last = s->last[k];
+        d = Lk[0];
+
+        if (d == 0.0) {
+#ifdef PRINTING
+            c_eprint("Error in KKT matrix LDL factorization when computing the nonzero elements. There are zeros in the diagonal matrix");
+#endif
+            return -1;
+        }
+        if (d > 0.0) npos++;
+
+        dinv = 1.0 / d;
+        D[k] = d;
+        Dinv[k] = dinv;
+
+        // Column of L below the pivot
+        Lk[0] = 1.0;
+        for (i = 1; i <= last - k; i++) Lk[i] *= dinv;
+
+        // Rank-1 update of the following columns within the band
+        for (j = k + 1; j <= last; j++) {
+            Lj = s->Lx + s->off[j] - j;
+            t = d * Lk[j - k];
+            if (t == 0.0) continue;
+            for (i = j; i <= last; i++) Lj[i] -= Lk[i - k] * t;
+        }
+    }
+
+    // The KKT matrix is quasidefinite: n positive and m negative pivots
+    if (npos < s->kkt->n) {
+#ifdef PRINTING
+        c_eprint("KKT matrix is not quasidefinite");
+#endif
+        return -2;
+    }
+
+    return 0;
+}
+
+
+/* Solve */
+
+static void banded_ldlsolve(banded_solver *s, c_float *x) {
+    c_int n = s->n;
+    c_int i, j;
+    c_float xj;
+    const c_float *Lj;
+
+    // Forward substitution with L
+    for (j = 0; j < n; j++) {
+        Lj = s->Lx + s->off[j] - j;
+        xj = x[j];
+        for (i = j + 1; i <= s->last[j]; i++) x[i] -= Lj[i] * xj;
+    }
+
+    // Diagonal
+    for (j = 0; j < n; j++) x[j] *= s->kkt->Dinv[j];
+
+    // Backward substitution with L'
+    for (j = n - 1; j >= 0; j--) {
+        Lj = s->Lx + s->off[j] - j;
+        xj = x[j];
+        for (i = j + 1; i <= s->last[j]; i++) xj -= Lj[i] * x[i];
+        x[j] = xj;
+    }
+}
+
+static c_int solve_linsys_banded(banded_solver *s, c_float *b) {
+    qdldl_solver *q = s->kkt;
+    c_int j;
+
+    // bp = P b
+    for (j = 0; j < s->n; j++) q->bp[j] = b[q->P[j]];
+    banded_ldlsolve(s, q->bp);
+    for (j = 0; j < s->n; j++) q->sol[q->P[j]] = q->bp[j];
+
+    // x_tilde and z_tilde
+    for (j = 0; j < q->n; j++) b[j] = q->sol[j];
+    for (j = 0; j < q->m; j++) b[j + q->n] += q->rho_inv_vec[j] * q->sol[j + q->n];
+
+    return 0;
+}
+
+
+/* Updates */
+
+static c_int update_linsys_solver_matrices_banded(banded_solver *s,
+                                                  const csc *P, const csc *A) {
+    qdldl_solver *q = s->kkt;
+
+    update_KKT_P(q->KKT, P, q->PtoKKT, q->sigma, q->Pdiag_idx, q->Pdiag_n);
+    update_KKT_A(q->KKT, A, q->AtoKKT);
+
+    return banded_factor(s);
+}
+
+static c_int update_linsys_solver_rho_vec_banded(banded_solver *s,
+                                                 const c_float *rho_vec) {
+    qdldl_solver *q = s->kkt;
+    c_int i;
+
+    for (i = 0; i < q->m; i++) q->rho_inv_vec[i] = 1. / rho_vec[i];
+    update_KKT_param2(q->KKT, q->rho_inv_vec, q->rhotoKKT, q->m);
+
+    return banded_factor(s);
+}
+
+
+static void free_linsys_solver_banded(banded_solver *s) {
+    if (s) {
+        if (s->kkt) s->kkt->free(s->kkt);
+        if (s->last) c_free(s->last);
+        if (s->off) c_free(s->off);
+        if (s->Lx) c_free(s->Lx);
+        c_free(s);
+    }
+}
+
+
+/*
+ * Replace a QDLDL solver with the banded solver for the current ordering of
+ * its KKT matrix. The QDLDL solver is kept to own the KKT matrix and the
+ * permutation, but its numerical factor is released.
+ */
+static c_int banded_install(LinSysSolver **solver) {
+    qdldl_solver *q = (qdldl_solver *) *solver;
+    banded_solver *s;
+
+    if (q->type != QDLDL_SOLVER) return 1;
+
+    s = (banded_solver *)c_calloc(1, sizeof(banded_solver));
+    if (!s) return 1;
+
+    s->type = BANDED_SOLVER;
+    s->solve = &solve_linsys_banded;
+    s->free = &free_linsys_solver_banded;
+    s->update_matrices = &update_linsys_solver_matrices_banded;
+    s->update_rho_vec = &update_linsys_solver_rho_vec_banded;
+    s->nthreads = 1;
+    s->kkt = q;
+    s->n = q->KKT->n;
+
+    if (banded_symbolic(s) || banded_factor(s)) {
+        // Leave the QDLDL solver in place
+        s->kkt = OSQP_NULL;
+        free_linsys_solver_banded(s);
+        return 1;
+    }
+
+    // The values of the QDLDL factor are no longer needed
+    c_free(q->L->x);
+    q->L->x = OSQP_NULL;
+
+    *solver = (LinSysSolver *) s;
+
+    return 0;
+}
+
+#endif
@@ -0,0 +1,179 @@
+#ifndef OSQPBATCHPY_H
+#define OSQPBATCHPY_H
+
+/*****************************************************
+ * Batched solves and derivatives of many instances  *
+ *****************************************************/
+
+/*
+ * Instances share the sparsity patterns of P and A and differ in their
+ * values and vectors. The instances are split over slots, one per thread.
+ * Every slot sets up a workspace with the problem itself and moves it to
+ * each of its instances with numerical updates only, so the solution of an
+ * instance does not depend on the number of slots or on the other instances
+ * of its slot: the solver is cold started, rho is reset to its setting and
+ * the scaling is either the one of the problem or, when P or A change,
+ * computed from the values of the instance alone. The symbolic analysis of
+ * the derivative system is done once and shared by the slots. The one of the
+ * KKT matrix of the solver is done by osqp_setup in each slot, the library
+ * has no way to share it between workspaces. The workers never touch the
+ * Python API.
+ */
+typedef struct {
+    c_int n, m, count;      // Dimensions and number of instances
+    c_int nslots;           // Number of slots (threads)
+    const csc *P, *A;       // Patterns of P and A
+    const OSQPSettings *settings;
+    c_float eps;            // Regularization of the derivative system
+
+    // Instances stacked by rows. Px and Ax are NULL when the values of all
+    // instances are P_base and A_base.
+    const c_float *Px, *q, *Ax, *l, *u;
+    const c_float *P_base, *A_base;
+    const c_float *q_base, *l_base, *u_base;    // Vectors of the problem
+    const c_float *q_zero;                      // Zero cost vector
+
+    const OSQPDerivative *deriv;    // Symbolic analysis of the derivative system
+
+    // Gradient seeds (any may be NULL, all NULL for solves only)
+    const c_float *dx, *dy_u, *dy_l;
+
+    // Outputs stacked by rows
+    c_float *x, *y;
+    c_int *status;
+    c_float *dPx, *dq, *dAx, *dl, *du;
+    c_int *refine_failed;   // Whether the refinement of an instance did not converge
+} batch_ctx;
+
+
+static const c_float *batch_row(const c_float *arr, c_int r, c_int len) {
+    return arr ? arr + r * len : OSQP_NULL;
+}
+
+static void batch_fill(c_float *arr, c_int len, c_float val) {
+    c_int k;
+
+    for (k = 0; k < len; k++) arr[k] = val;
+}
+
+// Gradients of instance r that cannot be computed
+static void batch_fill_grads(const batch_ctx *b, c_int r) {
+    c_int n = b->n, m = b->m, Pnz = b->P->p[n], Anz = b->A->p[n];
+
+    batch_fill(b->dPx + r * Pnz, Pnz, Py_NAN);
+    batch_fill(b->dq + r * n, n, Py_NAN);
+    batch_fill(b->dAx + r * Anz, Anz, Py_NAN);
+    batch_fill(b->dl + r * m, m, Py_NAN);
+    batch_fill(b->du + r * m, m, Py_NAN);
+}
+
+// Set up the workspace of a slot with the problem
+static c_int batch_setup(const batch_ctx *b, OSQPWorkspace **work) {
+    OSQPData data;
+    csc P, A;
+
+    P = *b->P;
+    A = *b->A;
+    P.x = (c_float *)b->P_base;
+    A.x = (c_float *)b->A_base;
+    data.n = b->n;
+    data.m = b->m;
+    data.P = &P;
+    data.A = &A;
+    data.q = (c_float *)b->q_base;
+    data.l = (c_float *)b->l_base;
+    data.u = (c_float *)b->u_base;
+    return osqp_setup(work, &data, b->settings);
+}
+
+/*
+ * Move the workspace of a slot to instance r. Updating P or A unscales and
+ * rescales the data with the scaling of the previous instance, so q is
+ * cleared first to compute the scaling from P and A alone, and q and the
+ * bounds are set after it.
+ */
+static c_int batch_update(const batch_ctx *b, c_int r, OSQPWorkspace *work) {
+    c_int Pnz = b->P->p[b->n], Anz = b->A->p[b->n];
+    c_int exitflag = 0;
+
+    if (work->settings->rho != b->settings->rho) {
+        exitflag = osqp_update_rho(work, b->settings->rho);
+    }
+    if (!exitflag && (b->Px || b->Ax) && work->settings->scaling) {
+        exitflag = osqp_update_lin_cost(work, b->q_zero);
+    }
+    if (exitflag) return exitflag;
+    if (b->Px && b->Ax) {
+        exitflag = osqp_update_P_A(work, b->Px + r * Pnz, OSQP_NULL, Pnz,
+                                   b->Ax + r * Anz, OSQP_NULL, Anz);
+    } else if (b->Px) {
+        exitflag = osqp_update_P(work, b->Px + r * Pnz, OSQP_NULL, Pnz);
+    } else if (b->Ax) {
+        exitflag = osqp_update_A(work, b->Ax + r * Anz, OSQP_NULL, Anz);
+    }
+    return exitflag ||
+           osqp_update_lin_cost(work, b->q + r * b->n) ||
+           osqp_update_bounds(work, b->l + r * b->m, b->u + r * b->m);
+}
+
+// Adjoint derivatives of instance r, solved in work. NaN if not solved.
+static void batch_adjoint(const batch_ctx *b, c_int r, OSQPWorkspace *work,
+                          OSQPDerivative **d) {
+    c_int n = b->n, m = b->m, Pnz = b->P->p[n], Anz = b->A->p[n];
+
+    if (!*d && b->deriv && work->info->status_val == OSQP_SOLVED) {
+        *d = derivative_clone(b->deriv);
+    }
+    if (!*d || work->info->status_val != OSQP_SOLVED ||
+        derivative_factor(*d, work, b->eps)) {
+        batch_fill_grads(b, r);
+        return;
+    }
+    b->refine_failed[r] = derivative_adjoint(*d, batch_row(b->dx, r, n),
+                                             batch_row(b->dy_u, r, m),
+                                             batch_row(b->dy_l, r, m),
+                                             b->dq + r * n, b->dl + r * m,
+                                             b->du + r * m);
+    derivative_matrix_values(*d, (*d)->sol, b->dPx + r * Pnz, b->dAx + r * Anz);
+}
+
+// Solve (and differentiate) the instances of slot t
+static c_int batch_task(void *ctx, c_int t) {
+    const batch_ctx *b = (const batch_ctx *) ctx;
+    OSQPWorkspace *work = OSQP_NULL;
+    OSQPDerivative *d = OSQP_NULL;
+    c_int r, failed, exitflag = 0;
+    c_int grads = b->dx || b->dy_u || b->dy_l;
+
+    for (r = t; r < b->count; r += b->nslots) {
+        b->refine_failed[r] = 0;
+        failed = (!work && batch_setup(b, &work)) || batch_update(b, r, work);
+
+        if (failed) {
+            // Invalid data of this instance (e.g. l > u or a nonconvex P).
+            // The next instance sets up a new workspace.
+            exitflag = 1;
+            b->status[r] = OSQP_UNSOLVED;
+            batch_fill(b->x + r * b->n, b->n, Py_NAN);
+            batch_fill(b->y + r * b->m, b->m, Py_NAN);
+            if (grads) batch_fill_grads(b, r);
+            if (work) osqp_cleanup(work);
+            work = OSQP_NULL;
+            derivative_free(d);
+            d = OSQP_NULL;
+            continue;
+        }
+
+        osqp_solve(work);
+        b->status[r] = work->info->status_val;
+        prea_vec_copy(work->solution->x, b->x + r * b->n, b->n);
+        prea_vec_copy(work->solution->y, b->y + r * b->m, b->m);
+        if (grads) batch_adjoint(b, r, work, &d);
+    }
+
+    derivative_free(d);
+    if (work) osqp_cleanup(work);
+    return exitflag;
+}
+
+#endif
@@ -0,0 +1,340 @@
+#ifndef OSQPBOXPY_H
+#define OSQPBOXPY_H
+
+#include "qdldl_interface.h"
+#include "kkt.h"
+
+/*****************************************************
+ * Elimination of box constraints from the KKT system *
+ *****************************************************/
+
+/*
+ * Rows of A with a single nonzero a_i = c_i e_j' (variable bounds) are
+ * eliminated from the KKT system. With nu_i = rho_i (c_i x_j - b_i) the
+ * reduced system reads
+ *
+ *   [P + sigma I + sum_i rho_i c_i^2 e_j e_j'   A_r'       ] [x   ]   [b_x + sum_i rho_i c_i b_i e_j]
+ *   [A_r                                       -diag(1/rho)] [nu_r] = [b_r                           ]
+ *
+ * and the projections of the eliminated rows are z_tilde_i = c_i x_j.
+ * The solver wraps the solver of the reduced system, so the ADMM iterates
+ * and the full dual vector y are computed by OSQP as usual.
+ *
+ * osqp_setup has already factored the full KKT matrix when the bounds are
+ * eliminated: the reduced system is factored on top of it and the full
+ * factorization is dropped. The time of the reduced factorization is part
+ * of the setup time reported in the info.
+ */
+#define BOX_SOLVER (SUPERNODAL_SOLVER + 1)
+
+
+typedef struct box box_solver;
+
+struct box {
+    enum linsys_solver_type type;
+
+    c_int (*solve)(struct box * self, c_float * b);
+    void (*free)(struct box * self);
+    c_int (*update_matrices)(struct box * self, const csc *P, const csc *A);
+    c_int (*update_rho_vec)(struct box * self, const c_float * rho_vec);
+
+    c_int nthreads;
+
+    LinSysSolver * kkt;     // Solver of the reduced KKT system
+    c_int n;                // Number of variables
+    c_int m;                // Number of constraints
+
+    c_int mr;               // Number of rows kept in the KKT system
+    c_int *rows;            // Kept rows
+    c_float *rho_vec;       // Step sizes of the kept rows
+
+    c_int nb;               // Number of eliminated rows
+    c_int *brows;           // Eliminated rows
+    c_int *bcol;            // Variable bounded by each eliminated row
+    c_int *bidx;            // Position of its coefficient in A->x
+    c_float *bval;          // Its coefficient
+    c_float *brho;          // Its step size
+
+    csc *P;                 // P with the full diagonal and the box terms
+    c_int *PtoPb;           // Position of each entry of P in the matrix above
+    c_int *Pdiag;           // Position of the diagonal entries
+    c_float *Pd;            // Diagonal of P
+    csc *A;                 // Kept rows of A
+    c_int *AtoAb;           // Position of each entry of A in the kept rows (or -1)
+
+    c_float *b;             // Right-hand side of the reduced system
+};
+
+
+// QDLDL solver holding the KKT matrix of a linear system solver
+static qdldl_solver *linsys_qdldl(LinSysSolver *s) {
+    if (s->type == QDLDL_SOLVER) return (qdldl_solver *) s;
+    if (s->type == SUPERNODAL_SOLVER) return ((supernodal_solver *) s)->kkt;
+    if (s->type == DENSE_SOLVER) return ((dense_solver *) s)->kkt;
+    if (s->type == BANDED_SOLVER) return ((banded_solver *) s)->kkt;
+    if (s->type == BOX_SOLVER) return linsys_qdldl(((box_solver *) s)->kkt);
+    return OSQP_NULL;
+}
+
+/*
+ * Solver factoring the KKT matrix of the workspace together with the P and
+ * A matrices of that KKT matrix. These are the reduced matrices when the
+ * box constraints have been eliminated.
+ */
+static LinSysSolver **linsys_kkt_solver(OSQPWorkspace *work,
+                                        const csc **P, const csc **A) {
+    box_solver *s;
+
+    if (work->linsys_solver->type == BOX_SOLVER) {
+        s = (box_solver *) work->linsys_solver;
+        *P = s->P;
+        *A = s->A;
+        return &s->kkt;
+    }
+    *P = work->data->P;
+    *A = work->data->A;
+    return &work->linsys_solver;
+}
+
+
+/* Values of the reduced matrices */
+
+static void box_update_P(box_solver *s, const csc *P) {
+    c_int j, k;
+
+    for (j = 0; j < s->n; j++) s->P->x[s->Pdiag[j]] = 0.;
+    for (k = 0; k < P->p[s->n]; k++) s->P->x[s->PtoPb[k]] = P->x[k];
+    for (j = 0; j < s->n; j++) s->Pd[j] = s->P->x[s->Pdiag[j]];
+}
+
+static void box_add_terms(box_solver *s) {
+    c_int j, k;
+
+    for (j = 0; j < s->n; j++) s->P->x[s->Pdiag[j]] = s->Pd[j];
+    for (k = 0; k < s->nb; k++) {
+        s->P->x[s->Pdiag[s->bcol[k]]] += s->brho[k] * s->bval[k] * s->bval[k];
+    }
+}
+
+static void box_update_A(box_solver *s, const csc *A) {
+    c_int k;
+
+    for (k = 0; k < A->p[s->n]; k++) {
+        if (s->AtoAb[k] >= 0) s->A->x[s->AtoAb[k]] = A->x[k];
+    }
+    for (k = 0; k < s->nb; k++) s->bval[k] = A->x[s->bidx[k]];
+}
+
+static void box_split_rho(box_solver *s, const c_float *rho_vec) {
+    c_int k;
+
+    for (k = 0; k < s->mr; k++) s->rho_vec[k] = rho_vec[s->rows[k]];
+    for (k = 0; k < s->nb; k++) s->brho[k] = rho_vec[s->brows[k]];
+}
+
+
+/* Solve */
+
+static c_int solve_linsys_box(box_solver *s, c_float *b) {
+    c_int j, k, exitflag;
+    c_int n = s->n;
+    c_float *br = s->b;
+
+    for (j = 0; j < n; j++) br[j] = b[j];
+    for (k = 0; k < s->mr; k++) br[n + k] = b[n + s->rows[k]];
+    for (k = 0; k < s->nb; k++) {
+        br[s->bcol[k]] += s->brho[k] * s->bval[k] * b[n + s->brows[k]];
+    }
+
+    exitflag = s->kkt->solve(s->kkt, br);
+
+    for (j = 0; j < n; j++) b[j] = br[j];
+    for (k = 0; k < s->mr; k++) b[n + s->rows[k]] = br[n + k];
+    for (k = 0; k < s->nb; k++) b[n + s->brows[k]] = s->bval[k] * br[s->bcol[k]];
+
+    return exitflag;
+}
+
+
+/* Updates */
+
+static c_int update_linsys_solver_matrices_box(box_solver *s,
+                                               const csc *P, const csc *A) {
+    box_update_P(s, P);
+    box_update_A(s, A);
+    box_add_terms(s);
+
+    return s->kkt->update_matrices(s->kkt, s->P, s->A);
+}
+
+static c_int update_linsys_solver_rho_vec_box(box_solver *s,
+                                              const c_float *rho_vec) {
+    qdldl_solver *q = linsys_qdldl(s->kkt);
+
+    box_split_rho(s, rho_vec);
+    box_add_terms(s);
+
+    // Refresh the P block of the KKT matrix and refactor once with the new rho
+    update_KKT_P(q->KKT, s->P, q->PtoKKT, q->sigma, q->Pdiag_idx, q->Pdiag_n);
+    return s->kkt->update_rho_vec(s->kkt, s->rho_vec);
+}
+
+
+static void free_linsys_solver_box(box_solver *s) {
+    if (s) {
+        if (s->kkt) s->kkt->free(s->kkt);
+        if (s->rows) c_free(s->rows);
+        if (s->rho_vec) c_free(s->rho_vec);
+        if (s->brows) c_free(s->brows);
+        if (s->bcol) c_free(s->bcol);
+        if (s->bidx) c_free(s->bidx);
+        if (s->bval) c_free(s->bval);
+        if (s->brho) c_free(s->brho);
+        if (s->P) csc_spfree(s->P);
+        if (s->PtoPb) c_free(s->PtoPb);
+        if (s->Pdiag) c_free(s->Pdiag);
+        if (s->Pd) c_free(s->Pd);
+        if (s->A) csc_spfree(s->A);
+        if (s->AtoAb) c_free(s->AtoAb);
+        if (s->b) c_free(s->b);
+        c_free(s);
+    }
+}
+
+
+/*
+ * Replace the QDLDL solver created by osqp_setup with a QDLDL solver of the
+ * KKT system without the singleton rows of A. Nothing is done if A has no
+ * singleton rows.
+ */
+static c_int box_install(OSQPWorkspace *work) {
+    const csc *P = work->data->P;
+    const csc *A = work->data->A;
+    c_int n = work->data->n;
+    c_int m = work->data->m;
+    c_int *rowmap;
+    c_int i, j, k, p, nb, Anz;
+    box_solver *s;
+
+    if (work->linsys_solver->type != QDLDL_SOLVER) return 1;
+
+    // Count the nonzeros of each row
+    rowmap = (c_int *)c_calloc(c_max(m, 1), sizeof(c_int));
+    if (!rowmap) return 1;
+    for (k = 0; k < A->p[n]; k++) rowmap[A->i[k]]++;
+    nb = 0;
+    for (i = 0; i < m; i++) if (rowmap[i] == 1) nb++;
+    if (nb == 0) {
+        c_free(rowmap);
+        return 0;
+    }
+
+    s = (box_solver *)c_calloc(1, sizeof(box_solver));
+    if (!s) {
+        c_free(rowmap);
+        return 1;
+    }
+    s->type = BOX_SOLVER;
+    s->solve = &solve_linsys_box;
+    s->free = &free_linsys_solver_box;
+    s->update_matrices = &update_linsys_solver_matrices_box;
+    s->update_rho_vec = &update_linsys_solver_rho_vec_box;
+    s->nthreads = 1;
+    s->n = n;
+    s->m = m;
+    s->nb = nb;
+    s->mr = m - nb;
+
+    Anz = A->p[n];
+    s->rows    = (c_int *)c_malloc(c_max(s->mr, 1) * sizeof(c_int));
+    s->rho_vec = (c_float *)c_malloc(c_max(s->mr, 1) * sizeof(c_float));
+    s->brows   = (c_int *)c_malloc(nb * sizeof(c_int));
+    s->bcol    = (c_int *)c_malloc(nb * sizeof(c_int));
+    s->bidx    = (c_int *)c_malloc(nb * sizeof(c_int));
+    s->bval    = (c_float *)c_malloc(nb * sizeof(c_float));
+    s->brho    = (c_float *)c_malloc(nb * sizeof(c_float));
+    s->PtoPb   = (c_int *)c_malloc(c_max(P->p[n], 1) * sizeof(c_int));
+    s->Pdiag   = (c_int *)c_malloc(c_max(n, 1) * sizeof(c_int));
+    s->Pd      = (c_float *)c_malloc(c_max(n, 1) * sizeof(c_float));
+    s->AtoAb   = (c_int *)c_malloc(c_max(Anz, 1) * sizeof(c_int));
+    s->b       = (c_float *)c_malloc((n + s->mr) * sizeof(c_float));
+    s->P       = csc_spalloc(n, n, P->p[n] + n, 1, 0);
+    s->A       = csc_spalloc(s->mr, n, Anz - nb, 1, 0);
+    if (!s->rows || !s->rho_vec || !s->brows || !s->bcol || !s->bidx ||
+        !s->bval || !s->brho || !s->PtoPb || !s->Pdiag || !s->Pd || !s->AtoAb ||
+        !s->b || !s->P || !s->A) {
+        c_free(rowmap);
+        free_linsys_solver_box(s);
+        return 1;
+    }
+
+    // Number the kept rows (>= 0) and the eliminated rows (< 0)
+    j = 0;
+    k = 0;
+    for (i = 0; i < m; i++) {
+        if (rowmap[i] == 1) {
+            s->brows[k] = i;
+            rowmap[i] = -(k++) - 1;
+        } else {
+            s->rows[j] = i;
+            rowmap[i] = j++;
+        }
+    }
+
+    // Kept rows of A and coefficients of the eliminated rows
+    k = 0;
+    for (j = 0; j < n; j++) {
+        s->A->p[j] = k;
+        for (p = A->p[j]; p < A->p[j + 1]; p++) {
+            i = rowmap[A->i[p]];
+            if (i >= 0) {
+                s->A->i[k] = i;
+                s->A->x[k] = A->x[p];
+                s->AtoAb[p] = k++;
+            } else {
+                s->bcol[-i - 1] = j;
+                s->bidx[-i - 1] = p;
+                s->bval[-i - 1] = A->x[p];
+                s->AtoAb[p] = -1;
+            }
+        }
+    }
+    s->A->p[n] = k;
+    c_free(rowmap);
+
+    // Upper triangular P with every diagonal entry present
+    k = 0;
+    for (j = 0; j < n; j++) {
+        s->P->p[j] = k;
+        s->Pdiag[j] = -1;
+        for (p = P->p[j]; p < P->p[j + 1]; p++) {
+            if (P->i[p] == j) s->Pdiag[j] = k;
+            s->P->i[k] = P->i[p];
+            s->PtoPb[p] = k++;
+        }
+        if (s->Pdiag[j] < 0) {
+            s->P->i[k] = j;
+            s->Pdiag[j] = k++;
+        }
+    }
+    s->P->p[n] = k;
+
+    box_split_rho(s, work->rho_vec);
+    box_update_P(s, P);
+    box_add_terms(s);
+
+    if (init_linsys_solver_qdldl((qdldl_solver **)&s->kkt, s->P, s->A,
+                                 work->settings->sigma, s->rho_vec, 0)) {
+        // The QDLDL solver is freed on failure
+        s->kkt = OSQP_NULL;
+        free_linsys_solver_box(s);
+        return 1;
+    }
+
+    work->linsys_solver->free(work->linsys_solver);
+    work->linsys_solver = (LinSysSolver *) s;
+
+    return 0;
+}
+
+#endif
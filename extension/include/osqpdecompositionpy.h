@@ -0,0 +1,602 @@
+#ifndef OSQPDECOMPOSITIONPY_H
+#define OSQPDECOMPOSITIONPY_H
+
+#include "cs.h"
+
+/*****************************************************
+ * Decomposition of block-separable problems         *
+ *****************************************************/
+
+/*
+ * The variables and constraints are split into the connected components of
+ * the sparsity graph of P and A. Each component is an independent problem
+ * with its own workspace, so the blocks are solved in parallel and each of
+ * them stops as soon as it meets its own termination criteria.
+ *
+ * The variables, constraints and entries of P and A are stored block by
+ * block: block b owns the positions [noff[b], noff[b + 1]) of the vectors
+ * of dimension n and similarly for m, nnz(P) and nnz(A). The pos arrays
+ * give the position of every variable, constraint and entry in this order.
+ */
+
+typedef struct {
+    c_int n;                // Number of variables
+    c_int m;                // Number of constraints
+    c_int nblocks;          // Number of blocks
+    c_int nthreads;         // Number of threads solving the blocks
+
+    OSQPData **data;        // Data of each block
+    OSQPWorkspace **work;   // Workspace of each block
+    OSQPIteration **iteration;  // Solve loop of each block
+
+    c_int *noff, *moff;     // Offsets of the variables and constraints of each block
+    c_int *Poff, *Aoff;     // Offsets of the entries of P and A of each block
+    c_int *xblk, *xpos;     // Block and position of each variable
+    c_int *yblk, *ypos;     // Block and position of each constraint
+    c_int *Pblk, *Ppos;     // Block and position of each entry of P
+    c_int *Ablk, *Apos;     // Block and position of each entry of A
+
+    c_float *xb, *yb;       // Vectors of dimension n and m in block order
+    c_float *lb, *ub;
+    c_float *Pxb, *Axb;     // Values of P and A in block order
+    c_int *Pidx, *Aidx;     // Block indices of the entries of partial updates
+    c_int *Pend, *Aend;     // End of the entries of each block in partial updates
+    c_int *count;           // Counters of the entries of each block
+
+    c_float *x, *y;         // Vectors of dimension n and m in problem order
+    OSQPInfo info;          // Information of the whole problem
+} OSQPDecomposition;
+
+
+static void decomposition_free(OSQPDecomposition *d) {
+    c_int b;
+
+    if (d) {
+        for (b = 0; b < d->nblocks; b++) {
+            if (d->iteration) iteration_free(d->iteration[b]);
+            if (d->work && d->work[b]) osqp_cleanup(d->work[b]);
+            if (d->data && d->data[b]) {
+                if (d->data[b]->P) csc_spfree(d->data[b]->P);
+                if (d->data[b]->A) csc_spfree(d->data[b]->A);
+                c_free(d->data[b]);
+            }
+        }
+        if (d->data) c_free(d->data);
+        if (d->work) c_free(d->work);
+        if (d->iteration) c_free(d->iteration);
+        if (d->noff) c_free(d->noff);
+        if (d->moff) c_free(d->moff);
+        if (d->Poff) c_free(d->Poff);
+        if (d->Aoff) c_free(d->Aoff);
+        if (d->xblk) c_free(d->xblk);
+        if (d->xpos) c_free(d->xpos);
+        if (d->yblk) c_free(d->yblk);
+        if (d->ypos) c_free(d->ypos);
+        if (d->Pblk) c_free(d->Pblk);
+        if (d->Ppos) c_free(d->Ppos);
+        if (d->Ablk) c_free(d->Ablk);
+        if (d->Apos) c_free(d->Apos);
+        if (d->xb) c_free(d->xb);
+        if (d->yb) c_free(d->yb);
+        if (d->lb) c_free(d->lb);
+        if (d->ub) c_free(d->ub);
+        if (d->Pxb) c_free(d->Pxb);
+        if (d->Axb) c_free(d->Axb);
+        if (d->Pidx) c_free(d->Pidx);
+        if (d->Aidx) c_free(d->Aidx);
+        if (d->Pend) c_free(d->Pend);
+        if (d->Aend) c_free(d->Aend);
+        if (d->count) c_free(d->count);
+        if (d->x) c_free(d->x);
+        if (d->y) c_free(d->y);
+        c_free(d);
+    }
+}
+
+
+/* Connected components */
+
+static c_int decomposition_find(c_int *parent, c_int i) {
+    c_int r = i, t;
+
+    while (parent[r] != r) r = parent[r];
+    while (parent[i] != r) {
+        t = parent[i];
+        parent[i] = r;
+        i = t;
+    }
+    return r;
+}
+
+static void decomposition_union(c_int *parent, c_int i, c_int j) {
+    i = decomposition_find(parent, i);
+    j = decomposition_find(parent, j);
+    // The smallest node is the root, so blocks follow the variable order
+    if (i < j) parent[j] = i;
+    else if (j < i) parent[i] = j;
+}
+
+
+/*
+ * Split the problem into its connected components. *dp is set to OSQP_NULL
+ * if the problem has a single component. Returns nonzero if the memory
+ * allocation fails.
+ */
+static c_int decomposition_setup(const OSQPData *data, c_int nthreads,
+                                 OSQPDecomposition **dp) {
+    const csc *P = data->P, *A = data->A;
+    c_int n = data->n, m = data->m;
+    c_int Pnz = P->p[n], Anz = A->p[n];
+    c_int *parent, *blk;
+    c_int b, i, j, k, p, nb;
+    OSQPDecomposition *d;
+    OSQPData *bd;
+
+    *dp = OSQP_NULL;
+    parent = (c_int *)c_malloc((n + m) * sizeof(c_int));
+    blk    = (c_int *)c_malloc((n + m) * sizeof(c_int));
+    if (!parent || !blk) {
+        if (parent) c_free(parent);
+        if (blk) c_free(blk);
+        return 1;
+    }
+
+    // Variables are the nodes 0..n-1 and constraints the nodes n..n+m-1
+    for (i = 0; i < n + m; i++) parent[i] = i;
+    for (j = 0; j < n; j++) {
+        for (p = P->p[j]; p < P->p[j + 1]; p++) decomposition_union(parent, P->i[p], j);
+        for (p = A->p[j]; p < A->p[j + 1]; p++) decomposition_union(parent, n + A->i[p], j);
+    }
+    for (j = 0; j < n + m; j++) blk[j] = -1;
+    nb = 0;
+    for (j = 0; j < n; j++) {
+        k = decomposition_find(parent, j);
+        if (blk[k] < 0) blk[k] = nb++;
+        blk[j] = blk[k];
+    }
+    // Empty constraints are assigned to the first block
+    for (i = 0; i < m; i++) {
+        k = decomposition_find(parent, n + i);
+        blk[n + i] = k < n ? blk[k] : 0;
+    }
+    c_free(parent);
+
+    if (nb <= 1) {
+        c_free(blk);
+        return 0;
+    }
+
+    d = (OSQPDecomposition *)c_calloc(1, sizeof(OSQPDecomposition));
+    if (!d) {
+        c_free(blk);
+        return 1;
+    }
+    d->n = n;
+    d->m = m;
+    d->nblocks = nb;
+    d->nthreads = nthreads;
+    d->data  = (OSQPData **)c_calloc(nb, sizeof(OSQPData *));
+    d->work  = (OSQPWorkspace **)c_calloc(nb, sizeof(OSQPWorkspace *));
+    d->iteration = (OSQPIteration **)c_calloc(nb, sizeof(OSQPIteration *));
+    d->noff  = (c_int *)c_calloc(nb + 1, sizeof(c_int));
+    d->moff  = (c_int *)c_calloc(nb + 1, sizeof(c_int));
+    d->Poff  = (c_int *)c_calloc(nb + 1, sizeof(c_int));
+    d->Aoff  = (c_int *)c_calloc(nb + 1, sizeof(c_int));
+    d->count = (c_int *)c_calloc(nb + 1, sizeof(c_int));
+    d->Pend  = (c_int *)c_calloc(nb + 1, sizeof(c_int));
+    d->Aend  = (c_int *)c_calloc(nb + 1, sizeof(c_int));
+    d->xblk  = (c_int *)c_malloc(n * sizeof(c_int));
+    d->xpos  = (c_int *)c_malloc(n * sizeof(c_int));
+    d->yblk  = (c_int *)c_malloc(c_max(m, 1) * sizeof(c_int));
+    d->ypos  = (c_int *)c_malloc(c_max(m, 1) * sizeof(c_int));
+    d->Pblk  = (c_int *)c_malloc(c_max(Pnz, 1) * sizeof(c_int));
+    d->Ppos  = (c_int *)c_malloc(c_max(Pnz, 1) * sizeof(c_int));
+    d->Ablk  = (c_int *)c_malloc(c_max(Anz, 1) * sizeof(c_int));
+    d->Apos  = (c_int *)c_malloc(c_max(Anz, 1) * sizeof(c_int));
+    d->xb    = (c_float *)c_malloc(n * sizeof(c_float));
+    d->yb    = (c_float *)c_malloc(c_max(m, 1) * sizeof(c_float));
+    d->lb    = (c_float *)c_malloc(c_max(m, 1) * sizeof(c_float));
+    d->ub    = (c_float *)c_malloc(c_max(m, 1) * sizeof(c_float));
+    d->Pxb   = (c_float *)c_malloc(c_max(Pnz, 1) * sizeof(c_float));
+    d->Axb   = (c_float *)c_malloc(c_max(Anz, 1) * sizeof(c_float));
+    d->Pidx  = (c_int *)c_malloc(c_max(Pnz, 1) * sizeof(c_int));
+    d->Aidx  = (c_int *)c_malloc(c_max(Anz, 1) * sizeof(c_int));
+    d->x     = (c_float *)c_malloc(n * sizeof(c_float));
+    d->y     = (c_float *)c_malloc(c_max(m, 1) * sizeof(c_float));
+    if (!d->data || !d->work || !d->iteration || !d->noff || !d->moff || !d->Poff ||
+        !d->Aoff || !d->count || !d->Pend || !d->Aend || !d->xblk ||
+        !d->xpos || !d->yblk || !d->ypos || !d->Pblk || !d->Ppos ||
+        !d->Ablk || !d->Apos || !d->xb || !d->yb || !d->lb || !d->ub ||
+        !d->Pxb || !d->Axb || !d->Pidx || !d->Aidx || !d->x || !d->y) {
+        c_free(blk);
+        decomposition_free(d);
+        return 1;
+    }
+
+    // Sizes and offsets of the blocks
+    for (j = 0; j < n; j++) {
+        d->xblk[j] = blk[j];
+        d->noff[blk[j] + 1]++;
+        d->Poff[blk[j] + 1] += P->p[j + 1] - P->p[j];
+        d->Aoff[blk[j] + 1] += A->p[j + 1] - A->p[j];
+    }
+    for (i = 0; i < m; i++) {
+        d->yblk[i] = blk[n + i];
+        d->moff[blk[n + i] + 1]++;
+    }
+    c_free(blk);
+    for (b = 0; b < nb; b++) {
+        d->noff[b + 1] += d->noff[b];
+        d->moff[b + 1] += d->moff[b];
+        d->Poff[b + 1] += d->Poff[b];
+        d->Aoff[b + 1] += d->Aoff[b];
+    }
+
+    // Positions of the variables and constraints in block order
+    for (b = 0; b < nb; b++) d->count[b] = d->noff[b];
+    for (j = 0; j < n; j++) d->xpos[j] = d->count[d->xblk[j]]++;
+    for (b = 0; b < nb; b++) d->count[b] = d->moff[b];
+    for (i = 0; i < m; i++) d->ypos[i] = d->count[d->yblk[i]]++;
+
+    // Data of the blocks
+    for (b = 0; b < nb; b++) {
+        bd = d->data[b] = (OSQPData *)c_calloc(1, sizeof(OSQPData));
+        if (!bd) {
+            decomposition_free(d);
+            return 1;
+        }
+        bd->n = d->noff[b + 1] - d->noff[b];
+        bd->m = d->moff[b + 1] - d->moff[b];
+        bd->P = csc_spalloc(bd->n, bd->n, d->Poff[b + 1] - d->Poff[b], 1, 0);
+        bd->A = csc_spalloc(bd->m, bd->n, d->Aoff[b + 1] - d->Aoff[b], 1, 0);
+        if (!bd->P || !bd->A) {
+            decomposition_free(d);
+            return 1;
+        }
+        bd->q = d->xb + d->noff[b];
+        bd->l = d->lb + d->moff[b];
+        bd->u = d->ub + d->moff[b];
+        d->count[b] = 0;
+    }
+
+    // Columns of P and A, in the order of the variables within each block
+    for (j = 0; j < n; j++) {
+        b = d->xblk[j];
+        bd = d->data[b];
+        k = d->xpos[j] - d->noff[b];
+        bd->P->p[k] = d->count[b];
+        for (p = P->p[j]; p < P->p[j + 1]; p++) {
+            d->Pblk[p] = b;
+            d->Ppos[p] = d->Poff[b] + d->count[b];
+            bd->P->i[d->count[b]] = d->xpos[P->i[p]] - d->noff[b];
+            bd->P->x[d->count[b]++] = P->x[p];
+        }
+    }
+    for (b = 0; b < nb; b++) {
+        d->data[b]->P->p[d->data[b]->n] = d->count[b];
+        d->count[b] = 0;
+    }
+    for (j = 0; j < n; j++) {
+        b = d->xblk[j];
+        bd = d->data[b];
+        k = d->xpos[j] - d->noff[b];
+        bd->A->p[k] = d->count[b];
+        for (p = A->p[j]; p < A->p[j + 1]; p++) {
+            d->Ablk[p] = b;
+            d->Apos[p] = d->Aoff[b] + d->count[b];
+            bd->A->i[d->count[b]] = d->ypos[A->i[p]] - d->moff[b];
+            bd->A->x[d->count[b]++] = A->x[p];
+        }
+    }
+    for (b = 0; b < nb; b++) {
+        d->data[b]->A->p[d->data[b]->n] = d->count[b];
+    }
+
+    for (j = 0; j < n; j++) d->xb[d->xpos[j]] = data->q[j];
+    for (i = 0; i < m; i++) {
+        d->lb[d->ypos[i]] = data->l[i];
+        d->ub[d->ypos[i]] = data->u[i];
+    }
+
+    *dp = d;
+    return 0;
+}
+
+
+/* Updates */
+
+static c_int decomposition_update_lin_cost(OSQPDecomposition *d, const c_float *q) {
+    c_int b, j, exitflag = 0;
+
+    for (j = 0; j < d->n; j++) d->xb[d->xpos[j]] = q[j];
+    for (b = 0; b < d->nblocks; b++) {
+        exitflag |= osqp_update_lin_cost(d->work[b], d->xb + d->noff[b]);
+    }
+    return exitflag;
+}
+
+// Bounds that are not given are kept. Invalid bounds leave every block unchanged.
+static c_int decomposition_update_bounds(OSQPDecomposition *d,
+                                         const c_float *l, const c_float *u) {
+    c_int b, i, exitflag = 0;
+
+    for (i = 0; i < d->m; i++) {
+        if ((l ? l[i] : d->lb[d->ypos[i]]) > (u ? u[i] : d->ub[d->ypos[i]])) {
+            return 1;
+        }
+    }
+    for (i = 0; i < d->m; i++) {
+        if (l) d->lb[d->ypos[i]] = l[i];
+        if (u) d->ub[d->ypos[i]] = u[i];
+    }
+    for (b = 0; b < d->nblocks; b++) {
+        if (d->moff[b + 1] == d->moff[b]) continue;
+        if (l && u) {
+            exitflag |= osqp_update_bounds(d->work[b], d->lb + d->moff[b],
+                                           d->ub + d->moff[b]);
+        } else if (l) {
+            exitflag |= osqp_update_lower_bound(d->work[b], d->lb + d->moff[b]);
+        } else {
+            exitflag |= osqp_update_upper_bound(d->work[b], d->ub + d->moff[b]);
+        }
+    }
+    return exitflag;
+}
+
+/*
+ * Indexed updates. The blocks touched are flagged in count, with bit 1 for
+ * the blocks updated and bit 2 for those where a constraint changed type.
+ */
+static c_int decomposition_update_lin_cost_idx(OSQPDecomposition *d,
+                                               const c_float *q,
+                                               const c_int *idx, c_int k) {
+    c_int t, b, exitflag = 0;
+
+    for (t = 0; t < k; t++) d->count[d->xblk[idx[t]]] = 0;
+    for (t = 0; t < k; t++) {
+        b = d->xblk[idx[t]];
+        if (!d->count[b]) update_idx_start(d->work[b]);
+        d->count[b] = 1;
+        update_idx_lin_cost(d->work[b], d->xpos[idx[t]] - d->noff[b], q[t]);
+    }
+    for (t = 0; t < k; t++) {
+        b = d->xblk[idx[t]];
+        if (d->count[b]) exitflag |= update_idx_finish(d->work[b], 0);
+        d->count[b] = 0;
+    }
+    return exitflag;
+}
+
+// Bounds that are not given are kept. Invalid bounds leave every block unchanged.
+static c_int decomposition_update_bounds_idx(OSQPDecomposition *d,
+                                             const c_float *l, const c_float *u,
+                                             const c_int *idx, c_int k) {
+    c_int t, b, p, exitflag = 0;
+    OSQPWorkspace *work;
+
+    for (t = 0; t < k; t++) {
+        p = d->ypos[idx[t]];
+        if ((l ? l[t] : d->lb[p]) > (u ? u[t] : d->ub[p])) return 1;
+        d->count[d->yblk[idx[t]]] = 0;
+    }
+    for (t = 0; t < k; t++) {
+        b = d->yblk[idx[t]];
+        p = d->ypos[idx[t]];
+        work = d->work[b];
+        if (!d->count[b]) update_idx_start(work);
+        d->count[b] |= 1;
+        if (l) d->lb[p] = l[t];
+        if (u) d->ub[p] = u[t];
+        if (update_idx_bounds(work, p - d->moff[b],
+                              update_idx_scale_bound(work, p - d->moff[b], d->lb[p]),
+                              update_idx_scale_bound(work, p - d->moff[b], d->ub[p]))) {
+            d->count[b] |= 2;
+        }
+    }
+    for (t = 0; t < k; t++) {
+        b = d->yblk[idx[t]];
+        if (d->count[b]) {
+            exitflag |= update_idx_finish(d->work[b], d->count[b] & 2);
+        }
+        d->count[b] = 0;
+    }
+    return exitflag;
+}
+
+/*
+ * Scatter the values of a (partial) update of a matrix into block order.
+ * The entries of block b are then xb[first..end[b]) with first = end[b - 1]
+ * (or 0) for partial updates and the whole block otherwise.
+ */
+static void decomposition_scatter(OSQPDecomposition *d, const c_int *blk,
+                                  const c_int *pos, const c_int *off,
+                                  const c_float *x, const c_int *idx, c_int nx,
+                                  c_float *xb, c_int *idxb, c_int *end) {
+    c_int b, k, t;
+
+    if (!idx) {
+        for (k = 0; k < nx; k++) xb[pos[k]] = x[k];
+        for (b = 0; b < d->nblocks; b++) end[b] = off[b + 1];
+        return;
+    }
+    for (b = 0; b <= d->nblocks; b++) end[b] = 0;
+    for (k = 0; k < nx; k++) end[blk[idx[k]] + 1]++;
+    for (b = 0; b < d->nblocks; b++) end[b + 1] += end[b];
+    for (k = 0; k < nx; k++) {
+        b = blk[idx[k]];
+        t = end[b]++;
+        xb[t] = x[k];
+        idxb[t] = pos[idx[k]] - off[b];
+    }
+}
+
+static c_int decomposition_update_P_A(OSQPDecomposition *d,
+                                      const c_float *Px, const c_int *Px_idx, c_int Px_n,
+                                      const c_float *Ax, const c_int *Ax_idx, c_int Ax_n) {
+    c_int b, Pfirst, Plen = 0, Afirst, Alen = 0, exitflag = 0;
+
+    if ((Px && Px_n > d->Poff[d->nblocks]) || (Ax && Ax_n > d->Aoff[d->nblocks])) {
+        return 1;
+    }
+    if (Px) {
+        decomposition_scatter(d, d->Pblk, d->Ppos, d->Poff, Px, Px_idx, Px_n,
+                              d->Pxb, d->Pidx, d->Pend);
+    }
+    if (Ax) {
+        decomposition_scatter(d, d->Ablk, d->Apos, d->Aoff, Ax, Ax_idx, Ax_n,
+                              d->Axb, d->Aidx, d->Aend);
+    }
+
+    for (b = 0; b < d->nblocks; b++) {
+        Pfirst = b > 0 ? d->Pend[b - 1] : 0;
+        Afirst = b > 0 ? d->Aend[b - 1] : 0;
+        if (Px) Plen = d->Pend[b] - Pfirst;
+        if (Ax) Alen = d->Aend[b] - Afirst;
+
+        if (Plen > 0 && Alen > 0) {
+            exitflag |= osqp_update_P_A(d->work[b],
+                                        d->Pxb + Pfirst, Px_idx ? d->Pidx + Pfirst : OSQP_NULL, Plen,
+                                        d->Axb + Afirst, Ax_idx ? d->Aidx + Afirst : OSQP_NULL, Alen);
+        } else if (Plen > 0) {
+            exitflag |= osqp_update_P(d->work[b], d->Pxb + Pfirst,
+                                      Px_idx ? d->Pidx + Pfirst : OSQP_NULL, Plen);
+        } else if (Alen > 0) {
+            exitflag |= osqp_update_A(d->work[b], d->Axb + Afirst,
+                                      Ax_idx ? d->Aidx + Afirst : OSQP_NULL, Alen);
+        }
+    }
+    return exitflag;
+}
+
+
+/* Warm start */
+
+static void decomposition_warm_start(OSQPDecomposition *d, const c_float *x,
+                                     const c_float *y) {
+    c_int b, j, i;
+
+    if (x) for (j = 0; j < d->n; j++) d->xb[d->xpos[j]] = x[j];
+    if (y) for (i = 0; i < d->m; i++) d->yb[d->ypos[i]] = y[i];
+    for (b = 0; b < d->nblocks; b++) {
+        if (x) osqp_warm_start_x(d->work[b], d->xb + d->noff[b]);
+        if (y && d->moff[b + 1] > d->moff[b]) {
+            osqp_warm_start_y(d->work[b], d->yb + d->moff[b]);
+        }
+    }
+}
+
+
+/* Solve */
+
+static c_int decomposition_solve_block(void *ctx, c_int b) {
+    OSQPDecomposition *d = (OSQPDecomposition *) ctx;
+
+    return iteration_run(d->work[b], d->iteration[b]);
+}
+
+// Order of the status values from the best to the worst
+static c_int decomposition_status_rank(c_int status_val) {
+    switch (status_val) {
+    case OSQP_SOLVED:                       return 0;
+    case OSQP_SOLVED_INACCURATE:            return 1;
+    case OSQP_MAX_ITER_REACHED:             return 2;
+    case OSQP_TIME_LIMIT_REACHED:           return 3;
+    case OSQP_CANCELLED:                    return 4;
+    case OSQP_SIGINT:                       return 5;
+    case OSQP_DUAL_INFEASIBLE_INACCURATE:   return 6;
+    case OSQP_PRIMAL_INFEASIBLE_INACCURATE: return 7;
+    case OSQP_DUAL_INFEASIBLE:              return 8;
+    case OSQP_PRIMAL_INFEASIBLE:            return 9;
+    case OSQP_NON_CVX:                      return 10;
+    default:                                return 11;
+    }
+}
+
+/*
+ * Solve the blocks in parallel and combine their information. The status of
+ * the problem is the worst status of the blocks.
+ */
+static c_int decomposition_solve(OSQPDecomposition *d) {
+    OSQPInfo *info = &d->info, *binfo;
+    c_int b, worst = 0, exitflag;
+
+    exitflag = parallel_for(d->nthreads, d->nblocks,
+                            &decomposition_solve_block, d);
+
+    for (b = 0; b < d->nblocks; b++) {
+        if (decomposition_status_rank(d->work[b]->info->status_val) >
+            decomposition_status_rank(d->work[worst]->info->status_val)) {
+            worst = b;
+        }
+    }
+    *info = *d->work[worst]->info;
+    info->iter = 0;
+    info->obj_val = 0.;
+    info->pri_res = 0.;
+    info->dua_res = 0.;
+    info->status_polish = 1;
+    info->rho_updates = 0;
+    info->rho_estimate = 0.;
+#ifdef PROFILING
+    info->setup_time = 0.;
+    info->solve_time = 0.;
+    info->update_time = 0.;
+    info->polish_time = 0.;
+    info->run_time = 0.;
+#endif
+    for (b = 0; b < d->nblocks; b++) {
+        binfo = d->work[b]->info;
+        info->iter = c_max(info->iter, binfo->iter);
+        info->obj_val += binfo->obj_val;
+        info->pri_res = c_max(info->pri_res, binfo->pri_res);
+        info->dua_res = c_max(info->dua_res, binfo->dua_res);
+        info->status_polish = c_min(info->status_polish, binfo->status_polish);
+        info->rho_updates += binfo->rho_updates;
+        info->rho_estimate += binfo->rho_estimate / d->nblocks;
+#ifdef PROFILING
+        // Blocks are set up one after the other but solved in parallel
+        info->setup_time += binfo->setup_time;
+        info->solve_time = c_max(info->solve_time, binfo->solve_time);
+        info->update_time += binfo->update_time;
+        info->polish_time = c_max(info->polish_time, binfo->polish_time);
+        info->run_time = c_max(info->run_time, binfo->run_time);
+#endif
+    }
+
+    return exitflag;
+}
+
+/*
+ * Gather a vector of dimension n (or m if dual) from the blocks. For
+ * infeasible problems the certificate of the worst block is extended by
+ * zeros.
+ */
+static c_float *decomposition_gather(OSQPDecomposition *d, c_int dual,
+                                     c_int certificate) {
+    c_int dim = dual ? d->m : d->n;
+    c_int *blk = dual ? d->yblk : d->xblk;
+    c_int *pos = dual ? d->ypos : d->xpos;
+    c_int *off = dual ? d->moff : d->noff;
+    c_float *out = dual ? d->y : d->x;
+    OSQPWorkspace *work;
+    c_float *v;
+    c_int k, b;
+
+    for (k = 0; k < dim; k++) {
+        b = blk[k];
+        work = d->work[b];
+        if (certificate) {
+            if (work->info->status_val != d->info.status_val) {
+                out[k] = 0.;
+                continue;
+            }
+            v = dual ? work->delta_y : work->delta_x;
+        } else {
+            v = dual ? work->solution->y : work->solution->x;
+        }
+        out[k] = v[pos[k] - off[b]];
+    }
+    return out;
+}
+
+#endif
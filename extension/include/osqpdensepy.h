@@ -0,0 +1,228 @@
+#ifndef OSQPDENSEPY_H
+#define OSQPDENSEPY_H
+
+/*****************************************************
+ * Dense LDL' linear system solver                   *
+ *****************************************************/
+
+/*
+ * Linear system solver for small KKT matrices. Like the supernodal solver it
+ * is set up on top of QDLDL, which keeps assembling the KKT matrix, but the
+ * factor is stored as a dense column-major matrix. This removes the index
+ * indirection of the sparse factor, and the factorization and solves run
+ * over contiguous columns that the compiler vectorizes.
+ *
+ * Only the linear system is dense. The other steps of an ADMM iteration are
+ * vector operations, and the products with P and A of the termination
+ * checks keep using the CSC matrices of the workspace.
+ */
+#define DENSE_SOLVER (SUPERNODAL_SOLVER + 2)   // Follows BOX_SOLVER
+
+// Largest KKT matrix selected automatically for the dense solver
+#define DENSE_MAX_DIM (150)
+
+// Smallest fill of the sparse factor, relative to a dense one, for which the
+// dense solver is selected automatically
+#define DENSE_MIN_FILL (0.25)
+
+
+typedef struct dense dense_solver;
+
+struct dense {
+    enum linsys_solver_type type;
+
+    c_int (*solve)(struct dense * self, c_float * b);
+    void (*free)(struct dense * self);
+    c_int (*update_matrices)(struct dense * self, const csc *P, const csc *A);
+    c_int (*update_rho_vec)(struct dense * self, const c_float * rho_vec);
+
+    c_int nthreads;
+
+    qdldl_solver * kkt;     // KKT matrix and permutation
+    c_int n;                // Dimension of the KKT matrix
+    c_float *L;             // Dense column-major unit lower triangular factor
+};
+
+
+/* Numerical factorization */
+
+static c_int dense_factor(dense_solver *s) {
+    csc *KKT = s->kkt->KKT;
+    c_int n = s->n;
+    c_int j, p, npos;
+
+    // Lower triangular part of the permuted KKT matrix
+    for (j = 0; j < n * n; j++) s->L[j] = 0.0;
+    for (j = 0; j < n; j++) {
+        for (p = KKT->p[j]; p < KKT->p[j + 1]; p++) {
+            s->L[j + KKT->i[p] * n] = KKT->x[p];
+        }
+    }
+
+    // The whole matrix is a single panel
+    npos = supernodal_panel_factor(n, n, s->L, s->kkt->D, s->kkt->Dinv);
+    if (npos < 0) {
+#ifdef PRINTING
+        c_eprint("Error in KKT matrix LDL factorization when computing the nonzero elements. There are zeros in the diagonal matrix");
+#endif
+        return -1;
+    }
+
+    // The KKT matrix is quasidefinite: n positive and m negative pivots
+    if (npos < s->kkt->n) {
+#ifdef PRINTING
+        c_eprint("KKT matrix is not quasidefinite");
+#endif
+        return -2;
+    }
+
+    return 0;
+}
+
+
+/* Solve */
+
+static void dense_ldlsolve(dense_solver *s, c_float *x) {
+    c_int n = s->n;
+    c_int i, j;
+    c_float xj;
+    const c_float *Lj;
+
+    // Forward substitution with L, one column at a time
+    for (j = 0; j < n; j++) {
+        Lj = s->L + j * n;
+        xj = x[j];
+        for (i = j + 1; i < n; i++) x[i] -= Lj[i] * xj;
+    }
+
+    // Diagonal
+    for (j = 0; j < n; j++) x[j] *= s->kkt->Dinv[j];
+
+    // Backward substitution with L', one dot product per column
+    for (j = n - 1; j >= 0; j--) {
+        Lj = s->L + j * n;
+        xj = x[j];
+        for (i = j + 1; i < n; i++) xj -= Lj[i] * x[i];
+        x[j] = xj;
+    }
+}
+
+static c_int solve_linsys_dense(dense_solver *s, c_float *b) {
+    qdldl_solver *q = s->kkt;
+    c_int j;
+
+    // bp = P b
+    for (j = 0; j < s->n; j++) q->bp[j] = b[q->P[j]];
+    dense_ldlsolve(s, q->bp);
+    for (j = 0; j < s->n; j++) q->sol[q->P[j]] = q->bp[j];
+
+    // x_tilde and z_tilde
+    for (j = 0; j < q->n; j++) b[j] = q->sol[j];
+    for (j = 0; j < q->m; j++) b[j + q->n] += q->rho_inv_vec[j] * q->sol[j + q->n];
+
+    return 0;
+}
+
+
+/* Updates */
+
+static c_int update_linsys_solver_matrices_dense(dense_solver *s,
+                                                 const csc *P, const csc *A) {
+    qdldl_solver *q = s->kkt;
+
+    update_KKT_P(q->KKT, P, q->PtoKKT, q->sigma, q->Pdiag_idx, q->Pdiag_n);
+    update_KKT_A(q->KKT, A, q->AtoKKT);
+
+    return dense_factor(s);
+}
+
+static c_int update_linsys_solver_rho_vec_dense(dense_solver *s,
+                                                const c_float *rho_vec) {
+    qdldl_solver *q = s->kkt;
+    c_int i;
+
+    for (i = 0; i < q->m; i++) q->rho_inv_vec[i] = 1. / rho_vec[i];
+    update_KKT_param2(q->KKT, q->rho_inv_vec, q->rhotoKKT, q->m);
+
+    return dense_factor(s);
+}
+
+
+static void free_linsys_solver_dense(dense_solver *s) {
+    if (s) {
+        if (s->kkt) s->kkt->free(s->kkt);
+        if (s->L) c_free(s->L);
+        c_free(s);
+    }
+}
+
+
+// Whether a linear system solver is a QDLDL solver small and dense enough
+// for the dense solver
+static c_int dense_eligible(const LinSysSolver *solver, c_int max_dim) {
+    const qdldl_solver *q = (const qdldl_solver *) solver;
+    c_float n;
+
+    if (solver->type != QDLDL_SOLVER || q->KKT->n > max_dim) return 0;
+    n = (c_float) q->KKT->n;
+    return q->L->p[q->KKT->n] >= DENSE_MIN_FILL * n * (n - 1.) / 2.;
+}
+
+/*
+ * Replace a QDLDL solver, as created by osqp_setup, with the dense solver.
+ * The QDLDL solver is kept to own the KKT matrix, the permutation and the
+ * pattern of L.
+ */
+static c_int dense_install(LinSysSolver **solver) {
+    qdldl_solver *q = (qdldl_solver *) *solver;
+    dense_solver *s;
+
+    if (q->type != QDLDL_SOLVER) return 1;
+
+    s = (dense_solver *)c_calloc(1, sizeof(dense_solver));
+    if (!s) return 1;
+
+    s->type = DENSE_SOLVER;
+    s->solve = &solve_linsys_dense;
+    s->free = &free_linsys_solver_dense;
+    s->update_matrices = &update_linsys_solver_matrices_dense;
+    s->update_rho_vec = &update_linsys_solver_rho_vec_dense;
+    s->nthreads = 1;
+    s->kkt = q;
+    s->n = q->KKT->n;
+    s->L = (c_float *)c_malloc(c_max(s->n * s->n, 1) * sizeof(c_float));
+
+    if (!s->L || dense_factor(s)) {
+        // Leave the QDLDL solver in place
+        s->kkt = OSQP_NULL;
+        free_linsys_solver_dense(s);
+        return 1;
+    }
+
+    *solver = (LinSysSolver *) s;
+
+    return 0;
+}
+
+/*
+ * Restore the QDLDL solver under a dense solver, refactoring the current
+ * KKT matrix. Used when the sparse factor itself is needed.
+ */
+static c_int dense_uninstall(LinSysSolver **solver) {
+    dense_solver *s = (dense_solver *) *solver;
+    qdldl_solver *q = s->kkt;
+
+    if (QDLDL_factor(q->KKT->n, q->KKT->p, q->KKT->i, q->KKT->x,
+                     q->L->p, q->L->i, q->L->x, q->D, q->Dinv, q->Lnz,
+                     q->etree, q->bwork, q->iwork, q->fwork) < q->n) {
+        return 1;
+    }
+
+    s->kkt = OSQP_NULL;
+    free_linsys_solver_dense(s);
+    *solver = (LinSysSolver *) q;
+
+    return 0;
+}
+
+#endif
@@ -0,0 +1,648 @@
+#ifndef OSQPDERIVATIVEPY_H
+#define OSQPDERIVATIVEPY_H
+
+#include "amd.h"
+#include "kkt.h"
+#include "qdldl.h"
+
+/*****************************************************
+ * Derivatives of the solution of the problem        *
+ *****************************************************/
+
+/*
+ * At a solution (x, y) a constraint is active at its upper bound when
+ * y_i > 0 and u_i - (Ax)_i < y_i, and at its lower bound when y_i < 0 and
+ * (Ax)_i - l_i < -y_i. With A_S the rows of the active constraints, the
+ * derivatives solve the reduced KKT system
+ *
+ *   [P    A_S'] [r_x]   [b_x]
+ *   [A_S  0   ] [r_w] = [b_S]
+ *
+ * and r_w = 0 on the inactive constraints. The inactive rows are kept as
+ * -r_w_i = 0, so the system has the pattern of the KKT matrix of the solver
+ * and its ordering is reused (AMD is used when the bounds were eliminated).
+ * The symbolic analysis is done once per problem, every solve only refactors
+ * the matrix regularized by eps, and the solutions are refined on the exact
+ * system. P, A, l, u and the solution are unscaled from the workspace.
+ */
+#define DERIVATIVE_REFINE_ITER (20)     // Maximum steps of iterative refinement
+#define DERIVATIVE_REFINE_TOL  (1e-12)  // Residual norm of the refined solutions
+
+typedef struct {
+    c_int n, m;
+    const csc *P, *A;       // Patterns of P and A (data of the workspace)
+    csc *KKT;               // Permuted upper triangular part of the reduced KKT matrix
+    c_int *perm;            // Permutation of the KKT matrix
+    c_int *PtoKKT, *AtoKKT; // Entries of P and A in KKT->x
+    c_int *diagtoKKT;       // Diagonal entries of the unpermuted columns in KKT->x
+
+    // LDL' factorization of the KKT matrix
+    csc *L;
+    QDLDL_float *D, *Dinv;
+    QDLDL_int *etree, *Lnz, *iwork;
+    QDLDL_bool *bwork;
+    QDLDL_float *fwork;
+
+    // Unscaled problem at the solution of the last factorization
+    c_float *Px, *Ax;
+    c_float *x, *y;
+    c_int *active;          // 1 (upper bound), -1 (lower bound) or 0 (inactive)
+    c_float eps;            // Regularization of the factored matrix
+    c_int factored;         // Whether the factorization is the one of the last solve
+
+    c_float *rhs, *sol, *res, *work;    // Vectors of length n + m
+    c_int shared;           // Whether the symbolic analysis (pattern of KKT, perm,
+                            // maps, etree and Lnz) belongs to another derivative
+} OSQPDerivative;
+
+
+static void derivative_free(OSQPDerivative *d) {
+    if (d) {
+        if (d->shared) {
+            if (d->KKT && d->KKT->x) c_free(d->KKT->x);
+            if (d->KKT) c_free(d->KKT);
+        } else {
+            if (d->KKT) csc_spfree(d->KKT);
+            if (d->perm) c_free(d->perm);
+            if (d->PtoKKT) c_free(d->PtoKKT);
+            if (d->AtoKKT) c_free(d->AtoKKT);
+            if (d->diagtoKKT) c_free(d->diagtoKKT);
+            if (d->etree) c_free(d->etree);
+            if (d->Lnz) c_free(d->Lnz);
+        }
+        if (d->L) csc_spfree(d->L);
+        if (d->D) c_free(d->D);
+        if (d->Dinv) c_free(d->Dinv);
+        if (d->iwork) c_free(d->iwork);
+        if (d->bwork) c_free(d->bwork);
+        if (d->fwork) c_free(d->fwork);
+        if (d->Px) c_free(d->Px);
+        if (d->Ax) c_free(d->Ax);
+        if (d->x) c_free(d->x);
+        if (d->y) c_free(d->y);
+        if (d->active) c_free(d->active);
+        if (d->rhs) c_free(d->rhs);
+        if (d->sol) c_free(d->sol);
+        if (d->res) c_free(d->res);
+        if (d->work) c_free(d->work);
+        c_free(d);
+    }
+}
+
+/*
+ * Symbolic analysis of the reduced KKT matrix of the data. The permutation
+ * perm of the KKT matrix of the solver is used if given.
+ */
+static OSQPDerivative *derivative_setup(const OSQPData *data, const c_int *perm) {
+    OSQPDerivative *d;
+    c_int n = data->n;
+    c_int m = data->m;
+    c_int N = n + m;
+    c_int Pnz = data->P->p[n];
+    c_int Anz = data->A->p[n];
+    c_int *rhotoKKT, *Pinv, *KtoPKPt;
+    c_float *ones, Info[AMD_INFO];
+    csc *KKT_temp;
+    c_int i, j, k, sum_Lnz, exitflag = 0;
+
+    d = (OSQPDerivative *)c_calloc(1, sizeof(OSQPDerivative));
+    if (!d) return OSQP_NULL;
+    d->n = n;
+    d->m = m;
+    d->P = data->P;
+    d->A = data->A;
+
+    // Unpermuted KKT matrix and maps from P, A and the diagonal to its entries
+    d->PtoKKT    = (c_int *)c_malloc(c_max(Pnz, 1) * sizeof(c_int));
+    d->AtoKKT    = (c_int *)c_malloc(c_max(Anz, 1) * sizeof(c_int));
+    d->diagtoKKT = (c_int *)c_malloc(N * sizeof(c_int));
+    d->perm      = (c_int *)c_malloc(N * sizeof(c_int));
+    rhotoKKT     = (c_int *)c_malloc(c_max(m, 1) * sizeof(c_int));
+    ones         = (c_float *)c_malloc(c_max(m, 1) * sizeof(c_float));
+    if (!d->PtoKKT || !d->AtoKKT || !d->diagtoKKT || !d->perm || !rhotoKKT || !ones) {
+        if (rhotoKKT) c_free(rhotoKKT);
+        if (ones) c_free(ones);
+        derivative_free(d);
+        return OSQP_NULL;
+    }
+    for (i = 0; i < m; i++) ones[i] = 1.0;
+    KKT_temp = form_KKT(data->P, data->A, 0, 1.0, ones, d->PtoKKT, d->AtoKKT,
+                        OSQP_NULL, OSQP_NULL, rhotoKKT);
+    c_free(ones);
+    if (!KKT_temp) {
+        c_free(rhotoKKT);
+        derivative_free(d);
+        return OSQP_NULL;
+    }
+    for (j = 0; j < n; j++) {
+        for (k = KKT_temp->p[j]; k < KKT_temp->p[j + 1]; k++) {
+            if (KKT_temp->i[k] == j) d->diagtoKKT[j] = k;
+        }
+    }
+    for (i = 0; i < m; i++) d->diagtoKKT[n + i] = rhotoKKT[i];
+    c_free(rhotoKKT);
+
+    // Ordering of the solver, or AMD
+    if (perm) {
+        for (i = 0; i < N; i++) d->perm[i] = perm[i];
+    } else {
+        exitflag = amd_order(N, KKT_temp->p, KKT_temp->i, d->perm, OSQP_NULL, Info) < 0;
+    }
+
+    // Permute the KKT matrix and compose the maps with the permutation
+    Pinv = exitflag ? OSQP_NULL : csc_pinv(d->perm, N);
+    KtoPKPt = (c_int *)c_malloc(c_max(KKT_temp->p[N], 1) * sizeof(c_int));
+    if (Pinv && KtoPKPt) {
+        d->KKT = csc_symperm(KKT_temp, Pinv, KtoPKPt, 1);
+        for (k = 0; k < Pnz; k++) d->PtoKKT[k] = KtoPKPt[d->PtoKKT[k]];
+        for (k = 0; k < Anz; k++) d->AtoKKT[k] = KtoPKPt[d->AtoKKT[k]];
+        for (i = 0; i < N; i++) d->diagtoKKT[i] = KtoPKPt[d->diagtoKKT[i]];
+    }
+    csc_spfree(KKT_temp);
+    if (KtoPKPt) c_free(KtoPKPt);
+    if (Pinv) c_free(Pinv);
+    if (!d->KKT) {
+        derivative_free(d);
+        return OSQP_NULL;
+    }
+
+    // Symbolic factorization
+    d->etree = (QDLDL_int *)c_malloc(N * sizeof(QDLDL_int));
+    d->Lnz   = (QDLDL_int *)c_malloc(N * sizeof(QDLDL_int));
+    d->iwork = (QDLDL_int *)c_malloc(3 * N * sizeof(QDLDL_int));
+    d->bwork = (QDLDL_bool *)c_malloc(N * sizeof(QDLDL_bool));
+    d->fwork = (QDLDL_float *)c_malloc(N * sizeof(QDLDL_float));
+    if (!d->etree || !d->Lnz || !d->iwork || !d->bwork || !d->fwork) {
+        derivative_free(d);
+        return OSQP_NULL;
+    }
+    sum_Lnz = QDLDL_etree(N, d->KKT->p, d->KKT->i, d->iwork, d->Lnz, d->etree);
+    if (sum_Lnz < 0) {
+        derivative_free(d);
+        return OSQP_NULL;
+    }
+    d->L    = csc_spalloc(N, N, c_max(sum_Lnz, 1), 1, 0);
+    d->D    = (QDLDL_float *)c_malloc(N * sizeof(QDLDL_float));
+    d->Dinv = (QDLDL_float *)c_malloc(N * sizeof(QDLDL_float));
+
+    d->Px     = (c_float *)c_malloc(c_max(Pnz, 1) * sizeof(c_float));
+    d->Ax     = (c_float *)c_malloc(c_max(Anz, 1) * sizeof(c_float));
+    d->x      = (c_float *)c_malloc(n * sizeof(c_float));
+    d->y      = (c_float *)c_malloc(c_max(m, 1) * sizeof(c_float));
+    d->active = (c_int *)c_malloc(c_max(m, 1) * sizeof(c_int));
+    d->rhs    = (c_float *)c_malloc(N * sizeof(c_float));
+    d->sol    = (c_float *)c_malloc(N * sizeof(c_float));
+    d->res    = (c_float *)c_malloc(N * sizeof(c_float));
+    d->work   = (c_float *)c_malloc(N * sizeof(c_float));
+    if (!d->L || !d->D || !d->Dinv || !d->Px || !d->Ax || !d->x || !d->y ||
+        !d->active || !d->rhs || !d->sol || !d->res || !d->work) {
+        derivative_free(d);
+        return OSQP_NULL;
+    }
+    return d;
+}
+
+/*
+ * Derivative sharing the symbolic analysis of src, which must outlive it,
+ * with its own factorization and vectors. Clones of the same derivative can
+ * be factored by several threads at once.
+ */
+static OSQPDerivative *derivative_clone(const OSQPDerivative *src) {
+    OSQPDerivative *d;
+    c_int n = src->n;
+    c_int m = src->m;
+    c_int N = n + m;
+
+    d = (OSQPDerivative *)c_calloc(1, sizeof(OSQPDerivative));
+    if (!d) return OSQP_NULL;
+    d->n = n;
+    d->m = m;
+    d->P = src->P;
+    d->A = src->A;
+    d->perm = src->perm;
+    d->PtoKKT = src->PtoKKT;
+    d->AtoKKT = src->AtoKKT;
+    d->diagtoKKT = src->diagtoKKT;
+    d->etree = src->etree;
+    d->Lnz = src->Lnz;
+    d->shared = 1;
+
+    // Pattern of the KKT matrix of src with its own values
+    d->KKT = (csc *)c_malloc(sizeof(csc));
+    if (!d->KKT) {
+        derivative_free(d);
+        return OSQP_NULL;
+    }
+    *d->KKT = *src->KKT;
+    d->KKT->x = (c_float *)c_malloc(c_max(src->KKT->p[N], 1) * sizeof(c_float));
+
+    d->L      = csc_spalloc(N, N, src->L->nzmax, 1, 0);
+    d->D      = (QDLDL_float *)c_malloc(N * sizeof(QDLDL_float));
+    d->Dinv   = (QDLDL_float *)c_malloc(N * sizeof(QDLDL_float));
+    d->iwork  = (QDLDL_int *)c_malloc(3 * N * sizeof(QDLDL_int));
+    d->bwork  = (QDLDL_bool *)c_malloc(N * sizeof(QDLDL_bool));
+    d->fwork  = (QDLDL_float *)c_malloc(N * sizeof(QDLDL_float));
+    d->Px     = (c_float *)c_malloc(c_max(src->P->p[n], 1) * sizeof(c_float));
+    d->Ax     = (c_float *)c_malloc(c_max(src->A->p[n], 1) * sizeof(c_float));
+    d->x      = (c_float *)c_malloc(n * sizeof(c_float));
+    d->y      = (c_float *)c_malloc(c_max(m, 1) * sizeof(c_float));
+    d->active = (c_int *)c_malloc(c_max(m, 1) * sizeof(c_int));
+    d->rhs    = (c_float *)c_malloc(N * sizeof(c_float));
+    d->sol    = (c_float *)c_malloc(N * sizeof(c_float));
+    d->res    = (c_float *)c_malloc(N * sizeof(c_float));
+    d->work   = (c_float *)c_malloc(N * sizeof(c_float));
+    if (!d->KKT->x || !d->L || !d->D || !d->Dinv || !d->iwork || !d->bwork ||
+        !d->fwork || !d->Px || !d->Ax || !d->x || !d->y || !d->active ||
+        !d->rhs || !d->sol || !d->res || !d->work) {
+        derivative_free(d);
+        return OSQP_NULL;
+    }
+    return d;
+}
+
+// Unscaled values of P and A of the workspace: P = P~ / (c D D), A = E^-1 A~ D^-1
+static void derivative_unscale_matrices(const OSQPWorkspace *work, c_float *Px,
+                                        c_float *Ax) {
+    const csc *P = work->data->P, *A = work->data->A;
+    const OSQPScaling *s = work->settings->scaling ? work->scaling : OSQP_NULL;
+    c_int j, k;
+
+    for (j = 0; j < work->data->n; j++) {
+        for (k = P->p[j]; k < P->p[j + 1]; k++) {
+            Px[k] = s ? P->x[k] * s->cinv * s->Dinv[P->i[k]] * s->Dinv[j] : P->x[k];
+        }
+        for (k = A->p[j]; k < A->p[j + 1]; k++) {
+            Ax[k] = s ? A->x[k] * s->Einv[A->i[k]] * s->Dinv[j] : A->x[k];
+        }
+    }
+}
+
+// Unscaled q, l and u of the workspace: q = D^-1 q~ / c, l = E^-1 l~, u = E^-1 u~
+static void derivative_unscale_vectors(const OSQPWorkspace *work, c_float *q,
+                                       c_float *l, c_float *u) {
+    const OSQPScaling *s = work->settings->scaling ? work->scaling : OSQP_NULL;
+    c_int i;
+
+    for (i = 0; i < work->data->n; i++) {
+        q[i] = s ? work->data->q[i] * s->cinv * s->Dinv[i] : work->data->q[i];
+    }
+    for (i = 0; i < work->data->m; i++) {
+        l[i] = s ? work->data->l[i] * s->Einv[i] : work->data->l[i];
+        u[i] = s ? work->data->u[i] * s->Einv[i] : work->data->u[i];
+    }
+}
+
+/*
+ * Factor the reduced KKT matrix at the solution of the workspace, regularized
+ * by eps. Returns 1 if the matrix is not quasidefinite.
+ */
+static c_int derivative_factor(OSQPDerivative *d, const OSQPWorkspace *work,
+                               c_float eps) {
+    const csc *P = d->P, *A = d->A;
+    const OSQPScaling *s = work->settings->scaling ? work->scaling : OSQP_NULL;
+    c_float *Kx = d->KKT->x, *Ax = d->res;
+    c_int n = d->n, m = d->m, N = n + m;
+    c_int i, j, k;
+    c_float l, u;
+
+    d->factored = 0;
+
+    derivative_unscale_matrices(work, d->Px, d->Ax);
+    prea_vec_copy(work->solution->x, d->x, n);
+    prea_vec_copy(work->solution->y, d->y, m);
+
+    // Active constraints
+    for (i = 0; i < m; i++) Ax[i] = 0.;
+    for (j = 0; j < n; j++) {
+        for (k = A->p[j]; k < A->p[j + 1]; k++) Ax[A->i[k]] += d->Ax[k] * d->x[j];
+    }
+    for (i = 0; i < m; i++) {
+        l = s ? work->data->l[i] * s->Einv[i] : work->data->l[i];
+        u = s ? work->data->u[i] * s->Einv[i] : work->data->u[i];
+        if (d->y[i] > 0. && u - Ax[i] < d->y[i]) {
+            d->active[i] = 1;
+        } else if (d->y[i] < 0. && Ax[i] - l < -d->y[i]) {
+            d->active[i] = -1;
+        } else {
+            d->active[i] = 0;
+        }
+    }
+
+    // Values of the regularized KKT matrix
+    for (k = 0; k < d->KKT->p[N]; k++) Kx[k] = 0.;
+    for (k = 0; k < P->p[n]; k++) Kx[d->PtoKKT[k]] += d->Px[k];
+    for (k = 0; k < A->p[n]; k++) {
+        Kx[d->AtoKKT[k]] = d->active[A->i[k]] ? d->Ax[k] : 0.;
+    }
+    for (j = 0; j < n; j++) Kx[d->diagtoKKT[j]] += eps;
+    for (i = 0; i < m; i++) Kx[d->diagtoKKT[n + i]] = d->active[i] ? -eps : -1.;
+
+    if (QDLDL_factor(N, d->KKT->p, d->KKT->i, Kx, d->L->p, d->L->i, d->L->x,
+                     d->D, d->Dinv, d->Lnz, d->etree, d->bwork, d->iwork,
+                     d->fwork) < n) {
+        return 1;
+    }
+    d->eps = eps;
+    d->factored = 1;
+    return 0;
+}
+
+// out = K v with the exact (unregularized) reduced KKT matrix
+static void derivative_kkt_mult(const OSQPDerivative *d, const c_float *v,
+                                c_float *out) {
+    const csc *P = d->P, *A = d->A;
+    const c_float *vw = v + d->n;
+    c_float *outw = out + d->n;
+    c_int i, j, k;
+
+    for (j = 0; j < d->n; j++) out[j] = 0.;
+    for (i = 0; i < d->m; i++) outw[i] = d->active[i] ? 0. : -vw[i];
+    for (j = 0; j < d->n; j++) {
+        for (k = P->p[j]; k < P->p[j + 1]; k++) {
+            i = P->i[k];
+            out[i] += d->Px[k] * v[j];
+            if (i != j) out[j] += d->Px[k] * v[i];
+        }
+        for (k = A->p[j]; k < A->p[j + 1]; k++) {
+            i = A->i[k];
+            if (!d->active[i]) continue;
+            out[j] += d->Ax[k] * vw[i];
+            outw[i] += d->Ax[k] * v[j];
+        }
+    }
+}
+
+// Solve with the factored matrix in place
+static void derivative_kkt_solve(OSQPDerivative *d, c_float *b) {
+    c_int k, N = d->n + d->m;
+
+    for (k = 0; k < N; k++) d->work[k] = b[d->perm[k]];
+    QDLDL_solve(N, d->L->p, d->L->i, d->L->x, d->Dinv, d->work);
+    for (k = 0; k < N; k++) b[d->perm[k]] = d->work[k];
+}
+
+/*
+ * Solve K sol = rhs with iterative refinement on the exact matrix. Returns 1
+ * if the refinement did not converge.
+ */
+static c_int derivative_refined_solve(OSQPDerivative *d, const c_float *rhs,
+                                      c_float *sol) {
+    c_int k, it, N = d->n + d->m;
+
+    prea_vec_copy(rhs, sol, N);
+    derivative_kkt_solve(d, sol);
+    for (it = 0; it < DERIVATIVE_REFINE_ITER; it++) {
+        derivative_kkt_mult(d, sol, d->res);
+        for (k = 0; k < N; k++) d->res[k] = rhs[k] - d->res[k];
+        if (c_sqrt(vec_prod(d->res, d->res, N)) < DERIVATIVE_REFINE_TOL) return 0;
+        derivative_kkt_solve(d, d->res);
+        for (k = 0; k < N; k++) sol[k] += d->res[k];
+    }
+    return 1;
+}
+
+/*
+ * Right-hand side of the adjoint system for the gradients dx, dy_u and dy_l,
+ * any of which may be NULL (zero)
+ */
+static void derivative_adjoint_rhs(const OSQPDerivative *d, const c_float *dx,
+                                   const c_float *dy_u, const c_float *dy_l,
+                                   c_float *rhs) {
+    c_int i, j;
+
+    for (j = 0; j < d->n; j++) rhs[j] = dx ? -dx[j] : 0.;
+    for (i = 0; i < d->m; i++) {
+        if (d->active[i] == 1 && dy_u) {
+            rhs[d->n + i] = -dy_u[i];
+        } else if (d->active[i] == -1 && dy_l) {
+            rhs[d->n + i] = dy_l[i];
+        } else {
+            rhs[d->n + i] = 0.;
+        }
+    }
+}
+
+// Gradients dq, dl and du from the solution of the adjoint system
+static void derivative_adjoint_vectors(const OSQPDerivative *d, const c_float *sol,
+                                       c_float *dq, c_float *dl, c_float *du) {
+    const c_float *w = sol + d->n;
+    c_int i;
+
+    prea_vec_copy(sol, dq, d->n);
+    for (i = 0; i < d->m; i++) {
+        du[i] = d->active[i] == 1 ? -w[i] : 0.;
+        dl[i] = d->active[i] == -1 ? -w[i] : 0.;
+    }
+}
+
+/*
+ * Adjoint derivative: the gradients dq, dl and du of a loss whose gradients
+ * with respect to x, max(y, 0) and -min(y, 0) are dx, dy_u and dy_l. The
+ * gradients with respect to P and A follow from r_x = dq and r_w = -(dl + du).
+ * Returns 1 if the refinement did not converge.
+ */
+static c_int derivative_adjoint(OSQPDerivative *d, const c_float *dx,
+                                const c_float *dy_u, const c_float *dy_l,
+                                c_float *dq, c_float *dl, c_float *du) {
+    c_int exitflag;
+
+    derivative_adjoint_rhs(d, dx, dy_u, dy_l, d->rhs);
+    exitflag = derivative_refined_solve(d, d->rhs, d->sol);
+    derivative_adjoint_vectors(d, d->sol, dq, dl, du);
+    return exitflag;
+}
+
+
+/* Batches of gradients */
+
+/*
+ * Solve the k right-hand sides b + r * N in place with the factored matrix.
+ * The sides are interleaved in X (of length k * N), so that every entry of
+ * L is loaded once for all of them.
+ */
+static void derivative_kkt_solve_multi(const OSQPDerivative *d, c_float *b,
+                                       c_int k, c_float *X) {
+    const c_int *Lp = d->L->p, *Li = d->L->i;
+    const c_float *Lx = d->L->x;
+    c_int N = d->n + d->m;
+    c_int j, p, r;
+    c_float *Xj, *Xi;
+
+    for (j = 0; j < N; j++) {
+        for (r = 0; r < k; r++) X[j * k + r] = b[r * N + d->perm[j]];
+    }
+    for (j = 0; j < N; j++) {
+        Xj = X + j * k;
+        for (p = Lp[j]; p < Lp[j + 1]; p++) {
+            Xi = X + Li[p] * k;
+            for (r = 0; r < k; r++) Xi[r] -= Lx[p] * Xj[r];
+        }
+    }
+    for (j = 0; j < N; j++) {
+        for (r = 0; r < k; r++) X[j * k + r] *= d->Dinv[j];
+    }
+    for (j = N - 1; j >= 0; j--) {
+        Xj = X + j * k;
+        for (p = Lp[j]; p < Lp[j + 1]; p++) {
+            Xi = X + Li[p] * k;
+            for (r = 0; r < k; r++) Xj[r] -= Lx[p] * Xi[r];
+        }
+    }
+    for (j = 0; j < N; j++) {
+        for (r = 0; r < k; r++) b[r * N + d->perm[j]] = X[j * k + r];
+    }
+}
+
+/*
+ * Solve the k systems K sol + r * N = rhs + r * N with iterative refinement
+ * of all of them at once. res and X have length k * N. Returns 1 if the
+ * refinement did not converge.
+ */
+static c_int derivative_refined_solve_multi(const OSQPDerivative *d,
+                                            const c_float *rhs, c_float *sol,
+                                            c_int k, c_float *res, c_float *X) {
+    c_int i, r, it, converged, N = d->n + d->m;
+    c_float *res_r;
+
+    prea_vec_copy(rhs, sol, k * N);
+    derivative_kkt_solve_multi(d, sol, k, X);
+    for (it = 0; it < DERIVATIVE_REFINE_ITER; it++) {
+        converged = 1;
+        for (r = 0; r < k; r++) {
+            res_r = res + r * N;
+            derivative_kkt_mult(d, sol + r * N, res_r);
+            for (i = 0; i < N; i++) res_r[i] = rhs[r * N + i] - res_r[i];
+            if (c_sqrt(vec_prod(res_r, res_r, N)) >= DERIVATIVE_REFINE_TOL) converged = 0;
+        }
+        if (converged) return 0;
+        derivative_kkt_solve_multi(d, res, k, X);
+        for (i = 0; i < k * N; i++) sol[i] += res[i];
+    }
+    return 1;
+}
+
+/*
+ * Gradients with respect to the values Px of the upper triangular P and Ax
+ * of A, as passed to update(Px=..., Ax=...). An off-diagonal value of Px
+ * sets both P_ij and P_ji.
+ */
+static void derivative_matrix_values(const OSQPDerivative *d, const c_float *sol,
+                                     c_float *dPx, c_float *dAx) {
+    const csc *P = d->P, *A = d->A;
+    const c_float *r_x = sol, *w = sol + d->n;
+    c_int i, j, k;
+
+    for (j = 0; j < d->n; j++) {
+        for (k = P->p[j]; k < P->p[j + 1]; k++) {
+            i = P->i[k];
+            dPx[k] = i == j ? r_x[i] * d->x[i] : r_x[i] * d->x[j] + r_x[j] * d->x[i];
+        }
+        for (k = A->p[j]; k < A->p[j + 1]; k++) {
+            i = A->i[k];
+            dAx[k] = d->y[i] * r_x[j] + (d->active[i] ? w[i] * d->x[j] : 0.);
+        }
+    }
+}
+
+/*
+ * Adjoint derivatives of k gradients. dx, dy_u and dy_l are stacked by rows
+ * or NULL when zero, and the outputs are stacked by rows. rhs, sol, res and X have length k * N. Returns 1 if the
+ * refinement did not converge.
+ */
+static c_int derivative_adjoint_batch(const OSQPDerivative *d, c_int k,
+                                      const c_float *dx, const c_float *dy_u,
+                                      const c_float *dy_l, c_float *dPx,
+                                      c_float *dq, c_float *dAx, c_float *dl,
+                                      c_float *du, c_float *rhs, c_float *sol,
+                                      c_float *res, c_float *X) {
+    c_int r, exitflag, n = d->n, m = d->m, N = n + m;
+
+    for (r = 0; r < k; r++) {
+        derivative_adjoint_rhs(d, dx ? dx + r * n : OSQP_NULL,
+                               dy_u ? dy_u + r * m : OSQP_NULL,
+                               dy_l ? dy_l + r * m : OSQP_NULL, rhs + r * N);
+    }
+    exitflag = derivative_refined_solve_multi(d, rhs, sol, k, res, X);
+    for (r = 0; r < k; r++) {
+        derivative_adjoint_vectors(d, sol + r * N, dq + r * n, dl + r * m, du + r * m);
+        derivative_matrix_values(d, sol + r * N, dPx + r * d->P->p[n], dAx + r * d->A->p[n]);
+    }
+    return exitflag;
+}
+
+
+/* Forward derivatives */
+
+/*
+ * Right-hand side of the forward system for the perturbations dPx (of the
+ * upper triangular P), dq, dAx, dl and du, any of which may be NULL (zero).
+ * Differentiating P x + q + A' y = 0 and A_S x = b_S gives
+ *
+ *   P dx + A_S' dy_S = -dP x - dq - dA' y
+ *   A_S dx           = db_S - dA_S x
+ *
+ * with db_i = du_i on the upper and dl_i on the lower active bounds.
+ */
+static void derivative_forward_rhs(const OSQPDerivative *d, const c_float *dPx,
+                                   const c_float *dq, const c_float *dAx,
+                                   const c_float *dl, const c_float *du,
+                                   c_float *rhs) {
+    const csc *P = d->P, *A = d->A;
+    c_float *rhs_w = rhs + d->n;
+    c_int i, j, k;
+
+    for (j = 0; j < d->n; j++) rhs[j] = dq ? -dq[j] : 0.;
+    for (i = 0; i < d->m; i++) {
+        if (d->active[i] == 1 && du) {
+            rhs_w[i] = du[i];
+        } else if (d->active[i] == -1 && dl) {
+            rhs_w[i] = dl[i];
+        } else {
+            rhs_w[i] = 0.;
+        }
+    }
+    for (j = 0; j < d->n; j++) {
+        for (k = P->p[j]; dPx && k < P->p[j + 1]; k++) {
+            i = P->i[k];
+            rhs[i] -= dPx[k] * d->x[j];
+            if (i != j) rhs[j] -= dPx[k] * d->x[i];
+        }
+        for (k = A->p[j]; dAx && k < A->p[j + 1]; k++) {
+            i = A->i[k];
+            rhs[j] -= dAx[k] * d->y[i];
+            if (d->active[i]) rhs_w[i] -= dAx[k] * d->x[j];
+        }
+    }
+}
+
+/*
+ * Forward derivatives dx and dy of k perturbations stacked by rows (NULL
+ * perturbations are zero). rhs, sol, res and X have length k * N. Returns 1 if the refinement did not converge.
+ */
+static c_int derivative_forward_batch(const OSQPDerivative *d, c_int k,
+                                      const c_float *dPx, const c_float *dq,
+                                      const c_float *dAx, const c_float *dl,
+                                      const c_float *du, c_float *dx,
+                                      c_float *dy, c_float *rhs, c_float *sol,
+                                      c_float *res, c_float *X) {
+    c_int i, r, exitflag, n = d->n, m = d->m, N = n + m;
+    c_int Pnz = d->P->p[n], Anz = d->A->p[n];
+
+    for (r = 0; r < k; r++) {
+        derivative_forward_rhs(d, dPx ? dPx + r * Pnz : OSQP_NULL,
+                               dq ? dq + r * n : OSQP_NULL,
+                               dAx ? dAx + r * Anz : OSQP_NULL,
+                               dl ? dl + r * m : OSQP_NULL,
+                               du ? du + r * m : OSQP_NULL, rhs + r * N);
+    }
+    exitflag = derivative_refined_solve_multi(d, rhs, sol, k, res, X);
+    for (r = 0; r < k; r++) {
+        prea_vec_copy(sol + r * N, dx + r * n, n);
+        for (i = 0; i < m; i++) {
+            dy[r * m + i] = d->active[i] ? sol[r * N + n + i] : 0.;
+        }
+    }
+    return exitflag;
+}
+
+#endif
@@ -21,11 +21,17 @@
     c_float update_time;       /* time taken for update phase (seconds) */
     c_float polish_time;       /* time taken for polish phase (seconds) */
     c_float run_time;          /* total time taken (seconds) */
+    c_float ordering_time;     /* time taken by the KKT ordering (seconds) */
     #endif
 
     c_int rho_updates;         /* number of rho updates */
     c_float rho_estimate;       /* optimal rho estimate */
 
+    c_int L_nnz;               /* number of nonzeros in the KKT factor */
+
+    c_int aa_accepted;         /* number of Anderson steps taken */
+    c_int aa_rejected;         /* number of Anderson restarts */
+
 } OSQP_info;
 
 
@@ -63,12 +69,14 @@ static PyMemberDef OSQP_info_members[] = {
     {"update_time", T_FLOAT, offsetof(OSQP_info, update_time), READONLY, "Update time"},
     {"polish_time", T_FLOAT, offsetof(OSQP_info, polish_time), READONLY, "Polish time"},
     {"run_time", T_FLOAT, offsetof(OSQP_info, run_time), READONLY, "Total run time"},
+    {"ordering_time", T_FLOAT, offsetof(OSQP_info, ordering_time), READONLY, "KKT ordering time, NaN for the AMD ordering"},
 #else   // DFLOAT
     {"setup_time", T_DOUBLE, offsetof(OSQP_info, setup_time), READONLY, "Setup time"},
     {"solve_time", T_DOUBLE, offsetof(OSQP_info, solve_time), READONLY, "Solve time"},
     {"update_time", T_DOUBLE, offsetof(OSQP_info, update_time), READONLY, "Update time"},
     {"polish_time", T_DOUBLE, offsetof(OSQP_info, polish_time), READONLY, "Polish time"},
     {"run_time", T_DOUBLE, offsetof(OSQP_info, run_time), READONLY, "Total run time"},
+    {"ordering_time", T_DOUBLE, offsetof(OSQP_info, ordering_time), READONLY, "KKT ordering time, NaN for the AMD ordering"},
 #endif  // DFLOAT
 #endif  // PROFILING
 
@@ -84,6 +92,20 @@ static PyMemberDef OSQP_info_members[] = {
     {"rho_estimate", T_DOUBLE, offsetof(OSQP_info, rho_estimate), READONLY, "Optimal rho estimate"},
 #endif  // DFLOAT
 
+#ifdef DLONG
+    {"L_nnz", T_LONGLONG, offsetof(OSQP_info, L_nnz), READONLY, "Number of nonzeros in the KKT factor"},
+#else   // DLONG
+    {"L_nnz", T_INT, offsetof(OSQP_info, L_nnz), READONLY, "Number of nonzeros in the KKT factor"},
+#endif  // DLONG
+
+#ifdef DLONG
+    {"aa_accepted", T_LONGLONG, offsetof(OSQP_info, aa_accepted), READONLY, "Number of Anderson steps taken"},
+    {"aa_rejected", T_LONGLONG, offsetof(OSQP_info, aa_rejected), READONLY, "Number of Anderson restarts"},
+#else   // DLONG
+    {"aa_accepted", T_INT, offsetof(OSQP_info, aa_accepted), READONLY, "Number of Anderson steps taken"},
+    {"aa_rejected", T_INT, offsetof(OSQP_info, aa_rejected), READONLY, "Number of Anderson restarts"},
+#endif  // DLONG
+
     {NULL}
 };
 
@@ -96,17 +118,17 @@ static c_int OSQP_info_init( OSQP_info * self, PyObject *args) {
 #ifdef DLONG
 
 #ifdef DFLOAT
-    static char * argparse_string = "LULLffffffffLf";
+    static char * argparse_string = "LULLfffffffffLfLLL";
 #else
-    static char * argparse_string = "LULLddddddddLd";
+    static char * argparse_string = "LULLdddddddddLdLLL";
 #endif
 
 #else   // DLONG
 
 #ifdef DFLOAT
-    static char * argparse_string = "iUiiffffffffif";
+    static char * argparse_string = "iUiifffffffffifiii";
 #else
-    static char * argparse_string = "iUiiddddddddid";
+    static char * argparse_string = "iUiidddddddddidiii";
 #endif
 
 #endif  // DLONG
@@ -118,17 +140,17 @@ static c_int OSQP_info_init( OSQP_info * self, PyObject *args) {
 #ifdef DLONG
 
 #ifdef DFLOAT
-    static char * argparse_string = "LULLfffLf";
+    static char * argparse_string = "LULLfffLfLLL";
 #else
-    static char * argparse_string = "LULLdddLd";
+    static char * argparse_string = "LULLdddLdLLL";
 #endif
 
 #else   // DLONG
 
 #ifdef DFLOAT
-    static char * argparse_string = "iUiifffif";
+    static char * argparse_string = "iUiifffifiii";
 #else
-    static char * argparse_string = "iUiidddid";
+    static char * argparse_string = "iUiidddidiii";
 #endif
 
 #endif  // DLONG
@@ -151,9 +173,13 @@ static c_int OSQP_info_init( OSQP_info * self, PyObject *args) {
                           &(self->update_time),
                           &(self->polish_time),
                           &(self->run_time),
+                          &(self->ordering_time),
 #endif
                           &(self->rho_updates),
-                          &(self->rho_estimate)
+                          &(self->rho_estimate),
+                          &(self->L_nnz),
+                          &(self->aa_accepted),
+                          &(self->aa_rejected)
 			              )) {
         return -1;
     }
@@ -0,0 +1,584 @@
+#ifndef OSQPITERATIONPY_H
+#define OSQPITERATIONPY_H
+
+#include "auxil.h"
+#include "util.h"
+#include "lin_alg.h"
+#include "polish.h"
+#ifdef CTRLC
+#include "ctrlc.h"
+#endif
+
+/*****************************************************
+ * ADMM solve loop of the extension                  *
+ *****************************************************/
+
+/*
+ * The solve loop of the OSQP library cannot be extended from the module.
+ * The solves using a feature of the extension (Anderson acceleration,
+ * adaptive checks, deadlines or cancellation) run the loop below, which
+ * follows osqp_solve on the internal step functions of the library. The
+ * other solves run osqp_solve.
+ */
+
+/*
+ * Adaptive scheduling of the termination checks. Both residuals are
+ * estimated at every iteration without a product with a matrix. The KKT
+ * solve gives z_tilde = A x_tilde, so A x is tracked exactly by
+ *
+ *   A x+ = alpha z_tilde + (1 - alpha) A x.
+ *
+ * The dual residual r = P x + q + A' y follows
+ *
+ *   r+ = sigma (x - x+) + (1 - alpha) r + A' diag(rho) (z - z+),
+ *
+ * which bounds its norm by the norms of the steps and the largest column
+ * norm of A. A full check is done as soon as the tracked primal residual
+ * and the bound on the dual residual meet their tolerances, and at least
+ * every check_termination iterations, which also detects infeasibility.
+ * The full checks compute the residuals with the tracked A x, so that they
+ * only need the products with P and A'.
+ */
+
+/*
+ * Cancellation. Each solve has a ticket, and another thread may set the
+ * cancel flag to the ticket of the solve to stop while the loop runs without
+ * the GIL. The flag is read at every iteration of the cancellable solves,
+ * which return the current iterate with the status OSQP_CANCELLED when it
+ * holds their ticket. A request for an earlier solve is ignored.
+ */
+#define OSQP_CANCELLED (-11)
+
+/*
+ * Anytime solves. When a solve is given a deadline, the iterate with the
+ * lowest residual relative to the tolerances, max(pri_res / eps_pri,
+ * dua_res / eps_dua), among the ones evaluated by the termination checks is
+ * kept in shadow buffers. If the deadline is reached before convergence,
+ * the best of this iterate and the last one is returned, with the status
+ * OSQP_TIME_LIMIT_REACHED and its own residuals in the info. The other
+ * iterates are not compared, since their residuals are not computed. The
+ * deadline is measured with the timer of the workspace, so it needs
+ * PROFILING, and the solves with a deadline are rejected without it.
+ */
+
+
+typedef struct {
+    OSQPAnderson *anderson;     // Anderson acceleration (or NULL)
+
+    c_int adaptive_check;       // Schedule the termination checks adaptively
+    c_float *Ax;                // Tracked A x
+    c_float dua_bound;          // Bound on the scaled dual residual (OSQP_INFTY = none)
+    c_float dua_tol;            // Dual tolerance at the last full check
+    c_float dua_unscale;        // Bound on the unscaling of the dual residual
+    c_float norm_A;             // Largest 1-norm of the columns of A
+    c_int last_check;           // Iteration of the last full check
+
+    c_float deadline;           // Time allowed to the current solve (0 = none)
+    c_float *best_x, *best_z, *best_y;  // Best iterate of the current solve
+    c_float best_score;         // Its residual relative to the tolerances
+    c_int has_best;             // Whether the best iterate is set
+
+    parallel_flag *cancel;      // Ticket of the solve to cancel (or NULL)
+    c_int ticket;               // Ticket of the current solve
+    c_int cancellable;          // Whether the current solve reads the request
+} OSQPIteration;
+
+
+static void iteration_free(OSQPIteration *it) {
+    if (it) {
+        anderson_free(it->anderson);
+        if (it->Ax) c_free(it->Ax);
+        if (it->best_x) c_free(it->best_x);
+        if (it->best_z) c_free(it->best_z);
+        if (it->best_y) c_free(it->best_y);
+        c_free(it);
+    }
+}
+
+static OSQPIteration *iteration_setup(OSQPWorkspace *work, c_int anderson,
+                                      c_int anderson_mem, c_int adaptive_check,
+                                      parallel_flag *cancel) {
+    OSQPIteration *it = (OSQPIteration *)c_calloc(1, sizeof(OSQPIteration));
+
+    if (!it) return OSQP_NULL;
+    it->cancel = cancel;
+    if (anderson != ANDERSON_NONE) {
+        it->anderson = anderson_setup(anderson, anderson_mem,
+                                      work->data->n, work->data->m);
+        if (!it->anderson) {
+            iteration_free(it);
+            return OSQP_NULL;
+        }
+    }
+    it->adaptive_check = adaptive_check;
+    if (adaptive_check) {
+        it->Ax = (c_float *)c_malloc(c_max(work->data->m, 1) * sizeof(c_float));
+        if (!it->Ax) {
+            iteration_free(it);
+            return OSQP_NULL;
+        }
+    }
+    return it;
+}
+
+// Shadow buffers of the anytime solves, allocated by the first one
+static c_int iteration_anytime_setup(OSQPIteration *it, OSQPWorkspace *work) {
+    if (it->best_x) return 0;
+    it->best_x = (c_float *)c_malloc(c_max(work->data->n, 1) * sizeof(c_float));
+    it->best_z = (c_float *)c_malloc(c_max(work->data->m, 1) * sizeof(c_float));
+    it->best_y = (c_float *)c_malloc(c_max(work->data->m, 1) * sizeof(c_float));
+    if (!it->best_x || !it->best_z || !it->best_y) {
+        if (it->best_x) c_free(it->best_x);
+        if (it->best_z) c_free(it->best_z);
+        if (it->best_y) c_free(it->best_y);
+        it->best_x = it->best_z = it->best_y = OSQP_NULL;
+        return 1;
+    }
+    return 0;
+}
+
+
+/* Residuals */
+
+// Primal residual and tolerance for a given A x, as in check_termination
+static c_float iteration_pri_res(OSQPWorkspace *work, const c_float *Ax, c_float *tol) {
+    c_int i, m = work->data->m;
+    c_int unscale = work->settings->scaling && !work->settings->scaled_termination;
+    c_float e, res = 0., norm_Ax = 0., norm_z = 0.;
+
+    for (i = 0; i < m; i++) {
+        e = unscale ? work->scaling->Einv[i] : 1.;
+        res = c_max(res, c_absval(e * (Ax[i] - work->z[i])));
+        norm_Ax = c_max(norm_Ax, c_absval(e * Ax[i]));
+        norm_z = c_max(norm_z, c_absval(e * work->z[i]));
+    }
+    *tol = work->settings->eps_abs + work->settings->eps_rel * c_max(norm_Ax, norm_z);
+    return res;
+}
+
+static c_int iteration_pri_converged(OSQPWorkspace *work, const c_float *Ax) {
+    c_float tol;
+
+    return iteration_pri_res(work, Ax, &tol) <= tol;
+}
+
+// Dual tolerance from the products computed by the last full check
+static c_float iteration_dua_tol(OSQPWorkspace *work) {
+    c_int n = work->data->n;
+    c_float norm;
+
+    if (work->settings->scaling && !work->settings->scaled_termination) {
+        norm = c_max(vec_scaled_norm_inf(work->scaling->Dinv, work->Px, n),
+                     vec_scaled_norm_inf(work->scaling->Dinv, work->Aty, n));
+        norm = c_max(norm, vec_scaled_norm_inf(work->scaling->Dinv, work->data->q, n));
+        norm *= work->scaling->cinv;
+    } else {
+        norm = c_max(vec_norm_inf(work->Px, n), vec_norm_inf(work->Aty, n));
+        norm = c_max(norm, vec_norm_inf(work->data->q, n));
+    }
+    return work->settings->eps_abs + work->settings->eps_rel * norm;
+}
+
+// Residual relative to the tolerances after update_info
+static c_float iteration_score(OSQPWorkspace *work) {
+    c_float pri_tol;
+
+    iteration_pri_res(work, work->Ax, &pri_tol);
+    return c_max(work->info->pri_res / pri_tol,
+                 work->info->dua_res / iteration_dua_tol(work));
+}
+
+
+/* Adaptive termination checks */
+
+// Start the estimates of the residuals at the initial iterate
+static void iteration_track_setup(OSQPIteration *it, OSQPWorkspace *work) {
+    const csc *A = work->data->A;
+    c_float norm;
+    c_int j, k;
+
+    mat_vec(A, work->x, it->Ax, 0);
+    it->norm_A = 0.;
+    for (j = 0; j < A->n; j++) {
+        norm = 0.;
+        for (k = A->p[j]; k < A->p[j + 1]; k++) norm += c_absval(A->x[k]);
+        it->norm_A = c_max(it->norm_A, norm);
+    }
+    it->dua_unscale = 1.;
+    if (work->settings->scaling && !work->settings->scaled_termination) {
+        it->dua_unscale = work->scaling->cinv *
+                          vec_norm_inf(work->scaling->Dinv, work->data->n);
+    }
+    it->dua_bound = OSQP_INFTY;
+    it->dua_tol = 0.;
+    it->last_check = 0;
+}
+
+// Advance the estimates after the steps of an iteration
+static void iteration_track(OSQPIteration *it, OSQPWorkspace *work) {
+    c_int i, n = work->data->n, m = work->data->m;
+    c_float alpha = work->settings->alpha;
+    c_float dz = 0.;
+
+    for (i = 0; i < m; i++) {
+        it->Ax[i] = alpha * work->xz_tilde[n + i] + (1. - alpha) * it->Ax[i];
+        dz = c_max(dz, work->rho_vec[i] * c_absval(work->z[i] - work->z_prev[i]));
+    }
+    if (it->dua_bound < OSQP_INFTY) {
+        it->dua_bound = work->settings->sigma * vec_norm_inf(work->delta_x, n) +
+                        c_absval(1. - alpha) * it->dua_bound + it->norm_A * dz;
+    }
+}
+
+/*
+ * update_info with the tracked A x, which saves its product with A. The
+ * dual residual is computed in x_prev as by update_info, and gives the
+ * bound of the next iterations.
+ */
+static void iteration_update_info(OSQPIteration *it, OSQPWorkspace *work,
+                                  c_int iter, c_int compute_objective) {
+    c_int n = work->data->n, m = work->data->m;
+    c_float pri_tol;
+
+    work->info->iter = iter;
+    if (compute_objective) {
+        work->info->obj_val = compute_obj_val(work, work->x);
+    }
+
+    prea_vec_copy(it->Ax, work->Ax, m);
+    work->info->pri_res = iteration_pri_res(work, work->Ax, &pri_tol);
+
+    prea_vec_copy(work->data->q, work->x_prev, n);
+    mat_vec(work->data->P, work->x, work->Px, 0);
+    mat_tpose_vec(work->data->P, work->x, work->Px, 1, 1);
+    vec_add_scaled(work->x_prev, work->x_prev, work->Px, n, 1.);
+    if (m > 0) {
+        mat_tpose_vec(work->data->A, work->y, work->Aty, 0, 0);
+        vec_add_scaled(work->x_prev, work->x_prev, work->Aty, n, 1.);
+    }
+    it->dua_bound = vec_norm_inf(work->x_prev, n);
+    if (work->settings->scaling && !work->settings->scaled_termination) {
+        work->info->dua_res = work->scaling->cinv *
+                              vec_scaled_norm_inf(work->scaling->Dinv, work->x_prev, n);
+    } else {
+        work->info->dua_res = it->dua_bound;
+    }
+
+#ifdef PROFILING
+    work->info->solve_time = osqp_toc(work->timer);
+#endif
+#ifdef PRINTING
+    work->summary_printed = 0;
+#endif
+}
+
+// update_info of the iterations of the loop
+static void iteration_info(OSQPIteration *it, OSQPWorkspace *work, c_int iter,
+                           c_int compute_objective) {
+    if (it->adaptive_check) {
+        iteration_update_info(it, work, iter, compute_objective);
+    } else {
+        update_info(work, iter, compute_objective, 0);
+    }
+}
+
+
+/* Anytime solves */
+
+// Keep the current iterate if it is the best one, after update_info
+static void iteration_track_best(OSQPIteration *it, OSQPWorkspace *work) {
+    c_float score = iteration_score(work);
+
+    if (!it->has_best || score < it->best_score) {
+        prea_vec_copy(work->x, it->best_x, work->data->n);
+        prea_vec_copy(work->z, it->best_z, work->data->m);
+        prea_vec_copy(work->y, it->best_y, work->data->m);
+        it->best_score = score;
+        it->has_best = 1;
+    }
+}
+
+// Return the best iterate at the deadline
+static void iteration_restore_best(OSQPIteration *it, OSQPWorkspace *work, c_int iter) {
+    if (!it->has_best) return;
+    update_info(work, iter, 0, 0);
+    if (it->best_score < iteration_score(work)) {
+        prea_vec_copy(it->best_x, work->x, work->data->n);
+        prea_vec_copy(it->best_z, work->z, work->data->m);
+        prea_vec_copy(it->best_y, work->y, work->data->m);
+    }
+}
+
+
+static c_int iteration_can_check(OSQPIteration *it, OSQPWorkspace *work, c_int iter) {
+    if (!work->settings->check_termination) return 0;
+    if (!it->adaptive_check) return iter % work->settings->check_termination == 0;
+
+    // Never later than the fixed schedule
+    if (iter - it->last_check >= work->settings->check_termination) return 1;
+    return it->dua_unscale * it->dua_bound <= it->dua_tol &&
+           iteration_pri_converged(work, it->Ax);
+}
+
+
+/*
+ * osqp_solve with the features of the extension. Anderson acceleration
+ * extrapolates the iterate after the termination checks and the rho
+ * adaptation of each iteration.
+ */
+static c_int iteration_solve(OSQPWorkspace *work, OSQPIteration *it) {
+    OSQPAnderson *aa = it->anderson;
+    c_int exitflag = 0;
+    c_int iter;
+    c_int compute_cost_function;
+    c_int can_check_termination = 0;
+    c_int can_adapt_rho;
+#ifdef PRINTING
+    c_int can_print;
+#endif
+#ifdef PROFILING
+    c_float temp_run_time;
+#endif
+
+    if (!work) return 1;
+
+#ifdef PRINTING
+    can_print = work->settings->verbose;
+    compute_cost_function = work->settings->verbose;
+#else
+    compute_cost_function = 0;
+#endif
+
+#ifdef PROFILING
+    if (work->clear_update_time == 1) work->info->update_time = 0.0;
+    work->rho_update_from_solve = 1;
+    osqp_tic(work->timer);
+#endif
+
+#ifdef PRINTING
+    if (work->settings->verbose) print_header();
+#endif
+
+#ifdef CTRLC
+    osqp_start_interrupt_listener();
+#endif
+
+    if (!work->settings->warm_start) cold_start(work);
+
+    if (aa) {
+        anderson_restart(aa);
+        aa->accepted = 0;
+        aa->rejected = 0;
+    }
+    if (it->adaptive_check) iteration_track_setup(it, work);
+    it->has_best = 0;
+
+    for (iter = 1; iter <= work->settings->max_iter; iter++) {
+        if (aa) anderson_gather(aa, work, aa->s);
+
+        // ADMM map
+        swap_vectors(&(work->x), &(work->x_prev));
+        swap_vectors(&(work->z), &(work->z_prev));
+        update_xz_tilde(work);
+        update_x(work);
+        update_z(work);
+        update_y(work);
+
+        if (it->adaptive_check) iteration_track(it, work);
+
+        if (it->cancellable && it->cancel &&
+            parallel_flag_get(it->cancel) == it->ticket) {
+            work->info->status_val = OSQP_CANCELLED;
+            c_strcpy(work->info->status, "cancelled");
+            iteration_info(it, work, iter, compute_cost_function);
+            can_check_termination = 1;
+#ifdef PRINTING
+            if (work->settings->verbose) c_print("solve cancelled\n");
+            can_print = 0;
+#endif
+            break;
+        }
+
+#ifdef CTRLC
+        if (osqp_is_interrupted()) {
+            update_status(work->info, OSQP_SIGINT);
+            c_print("Solver interrupted\n");
+            exitflag = 1;
+            goto exit;
+        }
+#endif
+
+#ifdef PROFILING
+        if (work->first_run) {
+            temp_run_time = work->info->setup_time + osqp_toc(work->timer);
+        } else {
+            temp_run_time = work->info->update_time + osqp_toc(work->timer);
+        }
+        if (work->settings->time_limit &&
+            (temp_run_time >= work->settings->time_limit)) {
+            update_status(work->info, OSQP_TIME_LIMIT_REACHED);
+#ifdef PRINTING
+            if (work->settings->verbose) c_print("run time limit reached\n");
+            can_print = 0;
+#endif
+            break;
+        }
+        if (it->deadline > 0. && osqp_toc(work->timer) >= it->deadline) {
+            iteration_restore_best(it, work, iter);
+            // Residuals of the returned iterate
+            update_info(work, iter, compute_cost_function, 0);
+            if (!check_termination(work, 0)) {
+                update_status(work->info, OSQP_TIME_LIMIT_REACHED);
+            }
+            can_check_termination = 1;
+#ifdef PRINTING
+            if (work->settings->verbose) c_print("deadline reached\n");
+            can_print = 0;
+#endif
+            break;
+        }
+#endif
+
+        can_check_termination = iteration_can_check(it, work, iter);
+#ifdef PRINTING
+        can_print = work->settings->verbose &&
+                    ((iter % PRINT_INTERVAL == 0) || (iter == 1));
+        if (can_check_termination || can_print) {
+#else
+        if (can_check_termination) {
+#endif
+            iteration_info(it, work, iter, compute_cost_function);
+#ifdef PRINTING
+            if (can_print) print_summary(work);
+#endif
+            if (can_check_termination) {
+                if (check_termination(work, 0)) break;
+                if (it->deadline > 0.) iteration_track_best(it, work);
+                if (it->adaptive_check) {
+                    it->last_check = iter;
+                    it->dua_tol = iteration_dua_tol(work);
+                }
+            }
+        }
+
+        // Interval of the rho adaptation, as set by osqp_solve
+        if (work->settings->adaptive_rho && !work->settings->adaptive_rho_interval) {
+#ifdef PROFILING
+            if (osqp_toc(work->timer) >
+                work->settings->adaptive_rho_fraction * work->info->setup_time) {
+                work->settings->adaptive_rho_interval = (c_int)c_roundmultiple(iter,
+                    work->settings->check_termination ? work->settings->check_termination : CHECK_TERMINATION);
+                work->settings->adaptive_rho_interval = c_max(
+                    work->settings->adaptive_rho_interval,
+                    work->settings->check_termination);
+            }
+#else
+            work->settings->adaptive_rho_interval = (c_int)c_roundmultiple(
+                ADAPTIVE_RHO_FIXED,
+                work->settings->check_termination ? work->settings->check_termination : CHECK_TERMINATION);
+#endif
+        }
+
+        can_adapt_rho = work->settings->adaptive_rho &&
+                        work->settings->adaptive_rho_interval &&
+                        (iter % work->settings->adaptive_rho_interval == 0);
+        if (can_adapt_rho) {
+#ifdef PRINTING
+            if (!can_check_termination && !can_print) {
+#else
+            if (!can_check_termination) {
+#endif
+                iteration_info(it, work, iter, compute_cost_function);
+            }
+            if (adapt_rho(work)) {
+#ifdef PRINTING
+                c_eprint("Failed rho update");
+#endif
+                exitflag = 1;
+                goto exit;
+            }
+            // A new rho changes the fixed-point map
+            if (aa) anderson_restart(aa);
+        } else if (aa && iter < work->settings->max_iter) {
+            anderson_step(aa, work);
+            if (it->adaptive_check && aa->extrapolated) {
+                // The extrapolation is not a step of the iteration
+                mat_vec(work->data->A, work->x, it->Ax, 0);
+                it->dua_bound = OSQP_INFTY;
+            }
+        }
+    }
+
+    // Update information and check termination condition if it hasn't been
+    // done during last iteration
+    if (!can_check_termination) {
+#ifdef PRINTING
+        if (!can_print) iteration_info(it, work, iter - 1, compute_cost_function);
+        if (work->settings->verbose && !work->summary_printed) print_summary(work);
+#else
+        iteration_info(it, work, iter - 1, compute_cost_function);
+#endif
+        check_termination(work, 0);
+    }
+
+    if (!compute_cost_function && has_solution(work->info)) {
+        work->info->obj_val = compute_obj_val(work, work->x);
+    }
+
+#ifdef PRINTING
+    if (work->settings->verbose) work->summary_printed = 0;
+#endif
+
+    if (work->info->status_val == OSQP_UNSOLVED) {
+        if (!check_termination(work, 1)) {
+            update_status(work->info, OSQP_MAX_ITER_REACHED);
+        }
+    }
+
+    work->info->rho_estimate = compute_rho_estimate(work);
+
+#ifdef PROFILING
+    work->info->solve_time = osqp_toc(work->timer);
+#endif
+
+    if (work->settings->polish && (work->info->status_val == OSQP_SOLVED)) {
+        polish(work);
+    }
+
+#ifdef PROFILING
+    if (work->first_run) {
+        work->info->run_time = work->info->setup_time +
+                               work->info->solve_time +
+                               work->info->polish_time;
+    } else {
+        work->info->run_time = work->info->update_time +
+                               work->info->solve_time +
+                               work->info->polish_time;
+    }
+    if (work->first_run) work->first_run = 0;
+    work->rho_update_from_solve = 0;
+#endif
+
+#ifdef PRINTING
+    if (work->settings->verbose) print_footer(work->info, work->settings->polish);
+#endif
+
+    store_solution(work);
+
+exit:
+#ifdef CTRLC
+    osqp_end_interrupt_listener();
+#endif
+    return exitflag;
+}
+
+// Solve with osqp_solve unless the solve needs the loop of the extension
+static c_int iteration_run(OSQPWorkspace *work, OSQPIteration *it) {
+    if (it->anderson || it->adaptive_check || it->deadline > 0. ||
+        it->cancellable) {
+        return iteration_solve(work, it);
+    }
+    return osqp_solve(work);
+}
+
+#endif
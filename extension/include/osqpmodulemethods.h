@@ -63,6 +63,10 @@ static PyObject *OSQP_constant(OSQP *self, PyObject *args) {
         return Py_BuildValue("i", OSQP_MAX_ITER_REACHED);
     }
 
+    if(!strcmp(constant_name, "OSQP_CANCELLED")){
+        return Py_BuildValue("i", OSQP_CANCELLED);
+    }
+
     if(!strcmp(constant_name, "OSQP_NON_CVX")){
         return Py_BuildValue("i", OSQP_NON_CVX);
     }
@@ -80,6 +84,47 @@ static PyObject *OSQP_constant(OSQP *self, PyObject *args) {
 		return Py_BuildValue("i", MKL_PARDISO_SOLVER);
 	}
 
+	if(!strcmp(constant_name, "SUPERNODAL_SOLVER")){
+		return Py_BuildValue("i", SUPERNODAL_SOLVER);
+	}
+
+	if(!strcmp(constant_name, "DENSE_SOLVER")){
+		return Py_BuildValue("i", DENSE_SOLVER);
+	}
+
+	if(!strcmp(constant_name, "BANDED_SOLVER")){
+		return Py_BuildValue("i", BANDED_SOLVER);
+	}
+
+	// KKT orderings
+	if(!strcmp(constant_name, "AMD_ORDERING")){
+		return Py_BuildValue("i", AMD_ORDERING);
+	}
+
+	if(!strcmp(constant_name, "NESDIS_ORDERING")){
+		return Py_BuildValue("i", NESDIS_ORDERING);
+	}
+
+	if(!strcmp(constant_name, "NATURAL_ORDERING")){
+		return Py_BuildValue("i", NATURAL_ORDERING);
+	}
+
+	if(!strcmp(constant_name, "RCM_ORDERING")){
+		return Py_BuildValue("i", RCM_ORDERING);
+	}
+
+	if(!strcmp(constant_name, "USER_ORDERING")){
+		return Py_BuildValue("i", USER_ORDERING);
+	}
+
+	if(!strcmp(constant_name, "ANDERSON_TYPE_I")){
+		return Py_BuildValue("i", ANDERSON_TYPE_I);
+	}
+
+	if(!strcmp(constant_name, "ANDERSON_TYPE_II")){
+		return Py_BuildValue("i", ANDERSON_TYPE_II);
+	}
+
     // If reached here error
     PyErr_SetString(PyExc_ValueError, "Constant not recognized");
     return (PyObject *) NULL;
@@ -88,8 +133,70 @@ static PyObject *OSQP_constant(OSQP *self, PyObject *args) {
 
 
 
+// File descriptor signalling the asynchronous solves that finished
+static PyObject *OSQP_async_fd(PyObject *self) {
+#ifdef _WIN32
+    PyErr_SetString(PyExc_ValueError, "Asynchronous solves are not supported on Windows!");
+    return (PyObject *) NULL;
+#else
+    if (async_start(&OSQP_run_solve)) {
+        PyErr_SetString(PyExc_ValueError, "Asynchronous solve allocation error!");
+        return (PyObject *) NULL;
+    }
+    return Py_BuildValue("i", async_pool.fd_read);
+#endif
+}
+
+
+/*
+ * Results of the asynchronous solves that finished, as a list of tuples
+ * (id, results, exception) where either results or exception is None.
+ */
+static PyObject *OSQP_async_poll(PyObject *self) {
+    PyObject *list, *results, *item;
+    PyObject *type, *value, *traceback;
+#ifndef _WIN32
+    async_job *job, *next;
+#endif
+
+    list = PyList_New(0);
+    if (!list) return (PyObject *) NULL;
+
+#ifndef _WIN32
+    for (job = async_take_done(); job; job = next) {
+        next = job->next;
+        results = OSQP_solve_results(job->self, job->exitflag);
+        if (results) {
+            item = Py_BuildValue("lNO", job->id, results, Py_None);
+        } else {
+            PyErr_Fetch(&type, &value, &traceback);
+            PyErr_NormalizeException(&type, &value, &traceback);
+            item = Py_BuildValue("lON", job->id, Py_None, value);
+            Py_XDECREF(type);
+            Py_XDECREF(traceback);
+        }
+        // The workspace may be modified again once its results are built
+        parallel_flag_set(&job->self->busy, 0);
+        Py_DECREF(job->self);
+        c_free(job);
+        if (!item || PyList_Append(list, item)) {
+            // Out of memory: only the result of this solve is lost
+            Py_XDECREF(item);
+            PyErr_Clear();
+            continue;
+        }
+        Py_DECREF(item);
+    }
+#endif
+
+    return list;
+}
+
+
 static PyMethodDef OSQP_module_methods[] = {
 	{"constant", (PyCFunction)OSQP_constant, METH_VARARGS, PyDoc_STR("Return internal OSQP constant")},
+	{"async_fd", (PyCFunction)OSQP_async_fd, METH_NOARGS, PyDoc_STR("Return the file descriptor signalling finished asynchronous solves")},
+	{"async_poll", (PyCFunction)OSQP_async_poll, METH_NOARGS, PyDoc_STR("Return the results of the finished asynchronous solves")},
 	{NULL, NULL}		/* sentinel */
 };
 
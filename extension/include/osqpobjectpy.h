@@ -12,6 +12,15 @@ static c_int OSQP_init(OSQP *self, PyObject *args, PyObject *kwds) {
 	if (self == NULL)
 		return -1;
 	self->workspace = NULL;
+	self->presolve = NULL;
+	self->decomposition = NULL;
+	self->iteration = NULL;
+	self->derivative = NULL;
+	self->cancel = 0;
+	self->ticket = 0;
+	self->cancellable = 0;
+	self->busy = 0;
+	self->ordering_time = Py_NAN;
 	// return self;
 	return 0;
 }
@@ -20,12 +29,18 @@ static c_int OSQP_init(OSQP *self, PyObject *args, PyObject *kwds) {
 // Deallocate OSQP object
 static c_int OSQP_dealloc(OSQP *self) {
     // Cleanup workspace if not null
-    if (self->workspace) {
+    if (self->decomposition) {
+        // The workspace is the one of the first block
+        decomposition_free(self->decomposition);
+    } else if (self->workspace) {
         if (osqp_cleanup(self->workspace)) {
 			PyErr_SetString(PyExc_ValueError, "Workspace deallocation error!");
 			return 1;
 		}
 	}
+    presolve_free(self->presolve);
+    iteration_free(self->iteration);
+    derivative_free(self->derivative);
 
     // Cleanup python object
     PyObject_Del(self);
@@ -33,10 +48,256 @@ static c_int OSQP_dealloc(OSQP *self) {
     return 0;
 }
 
-// Solve Optimization Problem
-static PyObject * OSQP_solve(OSQP *self) {
+// Dimensions of the problem
+static void OSQP_problem_dimensions(OSQP *self, c_int *n, c_int *m) {
+    if (self->presolve) {
+        *n = self->presolve->n;
+        *m = self->presolve->m;
+    } else if (self->decomposition) {
+        *n = self->decomposition->n;
+        *m = self->decomposition->m;
+    } else {
+        *n = self->workspace->data->n;
+        *m = self->workspace->data->m;
+    }
+}
+
+// Workspaces solving the problem, one per block if it is decomposed
+static OSQPWorkspace ** OSQP_workspaces(OSQP *self, c_int *nwork) {
+    if (self->decomposition) {
+        *nwork = self->decomposition->nblocks;
+        return self->decomposition->work;
+    }
+    *nwork = 1;
+    return &self->workspace;
+}
+
+// Solve loops of the workspaces
+static OSQPIteration ** OSQP_iterations(OSQP *self, c_int *nit) {
+    if (self->decomposition) {
+        *nit = self->decomposition->nblocks;
+        return self->decomposition->iteration;
+    }
+    *nit = 1;
+    return &self->iteration;
+}
+
+// Primal solution, or dual infeasibility certificate, of the problem
+static c_float * OSQP_get_x(OSQP *self, c_int certificate) {
+    c_float *x;
+
+    if (self->decomposition) {
+        x = decomposition_gather(self->decomposition, 0, certificate);
+    } else {
+        x = certificate ? self->workspace->delta_x : self->workspace->solution->x;
+    }
+    return self->presolve ? presolve_postsolve_x(self->presolve, x) : x;
+}
+
+// Dual solution, or primal infeasibility certificate, of the problem
+static c_float * OSQP_get_y(OSQP *self, c_int certificate) {
+    c_float *y;
+
+    if (self->decomposition) {
+        y = decomposition_gather(self->decomposition, 1, certificate);
+    } else {
+        y = certificate ? self->workspace->delta_y : self->workspace->solution->y;
+    }
+    return self->presolve ? presolve_postsolve_y(self->presolve, y) : y;
+}
+
+/*
+ * Updates of the problem solved by the workspaces, i.e. after the presolve
+ * and before the decomposition. Bounds and matrices that are not given are
+ * kept.
+ */
+static c_int OSQP_update_workspace_lin_cost(OSQP *self, const c_float *q) {
+    if (self->decomposition) {
+        return decomposition_update_lin_cost(self->decomposition, q);
+    }
+    return osqp_update_lin_cost(self->workspace, q);
+}
+
+static c_int OSQP_update_workspace_bounds(OSQP *self, const c_float *l,
+                                          const c_float *u) {
+    if (self->decomposition) {
+        return decomposition_update_bounds(self->decomposition, l, u);
+    }
+    if (l && u) return osqp_update_bounds(self->workspace, l, u);
+    if (l) return osqp_update_lower_bound(self->workspace, l);
+    return osqp_update_upper_bound(self->workspace, u);
+}
+
+static c_int OSQP_update_workspace_lin_cost_idx(OSQP *self, const c_float *q,
+                                               const c_int *idx, c_int k) {
+    if (self->decomposition) {
+        return decomposition_update_lin_cost_idx(self->decomposition, q, idx, k);
+    }
+    return update_lin_cost_idx(self->workspace, q, idx, k);
+}
+
+static c_int OSQP_update_workspace_bounds_idx(OSQP *self, const c_float *l,
+                                              const c_float *u,
+                                              const c_int *idx, c_int k) {
+    if (self->decomposition) {
+        return decomposition_update_bounds_idx(self->decomposition, l, u, idx, k);
+    }
+    return update_bounds_idx(self->workspace, l, u, idx, k);
+}
+
+static c_int OSQP_update_workspace_P_A(OSQP *self,
+                                       const c_float *Px, const c_int *Px_idx, c_int Px_n,
+                                       const c_float *Ax, const c_int *Ax_idx, c_int Ax_n) {
+    if (self->decomposition) {
+        return decomposition_update_P_A(self->decomposition, Px, Px_idx, Px_n,
+                                        Ax, Ax_idx, Ax_n);
+    }
+    if (Px && Ax) {
+        return osqp_update_P_A(self->workspace, Px, Px_idx, Px_n, Ax, Ax_idx, Ax_n);
+    }
+    if (Px) return osqp_update_P(self->workspace, Px, Px_idx, Px_n);
+    return osqp_update_A(self->workspace, Ax, Ax_idx, Ax_n);
+}
+
+static void OSQP_warm_start_workspace(OSQP *self, const c_float *x,
+                                      const c_float *y) {
+    if (self->decomposition) {
+        decomposition_warm_start(self->decomposition, x, y);
+    } else if (x && y) {
+        osqp_warm_start(self->workspace, x, y);
+    } else if (x) {
+        osqp_warm_start_x(self->workspace, x);
+    } else {
+        osqp_warm_start_y(self->workspace, y);
+    }
+}
+
+/*
+ * Install the linear system solvers of the extension in a QDLDL workspace.
+ * They replace the factorization done by osqp_setup with one of their own,
+ * whose time is added to the setup time of the workspace.
+ */
+static c_int OSQP_setup_linsys(OSQPWorkspace *work, int linsys_solver,
+                               int ordering, const c_int *ordering_perm,
+                               int eliminate_bounds, int dense_max_dim,
+                               int nthreads, c_float *ordering_time) {
+    LinSysSolver **kkt_solver;  // Solver factoring the KKT matrix
+    const csc *kkt_P, *kkt_A;   // Matrices of the factored KKT matrix
+    c_int exitflag = 0;
+#ifdef PROFILING
+    OSQPTimer timer;
+
+    osqp_tic(&timer);
+#endif
+
+    if (eliminate_bounds) {
+        exitflag = box_install(work);
+    }
+    if (!exitflag) {
+        kkt_solver = linsys_kkt_solver(work, &kkt_P, &kkt_A);
+        if (ordering != AMD_ORDERING) {
+            exitflag = kkt_reorder(*kkt_solver, kkt_P, kkt_A, ordering,
+                                   ordering_perm, ordering_time);
+        }
+        if (!exitflag && linsys_solver == SUPERNODAL_SOLVER) {
+            exitflag = supernodal_install(kkt_solver, nthreads);
+        } else if (!exitflag && linsys_solver == DENSE_SOLVER) {
+            exitflag = dense_install(kkt_solver);
+        } else if (!exitflag && linsys_solver == BANDED_SOLVER) {
+            exitflag = banded_install(kkt_solver);
+        } else if (!exitflag && linsys_solver == QDLDL_SOLVER &&
+                   dense_eligible(*kkt_solver, dense_max_dim)) {
+            // Small problems switch to the dense solver, or stay with QDLDL
+            // if it cannot be set up
+            dense_install(kkt_solver);
+        }
+    }
+#ifdef PROFILING
+    work->info->setup_time += osqp_toc(&timer);
+#endif
+    return exitflag;
+}
+
+// Reject the calls using the workspace while a solve of it runs
+static c_int OSQP_check_idle(OSQP *self) {
+    if (parallel_flag_get(&self->busy)) {
+        PyErr_SetString(PyExc_ValueError, "A solve of the problem is already running!");
+        return 1;
+    }
+    return 0;
+}
+
+// Ticket following the given one, as stored by a parallel_flag
+static c_int OSQP_next_ticket(c_int ticket) {
+    return ticket < INT_MAX ? ticket + 1 : 1;
+}
+
+// Solve the problem, without the GIL
+static c_int OSQP_run_solve(OSQP *self) {
     c_int exitflag;
 
+    if (self->decomposition) {
+        exitflag = decomposition_solve(self->decomposition);
+    } else {
+        exitflag = iteration_run(self->workspace, self->iteration);
+        self->iteration->deadline = 0.;
+    }
+    return exitflag;
+}
+
+// Prepare a solve with a deadline, or without one if time_budget < 0. The
+// object is marked busy until the caller has built the results. The
+// submitted solves can always be cancelled.
+static c_int OSQP_prepare_solve(OSQP *self, c_float time_budget,
+                                c_int submitted) {
+    OSQPIteration **its;
+    c_int k, nit;
+
+    // Check that the workspace is initialized
+    if (!self->workspace) {
+        PyErr_SetString(PyExc_ValueError, "Workspace not initialized!");
+        return 1;
+    }
+    if (OSQP_check_idle(self)) return 1;
+
+    // Anytime solve with a deadline
+    if (time_budget >= 0.) {
+#ifndef PROFILING
+        PyErr_SetString(PyExc_ValueError, "A deadline needs an extension built with PROFILING!");
+        return 1;
+#endif
+        if (self->decomposition) {
+            PyErr_SetString(PyExc_ValueError, "A deadline cannot be combined with decompose!");
+            return 1;
+        }
+        if (iteration_anytime_setup(self->iteration, self->workspace)) {
+            PyErr_SetString(PyExc_ValueError, "Anytime solve allocation error!");
+            return 1;
+        }
+        // A deadline already passed still runs one iteration
+        self->iteration->deadline = c_max(time_budget, 1e-9);
+    }
+
+    // The cancel() calls made during this solve, or since the last one
+    // finished, stop it. A solve cancelled in advance needs the loop of the
+    // extension.
+    self->ticket = OSQP_next_ticket(self->ticket);
+    its = OSQP_iterations(self, &nit);
+    for (k = 0; k < nit; k++) {
+        its[k]->ticket = self->ticket;
+        its[k]->cancellable = submitted || self->cancellable ||
+                              parallel_flag_get(&self->cancel) == self->ticket;
+    }
+
+    // The derivatives are refactored at the new solution
+    if (self->derivative) self->derivative->factored = 0;
+
+    parallel_flag_set(&self->busy, 1);
+    return 0;
+}
+
+// Results object of the last solve
+static PyObject * OSQP_solve_results(OSQP *self, c_int exitflag) {
     // Create status object
     PyObject * status;
 
@@ -57,47 +318,46 @@ static PyObject * OSQP_solve(OSQP *self) {
 
     npy_intp nd[1];
     npy_intp md[1];
-
-    // Check that the workspace is initialized
-    if (!self->workspace) {
-        PyErr_SetString(PyExc_ValueError, "Workspace not initialized!");
-        return (PyObject *) NULL;
-    }
+    c_int n, m, k, nwork, L_nnz = 0;
+    c_int aa_accepted, aa_rejected;
+    OSQPWorkspace **works;
+    OSQPInfo *solve_info;
 
     // Temporary solution
-    nd[0] = (npy_intp)self->workspace->data->n;  // Dimensions in R^n
-    md[0] = (npy_intp)self->workspace->data->m;  // Dimensions in R^m
-
-    /**
-     *  Solve QP Problem
-     */
-
-    // Release the GIL
-    Py_BEGIN_ALLOW_THREADS;
-    exitflag = osqp_solve(self->workspace);
-    Py_END_ALLOW_THREADS;
+    OSQP_problem_dimensions(self, &n, &m);
+    nd[0] = (npy_intp)n;  // Dimensions in R^n
+    md[0] = (npy_intp)m;  // Dimensions in R^m
 
     if(exitflag){
         PyErr_SetString(PyExc_ValueError, "OSQP solve error!");
         return (PyObject *) NULL;
     }
 
+    // Information of the whole problem
+    solve_info = self->decomposition ? &self->decomposition->info : self->workspace->info;
+    works = OSQP_workspaces(self, &nwork);
+    for (k = 0; k < nwork; k++) L_nnz += linsys_L_nnz(works[k]);
+    aa_accepted = self->iteration && self->iteration->anderson ?
+                  self->iteration->anderson->accepted : 0;
+    aa_rejected = self->iteration && self->iteration->anderson ?
+                  self->iteration->anderson->rejected : 0;
+
     // If problem is not primal or dual infeasible store it
-    if ((self->workspace->info->status_val != OSQP_PRIMAL_INFEASIBLE) &&
-            (self->workspace->info->status_val != OSQP_PRIMAL_INFEASIBLE_INACCURATE) &&
-            (self->workspace->info->status_val != OSQP_DUAL_INFEASIBLE) &&
-            (self->workspace->info->status_val != OSQP_DUAL_INFEASIBLE_INACCURATE)){
+    if ((solve_info->status_val != OSQP_PRIMAL_INFEASIBLE) &&
+            (solve_info->status_val != OSQP_PRIMAL_INFEASIBLE_INACCURATE) &&
+            (solve_info->status_val != OSQP_DUAL_INFEASIBLE) &&
+            (solve_info->status_val != OSQP_DUAL_INFEASIBLE_INACCURATE)){
 
         // Primal and dual solutions
-        x = (PyObject *)PyArrayFromCArray(self->workspace->solution->x, nd);
-        y = (PyObject *)PyArrayFromCArray(self->workspace->solution->y, md);
+        x = (PyObject *)PyArrayFromCArray(OSQP_get_x(self, 0), nd);
+        y = (PyObject *)PyArrayFromCArray(OSQP_get_y(self, 0), md);
 
         // Infeasibility certificates -> None values
         prim_inf_cert = PyArray_EMPTY(1, nd, NPY_OBJECT, 0);
         dual_inf_cert = PyArray_EMPTY(1, md, NPY_OBJECT, 0);
 
-    } else if (self->workspace->info->status_val == OSQP_PRIMAL_INFEASIBLE ||
-            self->workspace->info->status_val == OSQP_PRIMAL_INFEASIBLE_INACCURATE) {
+    } else if (solve_info->status_val == OSQP_PRIMAL_INFEASIBLE ||
+            solve_info->status_val == OSQP_PRIMAL_INFEASIBLE_INACCURATE) {
         // primal infeasible
 
         // Primal and dual solution arrays -> None values
@@ -105,13 +365,13 @@ static PyObject * OSQP_solve(OSQP *self) {
         y = PyArray_EMPTY(1, md, NPY_OBJECT, 0);
 
         // Primal infeasibility certificate
-        prim_inf_cert = (PyObject *)PyArrayFromCArray(self->workspace->delta_y, md);
+        prim_inf_cert = (PyObject *)PyArrayFromCArray(OSQP_get_y(self, 1), md);
 
         // Dual infeasibility certificate -> None values
         dual_inf_cert = PyArray_EMPTY(1, nd, NPY_OBJECT, 0);
 
         // Set objective value to infinity
-        self->workspace->info->obj_val = NPY_INFINITY;
+        solve_info->obj_val = NPY_INFINITY;
 
     } else {
         // dual infeasible
@@ -124,21 +384,21 @@ static PyObject * OSQP_solve(OSQP *self) {
         prim_inf_cert = PyArray_EMPTY(1, md, NPY_OBJECT, 0);
 
         // Dual infeasibility certificate
-        dual_inf_cert = (PyObject *)PyArrayFromCArray(self->workspace->delta_x, nd);
+        dual_inf_cert = (PyObject *)PyArrayFromCArray(OSQP_get_x(self, 1), nd);
 
         // Set objective value to -infinity
-        self->workspace->info->obj_val = -NPY_INFINITY;
+        solve_info->obj_val = -NPY_INFINITY;
     }
 
     /*  CREATE INFO OBJECT */
     // Store status string
-    status = PyUnicode_FromString(self->workspace->info->status);
+    status = PyUnicode_FromString(solve_info->status);
 
     // Store obj_val
-    if (self->workspace->info->status_val == OSQP_NON_CVX) {	// non convex
+    if (solve_info->status_val == OSQP_NON_CVX) {	// non convex
         obj_val = PyFloat_FromDouble(Py_NAN);
     } else {
-        obj_val = PyFloat_FromDouble(self->workspace->info->obj_val);
+        obj_val = PyFloat_FromDouble(solve_info->obj_val);
     }
 
 #ifdef PROFILING
@@ -146,67 +406,74 @@ static PyObject * OSQP_solve(OSQP *self) {
 #ifdef DLONG
 
 #ifdef DFLOAT
-    argparse_string = "LOLLOfffffffLf";
+    argparse_string = "LOLLOffffffffLfLLL";
 #else
-    argparse_string = "LOLLOdddddddLd";
+    argparse_string = "LOLLOddddddddLdLLL";
 #endif
 
 #else
 
 #ifdef DFLOAT
-    argparse_string = "iOiiOfffffffif";
+    argparse_string = "iOiiOffffffffifiii";
 #else
-    argparse_string = "iOiiOdddddddid";
+    argparse_string = "iOiiOddddddddidiii";
 #endif
 
 #endif
 
     info_list = Py_BuildValue(argparse_string,
-                    self->workspace->info->iter,
+                    solve_info->iter,
                     status,
-                    self->workspace->info->status_val,
-                    self->workspace->info->status_polish,
+                    solve_info->status_val,
+                    solve_info->status_polish,
                     obj_val,
-                    self->workspace->info->pri_res,
-                    self->workspace->info->dua_res,
-                    self->workspace->info->setup_time,
-                    self->workspace->info->solve_time,
-                    self->workspace->info->update_time,
-                    self->workspace->info->polish_time,
-                    self->workspace->info->run_time,
-                    self->workspace->info->rho_updates,
-                    self->workspace->info->rho_estimate
+                    solve_info->pri_res,
+                    solve_info->dua_res,
+                    solve_info->setup_time,
+                    solve_info->solve_time,
+                    solve_info->update_time,
+                    solve_info->polish_time,
+                    solve_info->run_time,
+                    self->ordering_time,
+                    solve_info->rho_updates,
+                    solve_info->rho_estimate,
+                    L_nnz,
+                    aa_accepted,
+                    aa_rejected
                     );
 #else
 
 #ifdef DLONG
 
 #ifdef DFLOAT
-    argparse_string = "LOLLOffLf";
+    argparse_string = "LOLLOffLfLLL";
 #else
-    argparse_string = "LOLLOddLd";
+    argparse_string = "LOLLOddLdLLL";
 #endif
 
 #else
 
 #ifdef DFLOAT
-    argparse_string = "iOiiOffif";
+    argparse_string = "iOiiOffifiii";
 #else
-    argparse_string = "iOiiOddid";
+    argparse_string = "iOiiOddidiii";
 #endif
 
 #endif
 
     info_list = Py_BuildValue(argparse_string,
-            self->workspace->info->iter,
+            solve_info->iter,
             status,
-            self->workspace->info->status_val,
-            self->workspace->info->status_polish,
+            solve_info->status_val,
+            solve_info->status_polish,
             obj_val,
-            self->workspace->info->pri_res,
-            self->workspace->info->dua_res,
-            self->workspace->info->rho_updates,
-            self->workspace->info->rho_estimate,
+            solve_info->pri_res,
+            solve_info->dua_res,
+            solve_info->rho_updates,
+            solve_info->rho_estimate,
+            L_nnz,
+            aa_accepted,
+            aa_rejected
             );
 #endif
 
@@ -228,15 +495,204 @@ static PyObject * OSQP_solve(OSQP *self) {
 }
 
 
+// Solve Optimization Problem
+static PyObject * OSQP_solve(OSQP *self, PyObject *const *args,
+                             Py_ssize_t nargs) {
+    PyObject *results;
+    c_int exitflag;
+    c_float time_budget = -1.;  // Time until the deadline (negative = none)
+
+    // Parse arguments
+    if (fastcall_nargs("solve", nargs, 0, 1) ||
+        (nargs > 0 && fastcall_float(args[0], &time_budget))) {
+        return (PyObject *) NULL;
+    }
+
+    if (OSQP_prepare_solve(self, time_budget, 0)) {
+        return (PyObject *) NULL;
+    }
+
+    /**
+     *  Solve QP Problem
+     */
+
+    // Release the GIL
+    Py_BEGIN_ALLOW_THREADS;
+    exitflag = OSQP_run_solve(self);
+    Py_END_ALLOW_THREADS;
+
+    results = OSQP_solve_results(self, exitflag);
+    parallel_flag_set(&self->busy, 0);
+    return results;
+}
+OSQP_FASTCALL_VARARGS(OSQP_solve)
+
+
+/*
+ * Fused update, warm start and solve of an MPC step. The vectors are q, l,
+ * u, x0 and y0, each None when it is not updated.
+ */
+#define UPDATE_SOLVE_NVEC (5)
+
+// Contiguous copies of the vectors, NULL for None
+static c_int OSQP_update_solve_vectors(OSQP *self, PyObject **vecs,
+                                       PyArrayObject **conts) {
+    static const char *names[UPDATE_SOLVE_NVEC] = {"q", "l", "u", "x0", "y0"};
+    c_int n, m, len, k;
+    PyArrayObject *vec;
+
+    OSQP_problem_dimensions(self, &n, &m);
+    for (k = 0; k < UPDATE_SOLVE_NVEC; k++) conts[k] = OSQP_NULL;
+    for (k = 0; k < UPDATE_SOLVE_NVEC; k++) {
+        if (vecs[k] == Py_None) continue;
+        vec = (PyArrayObject *)vecs[k];
+        len = (k == 0 || k == 3) ? n : m;
+        if (!PyArray_Check(vecs[k])) {
+            PyErr_Format(PyExc_TypeError, "%s must be numpy.ndarray, not %s",
+                         names[k], Py_TYPE(vecs[k])->tp_name);
+            return 1;
+        }
+        if (PyArray_NDIM(vec) != 1 || PyArray_DIM(vec, 0) != len) {
+            PyErr_Format(PyExc_ValueError, "%s must have length %s",
+                         names[k], (k == 0 || k == 3) ? "n" : "m");
+            return 1;
+        }
+        // The cast always copies, so the bounds can be clamped in place
+        conts[k] = get_contiguous(vec, get_float_type());
+        if (!conts[k]) return 1;
+    }
+    return 0;
+}
+
+// Update, warm start and solve, without the GIL. The update errors set error.
+static c_int OSQP_run_update_solve(OSQP *self, c_float **v, c_int m,
+                                   const char **error) {
+    c_float *q = v[0], *l = v[1], *u = v[2], *x = v[3], *y = v[4];
+    c_int i;
+
+    // Convert values to -OSQP_INFTY and OSQP_INFTY
+    if (l) for (i = 0; i < m; i++) l[i] = c_max(l[i], -OSQP_INFTY);
+    if (u) for (i = 0; i < m; i++) u[i] = c_min(u[i], OSQP_INFTY);
+
+    // Map the data onto the reduced problem
+    if (self->presolve) {
+        if ((q && presolve_update_lin_cost(self->presolve, q)) ||
+            ((l || u) && presolve_update_bounds(self->presolve, l, u))) {
+            *error = "Update removes a reduction of the presolve!";
+        } else {
+            if (q) q = self->presolve->data->q;
+            if (l || u) {
+                l = self->presolve->data->l;
+                u = self->presolve->data->u;
+            }
+            if (x) {
+                presolve_warm_start_x(self->presolve, x);
+                x = self->presolve->x;
+            }
+            if (y) {
+                presolve_warm_start_y(self->presolve, y);
+                y = self->presolve->y;
+            }
+        }
+    }
+
+    if (!*error && q && OSQP_update_workspace_lin_cost(self, q)) {
+        *error = "Linear cost update error!";
+    }
+    if (!*error && (l || u) && OSQP_update_workspace_bounds(self, l, u)) {
+        *error = "Bounds update error!";
+    }
+    if (*error) {
+        // Drop the deadline set for the solve
+        if (!self->decomposition) self->iteration->deadline = 0.;
+        return 1;
+    }
+    if (x || y) OSQP_warm_start_workspace(self, x, y);
+
+    return OSQP_run_solve(self);
+}
+
+static PyObject * OSQP_update_solve(OSQP *self, PyObject *const *args,
+                                    Py_ssize_t nargs) {
+    PyObject *vecs[UPDATE_SOLVE_NVEC];
+    PyArrayObject *conts[UPDATE_SOLVE_NVEC];
+    PyObject *results;
+    c_float *v[UPDATE_SOLVE_NVEC];
+    c_float time_budget = -1.;  // Time until the deadline (negative = none)
+    const char *error = OSQP_NULL;
+    c_int exitflag, n, m, k;
+
+    // Check that the workspace is initialized
+    if (!self->workspace) {
+        PyErr_SetString(PyExc_ValueError, "Workspace not initialized!");
+        return (PyObject *) NULL;
+    }
+
+    // Parse arguments
+    if (fastcall_nargs("update_solve", nargs, 5, 6) ||
+        (nargs > 5 && fastcall_float(args[5], &time_budget))) {
+        return (PyObject *) NULL;
+    }
+    for (k = 0; k < UPDATE_SOLVE_NVEC; k++) vecs[k] = args[k];
+
+    if (OSQP_update_solve_vectors(self, vecs, conts) ||
+        OSQP_prepare_solve(self, time_budget, 0)) {
+        for (k = 0; k < UPDATE_SOLVE_NVEC; k++) Py_XDECREF(conts[k]);
+        return (PyObject *) NULL;
+    }
+    for (k = 0; k < UPDATE_SOLVE_NVEC; k++) {
+        v[k] = conts[k] ? (c_float *)PyArray_DATA(conts[k]) : OSQP_NULL;
+    }
+    OSQP_problem_dimensions(self, &n, &m);
+
+    // Release the GIL
+    Py_BEGIN_ALLOW_THREADS;
+    exitflag = OSQP_run_update_solve(self, v, m, &error);
+    Py_END_ALLOW_THREADS;
+
+    // Free data
+    for (k = 0; k < UPDATE_SOLVE_NVEC; k++) Py_XDECREF(conts[k]);
+
+    if (error) {
+        parallel_flag_set(&self->busy, 0);
+        PyErr_SetString(PyExc_ValueError, error);
+        return (PyObject *) NULL;
+    }
+
+    results = OSQP_solve_results(self, exitflag);
+    parallel_flag_set(&self->busy, 0);
+    return results;
+}
+OSQP_FASTCALL_VARARGS(OSQP_update_solve)
+
+
 // Setup optimization problem
 static PyObject * OSQP_setup(OSQP *self, PyObject *args, PyObject *kwargs) {
     c_int n, m;  // Problem dimensions
     c_int exitflag;
+    int linsys_solver;  // Linear system solver requested by the user
 	PyOSQPData *pydata;
 	OSQPData * data;
 	OSQPSettings * settings;
 
     PyArrayObject *Px, *Pi, *Pp, *q, *Ax, *Ai, *Ap, *l, *u;
+    int ordering = AMD_ORDERING;                // Fill-reducing ordering
+    PyArrayObject *ordering_perm = OSQP_NULL;   // User permutation
+    PyArrayObject *ordering_perm_cont = OSQP_NULL;
+    c_int *ordering_perm_arr = OSQP_NULL;
+    int eliminate_bounds = 0;   // Eliminate box constraints from the KKT
+    int presolve = 0;           // Presolve the problem data
+    int decompose = 0;          // Solve independent blocks separately
+    int threads = 0;            // Threads of the blocks or of the supernodal solver (0 = all processors)
+    int dense_max_dim = DENSE_MAX_DIM;  // Largest KKT matrix factored densely
+    int anderson = ANDERSON_NONE;       // Type of Anderson acceleration
+    int anderson_mem = ANDERSON_MEM;    // Differences kept by Anderson acceleration
+    int adaptive_check = 0;     // Schedule the termination checks adaptively
+    int cancellable = 0;        // Let cancel() stop the synchronous solves
+    const OSQPData *setup_data; // Problem passed to OSQP
+    OSQPDecomposition *decomp;
+    c_float block_ordering_time;
+    c_int k;
     static char *kwlist[] = {"dims",                     // nvars and ncons
                              "Px", "Pi", "Pp", "q",      // Cost function
                              "Ax", "Ai", "Ap", "l", "u", // Constraints
@@ -249,24 +705,29 @@ static PyObject * OSQP_setup(OSQP *self, PyObject *args, PyObject *kwargs) {
                              "polish_refine_iter", "verbose",
                              "scaled_termination",
                              "check_termination", "warm_start",
-                             "time_limit", NULL};        // Settings
+                             "time_limit",
+                             "ordering", "ordering_perm",
+                             "eliminate_bounds", "presolve",
+                             "decompose", "threads", "dense_max_dim",
+                             "anderson", "anderson_mem", "adaptive_check",
+                             "cancellable", NULL};  // Settings
 
 #ifdef DLONG
 
 // NB: linsys_solver is enum type which is stored as int (regardless on how c_int is defined).
 
 #ifdef DFLOAT
-    static char * argparse_string = "(LL)O!O!O!O!O!O!O!O!O!|LLLffffLffffffiLLLLLLf";
+    static char * argparse_string = "(LL)O!O!O!O!O!O!O!O!O!|LLLffffLffffffiLLLLLLfiO!iiiiiiiii";
 #else
-    static char * argparse_string = "(LL)O!O!O!O!O!O!O!O!O!|LLLddddLddddddiLLLLLLd";
+    static char * argparse_string = "(LL)O!O!O!O!O!O!O!O!O!|LLLddddLddddddiLLLLLLdiO!iiiiiiiii";
 #endif
 
 #else
 
 #ifdef DFLOAT
-    static char * argparse_string = "(ii)O!O!O!O!O!O!O!O!O!|iiiffffiffffffiiiiiiif";
+    static char * argparse_string = "(ii)O!O!O!O!O!O!O!O!O!|iiiffffiffffffiiiiiiifiO!iiiiiiiii";
 #else
-    static char * argparse_string = "(ii)O!O!O!O!O!O!O!O!O!|iiiddddiddddddiiiiiiid";
+    static char * argparse_string = "(ii)O!O!O!O!O!O!O!O!O!|iiiddddiddddddiiiiiiidiO!iiiiiiiii";
 #endif
 
 #endif
@@ -313,24 +774,169 @@ static PyObject * OSQP_setup(OSQP *self, PyObject *args, PyObject *kwargs) {
                                      &settings->scaled_termination,
                                      &settings->check_termination,
                                      &settings->warm_start,
-                                     &settings->time_limit)) {
+                                     &settings->time_limit,
+                                     &ordering,
+                                     &PyArray_Type, &ordering_perm,
+                                     &eliminate_bounds,
+                                     &presolve,
+                                     &decompose,
+                                     &threads,
+                                     &dense_max_dim,
+                                     &anderson,
+                                     &anderson_mem,
+                                     &adaptive_check,
+                                     &cancellable)) {
         return (PyObject *) NULL;
     }
 
+    // Linear system solvers of the extension are set up on top of QDLDL
+    linsys_solver = settings->linsys_solver;
+    if (linsys_solver == SUPERNODAL_SOLVER || linsys_solver == DENSE_SOLVER ||
+        linsys_solver == BANDED_SOLVER) {
+        settings->linsys_solver = QDLDL_SOLVER;
+    }
+
+    // The banded solver needs an ordering giving a narrow band
+    if (linsys_solver == BANDED_SOLVER && ordering == AMD_ORDERING) {
+        ordering = RCM_ORDERING;
+    }
+
+    // Orderings other than AMD and the elimination of box constraints are
+    // applied to the QDLDL solver
+    if ((ordering != AMD_ORDERING || eliminate_bounds) &&
+        settings->linsys_solver != QDLDL_SOLVER) {
+        c_free(settings);
+        PyErr_SetString(PyExc_ValueError, "The ordering and eliminate_bounds can only be selected for QDLDL based linear system solvers!");
+        return (PyObject *) NULL;
+    }
+    if (ordering == USER_ORDERING) {
+        if (eliminate_bounds || presolve || decompose) {
+            c_free(settings);
+            PyErr_SetString(PyExc_ValueError, "A user ordering cannot be combined with eliminate_bounds, presolve or decompose!");
+            return (PyObject *) NULL;
+        }
+        if (!ordering_perm || PyArray_SIZE(ordering_perm) != (npy_intp)(n + m)) {
+            c_free(settings);
+            PyErr_SetString(PyExc_ValueError, "The ordering permutation must have length n + m!");
+            return (PyObject *) NULL;
+        }
+        ordering_perm_cont = get_contiguous(ordering_perm, get_int_type());
+        if (!ordering_perm_cont) {
+            // The conversion error is already set
+            c_free(settings);
+            return (PyObject *) NULL;
+        }
+        ordering_perm_arr = (c_int *)PyArray_DATA(ordering_perm_cont);
+        if (!is_permutation(ordering_perm_arr, n + m)) {
+            Py_DECREF(ordering_perm_cont);
+            c_free(settings);
+            PyErr_SetString(PyExc_ValueError, "The ordering is not a permutation of the KKT matrix!");
+            return (PyObject *) NULL;
+        }
+    }
+    if (anderson != ANDERSON_NONE) {
+        if (anderson != ANDERSON_TYPE_I && anderson != ANDERSON_TYPE_II) {
+            c_free(settings);
+            if (ordering_perm_cont) Py_DECREF(ordering_perm_cont);
+            PyErr_SetString(PyExc_ValueError, "Unknown type of Anderson acceleration!");
+            return (PyObject *) NULL;
+        }
+        if (anderson_mem < 1) {
+            c_free(settings);
+            if (ordering_perm_cont) Py_DECREF(ordering_perm_cont);
+            PyErr_SetString(PyExc_ValueError, "anderson_mem must be positive!");
+            return (PyObject *) NULL;
+        }
+    }
+    if ((anderson != ANDERSON_NONE || adaptive_check) && decompose) {
+        c_free(settings);
+        if (ordering_perm_cont) Py_DECREF(ordering_perm_cont);
+        PyErr_SetString(PyExc_ValueError, "Anderson acceleration and adaptive_check cannot be combined with decompose!");
+        return (PyObject *) NULL;
+    }
+    self->ordering_time = Py_NAN;
+    self->cancellable = cancellable;
+
     // Create Data from parsed vectors
     pydata = create_pydata(n, m, Px, Pi, Pp, q, Ax, Ai, Ap, l, u);
     data = create_data(pydata);
 
+    // Reduce the problem passed to OSQP
+    if (presolve) {
+        self->presolve = presolve_setup(data);
+        if (!self->presolve) {
+            free_data(data, pydata);
+            c_free(settings);
+            if (ordering_perm_cont) Py_DECREF(ordering_perm_cont);
+            PyErr_SetString(PyExc_ValueError, "Presolve allocation error!");
+            return (PyObject *) NULL;
+        }
+    }
+
     // Create Workspace object
     // Release the GIL
     Py_BEGIN_ALLOW_THREADS;
-    exitflag = osqp_setup(&(self->workspace), data, settings);
+    setup_data = self->presolve ? self->presolve->data : data;
+    decomp = OSQP_NULL;
+    exitflag = decompose ? decomposition_setup(setup_data, threads, &decomp) : 0;
+    if (!exitflag && decomp) {
+        // One workspace per block, the first one standing for the problem
+        if (ordering != AMD_ORDERING) self->ordering_time = 0.;
+        for (k = 0; !exitflag && k < decomp->nblocks; k++) {
+            exitflag = osqp_setup(&decomp->work[k], decomp->data[k], settings);
+            if (!exitflag) {
+                block_ordering_time = 0.;
+                // The blocks already run on the threads
+                exitflag = OSQP_setup_linsys(decomp->work[k], linsys_solver,
+                                             ordering, ordering_perm_arr,
+                                             eliminate_bounds, dense_max_dim,
+                                             1, &block_ordering_time);
+                self->ordering_time += block_ordering_time;
+            }
+            if (!exitflag) {
+                decomp->iteration[k] = iteration_setup(decomp->work[k],
+                                                       ANDERSON_NONE, 0, 0,
+                                                       &self->cancel);
+                if (!decomp->iteration[k]) exitflag = 1;
+            }
+        }
+        if (exitflag) {
+            decomposition_free(decomp);
+        } else {
+            self->decomposition = decomp;
+            self->workspace = decomp->work[0];
+        }
+    } else if (!exitflag) {
+        exitflag = osqp_setup(&(self->workspace), setup_data, settings);
+        if (!exitflag) {
+            exitflag = OSQP_setup_linsys(self->workspace, linsys_solver,
+                                         ordering, ordering_perm_arr,
+                                         eliminate_bounds, dense_max_dim,
+                                         threads, &self->ordering_time);
+        }
+        if (!exitflag) {
+            self->iteration = iteration_setup(self->workspace, anderson,
+                                              anderson_mem, adaptive_check,
+                                              &self->cancel);
+            if (!self->iteration) exitflag = 1;
+        }
+        if (exitflag && self->workspace) {
+            osqp_cleanup(self->workspace);
+            self->workspace = OSQP_NULL;
+        }
+    }
     Py_END_ALLOW_THREADS;
 
 
     // Cleanup data and settings
     free_data(data, pydata);
     c_free(settings);
+    if (ordering_perm_cont) Py_DECREF(ordering_perm_cont);
+
+    if (exitflag) {
+        presolve_free(self->presolve);
+        self->presolve = OSQP_NULL;
+    }
 
     if (!exitflag){ // Workspace allocation correct
         // Return workspace
@@ -343,12 +949,61 @@ static PyObject * OSQP_setup(OSQP *self, PyObject *args, PyObject *kwargs) {
 }
 
 
+// Start a solve on the worker pool and return its identifier
+static PyObject * OSQP_solve_submit(OSQP *self, PyObject *const *args,
+                                    Py_ssize_t nargs) {
+    c_float time_budget = -1.;  // Time until the deadline (negative = none)
+    long id;
+
+    // Parse arguments
+    if (fastcall_nargs("solve_submit", nargs, 0, 1) ||
+        (nargs > 0 && fastcall_float(args[0], &time_budget))) {
+        return (PyObject *) NULL;
+    }
+
+#ifdef _WIN32
+    PyErr_SetString(PyExc_ValueError, "Asynchronous solves are not supported on Windows!");
+    return (PyObject *) NULL;
+#else
+    if (OSQP_prepare_solve(self, time_budget, 1)) {
+        return (PyObject *) NULL;
+    }
+    // The job keeps the object alive, and busy, until async_poll has built
+    // its results. The worker may finish before async_submit returns.
+    Py_INCREF(self);
+    if (async_start(&OSQP_run_solve) || async_submit(self, &id)) {
+        parallel_flag_set(&self->busy, 0);
+        Py_DECREF(self);
+        PyErr_SetString(PyExc_ValueError, "Asynchronous solve allocation error!");
+        return (PyObject *) NULL;
+    }
+
+    return Py_BuildValue("l", id);
+#endif
+}
+OSQP_FASTCALL_VARARGS(OSQP_solve_submit)
+
+
+// Stop the solve running in another thread, or the next solve if none
+// runs, which returns the current iterate with the status OSQP_CANCELLED
+static PyObject *OSQP_cancel(OSQP *self) {
+    // The running solve, or the next one if none runs. The GIL orders this
+    // call with the start and the end of the solves.
+    parallel_flag_set(&self->cancel, parallel_flag_get(&self->busy) ?
+                      self->ticket : OSQP_next_ticket(self->ticket));
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+
 static PyObject *OSQP_version(OSQP *self) {
     return Py_BuildValue("s", osqp_version());
 }
 
 
 static PyObject *OSQP_dimensions(OSQP *self){
+    c_int n, m;
 
     // Check that the workspace is initialized
     if (!self->workspace) {
@@ -356,33 +1011,107 @@ static PyObject *OSQP_dimensions(OSQP *self){
         return (PyObject *) NULL;
     }
 
+    OSQP_problem_dimensions(self, &n, &m);
+
 #ifdef DLONG
-    return Py_BuildValue("ll", self->workspace->data->n, self->workspace->data->m);
+    return Py_BuildValue("ll", n, m);
 #else
-    return Py_BuildValue("ii", self->workspace->data->n, self->workspace->data->m);
+    return Py_BuildValue("ii", n, m);
 #endif
 }
 
 
+// Unscaled P (upper triangular) and A reconstructed from the scaled workspace data
+static PyObject *OSQP_unscaled_matrices(OSQP *self) {
+    PyArrayObject *Px, *Pi, *Pp, *Ax, *Ai, *Ap;
+    const csc *P, *A;
+    npy_intp Pnz, Anz, np1;
+    int float_type = get_float_type();
+    int int_type = get_int_type();
+
+    // Check that the workspace is initialized
+    if (!self->workspace) {
+        PyErr_SetString(PyExc_ValueError, "Workspace not initialized!");
+        return (PyObject *) NULL;
+    }
+    if (self->presolve || self->decomposition) {
+        PyErr_SetString(PyExc_ValueError, "The matrices cannot be reconstructed with presolve or decompose!");
+        return (PyObject *) NULL;
+    }
+
+    P = self->workspace->data->P;
+    A = self->workspace->data->A;
+    np1 = (npy_intp)P->n + 1;
+    Pnz = (npy_intp)P->p[P->n];
+    Anz = (npy_intp)A->p[A->n];
+    Px = (PyArrayObject *)PyArray_SimpleNew(1, &Pnz, float_type);
+    Pi = (PyArrayObject *)PyArray_SimpleNew(1, &Pnz, int_type);
+    Pp = (PyArrayObject *)PyArray_SimpleNew(1, &np1, int_type);
+    Ax = (PyArrayObject *)PyArray_SimpleNew(1, &Anz, float_type);
+    Ai = (PyArrayObject *)PyArray_SimpleNew(1, &Anz, int_type);
+    Ap = (PyArrayObject *)PyArray_SimpleNew(1, &np1, int_type);
+
+    derivative_unscale_matrices(self->workspace, (c_float *)PyArray_DATA(Px),
+                                (c_float *)PyArray_DATA(Ax));
+    memcpy(PyArray_DATA(Pi), P->i, Pnz * sizeof(c_int));
+    memcpy(PyArray_DATA(Pp), P->p, np1 * sizeof(c_int));
+    memcpy(PyArray_DATA(Ai), A->i, Anz * sizeof(c_int));
+    memcpy(PyArray_DATA(Ap), A->p, np1 * sizeof(c_int));
+
+    return Py_BuildValue("(NNNNNN)", Px, Pi, Pp, Ax, Ai, Ap);
+}
+
+
+
+
+// Switch the dense linear system solvers back to the QDLDL solvers under
+// them, whose factors are then up to date
+static PyObject *OSQP_use_qdldl(OSQP *self) {
+    LinSysSolver **kkt_solver;
+    const csc *kkt_P, *kkt_A;
+    OSQPWorkspace **works;
+    c_int k, nwork;
+
+    // Check that the workspace is initialized
+    if (!self->workspace) {
+        PyErr_SetString(PyExc_ValueError, "Workspace not initialized!");
+        return (PyObject *) NULL;
+    }
+    if (OSQP_check_idle(self)) return (PyObject *) NULL;
+
+    works = OSQP_workspaces(self, &nwork);
+    for (k = 0; k < nwork; k++) {
+        kkt_solver = linsys_kkt_solver(works[k], &kkt_P, &kkt_A);
+        if ((*kkt_solver)->type == DENSE_SOLVER && dense_uninstall(kkt_solver)) {
+            PyErr_SetString(PyExc_ValueError, "KKT matrix factorization error!");
+            return (PyObject *) NULL;
+        }
+    }
+
+    // Return None
+    Py_INCREF(Py_None);
+    return Py_None;
+}
 
 
-static PyObject *OSQP_update_lin_cost(OSQP *self, PyObject *args) {
+static PyObject *OSQP_update_lin_cost(OSQP *self, PyObject *const *args,
+                                      Py_ssize_t nargs) {
 
     PyArrayObject *q, *q_cont;
     c_float * q_arr;
     int float_type = get_float_type();
     int exitflag = 0;
 
-    static char * argparse_string = "O!";
-
     // Check that the workspace is initialized
     if (!self->workspace) {
         PyErr_SetString(PyExc_ValueError, "Workspace not initialized!");
         return (PyObject *) NULL;
     }
+    if (OSQP_check_idle(self)) return (PyObject *) NULL;
 
     // Parse arguments
-    if( !PyArg_ParseTuple(args, argparse_string, &PyArray_Type, &q)) {
+    if (fastcall_nargs("update_lin_cost", nargs, 1, 1) ||
+        !(q = fastcall_array("update_lin_cost", args, 0))) {
         return (PyObject *) NULL;
     }
 
@@ -392,8 +1121,18 @@ static PyObject *OSQP_update_lin_cost(OSQP *self, PyObject *args) {
     // Copy array into c_float array
     q_arr = (c_float *)PyArray_DATA(q_cont);
 
+    // Map the linear cost onto the reduced problem
+    if (self->presolve) {
+        if (presolve_update_lin_cost(self->presolve, q_arr)) {
+            Py_DECREF(q_cont);
+            PyErr_SetString(PyExc_ValueError, "Linear cost update removes a reduction of the presolve!");
+            return (PyObject *) NULL;
+        }
+        q_arr = self->presolve->data->q;
+    }
+
     // Update linear cost
-    exitflag = osqp_update_lin_cost(self->workspace, q_arr);
+    exitflag = OSQP_update_workspace_lin_cost(self, q_arr);
 
     // Free data
     Py_DECREF(q_cont);
@@ -409,24 +1148,26 @@ static PyObject *OSQP_update_lin_cost(OSQP *self, PyObject *args) {
     return Py_None;
 
 }
+OSQP_FASTCALL_VARARGS(OSQP_update_lin_cost)
 
-static PyObject *OSQP_update_lower_bound(OSQP *self, PyObject *args){
+static PyObject *OSQP_update_lower_bound(OSQP *self, PyObject *const *args,
+                                         Py_ssize_t nargs){
 
     PyArrayObject *l, *l_cont;
     c_float * l_arr;
     int float_type = get_float_type();
     int exitflag = 0;
 
-    static char * argparse_string = "O!";
-
     // Check that the workspace is initialized
     if (!self->workspace) {
         PyErr_SetString(PyExc_ValueError, "Workspace not initialized!");
         return (PyObject *) NULL;
     }
+    if (OSQP_check_idle(self)) return (PyObject *) NULL;
 
     // Parse arguments
-    if( !PyArg_ParseTuple(args, argparse_string, &PyArray_Type, &l)) {
+    if (fastcall_nargs("update_lower_bound", nargs, 1, 1) ||
+        !(l = fastcall_array("update_lower_bound", args, 0))) {
         return (PyObject *) NULL;
     }
 
@@ -437,7 +1178,17 @@ static PyObject *OSQP_update_lower_bound(OSQP *self, PyObject *args){
     l_arr = (c_float *)PyArray_DATA(l_cont);
 
     // Update lower bound
-    exitflag = osqp_update_lower_bound(self->workspace, l_arr);
+    if (self->presolve) {
+        if (presolve_update_bounds(self->presolve, l_arr, OSQP_NULL)) {
+            Py_DECREF(l_cont);
+            PyErr_SetString(PyExc_ValueError, "Bounds update removes a reduction of the presolve!");
+            return (PyObject *) NULL;
+        }
+        exitflag = OSQP_update_workspace_bounds(self, self->presolve->data->l,
+                                                self->presolve->data->u);
+    } else {
+        exitflag = OSQP_update_workspace_bounds(self, l_arr, OSQP_NULL);
+    }
 
     // Free data
     Py_DECREF(l_cont);
@@ -452,24 +1203,26 @@ static PyObject *OSQP_update_lower_bound(OSQP *self, PyObject *args){
     return Py_None;
 
 }
+OSQP_FASTCALL_VARARGS(OSQP_update_lower_bound)
 
-static PyObject *OSQP_update_upper_bound(OSQP *self, PyObject *args){
+static PyObject *OSQP_update_upper_bound(OSQP *self, PyObject *const *args,
+                                         Py_ssize_t nargs){
 
     PyArrayObject *u, *u_cont;
     c_float * u_arr;
     int float_type = get_float_type();
     int exitflag = 0;
 
-    static char * argparse_string = "O!";
-
     // Check that the workspace is initialized
     if (!self->workspace) {
         PyErr_SetString(PyExc_ValueError, "Workspace not initialized!");
         return (PyObject *) NULL;
     }
+    if (OSQP_check_idle(self)) return (PyObject *) NULL;
 
     // Parse arguments
-    if( !PyArg_ParseTuple(args, argparse_string, &PyArray_Type, &u)) {
+    if (fastcall_nargs("update_upper_bound", nargs, 1, 1) ||
+        !(u = fastcall_array("update_upper_bound", args, 0))) {
         return (PyObject *) NULL;
     }
 
@@ -480,7 +1233,17 @@ static PyObject *OSQP_update_upper_bound(OSQP *self, PyObject *args){
     u_arr = (c_float *)PyArray_DATA(u_cont);
 
     // Update upper bound
-    exitflag = osqp_update_upper_bound(self->workspace, u_arr);
+    if (self->presolve) {
+        if (presolve_update_bounds(self->presolve, OSQP_NULL, u_arr)) {
+            Py_DECREF(u_cont);
+            PyErr_SetString(PyExc_ValueError, "Bounds update removes a reduction of the presolve!");
+            return (PyObject *) NULL;
+        }
+        exitflag = OSQP_update_workspace_bounds(self, self->presolve->data->l,
+                                                self->presolve->data->u);
+    } else {
+        exitflag = OSQP_update_workspace_bounds(self, OSQP_NULL, u_arr);
+    }
 
     // Free data
     Py_DECREF(u_cont);
@@ -495,27 +1258,28 @@ static PyObject *OSQP_update_upper_bound(OSQP *self, PyObject *args){
     Py_INCREF(Py_None);
     return Py_None;
 }
+OSQP_FASTCALL_VARARGS(OSQP_update_upper_bound)
 
 
-static PyObject *OSQP_update_bounds(OSQP *self, PyObject *args){
+static PyObject *OSQP_update_bounds(OSQP *self, PyObject *const *args,
+                                    Py_ssize_t nargs){
 
     PyArrayObject *l, *l_cont, *u, *u_cont;
     c_float * l_arr, * u_arr;
     int float_type = get_float_type();
     int exitflag = 0;
 
-    static char * argparse_string = "O!O!";
-
     // Check that the workspace is initialized
     if (!self->workspace) {
         PyErr_SetString(PyExc_ValueError, "Workspace not initialized!");
         return (PyObject *) NULL;
     }
+    if (OSQP_check_idle(self)) return (PyObject *) NULL;
 
     // Parse arguments
-    if( !PyArg_ParseTuple(args, argparse_string,
-                          &PyArray_Type, &l,
-                          &PyArray_Type, &u)) {
+    if (fastcall_nargs("update_bounds", nargs, 2, 2) ||
+        !(l = fastcall_array("update_bounds", args, 0)) ||
+        !(u = fastcall_array("update_bounds", args, 1))) {
         return (PyObject *) NULL;
     }
 
@@ -528,7 +1292,18 @@ static PyObject *OSQP_update_bounds(OSQP *self, PyObject *args){
     u_arr = (c_float *)PyArray_DATA(u_cont);
 
     // Update bounds
-    exitflag = osqp_update_bounds(self->workspace, l_arr, u_arr);
+    if (self->presolve) {
+        if (presolve_update_bounds(self->presolve, l_arr, u_arr)) {
+            Py_DECREF(l_cont);
+            Py_DECREF(u_cont);
+            PyErr_SetString(PyExc_ValueError, "Bounds update removes a reduction of the presolve!");
+            return (PyObject *) NULL;
+        }
+        exitflag = OSQP_update_workspace_bounds(self, self->presolve->data->l,
+                                                self->presolve->data->u);
+    } else {
+        exitflag = OSQP_update_workspace_bounds(self, l_arr, u_arr);
+    }
 
     // Free data
     Py_DECREF(l_cont);
@@ -544,10 +1319,216 @@ static PyObject *OSQP_update_bounds(OSQP *self, PyObject *args){
     Py_INCREF(Py_None);
     return Py_None;
 }
+OSQP_FASTCALL_VARARGS(OSQP_update_bounds)
+
+
+/*
+ * Indexed updates of the vectors. Only the given entries are updated. With
+ * the presolve, the bounds are mapped onto the reduced problem as a whole.
+ */
+static c_int OSQP_check_idx(const c_int *idx, c_int k, c_int dim) {
+    c_int t;
+
+    for (t = 0; t < k; t++) {
+        if (idx[t] < 0 || idx[t] >= dim) {
+            PyErr_SetString(PyExc_ValueError, "Index out of range!");
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static PyObject *OSQP_update_lin_cost_idx(OSQP *self, PyObject *const *args,
+                                          Py_ssize_t nargs) {
+
+    PyArrayObject *q, *q_cont, *q_idx, *q_idx_cont;
+    c_float *q_arr, *qr_arr;
+    c_int *q_idx_arr, *idxr_arr;
+    c_int n, m, k, kr;
+    int float_type = get_float_type();
+    int int_type = get_int_type();
+    int exitflag = 0;
+
+    // Check that the workspace is initialized
+    if (!self->workspace) {
+        PyErr_SetString(PyExc_ValueError, "Workspace not initialized!");
+        return (PyObject *) NULL;
+    }
+    if (OSQP_check_idle(self)) return (PyObject *) NULL;
+
+    // Parse arguments
+    if (fastcall_nargs("update_lin_cost_idx", nargs, 2, 2) ||
+        !(q = fastcall_array("update_lin_cost_idx", args, 0)) ||
+        !(q_idx = fastcall_array("update_lin_cost_idx", args, 1))) {
+        return (PyObject *) NULL;
+    }
+    if (PyArray_SIZE(q) != PyArray_SIZE(q_idx)) {
+        PyErr_SetString(PyExc_ValueError, "q and q_idx must have the same lengths!");
+        return (PyObject *) NULL;
+    }
+
+    // Get contiguous data structure
+    q_cont = get_contiguous(q, float_type);
+    q_idx_cont = get_contiguous(q_idx, int_type);
+
+    // Copy array into c_float and c_int arrays
+    q_arr = (c_float *)PyArray_DATA(q_cont);
+    q_idx_arr = (c_int *)PyArray_DATA(q_idx_cont);
+    k = (c_int)PyArray_SIZE(q_idx_cont);
+
+    OSQP_problem_dimensions(self, &n, &m);
+    if (OSQP_check_idx(q_idx_arr, k, n)) {
+        Py_DECREF(q_cont);
+        Py_DECREF(q_idx_cont);
+        return (PyObject *) NULL;
+    }
+
+    // Update linear cost, mapped onto the reduced problem
+    if (self->presolve) {
+        qr_arr = (c_float *)c_malloc((k + 1) * sizeof(c_float));
+        idxr_arr = (c_int *)c_malloc((k + 1) * sizeof(c_int));
+        if (!qr_arr || !idxr_arr) {
+            PyErr_SetString(PyExc_ValueError, "Linear cost update allocation error!");
+        } else if (presolve_update_lin_cost_idx(self->presolve, q_arr, q_idx_arr,
+                                                k, qr_arr, idxr_arr, &kr)) {
+            PyErr_SetString(PyExc_ValueError, "Linear cost update removes a reduction of the presolve!");
+        } else {
+            exitflag = OSQP_update_workspace_lin_cost_idx(self, qr_arr, idxr_arr, kr);
+        }
+        if (qr_arr) c_free(qr_arr);
+        if (idxr_arr) c_free(idxr_arr);
+        if (PyErr_Occurred()) {
+            Py_DECREF(q_cont);
+            Py_DECREF(q_idx_cont);
+            return (PyObject *) NULL;
+        }
+    } else {
+        exitflag = OSQP_update_workspace_lin_cost_idx(self, q_arr, q_idx_arr, k);
+    }
+
+    // Free data
+    Py_DECREF(q_cont);
+    Py_DECREF(q_idx_cont);
+
+    if(exitflag){
+        PyErr_SetString(PyExc_ValueError, "Linear cost update error!");
+        return (PyObject *) NULL;
+    }
+
+    // Return None
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+OSQP_FASTCALL_VARARGS(OSQP_update_lin_cost_idx)
+
+static PyObject *OSQP_update_bounds_idx(OSQP *self, PyObject *const *args,
+                                        Py_ssize_t nargs) {
+
+    PyObject *l, *u;
+    PyArrayObject *l_cont = OSQP_NULL, *u_cont = OSQP_NULL, *idx, *idx_cont;
+    c_float *l_arr = OSQP_NULL, *u_arr = OSQP_NULL;
+    c_float *l_full = OSQP_NULL, *u_full = OSQP_NULL;
+    c_int *idx_arr;
+    c_int n, m, k, t;
+    int float_type = get_float_type();
+    int int_type = get_int_type();
+    int exitflag = 0;
+
+    // Check that the workspace is initialized
+    if (!self->workspace) {
+        PyErr_SetString(PyExc_ValueError, "Workspace not initialized!");
+        return (PyObject *) NULL;
+    }
+    if (OSQP_check_idle(self)) return (PyObject *) NULL;
+
+    // Parse arguments, the bounds that are None are kept
+    if (fastcall_nargs("update_bounds_idx", nargs, 3, 3) ||
+        !(idx = fastcall_array("update_bounds_idx", args, 2))) {
+        return (PyObject *) NULL;
+    }
+    l = args[0];
+    u = args[1];
+    if ((l == Py_None && u == Py_None) ||
+        (l != Py_None && !PyArray_Check(l)) ||
+        (u != Py_None && !PyArray_Check(u))) {
+        PyErr_SetString(PyExc_ValueError, "l and u must be arrays or None!");
+        return (PyObject *) NULL;
+    }
+    if ((l != Py_None && PyArray_SIZE((PyArrayObject *)l) != PyArray_SIZE(idx)) ||
+        (u != Py_None && PyArray_SIZE((PyArrayObject *)u) != PyArray_SIZE(idx))) {
+        PyErr_SetString(PyExc_ValueError, "l, u and idx must have the same lengths!");
+        return (PyObject *) NULL;
+    }
+
+    // Get contiguous data structure
+    idx_cont = get_contiguous(idx, int_type);
+    idx_arr = (c_int *)PyArray_DATA(idx_cont);
+    k = (c_int)PyArray_SIZE(idx_cont);
+
+    OSQP_problem_dimensions(self, &n, &m);
+    if (OSQP_check_idx(idx_arr, k, m)) {
+        Py_DECREF(idx_cont);
+        return (PyObject *) NULL;
+    }
+    if (l != Py_None) {
+        l_cont = get_contiguous((PyArrayObject *)l, float_type);
+        l_arr = (c_float *)PyArray_DATA(l_cont);
+    }
+    if (u != Py_None) {
+        u_cont = get_contiguous((PyArrayObject *)u, float_type);
+        u_arr = (c_float *)PyArray_DATA(u_cont);
+    }
+
+    // Update bounds
+    if (self->presolve) {
+        // Merged rows may depend on other constraints: map the whole bounds
+        if (l_arr) l_full = (c_float *)c_malloc(m * sizeof(c_float));
+        if (u_arr) u_full = (c_float *)c_malloc(m * sizeof(c_float));
+        if ((l_arr && !l_full) || (u_arr && !u_full)) {
+            PyErr_SetString(PyExc_ValueError, "Bounds update allocation error!");
+        } else {
+            if (l_full) prea_vec_copy(self->presolve->l, l_full, m);
+            if (u_full) prea_vec_copy(self->presolve->u, u_full, m);
+            for (t = 0; t < k; t++) {
+                if (l_full) l_full[idx_arr[t]] = l_arr[t];
+                if (u_full) u_full[idx_arr[t]] = u_arr[t];
+            }
+            if (presolve_update_bounds(self->presolve, l_full, u_full)) {
+                PyErr_SetString(PyExc_ValueError, "Bounds update removes a reduction of the presolve!");
+            } else {
+                exitflag = OSQP_update_workspace_bounds(self, self->presolve->data->l,
+                                                        self->presolve->data->u);
+            }
+        }
+        if (l_full) c_free(l_full);
+        if (u_full) c_free(u_full);
+    } else {
+        exitflag = OSQP_update_workspace_bounds_idx(self, l_arr, u_arr, idx_arr, k);
+    }
+
+    // Free data
+    Py_XDECREF(l_cont);
+    Py_XDECREF(u_cont);
+    Py_DECREF(idx_cont);
+
+    if (PyErr_Occurred()) {
+        return (PyObject *) NULL;
+    }
+    if(exitflag){
+        PyErr_SetString(PyExc_ValueError, "Bounds update error!");
+        return (PyObject *) NULL;
+    }
+
+    // Return None
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+OSQP_FASTCALL_VARARGS(OSQP_update_bounds_idx)
 
 
 // Update elements of matrix P
-static PyObject * OSQP_update_P(OSQP *self, PyObject *args) {
+static PyObject * OSQP_update_P(OSQP *self, PyObject *const *args,
+                                Py_ssize_t nargs) {
 
     PyArrayObject *Px, *Px_cont, *Px_idx, *Px_idx_cont;
     c_float * Px_arr;
@@ -557,23 +1538,18 @@ static PyObject * OSQP_update_P(OSQP *self, PyObject *args) {
     int float_type = get_float_type();
     int int_type = get_int_type();
 
-#ifdef DLONG
-    static char * argparse_string = "O!O!L";
-#else
-    static char * argparse_string = "O!O!i";
-#endif
-
     // Check that the workspace is initialized
     if (!self->workspace) {
         PyErr_SetString(PyExc_ValueError, "Workspace not initialized!");
         return (PyObject *) NULL;
     }
+    if (OSQP_check_idle(self)) return (PyObject *) NULL;
 
     // Parse arguments
-    if( !PyArg_ParseTuple(args, argparse_string,
-                          &PyArray_Type, &Px,
-                          &PyArray_Type, &Px_idx,
-                          &Px_n)) {
+    if (fastcall_nargs("update_P", nargs, 3, 3) ||
+        !(Px = fastcall_array("update_P", args, 0)) ||
+        !(Px_idx = fastcall_array("update_P", args, 1)) ||
+        fastcall_int(args[2], &Px_n)) {
         return (PyObject *) NULL;
     }
 
@@ -593,7 +1569,8 @@ static PyObject * OSQP_update_P(OSQP *self, PyObject *args) {
     Px_arr = (c_float *)PyArray_DATA(Px_cont);
 
     // Update matrix P
-    exitflag = osqp_update_P(self->workspace, Px_arr, Px_idx_arr, Px_n);
+    exitflag = OSQP_update_workspace_P_A(self, Px_arr, Px_idx_arr, Px_n,
+                                         OSQP_NULL, OSQP_NULL, 0);
 
     // Free data
     Py_DECREF(Px_cont);
@@ -609,10 +1586,12 @@ static PyObject * OSQP_update_P(OSQP *self, PyObject *args) {
     Py_INCREF(Py_None);
     return Py_None;
 }
+OSQP_FASTCALL_VARARGS(OSQP_update_P)
 
 
 // Update elements of matrix A
-static PyObject * OSQP_update_A(OSQP *self, PyObject *args) {
+static PyObject * OSQP_update_A(OSQP *self, PyObject *const *args,
+                                Py_ssize_t nargs) {
 
     PyArrayObject *Ax, *Ax_cont, *Ax_idx, *Ax_idx_cont;
     c_float * Ax_arr;
@@ -622,25 +1601,20 @@ static PyObject * OSQP_update_A(OSQP *self, PyObject *args) {
     int int_type = get_int_type();
     int exitflag = 0;
 
-#ifdef DLONG
-    static char * argparse_string = "O!O!L";
-#else
-    static char * argparse_string = "O!O!i";
-#endif
-
     // Check that the workspace is initialized
     if (!self->workspace) {
         PyErr_SetString(PyExc_ValueError, "Workspace not initialized!");
         return (PyObject *) NULL;
     }
+    if (OSQP_check_idle(self)) return (PyObject *) NULL;
 
-	// Parse arguments
-    if( !PyArg_ParseTuple(args, argparse_string,
-                          &PyArray_Type, &Ax,
-                          &PyArray_Type, &Ax_idx,
-                          &Ax_n)) {
-		return (PyObject *) NULL;
-	}
+    // Parse arguments
+    if (fastcall_nargs("update_A", nargs, 3, 3) ||
+        !(Ax = fastcall_array("update_A", args, 0)) ||
+        !(Ax_idx = fastcall_array("update_A", args, 1)) ||
+        fastcall_int(args[2], &Ax_n)) {
+        return (PyObject *) NULL;
+    }
 
 	// Check if Ax_idx is passed
     if (PyObject_Length((PyObject *)Ax_idx) > 0) {
@@ -658,7 +1632,17 @@ static PyObject * OSQP_update_A(OSQP *self, PyObject *args) {
     Ax_arr = (c_float *)PyArray_DATA(Ax_cont);
 
     // Update matrix A
-    exitflag = osqp_update_A(self->workspace, Ax_arr, Ax_idx_arr, Ax_n);
+    if (self->presolve) {
+        exitflag = presolve_update_A(self->presolve, Ax_arr, Ax_idx_arr, Ax_n);
+        if (!exitflag) {
+            exitflag = OSQP_update_workspace_P_A(self, OSQP_NULL, OSQP_NULL, 0,
+                                                 self->presolve->data->A->x, OSQP_NULL,
+                                                 self->presolve->data->A->p[self->presolve->nr]);
+        }
+    } else {
+        exitflag = OSQP_update_workspace_P_A(self, OSQP_NULL, OSQP_NULL, 0,
+                                             Ax_arr, Ax_idx_arr, Ax_n);
+    }
 
     // Free data
     Py_DECREF(Ax_cont);
@@ -673,10 +1657,12 @@ static PyObject * OSQP_update_A(OSQP *self, PyObject *args) {
     Py_INCREF(Py_None);
     return Py_None;
 }
+OSQP_FASTCALL_VARARGS(OSQP_update_A)
 
 
 // Update elements of matrices P and A
-static PyObject * OSQP_update_P_A(OSQP *self, PyObject *args) {
+static PyObject * OSQP_update_P_A(OSQP *self, PyObject *const *args,
+                                  Py_ssize_t nargs) {
 
     PyArrayObject *Px, *Px_cont, *Px_idx, *Px_idx_cont;
     PyArrayObject *Ax, *Ax_cont, *Ax_idx, *Ax_idx_cont;
@@ -687,12 +1673,6 @@ static PyObject * OSQP_update_P_A(OSQP *self, PyObject *args) {
     int int_type = get_int_type();
     int exitflag = 0;
 
-#ifdef DLONG
-    static char * argparse_string = "O!O!LO!O!L";
-#else
-    static char * argparse_string = "O!O!iO!O!i";
-#endif
-
     exitflag = 0;  // Assume successful execution
 
     // Check that the workspace is initialized
@@ -700,15 +1680,16 @@ static PyObject * OSQP_update_P_A(OSQP *self, PyObject *args) {
         PyErr_SetString(PyExc_ValueError, "Workspace not initialized!");
         return (PyObject *) NULL;
     }
+    if (OSQP_check_idle(self)) return (PyObject *) NULL;
 
-	// Parse arguments
-    if( !PyArg_ParseTuple(args, argparse_string,
-                          &PyArray_Type, &Px,
-                          &PyArray_Type, &Px_idx,
-                          &Px_n,
-                          &PyArray_Type, &Ax,
-                          &PyArray_Type, &Ax_idx,
-                          &Ax_n)) {
+    // Parse arguments
+    if (fastcall_nargs("update_P_A", nargs, 6, 6) ||
+        !(Px = fastcall_array("update_P_A", args, 0)) ||
+        !(Px_idx = fastcall_array("update_P_A", args, 1)) ||
+        fastcall_int(args[2], &Px_n) ||
+        !(Ax = fastcall_array("update_P_A", args, 3)) ||
+        !(Ax_idx = fastcall_array("update_P_A", args, 4)) ||
+        fastcall_int(args[5], &Ax_n)) {
         return (PyObject *) NULL;
     }
 
@@ -739,9 +1720,20 @@ static PyObject * OSQP_update_P_A(OSQP *self, PyObject *args) {
     Ax_arr = (c_float *)PyArray_DATA(Ax_cont);
 
     // Update matrices P and A
-    exitflag = osqp_update_P_A(self->workspace,
-                               Px_arr, Px_idx_arr, Px_n,
-                               Ax_arr, Ax_idx_arr, Ax_n);
+    // NB: The presolve keeps the ordering of the entries of P
+    if (self->presolve) {
+        exitflag = presolve_update_A(self->presolve, Ax_arr, Ax_idx_arr, Ax_n);
+        if (!exitflag) {
+            exitflag = OSQP_update_workspace_P_A(self,
+                                                 Px_arr, Px_idx_arr, Px_n,
+                                                 self->presolve->data->A->x, OSQP_NULL,
+                                                 self->presolve->data->A->p[self->presolve->nr]);
+        }
+    } else {
+        exitflag = OSQP_update_workspace_P_A(self,
+                                             Px_arr, Px_idx_arr, Px_n,
+                                             Ax_arr, Ax_idx_arr, Ax_n);
+    }
 
     // Free data
     Py_DECREF(Px_cont);
@@ -758,26 +1750,27 @@ static PyObject * OSQP_update_P_A(OSQP *self, PyObject *args) {
     Py_INCREF(Py_None);
     return Py_None;
 }
+OSQP_FASTCALL_VARARGS(OSQP_update_P_A)
 
 
-static PyObject *OSQP_warm_start(OSQP *self, PyObject *args){
+static PyObject *OSQP_warm_start(OSQP *self, PyObject *const *args,
+                                 Py_ssize_t nargs){
 
     PyArrayObject *x, *x_cont, *y, *y_cont;
     c_float * x_arr, * y_arr;
     int float_type = get_float_type();
 
-    static char * argparse_string = "O!O!";
-
     // Check that the workspace is initialized
     if (!self->workspace) {
         PyErr_SetString(PyExc_ValueError, "Workspace not initialized!");
         return (PyObject *) NULL;
     }
+    if (OSQP_check_idle(self)) return (PyObject *) NULL;
 
     // Parse arguments
-    if( !PyArg_ParseTuple(args, argparse_string,
-                          &PyArray_Type, &x,
-                          &PyArray_Type, &y)) {
+    if (fastcall_nargs("warm_start", nargs, 2, 2) ||
+        !(x = fastcall_array("warm_start", args, 0)) ||
+        !(y = fastcall_array("warm_start", args, 1))) {
         return (PyObject *) NULL;
     }
 
@@ -790,7 +1783,13 @@ static PyObject *OSQP_warm_start(OSQP *self, PyObject *args){
     y_arr = (c_float *)PyArray_DATA(y_cont);
 
     // Update linear cost
-    osqp_warm_start(self->workspace, x_arr, y_arr);
+    if (self->presolve) {
+        presolve_warm_start_x(self->presolve, x_arr);
+        presolve_warm_start_y(self->presolve, y_arr);
+        x_arr = self->presolve->x;
+        y_arr = self->presolve->y;
+    }
+    OSQP_warm_start_workspace(self, x_arr, y_arr);
 
     // Free data
     Py_DECREF(x_cont);
@@ -800,23 +1799,25 @@ static PyObject *OSQP_warm_start(OSQP *self, PyObject *args){
     Py_INCREF(Py_None);
     return Py_None;
 }
+OSQP_FASTCALL_VARARGS(OSQP_warm_start)
 
-static PyObject *OSQP_warm_start_x(OSQP *self, PyObject *args) {
+static PyObject *OSQP_warm_start_x(OSQP *self, PyObject *const *args,
+                                   Py_ssize_t nargs) {
 
     PyArrayObject *x, *x_cont;
     c_float * x_arr;
     int float_type = get_float_type();
 
-    static char * argparse_string = "O!";
-
     // Check that the workspace is initialized
     if (!self->workspace) {
         PyErr_SetString(PyExc_ValueError, "Workspace not initialized!");
         return (PyObject *) NULL;
     }
+    if (OSQP_check_idle(self)) return (PyObject *) NULL;
 
     // Parse arguments
-    if( !PyArg_ParseTuple(args, argparse_string, &PyArray_Type, &x)) {
+    if (fastcall_nargs("warm_start_x", nargs, 1, 1) ||
+        !(x = fastcall_array("warm_start_x", args, 0))) {
         return (PyObject *) NULL;
     }
 
@@ -827,7 +1828,11 @@ static PyObject *OSQP_warm_start_x(OSQP *self, PyObject *args) {
     x_arr = (c_float *)PyArray_DATA(x_cont);
 
     // Update linear cost
-    osqp_warm_start_x(self->workspace, x_arr);
+    if (self->presolve) {
+        presolve_warm_start_x(self->presolve, x_arr);
+        x_arr = self->presolve->x;
+    }
+    OSQP_warm_start_workspace(self, x_arr, OSQP_NULL);
 
     // Free data
     Py_DECREF(x_cont);
@@ -836,23 +1841,25 @@ static PyObject *OSQP_warm_start_x(OSQP *self, PyObject *args) {
     Py_INCREF(Py_None);
     return Py_None;
 }
+OSQP_FASTCALL_VARARGS(OSQP_warm_start_x)
 
-static PyObject *OSQP_warm_start_y(OSQP *self, PyObject *args) {
+static PyObject *OSQP_warm_start_y(OSQP *self, PyObject *const *args,
+                                   Py_ssize_t nargs) {
 
     PyArrayObject *y, *y_cont;
     c_float * y_arr;
     int float_type = get_float_type();
 
-    static char * argparse_string = "O!";
-
     // Check that the workspace is initialized
     if (!self->workspace) {
         PyErr_SetString(PyExc_ValueError, "Workspace not initialized!");
         return (PyObject *) NULL;
     }
+    if (OSQP_check_idle(self)) return (PyObject *) NULL;
 
     // Parse arguments
-    if( !PyArg_ParseTuple(args, argparse_string, &PyArray_Type, &y)) {
+    if (fastcall_nargs("warm_start_y", nargs, 1, 1) ||
+        !(y = fastcall_array("warm_start_y", args, 0))) {
         return (PyObject *) NULL;
     }
 
@@ -863,7 +1870,11 @@ static PyObject *OSQP_warm_start_y(OSQP *self, PyObject *args) {
     y_arr = (c_float *)PyArray_DATA(y_cont);
 
     // Update linear cost
-    osqp_warm_start_y(self->workspace, y_arr);
+    if (self->presolve) {
+        presolve_warm_start_y(self->presolve, y_arr);
+        y_arr = self->presolve->y;
+    }
+    OSQP_warm_start_workspace(self, OSQP_NULL, y_arr);
 
     // Free data
     Py_DECREF(y_cont);
@@ -872,11 +1883,499 @@ static PyObject *OSQP_warm_start_y(OSQP *self, PyObject *args) {
     Py_INCREF(Py_None);
     return Py_None;
 }
+OSQP_FASTCALL_VARARGS(OSQP_warm_start_y)
+
+// Set up the derivative system and factor it at the last solution if needed
+static c_int OSQP_derivative_factor(OSQP *self, c_float eps) {
+    qdldl_solver *s;
+    OSQPDerivative *d = self->derivative;
+    c_int n = self->workspace->data->n;
+    c_int m = self->workspace->data->m;
+    c_int exitflag = 0;
+
+    if (!d) {
+        // The ordering of the solver is the one of the full KKT matrix
+        // unless the box constraints have been eliminated
+        s = linsys_qdldl(self->workspace->linsys_solver);
+        d = derivative_setup(self->workspace->data,
+                             s && s->KKT->n == n + m ? s->P : OSQP_NULL);
+        if (!d) {
+            PyErr_SetString(PyExc_ValueError, "Derivative system allocation error!");
+            return 1;
+        }
+        self->derivative = d;
+    }
+    if (d->factored && d->eps == eps) return 0;
+
+    Py_BEGIN_ALLOW_THREADS;
+    exitflag = derivative_factor(d, self->workspace, eps);
+    Py_END_ALLOW_THREADS;
+
+    if (exitflag) {
+        PyErr_SetString(PyExc_ValueError, "Derivative KKT matrix factorization error!");
+        return 1;
+    }
+    return 0;
+}
+
+// Check that derivatives can be taken at the last solution
+static c_int OSQP_check_derivative(OSQP *self) {
+    if (!self->workspace) {
+        PyErr_SetString(PyExc_ValueError, "Workspace not initialized!");
+        return 1;
+    }
+    if (self->presolve || self->decomposition) {
+        PyErr_SetString(PyExc_ValueError, "Derivatives cannot be combined with presolve or decompose!");
+        return 1;
+    }
+    if (OSQP_check_idle(self)) return 1;
+    if (self->workspace->info->status_val != OSQP_SOLVED) {
+        PyErr_SetString(PyExc_ValueError, "Problem has not been solved to optimality. You cannot take derivatives!");
+        return 1;
+    }
+    return 0;
+}
+
+static PyObject *OSQP_adjoint_derivative(OSQP *self, PyObject *const *args,
+                                         Py_ssize_t nargs) {
+
+    PyArrayObject *dx, *dy_u, *dy_l, *dx_cont, *dy_u_cont, *dy_l_cont;
+    PyArrayObject *dq, *dl, *du;
+    c_float eps;
+    npy_intp nd[1], md[1];
+    int float_type = get_float_type();
+    c_int exitflag = 0;
+
+    if (OSQP_check_derivative(self)) {
+        return (PyObject *) NULL;
+    }
+
+    // Parse arguments
+    if (fastcall_nargs("adjoint_derivative", nargs, 4, 4) ||
+        !(dx = fastcall_array("adjoint_derivative", args, 0)) ||
+        !(dy_u = fastcall_array("adjoint_derivative", args, 1)) ||
+        !(dy_l = fastcall_array("adjoint_derivative", args, 2)) ||
+        fastcall_float(args[3], &eps)) {
+        return (PyObject *) NULL;
+    }
+    nd[0] = (npy_intp)self->workspace->data->n;
+    md[0] = (npy_intp)self->workspace->data->m;
+    if (PyArray_SIZE(dx) != nd[0] || PyArray_SIZE(dy_u) != md[0] ||
+        PyArray_SIZE(dy_l) != md[0]) {
+        PyErr_SetString(PyExc_ValueError, "Wrong dimension of the derivatives of the solution!");
+        return (PyObject *) NULL;
+    }
+
+    if (OSQP_derivative_factor(self, eps)) {
+        return (PyObject *) NULL;
+    }
+
+    dx_cont = get_contiguous(dx, float_type);
+    dy_u_cont = get_contiguous(dy_u, float_type);
+    dy_l_cont = get_contiguous(dy_l, float_type);
+    dq = (PyArrayObject *)PyArray_SimpleNew(1, nd, float_type);
+    dl = (PyArrayObject *)PyArray_SimpleNew(1, md, float_type);
+    du = (PyArrayObject *)PyArray_SimpleNew(1, md, float_type);
+
+    Py_BEGIN_ALLOW_THREADS;
+    exitflag = derivative_adjoint(self->derivative,
+                                  (c_float *)PyArray_DATA(dx_cont),
+                                  (c_float *)PyArray_DATA(dy_u_cont),
+                                  (c_float *)PyArray_DATA(dy_l_cont),
+                                  (c_float *)PyArray_DATA(dq),
+                                  (c_float *)PyArray_DATA(dl),
+                                  (c_float *)PyArray_DATA(du));
+    Py_END_ALLOW_THREADS;
+
+    Py_DECREF(dx_cont);
+    Py_DECREF(dy_u_cont);
+    Py_DECREF(dy_l_cont);
+
+    if (exitflag &&
+        PyErr_WarnEx(PyExc_UserWarning, "max_iter iterative refinement reached.", 1)) {
+        Py_DECREF(dq);
+        Py_DECREF(dl);
+        Py_DECREF(du);
+        return (PyObject *) NULL;
+    }
+
+    return Py_BuildValue("(NNN)", dq, dl, du);
+}
+OSQP_FASTCALL_VARARGS(OSQP_adjoint_derivative)
+
+// Whether arr is a batch of k vectors of length len
+static c_int OSQP_check_batch(PyArrayObject *arr, npy_intp k, npy_intp len) {
+    return PyArray_NDIM(arr) == 2 && PyArray_DIM(arr, 0) == k &&
+           PyArray_DIM(arr, 1) == len;
+}
+
+static PyObject *OSQP_adjoint_derivative_batch(OSQP *self, PyObject *const *args,
+                                               Py_ssize_t nargs) {
+
+    PyArrayObject *dx, *dy_u, *dy_l, *dx_cont, *dy_u_cont, *dy_l_cont;
+    PyArrayObject *dPx, *dq, *dAx, *dl, *du;
+    c_float eps, *buf;
+    npy_intp k, n, m, N, dims[2];
+    int float_type = get_float_type();
+    c_int exitflag = 0;
+
+    if (OSQP_check_derivative(self)) {
+        return (PyObject *) NULL;
+    }
+
+    // Parse arguments
+    if (fastcall_nargs("adjoint_derivative_batch", nargs, 4, 4) ||
+        !(dx = fastcall_array("adjoint_derivative_batch", args, 0)) ||
+        !(dy_u = fastcall_array("adjoint_derivative_batch", args, 1)) ||
+        !(dy_l = fastcall_array("adjoint_derivative_batch", args, 2)) ||
+        fastcall_float(args[3], &eps)) {
+        return (PyObject *) NULL;
+    }
+    n = (npy_intp)self->workspace->data->n;
+    m = (npy_intp)self->workspace->data->m;
+    N = n + m;
+    k = PyArray_NDIM(dx) == 2 ? PyArray_DIM(dx, 0) : 0;
+    if (!OSQP_check_batch(dx, k, n) || !OSQP_check_batch(dy_u, k, m) ||
+        !OSQP_check_batch(dy_l, k, m)) {
+        PyErr_SetString(PyExc_ValueError, "Wrong dimension of the derivatives of the solution!");
+        return (PyObject *) NULL;
+    }
+
+    if (OSQP_derivative_factor(self, eps)) {
+        return (PyObject *) NULL;
+    }
+
+    // Right-hand sides, solutions, residuals and interleaved work
+    buf = (c_float *)c_malloc(c_max(4 * k * N, 1) * sizeof(c_float));
+    if (!buf) {
+        PyErr_SetString(PyExc_ValueError, "Derivative allocation error!");
+        return (PyObject *) NULL;
+    }
+
+    dx_cont = get_contiguous(dx, float_type);
+    dy_u_cont = get_contiguous(dy_u, float_type);
+    dy_l_cont = get_contiguous(dy_l, float_type);
+    dims[0] = k;
+    dims[1] = (npy_intp)self->workspace->data->P->p[n];
+    dPx = (PyArrayObject *)PyArray_SimpleNew(2, dims, float_type);
+    dims[1] = n;
+    dq = (PyArrayObject *)PyArray_SimpleNew(2, dims, float_type);
+    dims[1] = (npy_intp)self->workspace->data->A->p[n];
+    dAx = (PyArrayObject *)PyArray_SimpleNew(2, dims, float_type);
+    dims[1] = m;
+    dl = (PyArrayObject *)PyArray_SimpleNew(2, dims, float_type);
+    du = (PyArrayObject *)PyArray_SimpleNew(2, dims, float_type);
+
+    Py_BEGIN_ALLOW_THREADS;
+    exitflag = derivative_adjoint_batch(self->derivative, (c_int)k,
+                                        (c_float *)PyArray_DATA(dx_cont),
+                                        (c_float *)PyArray_DATA(dy_u_cont),
+                                        (c_float *)PyArray_DATA(dy_l_cont),
+                                        (c_float *)PyArray_DATA(dPx),
+                                        (c_float *)PyArray_DATA(dq),
+                                        (c_float *)PyArray_DATA(dAx),
+                                        (c_float *)PyArray_DATA(dl),
+                                        (c_float *)PyArray_DATA(du),
+                                        buf, buf + k * N, buf + 2 * k * N,
+                                        buf + 3 * k * N);
+    Py_END_ALLOW_THREADS;
+
+    c_free(buf);
+    Py_DECREF(dx_cont);
+    Py_DECREF(dy_u_cont);
+    Py_DECREF(dy_l_cont);
+
+    if (exitflag &&
+        PyErr_WarnEx(PyExc_UserWarning, "max_iter iterative refinement reached.", 1)) {
+        Py_DECREF(dPx);
+        Py_DECREF(dq);
+        Py_DECREF(dAx);
+        Py_DECREF(dl);
+        Py_DECREF(du);
+        return (PyObject *) NULL;
+    }
+
+    return Py_BuildValue("(NNNNN)", dPx, dq, dAx, dl, du);
+}
+OSQP_FASTCALL_VARARGS(OSQP_adjoint_derivative_batch)
+
+// Data of an optional array
+static c_float *OSQP_derivative_data(PyArrayObject *arr) {
+    return arr ? (c_float *)PyArray_DATA(arr) : OSQP_NULL;
+}
+
+static PyObject *OSQP_forward_derivative(OSQP *self, PyObject *const *args,
+                                         Py_ssize_t nargs) {
+
+    PyArrayObject *dir[5], *conts[5], *dx, *dy;
+    c_float eps, *buf;
+    npy_intp k, n, m, N, len[5], dims[2];
+    int float_type = get_float_type();
+    c_int t, exitflag = 0;
+
+    if (OSQP_check_derivative(self)) {
+        return (PyObject *) NULL;
+    }
+
+    // Parse arguments: dPx, dq, dAx, dl, du (or None) and eps_iter_ref
+    if (fastcall_nargs("forward_derivative", nargs, 6, 6)) {
+        return (PyObject *) NULL;
+    }
+    k = -1;
+    for (t = 0; t < 5; t++) {
+        dir[t] = conts[t] = (PyArrayObject *) NULL;
+        if (args[t] == Py_None) continue;
+        if (!(dir[t] = fastcall_array("forward_derivative", args, t))) {
+            return (PyObject *) NULL;
+        }
+        if (k < 0) k = PyArray_NDIM(dir[t]) == 2 ? PyArray_DIM(dir[t], 0) : 0;
+    }
+    if (k < 0) {
+        PyErr_SetString(PyExc_ValueError, "No perturbations of the problem given!");
+        return (PyObject *) NULL;
+    }
+    if (fastcall_float(args[5], &eps)) {
+        return (PyObject *) NULL;
+    }
+    n = (npy_intp)self->workspace->data->n;
+    m = (npy_intp)self->workspace->data->m;
+    N = n + m;
+    len[0] = (npy_intp)self->workspace->data->P->p[n];
+    len[1] = n;
+    len[2] = (npy_intp)self->workspace->data->A->p[n];
+    len[3] = m;
+    len[4] = m;
+    for (t = 0; t < 5; t++) {
+        if (dir[t] && !OSQP_check_batch(dir[t], k, len[t])) {
+            PyErr_SetString(PyExc_ValueError, "Wrong dimension of the perturbations of the problem!");
+            return (PyObject *) NULL;
+        }
+    }
+
+    if (OSQP_derivative_factor(self, eps)) {
+        return (PyObject *) NULL;
+    }
+
+    // Right-hand sides, solutions, residuals and interleaved work
+    buf = (c_float *)c_malloc(c_max(4 * k * N, 1) * sizeof(c_float));
+    if (!buf) {
+        PyErr_SetString(PyExc_ValueError, "Derivative allocation error!");
+        return (PyObject *) NULL;
+    }
+
+    for (t = 0; t < 5; t++) {
+        if (dir[t]) conts[t] = get_contiguous(dir[t], float_type);
+    }
+    dims[0] = k;
+    dims[1] = n;
+    dx = (PyArrayObject *)PyArray_SimpleNew(2, dims, float_type);
+    dims[1] = m;
+    dy = (PyArrayObject *)PyArray_SimpleNew(2, dims, float_type);
+
+    Py_BEGIN_ALLOW_THREADS;
+    exitflag = derivative_forward_batch(self->derivative, (c_int)k,
+                                        OSQP_derivative_data(conts[0]),
+                                        OSQP_derivative_data(conts[1]),
+                                        OSQP_derivative_data(conts[2]),
+                                        OSQP_derivative_data(conts[3]),
+                                        OSQP_derivative_data(conts[4]),
+                                        (c_float *)PyArray_DATA(dx),
+                                        (c_float *)PyArray_DATA(dy),
+                                        buf, buf + k * N, buf + 2 * k * N,
+                                        buf + 3 * k * N);
+    Py_END_ALLOW_THREADS;
+
+    c_free(buf);
+    for (t = 0; t < 5; t++) {
+        if (conts[t]) Py_DECREF(conts[t]);
+    }
+
+    if (exitflag &&
+        PyErr_WarnEx(PyExc_UserWarning, "max_iter iterative refinement reached.", 1)) {
+        Py_DECREF(dx);
+        Py_DECREF(dy);
+        return (PyObject *) NULL;
+    }
+
+    return Py_BuildValue("(NN)", dx, dy);
+}
+OSQP_FASTCALL_VARARGS(OSQP_forward_derivative)
+
+/*
+ * Solve a batch of instances with the patterns of the problem, and their
+ * adjoint derivatives if gradient seeds are given. The arguments are Px, q,
+ * Ax, l, u, dx, dy_u and dy_l stacked by rows (Px, Ax and the seeds may be
+ * None), the number of threads and eps_iter_ref.
+ */
+static PyObject *OSQP_solve_batch(OSQP *self, PyObject *const *args,
+                                  Py_ssize_t nargs) {
+
+    PyArrayObject *arr[8], *conts[8], *x, *y, *status, *grad[5];
+    PyObject *grads;
+    batch_ctx b;
+    OSQPSettings *settings;
+    OSQPDerivative *deriv = OSQP_NULL;
+    c_float eps, *base = OSQP_NULL;
+    c_int *refine_failed;
+    c_int t, nthreads, nrefine = 0;
+    npy_intp count, n, m, Pnz, Anz, len[8], dims[2];
+    int float_type = get_float_type();
+    int int_type = get_int_type();
+
+    if (!self->workspace) {
+        PyErr_SetString(PyExc_ValueError, "Workspace not initialized!");
+        return (PyObject *) NULL;
+    }
+    if (self->presolve || self->decomposition) {
+        PyErr_SetString(PyExc_ValueError, "Batched solves cannot be combined with presolve or decompose!");
+        return (PyObject *) NULL;
+    }
+    if (OSQP_check_idle(self)) return (PyObject *) NULL;
+
+    // Parse arguments
+    if (fastcall_nargs("solve_batch", nargs, 10, 10)) {
+        return (PyObject *) NULL;
+    }
+    for (t = 0; t < 8; t++) {
+        arr[t] = conts[t] = (PyArrayObject *) NULL;
+        if (args[t] == Py_None && t != 1 && t != 3 && t != 4) continue;
+        if (!(arr[t] = fastcall_array("solve_batch", args, t))) {
+            return (PyObject *) NULL;
+        }
+    }
+    if (fastcall_int(args[8], &nthreads) || fastcall_float(args[9], &eps)) {
+        return (PyObject *) NULL;
+    }
+    n = (npy_intp)self->workspace->data->n;
+    m = (npy_intp)self->workspace->data->m;
+    Pnz = (npy_intp)self->workspace->data->P->p[n];
+    Anz = (npy_intp)self->workspace->data->A->p[n];
+    len[0] = Pnz;
+    len[1] = n;
+    len[2] = Anz;
+    len[3] = m;
+    len[4] = m;
+    len[5] = n;
+    len[6] = m;
+    len[7] = m;
+    count = PyArray_NDIM(arr[1]) == 2 ? PyArray_DIM(arr[1], 0) : 0;
+    for (t = 0; t < 8; t++) {
+        if (arr[t] && !OSQP_check_batch(arr[t], count, len[t])) {
+            PyErr_SetString(PyExc_ValueError, "Wrong dimension of the batch of problems!");
+            return (PyObject *) NULL;
+        }
+    }
+
+    // Settings of the problem, cold started and without printing from the
+    // threads. The unscaled data of the problem is followed by a zero q.
+    settings = copy_settings(self->workspace->settings);
+    base = (c_float *)c_calloc(Pnz + Anz + 2 * n + 2 * m + 1, sizeof(c_float));
+    refine_failed = (c_int *)c_malloc(c_max(count, 1) * sizeof(c_int));
+    if (!settings || !base || !refine_failed) {
+        if (settings) c_free(settings);
+        if (base) c_free(base);
+        if (refine_failed) c_free(refine_failed);
+        PyErr_SetString(PyExc_ValueError, "Batch allocation error!");
+        return (PyObject *) NULL;
+    }
+    settings->verbose = 0;
+    settings->warm_start = 0;
+    settings->linsys_solver = QDLDL_SOLVER;
+    derivative_unscale_matrices(self->workspace, base, base + Pnz);
+    derivative_unscale_vectors(self->workspace, base + Pnz + Anz,
+                               base + Pnz + Anz + n, base + Pnz + Anz + n + m);
+
+    for (t = 0; t < 8; t++) {
+        if (arr[t]) conts[t] = get_contiguous(arr[t], float_type);
+    }
+    dims[0] = count;
+    dims[1] = n;
+    x = (PyArrayObject *)PyArray_SimpleNew(2, dims, float_type);
+    dims[1] = m;
+    y = (PyArrayObject *)PyArray_SimpleNew(2, dims, float_type);
+    status = (PyArrayObject *)PyArray_SimpleNew(1, dims, int_type);
+    for (t = 0; t < 5; t++) grad[t] = (PyArrayObject *) NULL;
+    if (arr[5] || arr[6] || arr[7]) {
+        for (t = 0; t < 5; t++) {
+            dims[1] = len[t];
+            grad[t] = (PyArrayObject *)PyArray_SimpleNew(2, dims, float_type);
+        }
+        // Symbolic analysis shared by the slots, NaN gradients if it fails
+        deriv = derivative_setup(self->workspace->data, OSQP_NULL);
+    }
+
+    b.n = (c_int)n;
+    b.m = (c_int)m;
+    b.count = (c_int)count;
+    b.nslots = (c_int)c_min(nthreads > 0 ? nthreads : parallel_nprocs(), count);
+    b.P = self->workspace->data->P;
+    b.A = self->workspace->data->A;
+    b.settings = settings;
+    b.eps = eps;
+    b.Px = OSQP_derivative_data(conts[0]);
+    b.q = OSQP_derivative_data(conts[1]);
+    b.Ax = OSQP_derivative_data(conts[2]);
+    b.l = OSQP_derivative_data(conts[3]);
+    b.u = OSQP_derivative_data(conts[4]);
+    b.P_base = base;
+    b.A_base = base + Pnz;
+    b.q_base = base + Pnz + Anz;
+    b.l_base = base + Pnz + Anz + n;
+    b.u_base = base + Pnz + Anz + n + m;
+    b.q_zero = base + Pnz + Anz + n + 2 * m;
+    b.deriv = deriv;
+    b.dx = OSQP_derivative_data(conts[5]);
+    b.dy_u = OSQP_derivative_data(conts[6]);
+    b.dy_l = OSQP_derivative_data(conts[7]);
+    b.x = (c_float *)PyArray_DATA(x);
+    b.y = (c_float *)PyArray_DATA(y);
+    b.status = (c_int *)PyArray_DATA(status);
+    b.dPx = OSQP_derivative_data(grad[0]);
+    b.dq = OSQP_derivative_data(grad[1]);
+    b.dAx = OSQP_derivative_data(grad[2]);
+    b.dl = OSQP_derivative_data(grad[3]);
+    b.du = OSQP_derivative_data(grad[4]);
+    b.refine_failed = refine_failed;
+
+    // Instances with invalid data are reported by their status
+    Py_BEGIN_ALLOW_THREADS;
+    if (count > 0) parallel_for(b.nslots, b.nslots, batch_task, &b);
+    Py_END_ALLOW_THREADS;
+
+    for (t = 0; t < count; t++) nrefine += refine_failed[t];
+    derivative_free(deriv);
+    c_free(refine_failed);
+    c_free(base);
+    c_free(settings);
+    for (t = 0; t < 8; t++) {
+        if (conts[t]) Py_DECREF(conts[t]);
+    }
+
+    if (grad[0]) {
+        grads = Py_BuildValue("(NNNNN)", grad[0], grad[1], grad[2], grad[3], grad[4]);
+    } else {
+        Py_INCREF(Py_None);
+        grads = Py_None;
+    }
+    if (nrefine &&
+        PyErr_WarnEx(PyExc_UserWarning, "max_iter iterative refinement reached.", 1)) {
+        Py_DECREF(x);
+        Py_DECREF(y);
+        Py_DECREF(status);
+        Py_DECREF(grads);
+        return (PyObject *) NULL;
+    }
+
+    return Py_BuildValue("(NNNN)", x, y, status, grads);
+}
+OSQP_FASTCALL_VARARGS(OSQP_solve_batch)
 
 
 static PyObject *OSQP_update_max_iter(OSQP *self, PyObject *args){
 
     c_int max_iter_new;
+    c_int k, nwork;
+    OSQPWorkspace **works;
 
 #ifdef DLONG
     static char * argparse_string = "L";
@@ -889,6 +2388,7 @@ static PyObject *OSQP_update_max_iter(OSQP *self, PyObject *args){
         PyErr_SetString(PyExc_ValueError, "Workspace not initialized!");
         return (PyObject *) NULL;
     }
+    if (OSQP_check_idle(self)) return (PyObject *) NULL;
 
     // Parse arguments
     if( !PyArg_ParseTuple(args, argparse_string, &max_iter_new)) {
@@ -896,7 +2396,8 @@ static PyObject *OSQP_update_max_iter(OSQP *self, PyObject *args){
     }
 
     // Perform Update
-    osqp_update_max_iter(self->workspace, max_iter_new);
+    works = OSQP_workspaces(self, &nwork);
+    for (k = 0; k < nwork; k++) osqp_update_max_iter(works[k], max_iter_new);
 
     // Return None
     Py_INCREF(Py_None);
@@ -907,6 +2408,8 @@ static PyObject *OSQP_update_max_iter(OSQP *self, PyObject *args){
 static PyObject *OSQP_update_eps_abs(OSQP *self, PyObject *args){
 
     c_float eps_abs_new;
+    c_int k, nwork;
+    OSQPWorkspace **works;
 
 #ifdef DFLOAT
     static char * argparse_string = "f";
@@ -919,6 +2422,7 @@ static PyObject *OSQP_update_eps_abs(OSQP *self, PyObject *args){
         PyErr_SetString(PyExc_ValueError, "Workspace not initialized!");
         return (PyObject *) NULL;
     }
+    if (OSQP_check_idle(self)) return (PyObject *) NULL;
 
     // Parse arguments
     if( !PyArg_ParseTuple(args, argparse_string, &eps_abs_new)) {
@@ -926,7 +2430,8 @@ static PyObject *OSQP_update_eps_abs(OSQP *self, PyObject *args){
     }
 
     // Perform Update
-    osqp_update_eps_abs(self->workspace, eps_abs_new);
+    works = OSQP_workspaces(self, &nwork);
+    for (k = 0; k < nwork; k++) osqp_update_eps_abs(works[k], eps_abs_new);
 
     // Return None
     Py_INCREF(Py_None);
@@ -937,6 +2442,8 @@ static PyObject *OSQP_update_eps_abs(OSQP *self, PyObject *args){
 static PyObject *OSQP_update_eps_rel(OSQP *self, PyObject *args) {
 
     c_float eps_rel_new;
+    c_int k, nwork;
+    OSQPWorkspace **works;
 
 #ifdef DFLOAT
     static char * argparse_string = "f";
@@ -949,6 +2456,7 @@ static PyObject *OSQP_update_eps_rel(OSQP *self, PyObject *args) {
         PyErr_SetString(PyExc_ValueError, "Workspace not initialized!");
         return (PyObject *) NULL;
     }
+    if (OSQP_check_idle(self)) return (PyObject *) NULL;
 
     // Parse arguments
     if( !PyArg_ParseTuple(args, argparse_string, &eps_rel_new)) {
@@ -956,7 +2464,8 @@ static PyObject *OSQP_update_eps_rel(OSQP *self, PyObject *args) {
     }
 
     // Perform Update
-    osqp_update_eps_rel(self->workspace, eps_rel_new);
+    works = OSQP_workspaces(self, &nwork);
+    for (k = 0; k < nwork; k++) osqp_update_eps_rel(works[k], eps_rel_new);
 
     // Return None
     Py_INCREF(Py_None);
@@ -967,6 +2476,8 @@ static PyObject *OSQP_update_eps_rel(OSQP *self, PyObject *args) {
 static PyObject *OSQP_update_eps_prim_inf(OSQP *self, PyObject *args) {
 
     c_float eps_prim_inf_new;
+    c_int k, nwork;
+    OSQPWorkspace **works;
 
 #ifdef DFLOAT
     static char * argparse_string = "f";
@@ -979,6 +2490,7 @@ static PyObject *OSQP_update_eps_prim_inf(OSQP *self, PyObject *args) {
         PyErr_SetString(PyExc_ValueError, "Workspace not initialized!");
         return (PyObject *) NULL;
     }
+    if (OSQP_check_idle(self)) return (PyObject *) NULL;
 
     // Parse arguments
     if( !PyArg_ParseTuple(args, argparse_string, &eps_prim_inf_new)) {
@@ -986,7 +2498,8 @@ static PyObject *OSQP_update_eps_prim_inf(OSQP *self, PyObject *args) {
     }
 
     // Perform Update
-    osqp_update_eps_prim_inf(self->workspace, eps_prim_inf_new);
+    works = OSQP_workspaces(self, &nwork);
+    for (k = 0; k < nwork; k++) osqp_update_eps_prim_inf(works[k], eps_prim_inf_new);
 
     // Return None
     Py_INCREF(Py_None);
@@ -997,6 +2510,8 @@ static PyObject *OSQP_update_eps_prim_inf(OSQP *self, PyObject *args) {
 static PyObject *OSQP_update_eps_dual_inf(OSQP *self, PyObject *args) {
 
     c_float eps_dual_inf_new;
+    c_int k, nwork;
+    OSQPWorkspace **works;
 
 #ifdef DFLOAT
     static char * argparse_string = "f";
@@ -1009,6 +2524,7 @@ static PyObject *OSQP_update_eps_dual_inf(OSQP *self, PyObject *args) {
         PyErr_SetString(PyExc_ValueError, "Workspace not initialized!");
         return (PyObject *) NULL;
     }
+    if (OSQP_check_idle(self)) return (PyObject *) NULL;
 
     // Parse arguments
     if( !PyArg_ParseTuple(args, argparse_string, &eps_dual_inf_new)) {
@@ -1016,7 +2532,8 @@ static PyObject *OSQP_update_eps_dual_inf(OSQP *self, PyObject *args) {
     }
 
     // Perform Update
-    osqp_update_eps_dual_inf(self->workspace, eps_dual_inf_new);
+    works = OSQP_workspaces(self, &nwork);
+    for (k = 0; k < nwork; k++) osqp_update_eps_dual_inf(works[k], eps_dual_inf_new);
 
     // Return None
     Py_INCREF(Py_None);
@@ -1028,6 +2545,8 @@ static PyObject *OSQP_update_rho(OSQP *self, PyObject *args) {
 
     c_float rho_new;
     int exitflag = 0;
+    c_int k, nwork;
+    OSQPWorkspace **works;
 
 #ifdef DFLOAT
     static char * argparse_string = "f";
@@ -1040,6 +2559,7 @@ static PyObject *OSQP_update_rho(OSQP *self, PyObject *args) {
         PyErr_SetString(PyExc_ValueError, "Workspace not initialized!");
         return (PyObject *) NULL;
     }
+    if (OSQP_check_idle(self)) return (PyObject *) NULL;
 
     // Parse arguments
     if( !PyArg_ParseTuple(args, argparse_string, &rho_new)) {
@@ -1047,7 +2567,8 @@ static PyObject *OSQP_update_rho(OSQP *self, PyObject *args) {
     }
 
     // Perform Update
-    exitflag = osqp_update_rho(self->workspace, rho_new);
+    works = OSQP_workspaces(self, &nwork);
+    for (k = 0; k < nwork; k++) exitflag |= osqp_update_rho(works[k], rho_new);
 
     if (exitflag){
         PyErr_SetString(PyExc_ValueError, "rho update error!");
@@ -1064,6 +2585,8 @@ static PyObject *OSQP_update_rho(OSQP *self, PyObject *args) {
 static PyObject *OSQP_update_alpha(OSQP *self, PyObject *args) {
 
     c_float alpha_new;
+    c_int k, nwork;
+    OSQPWorkspace **works;
 
 #ifdef DFLOAT
     static char * argparse_string = "f";
@@ -1076,6 +2599,7 @@ static PyObject *OSQP_update_alpha(OSQP *self, PyObject *args) {
         PyErr_SetString(PyExc_ValueError, "Workspace not initialized!");
         return (PyObject *) NULL;
     }
+    if (OSQP_check_idle(self)) return (PyObject *) NULL;
 
     // Parse arguments
     if( !PyArg_ParseTuple(args, argparse_string, &alpha_new)) {
@@ -1083,7 +2607,8 @@ static PyObject *OSQP_update_alpha(OSQP *self, PyObject *args) {
     }
 
     // Perform Update
-    osqp_update_alpha(self->workspace, alpha_new);
+    works = OSQP_workspaces(self, &nwork);
+    for (k = 0; k < nwork; k++) osqp_update_alpha(works[k], alpha_new);
 
     // Return None
     Py_INCREF(Py_None);
@@ -1094,6 +2619,8 @@ static PyObject *OSQP_update_alpha(OSQP *self, PyObject *args) {
 static PyObject *OSQP_update_delta(OSQP *self, PyObject *args){
 
     c_float delta_new;
+    c_int k, nwork;
+    OSQPWorkspace **works;
 
 #ifdef DFLOAT
     static char * argparse_string = "f";
@@ -1106,6 +2633,7 @@ static PyObject *OSQP_update_delta(OSQP *self, PyObject *args){
         PyErr_SetString(PyExc_ValueError, "Workspace not initialized!");
         return (PyObject *) NULL;
     }
+    if (OSQP_check_idle(self)) return (PyObject *) NULL;
 
     // Parse arguments
     if( !PyArg_ParseTuple(args, argparse_string, &delta_new)) {
@@ -1113,7 +2641,8 @@ static PyObject *OSQP_update_delta(OSQP *self, PyObject *args){
     }
 
     // Perform Update
-    osqp_update_delta(self->workspace, delta_new);
+    works = OSQP_workspaces(self, &nwork);
+    for (k = 0; k < nwork; k++) osqp_update_delta(works[k], delta_new);
 
     // Return None
     Py_INCREF(Py_None);
@@ -1124,6 +2653,8 @@ static PyObject *OSQP_update_delta(OSQP *self, PyObject *args){
 static PyObject *OSQP_update_polish(OSQP *self, PyObject *args){
 
     c_int polish_new;
+    c_int k, nwork;
+    OSQPWorkspace **works;
 
 #ifdef DLONG
     static char * argparse_string = "L";
@@ -1136,6 +2667,7 @@ static PyObject *OSQP_update_polish(OSQP *self, PyObject *args){
         PyErr_SetString(PyExc_ValueError, "Workspace not initialized!");
         return (PyObject *) NULL;
     }
+    if (OSQP_check_idle(self)) return (PyObject *) NULL;
 
     // Parse arguments
     if( !PyArg_ParseTuple(args, argparse_string, &polish_new)) {
@@ -1143,7 +2675,8 @@ static PyObject *OSQP_update_polish(OSQP *self, PyObject *args){
     }
 
     // Perform Update
-    osqp_update_polish(self->workspace, polish_new);
+    works = OSQP_workspaces(self, &nwork);
+    for (k = 0; k < nwork; k++) osqp_update_polish(works[k], polish_new);
 
     // Return None
     Py_INCREF(Py_None);
@@ -1154,6 +2687,8 @@ static PyObject *OSQP_update_polish(OSQP *self, PyObject *args){
 static PyObject *OSQP_update_polish_refine_iter(OSQP *self, PyObject *args){
 
     c_int polish_refine_iter_new;
+    c_int k, nwork;
+    OSQPWorkspace **works;
 
 #ifdef DLONG
     static char * argparse_string = "L";
@@ -1166,6 +2701,7 @@ static PyObject *OSQP_update_polish_refine_iter(OSQP *self, PyObject *args){
         PyErr_SetString(PyExc_ValueError, "Workspace not initialized!");
         return (PyObject *) NULL;
     }
+    if (OSQP_check_idle(self)) return (PyObject *) NULL;
 
     // Parse arguments
     if( !PyArg_ParseTuple(args, argparse_string, &polish_refine_iter_new)) {
@@ -1173,7 +2709,8 @@ static PyObject *OSQP_update_polish_refine_iter(OSQP *self, PyObject *args){
     }
 
     // Perform Update
-    osqp_update_polish_refine_iter(self->workspace, polish_refine_iter_new);
+    works = OSQP_workspaces(self, &nwork);
+    for (k = 0; k < nwork; k++) osqp_update_polish_refine_iter(works[k], polish_refine_iter_new);
 
     // Return None
     Py_INCREF(Py_None);
@@ -1184,6 +2721,8 @@ static PyObject *OSQP_update_polish_refine_iter(OSQP *self, PyObject *args){
 static PyObject *OSQP_update_verbose(OSQP *self, PyObject *args){
 
     c_int verbose_new;
+    c_int k, nwork;
+    OSQPWorkspace **works;
 
 #ifdef DLONG
     static char * argparse_string = "L";
@@ -1196,6 +2735,7 @@ static PyObject *OSQP_update_verbose(OSQP *self, PyObject *args){
         PyErr_SetString(PyExc_ValueError, "Workspace not initialized!");
         return (PyObject *) NULL;
     }
+    if (OSQP_check_idle(self)) return (PyObject *) NULL;
 
     // Parse arguments
     if( !PyArg_ParseTuple(args, argparse_string, &verbose_new)) {
@@ -1203,7 +2743,8 @@ static PyObject *OSQP_update_verbose(OSQP *self, PyObject *args){
     }
 
     // Perform Update
-    osqp_update_verbose(self->workspace, verbose_new);
+    works = OSQP_workspaces(self, &nwork);
+    for (k = 0; k < nwork; k++) osqp_update_verbose(works[k], verbose_new);
 
     // Return None
     Py_INCREF(Py_None);
@@ -1214,6 +2755,8 @@ static PyObject *OSQP_update_verbose(OSQP *self, PyObject *args){
 static PyObject *OSQP_update_scaled_termination(OSQP *self, PyObject *args){
 
     c_int scaled_termination_new;
+    c_int k, nwork;
+    OSQPWorkspace **works;
 
 #ifdef DLONG
     static char * argparse_string = "L";
@@ -1226,6 +2769,7 @@ static PyObject *OSQP_update_scaled_termination(OSQP *self, PyObject *args){
         PyErr_SetString(PyExc_ValueError, "Workspace not initialized!");
         return (PyObject *) NULL;
     }
+    if (OSQP_check_idle(self)) return (PyObject *) NULL;
 
     // Parse arguments
     if( !PyArg_ParseTuple(args, argparse_string, &scaled_termination_new)) {
@@ -1233,7 +2777,8 @@ static PyObject *OSQP_update_scaled_termination(OSQP *self, PyObject *args){
     }
 
     // Perform Update
-    osqp_update_scaled_termination(self->workspace, scaled_termination_new);
+    works = OSQP_workspaces(self, &nwork);
+    for (k = 0; k < nwork; k++) osqp_update_scaled_termination(works[k], scaled_termination_new);
 
     // Return None
     Py_INCREF(Py_None);
@@ -1244,6 +2789,8 @@ static PyObject *OSQP_update_scaled_termination(OSQP *self, PyObject *args){
 static PyObject *OSQP_update_check_termination(OSQP *self, PyObject *args){
 
     c_int check_termination_new;
+    c_int k, nwork;
+    OSQPWorkspace **works;
 
 #ifdef DLONG
     static char * argparse_string = "L";
@@ -1256,6 +2803,7 @@ static PyObject *OSQP_update_check_termination(OSQP *self, PyObject *args){
         PyErr_SetString(PyExc_ValueError, "Workspace not initialized!");
         return (PyObject *) NULL;
     }
+    if (OSQP_check_idle(self)) return (PyObject *) NULL;
 
     // Parse arguments
     if( !PyArg_ParseTuple(args, argparse_string, &check_termination_new)) {
@@ -1263,7 +2811,8 @@ static PyObject *OSQP_update_check_termination(OSQP *self, PyObject *args){
     }
 
     // Perform Update
-    osqp_update_check_termination(self->workspace, check_termination_new);
+    works = OSQP_workspaces(self, &nwork);
+    for (k = 0; k < nwork; k++) osqp_update_check_termination(works[k], check_termination_new);
 
     // Return None
     Py_INCREF(Py_None);
@@ -1274,6 +2823,8 @@ static PyObject *OSQP_update_check_termination(OSQP *self, PyObject *args){
 static PyObject *OSQP_update_warm_start(OSQP *self, PyObject *args){
 
     c_int warm_start_new;
+    c_int k, nwork;
+    OSQPWorkspace **works;
 
 #ifdef DLONG
     static char * argparse_string = "L";
@@ -1286,6 +2837,7 @@ static PyObject *OSQP_update_warm_start(OSQP *self, PyObject *args){
         PyErr_SetString(PyExc_ValueError, "Workspace not initialized!");
         return (PyObject *) NULL;
     }
+    if (OSQP_check_idle(self)) return (PyObject *) NULL;
 
     // Parse arguments
     if( !PyArg_ParseTuple(args, argparse_string, &warm_start_new)) {
@@ -1293,7 +2845,8 @@ static PyObject *OSQP_update_warm_start(OSQP *self, PyObject *args){
     }
 
     // Perform Update
-    osqp_update_warm_start(self->workspace, warm_start_new);
+    works = OSQP_workspaces(self, &nwork);
+    for (k = 0; k < nwork; k++) osqp_update_warm_start(works[k], warm_start_new);
 
     // Return None
     Py_INCREF(Py_None);
@@ -1304,6 +2857,8 @@ static PyObject *OSQP_update_warm_start(OSQP *self, PyObject *args){
 static PyObject *OSQP_update_time_limit(OSQP *self, PyObject *args){
 
     c_float time_limit_new;
+    c_int k, nwork;
+    OSQPWorkspace **works;
 
 #ifdef DFLOAT
     static char * argparse_string = "f";
@@ -1316,6 +2871,7 @@ static PyObject *OSQP_update_time_limit(OSQP *self, PyObject *args){
         PyErr_SetString(PyExc_ValueError, "Workspace not initialized!");
         return (PyObject *) NULL;
     }
+    if (OSQP_check_idle(self)) return (PyObject *) NULL;
 
     // Parse arguments
     if( !PyArg_ParseTuple(args, argparse_string, &time_limit_new)) {
@@ -1323,7 +2879,8 @@ static PyObject *OSQP_update_time_limit(OSQP *self, PyObject *args){
     }
 
     // Perform Update
-    osqp_update_time_limit(self->workspace, time_limit_new);
+    works = OSQP_workspaces(self, &nwork);
+    for (k = 0; k < nwork; k++) osqp_update_time_limit(works[k], time_limit_new);
 
     // Return None
     Py_INCREF(Py_None);
@@ -1333,19 +2890,30 @@ static PyObject *OSQP_update_time_limit(OSQP *self, PyObject *args){
 
 static PyMethodDef OSQP_methods[] = {
     {"setup", (PyCFunction)OSQP_setup,METH_VARARGS|METH_KEYWORDS, PyDoc_STR("Setup OSQP problem")},
-    {"solve", (PyCFunction)OSQP_solve, METH_VARARGS, PyDoc_STR("Solve OSQP problem")},
+    {"solve", OSQP_FASTCALL(OSQP_solve), METH_OSQP_FASTCALL, PyDoc_STR("Solve OSQP problem")},
+    {"update_solve", OSQP_FASTCALL(OSQP_update_solve), METH_OSQP_FASTCALL, PyDoc_STR("Update vectors, warm start and solve OSQP problem")},
+    {"solve_submit", OSQP_FASTCALL(OSQP_solve_submit), METH_OSQP_FASTCALL, PyDoc_STR("Start solving OSQP problem on the worker pool")},
+    {"cancel", (PyCFunction)OSQP_cancel, METH_NOARGS, PyDoc_STR("Cancel the running solve")},
     {"version",	(PyCFunction)OSQP_version, METH_NOARGS, PyDoc_STR("OSQP version")},
     {"dimensions", (PyCFunction)OSQP_dimensions, METH_NOARGS, PyDoc_STR("Return problem dimensions (n, m)")},
-    {"update_lin_cost",	(PyCFunction)OSQP_update_lin_cost, METH_VARARGS, PyDoc_STR("Update OSQP problem linear cost")},
-    {"update_lower_bound", (PyCFunction)OSQP_update_lower_bound, METH_VARARGS, PyDoc_STR("Update OSQP problem lower bound")},
-    {"update_upper_bound", (PyCFunction)OSQP_update_upper_bound, METH_VARARGS, PyDoc_STR("Update OSQP problem upper bound")},
-    {"update_bounds", (PyCFunction)OSQP_update_bounds, METH_VARARGS, PyDoc_STR("Update OSQP problem bounds")},
-	{"update_P", (PyCFunction)OSQP_update_P, METH_VARARGS, PyDoc_STR("Update OSQP problem quadratic cost matrix")},
-	{"update_P_A", (PyCFunction)OSQP_update_P_A, METH_VARARGS, PyDoc_STR("Update OSQP problem matrices")},
-	{"update_A", (PyCFunction)OSQP_update_A, METH_VARARGS, PyDoc_STR("Update OSQP problem constraint matrix")},
-    {"warm_start", (PyCFunction)OSQP_warm_start, METH_VARARGS, PyDoc_STR("Warm start primal and dual variables")},
-    {"warm_start_x", (PyCFunction)OSQP_warm_start_x, METH_VARARGS, PyDoc_STR("Warm start primal variable")},
-    {"warm_start_y", (PyCFunction)OSQP_warm_start_y, METH_VARARGS, PyDoc_STR("Warm start dual variable")},
+    {"unscaled_matrices", (PyCFunction)OSQP_unscaled_matrices, METH_NOARGS, PyDoc_STR("Return the unscaled matrices (Px, Pi, Pp, Ax, Ai, Ap)")},
+    {"use_qdldl", (PyCFunction)OSQP_use_qdldl, METH_NOARGS, PyDoc_STR("Switch the dense linear system solver back to QDLDL")},
+    {"update_lin_cost",	OSQP_FASTCALL(OSQP_update_lin_cost), METH_OSQP_FASTCALL, PyDoc_STR("Update OSQP problem linear cost")},
+    {"update_lower_bound", OSQP_FASTCALL(OSQP_update_lower_bound), METH_OSQP_FASTCALL, PyDoc_STR("Update OSQP problem lower bound")},
+    {"update_upper_bound", OSQP_FASTCALL(OSQP_update_upper_bound), METH_OSQP_FASTCALL, PyDoc_STR("Update OSQP problem upper bound")},
+    {"update_bounds", OSQP_FASTCALL(OSQP_update_bounds), METH_OSQP_FASTCALL, PyDoc_STR("Update OSQP problem bounds")},
+    {"update_lin_cost_idx", OSQP_FASTCALL(OSQP_update_lin_cost_idx), METH_OSQP_FASTCALL, PyDoc_STR("Update entries of OSQP linear cost")},
+    {"update_bounds_idx", OSQP_FASTCALL(OSQP_update_bounds_idx), METH_OSQP_FASTCALL, PyDoc_STR("Update entries of OSQP bounds")},
+	{"update_P", OSQP_FASTCALL(OSQP_update_P), METH_OSQP_FASTCALL, PyDoc_STR("Update OSQP problem quadratic cost matrix")},
+	{"update_P_A", OSQP_FASTCALL(OSQP_update_P_A), METH_OSQP_FASTCALL, PyDoc_STR("Update OSQP problem matrices")},
+	{"update_A", OSQP_FASTCALL(OSQP_update_A), METH_OSQP_FASTCALL, PyDoc_STR("Update OSQP problem constraint matrix")},
+    {"warm_start", OSQP_FASTCALL(OSQP_warm_start), METH_OSQP_FASTCALL, PyDoc_STR("Warm start primal and dual variables")},
+    {"warm_start_x", OSQP_FASTCALL(OSQP_warm_start_x), METH_OSQP_FASTCALL, PyDoc_STR("Warm start primal variable")},
+    {"warm_start_y", OSQP_FASTCALL(OSQP_warm_start_y), METH_OSQP_FASTCALL, PyDoc_STR("Warm start dual variable")},
+    {"adjoint_derivative", OSQP_FASTCALL(OSQP_adjoint_derivative), METH_OSQP_FASTCALL, PyDoc_STR("Adjoint derivative of the last solution")},
+    {"adjoint_derivative_batch", OSQP_FASTCALL(OSQP_adjoint_derivative_batch), METH_OSQP_FASTCALL, PyDoc_STR("Adjoint derivatives of a batch of gradients")},
+    {"forward_derivative", OSQP_FASTCALL(OSQP_forward_derivative), METH_OSQP_FASTCALL, PyDoc_STR("Forward derivatives of a batch of perturbations")},
+    {"solve_batch", OSQP_FASTCALL(OSQP_solve_batch), METH_OSQP_FASTCALL, PyDoc_STR("Solve and differentiate a batch of problem instances")},
     {"update_max_iter", (PyCFunction)OSQP_update_max_iter, METH_VARARGS, PyDoc_STR("Update OSQP solver setting max_iter")},
     {"update_eps_abs", (PyCFunction)OSQP_update_eps_abs, METH_VARARGS, PyDoc_STR("Update OSQP solver setting eps_abs")},
     {"update_eps_rel", (PyCFunction)OSQP_update_eps_rel, METH_VARARGS, PyDoc_STR("Update OSQP solver setting eps_rel")},
@@ -0,0 +1,468 @@
+#ifndef OSQPORDERINGPY_H
+#define OSQPORDERINGPY_H
+
+#include "qdldl_interface.h"
+#include "qdldl.h"
+#include "kkt.h"
+
+/*****************************************************
+ * Fill-reducing orderings of the KKT matrix         *
+ *****************************************************/
+
+/*
+ * The QDLDL solver created by osqp_setup always orders the KKT matrix
+ * with AMD. Other orderings are applied afterwards by rebuilding the
+ * permuted KKT matrix, the index maps and the factorization in place.
+ *
+ * osqp_setup gives no way to order the matrix before its factorization, so
+ * a setup with another ordering pays for the AMD ordering and a full
+ * factorization on top of its own. Only the other orderings are timed: the
+ * ordering time of the default AMD ordering, computed inside osqp_setup, is
+ * NaN.
+ */
+#define AMD_ORDERING     (0)    // AMD ordering computed by osqp_setup
+#define NESDIS_ORDERING  (1)    // Nested dissection
+#define NATURAL_ORDERING (2)    // No permutation
+#define USER_ORDERING    (3)    // Permutation given by the user
+#define RCM_ORDERING     (4)    // Reverse Cuthill-McKee
+
+// Subgraphs smaller than this are not dissected further
+#define NESDIS_LEAF_SIZE (64)
+
+// Maximum number of searches for a pseudo-peripheral vertex
+#define NESDIS_PERIPHERAL_ITER (8)
+
+
+/* Graph of the KKT matrix */
+
+// Symmetric adjacency structure, without the diagonal, of the matrix whose
+// upper triangular part is stored in KKT. xadj must be zero on entry and
+// deg receives the degree of each vertex.
+static void kkt_adjacency(const csc *KKT, c_int *xadj, c_int *adj, c_int *deg) {
+    c_int N = KKT->n;
+    c_int i, j, p;
+
+    for (j = 0; j < N; j++) {
+        for (p = KKT->p[j]; p < KKT->p[j + 1]; p++) {
+            i = KKT->i[p];
+            if (i != j) {
+                xadj[i + 1]++;
+                xadj[j + 1]++;
+            }
+        }
+    }
+    for (j = 0; j < N; j++) {
+        xadj[j + 1] += xadj[j];
+        deg[j] = xadj[j];
+    }
+    for (j = 0; j < N; j++) {
+        for (p = KKT->p[j]; p < KKT->p[j + 1]; p++) {
+            i = KKT->i[p];
+            if (i != j) {
+                adj[deg[i]++] = j;
+                adj[deg[j]++] = i;
+            }
+        }
+    }
+    for (j = 0; j < N; j++) deg[j] = xadj[j + 1] - xadj[j];
+}
+
+
+/* Nested dissection */
+
+// Breadth-first search restricted to the vertices labeled with lab.
+// Returns the number of levels and the number of visited vertices in nvis.
+static c_int nesdis_bfs(c_int root, c_int lab, const c_int *xadj,
+                        const c_int *adj, const c_int *label, c_int *level,
+                        c_int *queue, c_int *nvis) {
+    c_int head = 0, tail = 0, v, u, p, nlevels = 0;
+
+    queue[tail++] = root;
+    level[root] = 0;
+    while (head < tail) {
+        v = queue[head++];
+        nlevels = level[v] + 1;
+        for (p = xadj[v]; p < xadj[v + 1]; p++) {
+            u = adj[p];
+            if (label[u] == lab && level[u] < 0) {
+                level[u] = level[v] + 1;
+                queue[tail++] = u;
+            }
+        }
+    }
+
+    *nvis = tail;
+    return nlevels;
+}
+
+// Clear the levels of the vertices visited by the last search
+static void nesdis_clear(c_int *level, const c_int *queue, c_int nvis) {
+    c_int k;
+    for (k = 0; k < nvis; k++) level[queue[k]] = -1;
+}
+
+/*
+ * Nested dissection ordering of the symmetric matrix whose upper triangular
+ * part is stored in KKT. Separators are taken from the middle level of a
+ * rooted level structure grown from a pseudo-peripheral vertex. On exit
+ * perm[k] is the column eliminated k-th.
+ */
+static c_int nesdis_order(const csc *KKT, c_int *perm) {
+    c_int N = KKT->n;
+    c_int *xadj, *adj, *label, *level, *queue, *verts, *stack, *deg;
+    c_int i, j, p, k, v, u, lo, hi, size, nstack, nvis, nlevels, prev;
+    c_int root, lev, nA, nB, nS, sep;
+
+    xadj  = (c_int *)c_calloc(N + 1, sizeof(c_int));
+    adj   = (c_int *)c_malloc(c_max(2 * KKT->p[N], 1) * sizeof(c_int));
+    label = (c_int *)c_malloc(c_max(N, 1) * sizeof(c_int));
+    level = (c_int *)c_malloc(c_max(N, 1) * sizeof(c_int));
+    queue = (c_int *)c_malloc(c_max(N, 1) * sizeof(c_int));
+    verts = (c_int *)c_malloc(c_max(N, 1) * sizeof(c_int));
+    deg   = (c_int *)c_malloc(c_max(N, 1) * sizeof(c_int));
+    stack = (c_int *)c_malloc(c_max(2 * N, 2) * sizeof(c_int));
+
+    if (!xadj || !adj || !label || !level || !queue || !verts || !deg || !stack) {
+        c_free(xadj); c_free(adj); c_free(label); c_free(level);
+        c_free(queue); c_free(verts); c_free(deg); c_free(stack);
+        return 1;
+    }
+
+    kkt_adjacency(KKT, xadj, adj, deg);
+    for (j = 0; j < N; j++) {
+        label[j] = 0;
+        level[j] = -1;
+        verts[j] = j;
+    }
+
+    // Each task is a range [lo, hi) of verts labeled with lo. The range is
+    // also the range of positions in perm given to its vertices.
+    nstack = 0;
+    if (N > 0) {
+        stack[nstack++] = 0;
+        stack[nstack++] = N;
+    }
+    while (nstack > 0) {
+        hi = stack[--nstack];
+        lo = stack[--nstack];
+        size = hi - lo;
+
+        // Pseudo-peripheral root of minimum degree
+        root = verts[lo];
+        for (k = lo + 1; k < hi; k++) {
+            if (deg[verts[k]] < deg[root]) root = verts[k];
+        }
+        nlevels = nesdis_bfs(root, lo, xadj, adj, label, level, queue, &nvis);
+        for (prev = 0, k = 0; k < NESDIS_PERIPHERAL_ITER && nlevels > prev; k++) {
+            prev = nlevels;
+            v = queue[nvis - 1];
+            for (i = nvis - 1; i >= 0 && level[queue[i]] == nlevels - 1; i--) {
+                if (deg[queue[i]] < deg[v]) v = queue[i];
+            }
+            nesdis_clear(level, queue, nvis);
+            root = v;
+            nlevels = nesdis_bfs(root, lo, xadj, adj, label, level, queue, &nvis);
+        }
+
+        // Disconnected subgraph: split off the component of the root
+        if (nvis < size) {
+            k = nvis;
+            for (i = lo; i < hi; i++) {
+                v = verts[i];
+                if (level[v] < 0) {
+                    queue[k++] = v;
+                    label[v] = lo + nvis;
+                }
+            }
+            for (i = 0; i < size; i++) verts[lo + i] = queue[i];
+            nesdis_clear(level, queue, nvis);
+            stack[nstack++] = lo;
+            stack[nstack++] = lo + nvis;
+            stack[nstack++] = lo + nvis;
+            stack[nstack++] = hi;
+            continue;
+        }
+
+        // Leaf: reverse Cuthill-McKee order of the level structure
+        if (size <= NESDIS_LEAF_SIZE || nlevels < 3) {
+            for (i = 0; i < nvis; i++) {
+                v = queue[nvis - 1 - i];
+                perm[lo + i] = v;
+                label[v] = -1;
+            }
+            nesdis_clear(level, queue, nvis);
+            continue;
+        }
+
+        // Separator: vertices of the middle level adjacent to the next level
+        lev = nlevels / 2;
+        nA = nB = nS = 0;
+        for (i = 0; i < nvis; i++) {
+            v = queue[i];
+            sep = 0;
+            if (level[v] == lev) {
+                for (p = xadj[v]; p < xadj[v + 1]; p++) {
+                    u = adj[p];
+                    if (label[u] == lo && level[u] == lev + 1) {
+                        sep = 1;
+                        break;
+                    }
+                }
+            }
+            if (sep) {
+                perm[hi - 1 - nS++] = v;
+            } else if (level[v] <= lev) {
+                verts[lo + nA++] = v;
+            }
+        }
+        for (i = 0; i < nvis; i++) {
+            v = queue[i];
+            if (level[v] > lev) verts[lo + nA + nB++] = v;
+        }
+        nesdis_clear(level, queue, nvis);
+
+        // Relabel the parts and number the separator last
+        for (i = lo; i < lo + nA; i++) label[verts[i]] = lo;
+        for (i = lo + nA; i < lo + nA + nB; i++) label[verts[i]] = lo + nA;
+        for (i = hi - nS; i < hi; i++) {
+            label[perm[i]] = -1;
+            verts[i] = perm[i];
+        }
+
+        if (nA > 0) {
+            stack[nstack++] = lo;
+            stack[nstack++] = lo + nA;
+        }
+        if (nB > 0) {
+            stack[nstack++] = lo + nA;
+            stack[nstack++] = lo + nA + nB;
+        }
+    }
+
+    c_free(xadj); c_free(adj); c_free(label); c_free(level);
+    c_free(queue); c_free(verts); c_free(deg); c_free(stack);
+
+    return 0;
+}
+
+
+/* Reverse Cuthill-McKee */
+
+/*
+ * Reverse Cuthill-McKee ordering of each connected component, started from
+ * a pseudo-peripheral vertex. The level structure keeps the KKT matrix of
+ * problems with a chain structure, like the stages of an MPC problem, in a
+ * narrow band. On exit perm[k] is the column eliminated k-th.
+ */
+static c_int rcm_order(const csc *KKT, c_int *perm) {
+    c_int N = KKT->n;
+    c_int *xadj, *adj, *label, *level, *queue, *deg;
+    c_int i, k, v, root, nvis, nlevels, prev, pos;
+
+    xadj  = (c_int *)c_calloc(N + 1, sizeof(c_int));
+    adj   = (c_int *)c_malloc(c_max(2 * KKT->p[N], 1) * sizeof(c_int));
+    label = (c_int *)c_malloc(c_max(N, 1) * sizeof(c_int));
+    level = (c_int *)c_malloc(c_max(N, 1) * sizeof(c_int));
+    queue = (c_int *)c_malloc(c_max(N, 1) * sizeof(c_int));
+    deg   = (c_int *)c_malloc(c_max(N, 1) * sizeof(c_int));
+
+    if (!xadj || !adj || !label || !level || !queue || !deg) {
+        c_free(xadj); c_free(adj); c_free(label); c_free(level);
+        c_free(queue); c_free(deg);
+        return 1;
+    }
+
+    kkt_adjacency(KKT, xadj, adj, deg);
+    for (i = 0; i < N; i++) {
+        label[i] = 0;
+        level[i] = -1;
+    }
+
+    // Components are numbered from the end of perm in reverse BFS order
+    pos = N;
+    for (root = 0; root < N; root++) {
+        if (label[root] < 0) continue;
+
+        nlevels = nesdis_bfs(root, 0, xadj, adj, label, level, queue, &nvis);
+        for (prev = 0, k = 0; k < NESDIS_PERIPHERAL_ITER && nlevels > prev; k++) {
+            prev = nlevels;
+            v = queue[nvis - 1];
+            for (i = nvis - 1; i >= 0 && level[queue[i]] == nlevels - 1; i--) {
+                if (deg[queue[i]] < deg[v]) v = queue[i];
+            }
+            nesdis_clear(level, queue, nvis);
+            nlevels = nesdis_bfs(v, 0, xadj, adj, label, level, queue, &nvis);
+        }
+
+        for (i = 0; i < nvis; i++) {
+            perm[--pos] = queue[i];
+            label[queue[i]] = -1;
+        }
+        nesdis_clear(level, queue, nvis);
+    }
+
+    c_free(xadj); c_free(adj); c_free(label); c_free(level);
+    c_free(queue); c_free(deg);
+
+    return 0;
+}
+
+
+// Check that perm is a permutation of 0, ..., N - 1
+static c_int is_permutation(const c_int *perm, c_int N) {
+    c_int i, ok = 1;
+    c_int *seen = (c_int *)c_calloc(c_max(N, 1), sizeof(c_int));
+
+    for (i = 0; i < N && ok; i++) {
+        if (perm[i] < 0 || perm[i] >= N || seen[perm[i]]) ok = 0;
+        else seen[perm[i]] = 1;
+    }
+    c_free(seen);
+
+    return ok;
+}
+
+
+/*
+ * Replace the AMD ordering of a QDLDL solver with the given ordering. The
+ * unpermuted KKT matrix is formed from the P and A matrices the solver was
+ * set up with and permuted, the index maps are composed with the new
+ * permutation and the matrix is factored again. The time spent computing
+ * the ordering is stored in ordering_time.
+ */
+static c_int kkt_reorder(LinSysSolver *solver, const csc *P, const csc *A,
+                         int ordering, const c_int *user_perm,
+                         c_float *ordering_time) {
+    qdldl_solver *s = (qdldl_solver *) solver;
+    c_int n = A->n;
+    c_int m = A->m;
+    c_int N = n + m;
+    c_int Pnz = P->p[n];
+    c_int Anz = A->p[n];
+    c_int *PtoKKT, *AtoKKT, *rhotoKKT, *Pinv, *KtoPKPt;
+    QDLDL_int *Li;
+    QDLDL_float *Lx;
+    csc *KKT_temp, *KKT;
+    c_int i, sum_Lnz, exitflag = 0;
+#ifdef PROFILING
+    OSQPTimer timer;
+#endif
+
+    if (solver->type != QDLDL_SOLVER) return 1;
+
+    // Unpermuted KKT matrix and maps from P, A and rho to its entries
+    PtoKKT   = (c_int *)c_malloc(c_max(Pnz, 1) * sizeof(c_int));
+    AtoKKT   = (c_int *)c_malloc(c_max(Anz, 1) * sizeof(c_int));
+    rhotoKKT = (c_int *)c_malloc(c_max(m, 1) * sizeof(c_int));
+    KKT_temp = (PtoKKT && AtoKKT && rhotoKKT) ?
+               form_KKT(P, A, 0, s->sigma, s->rho_inv_vec, PtoKKT, AtoKKT,
+                        OSQP_NULL, OSQP_NULL, rhotoKKT) : OSQP_NULL;
+    if (!KKT_temp) {
+        c_free(PtoKKT);
+        c_free(AtoKKT);
+        c_free(rhotoKKT);
+        return 1;
+    }
+
+    // Compute the ordering
+#ifdef PROFILING
+    osqp_tic(&timer);
+#endif
+    switch (ordering) {
+    case NESDIS_ORDERING:
+        exitflag = nesdis_order(KKT_temp, s->P);
+        break;
+    case NATURAL_ORDERING:
+        for (i = 0; i < N; i++) s->P[i] = i;
+        break;
+    case RCM_ORDERING:
+        exitflag = rcm_order(KKT_temp, s->P);
+        break;
+    case USER_ORDERING:
+        for (i = 0; i < N; i++) s->P[i] = user_perm[i];
+        break;
+    default:
+        exitflag = 1;
+    }
+#ifdef PROFILING
+    *ordering_time = osqp_toc(&timer);
+#endif
+
+    if (exitflag) {
+        csc_spfree(KKT_temp);
+        c_free(PtoKKT);
+        c_free(AtoKKT);
+        c_free(rhotoKKT);
+        return exitflag;
+    }
+
+    // Permute the KKT matrix and compose the maps with the permutation
+    Pinv = csc_pinv(s->P, N);
+    KtoPKPt = (c_int *)c_malloc(c_max(KKT_temp->p[N], 1) * sizeof(c_int));
+    KKT = (Pinv && KtoPKPt) ? csc_symperm(KKT_temp, Pinv, KtoPKPt, 1) : OSQP_NULL;
+    if (KKT) {
+        for (i = 0; i < Pnz; i++) PtoKKT[i] = KtoPKPt[PtoKKT[i]];
+        for (i = 0; i < Anz; i++) AtoKKT[i] = KtoPKPt[AtoKKT[i]];
+        for (i = 0; i < m; i++) rhotoKKT[i] = KtoPKPt[rhotoKKT[i]];
+    }
+    csc_spfree(KKT_temp);
+    if (KtoPKPt) c_free(KtoPKPt);
+    if (Pinv) c_free(Pinv);
+    if (!KKT) {
+        c_free(PtoKKT);
+        c_free(AtoKKT);
+        c_free(rhotoKKT);
+        return 1;
+    }
+
+    csc_spfree(s->KKT);
+    c_free(s->PtoKKT);
+    c_free(s->AtoKKT);
+    c_free(s->rhotoKKT);
+    s->KKT = KKT;
+    s->PtoKKT = PtoKKT;
+    s->AtoKKT = AtoKKT;
+    s->rhotoKKT = rhotoKKT;
+
+    // Symbolic and numerical factorization with the new ordering
+    sum_Lnz = QDLDL_etree(N, KKT->p, KKT->i, s->iwork, s->Lnz, s->etree);
+    if (sum_Lnz < 0) {
+#ifdef PRINTING
+        c_eprint("Error in KKT matrix LDL factorization when computing the elimination tree.");
+#endif
+        return 1;
+    }
+    // The old arrays stay with the solver if they cannot be resized
+    Li = (QDLDL_int *)c_realloc(s->L->i, c_max(sum_Lnz, 1) * sizeof(QDLDL_int));
+    if (Li) s->L->i = Li;
+    Lx = (QDLDL_float *)c_realloc(s->L->x, c_max(sum_Lnz, 1) * sizeof(QDLDL_float));
+    if (Lx) s->L->x = Lx;
+    if (!Li || !Lx) {
+#ifdef PRINTING
+        c_eprint("Memory allocation error for the KKT factorization.");
+#endif
+        return 1;
+    }
+    s->L->nzmax = sum_Lnz;
+
+    if (QDLDL_factor(N, KKT->p, KKT->i, KKT->x, s->L->p, s->L->i, s->L->x,
+                     s->D, s->Dinv, s->Lnz, s->etree, s->bwork, s->iwork,
+                     s->fwork) < n) {
+#ifdef PRINTING
+        c_eprint("KKT matrix is not quasidefinite");
+#endif
+        return 1;
+    }
+
+    return 0;
+}
+
+
+// Number of nonzeros of L (without the diagonal) of the KKT factorization
+static c_int linsys_L_nnz(OSQPWorkspace *work) {
+    qdldl_solver *s = linsys_qdldl(work->linsys_solver);
+
+    return s ? s->L->p[s->KKT->n] : 0;
+}
+
+#endif
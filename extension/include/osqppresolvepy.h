@@ -0,0 +1,550 @@
+#ifndef OSQPPRESOLVEPY_H
+#define OSQPPRESOLVEPY_H
+
+#include <string.h>
+#include "cs.h"
+
+/*****************************************************
+ * Presolve and postsolve of the problem data        *
+ *****************************************************/
+
+/*
+ * The presolve removes from the problem passed to osqp_setup
+ *
+ *   - loose constraints (both bounds infinite),
+ *   - empty constraints whose bounds contain zero,
+ *   - duplicate constraints, i.e. rows of A that are a multiple s_i of an
+ *     earlier row. Their bounds are divided by s_i and intersected with the
+ *     bounds of the earlier row,
+ *   - variables that appear neither in P nor in the remaining rows of A and
+ *     have zero linear cost. They are set to zero.
+ *
+ * The postsolve assigns the dual of a merged row to the constraint defining
+ * the active bound, so that the complementarity conditions of the original
+ * problem hold. The same mapping is applied to the infeasibility certificates.
+ * Updates are mapped onto the reduced problem. Updates that would invalidate
+ * a reduction are rejected.
+ */
+
+typedef struct {
+    c_int n;                // Number of variables
+    c_int m;                // Number of constraints
+    c_int nr;               // Number of variables of the reduced problem
+    c_int mr;               // Number of constraints of the reduced problem
+
+    c_int *colmap;          // Reduced variable of each variable (or -1)
+    c_int *cols;            // Variable of each reduced variable
+    c_int *rowmap;          // Reduced row of each constraint (or -1)
+    c_float *rscale;        // Multiple of the reduced row given by each constraint
+    c_int *rows;            // First constraint of each reduced row
+    c_int *next;            // Next constraint merged into the same reduced row (or -1)
+    c_int *lsrc;            // Constraint defining the lower bound of each reduced row
+    c_int *usrc;            // Constraint defining the upper bound of each reduced row
+
+    csc *A;                 // Constraint matrix of the problem
+    c_int *Rp;              // Rows of A
+    c_int *Rj;              // Column of the entries of the rows
+    c_int *Rx;              // Position in A->x of the entries of the rows
+    c_int *Apos;            // Position in A->x of each entry of the reduced A
+    c_float *l;             // Lower bounds of the problem
+    c_float *u;             // Upper bounds of the problem
+    c_float *Ax;            // Scratch copy of A->x used to validate updates
+
+    OSQPData *data;         // Reduced problem data
+    c_float *x;             // Vector of the problem dimension n
+    c_float *y;             // Vector of the problem dimension m
+} OSQPPresolve;
+
+
+static void presolve_free(OSQPPresolve *pre) {
+    if (pre) {
+        if (pre->colmap) c_free(pre->colmap);
+        if (pre->cols) c_free(pre->cols);
+        if (pre->rowmap) c_free(pre->rowmap);
+        if (pre->rscale) c_free(pre->rscale);
+        if (pre->rows) c_free(pre->rows);
+        if (pre->next) c_free(pre->next);
+        if (pre->lsrc) c_free(pre->lsrc);
+        if (pre->usrc) c_free(pre->usrc);
+        if (pre->A) csc_spfree(pre->A);
+        if (pre->Rp) c_free(pre->Rp);
+        if (pre->Rj) c_free(pre->Rj);
+        if (pre->Rx) c_free(pre->Rx);
+        if (pre->Apos) c_free(pre->Apos);
+        if (pre->l) c_free(pre->l);
+        if (pre->u) c_free(pre->u);
+        if (pre->Ax) c_free(pre->Ax);
+        if (pre->data) {
+            if (pre->data->P) csc_spfree(pre->data->P);
+            if (pre->data->A) csc_spfree(pre->data->A);
+            if (pre->data->q) c_free(pre->data->q);
+            if (pre->data->l) c_free(pre->data->l);
+            if (pre->data->u) c_free(pre->data->u);
+            c_free(pre->data);
+        }
+        if (pre->x) c_free(pre->x);
+        if (pre->y) c_free(pre->y);
+        c_free(pre);
+    }
+}
+
+
+/* Classification of the constraints */
+
+static c_int presolve_is_loose(c_float l, c_float u) {
+    return l < -OSQP_INFTY * MIN_SCALING && u > OSQP_INFTY * MIN_SCALING;
+}
+
+static c_int presolve_is_dropped(const OSQPPresolve *pre, c_int i,
+                                 c_float l, c_float u) {
+    return presolve_is_loose(l, u) ||
+           (pre->Rp[i] == pre->Rp[i + 1] && l <= 0. && u >= 0.);
+}
+
+/*
+ * Check whether row k of A (with values Ax) is s times row i and store s.
+ * Rows with a zero leading coefficient are never considered parallel.
+ */
+static c_int presolve_parallel(const OSQPPresolve *pre, const c_float *Ax,
+                               c_int i, c_int k, c_float *s) {
+    const c_int *Rp = pre->Rp, *Rj = pre->Rj, *Rx = pre->Rx;
+    c_int len = Rp[i + 1] - Rp[i];
+    c_float ai, ak;
+    c_int t;
+
+    if (Rp[k + 1] - Rp[k] != len || len == 0) return 0;
+    ai = Ax[Rx[Rp[i]]];
+    ak = Ax[Rx[Rp[k]]];
+    if (ai == 0. || ak == 0.) return 0;
+    for (t = 0; t < len; t++) {
+        if (Rj[Rp[i] + t] != Rj[Rp[k] + t]) return 0;
+    }
+    for (t = 0; t < len; t++) {
+        if (Ax[Rx[Rp[i] + t]] / ai != Ax[Rx[Rp[k] + t]] / ak) return 0;
+    }
+    *s = ak / ai;
+    return 1;
+}
+
+// Hash of the pattern and of the normalized values of row i
+static unsigned long long presolve_row_hash(const OSQPPresolve *pre, c_int i) {
+    const c_int *Rp = pre->Rp, *Rx = pre->Rx;
+    unsigned long long h = (unsigned long long)(Rp[i + 1] - Rp[i]);
+    unsigned long long bits;
+    c_float a0, v;
+    c_int t;
+
+    if (Rp[i + 1] == Rp[i]) return h;
+    a0 = pre->A->x[Rx[Rp[i]]];
+    for (t = Rp[i]; t < Rp[i + 1]; t++) {
+        v = a0 != 0. ? pre->A->x[Rx[t]] / a0 : 0.;
+        bits = 0;
+        memcpy(&bits, &v, sizeof(c_float));
+        h = h * 1099511628211ULL + (unsigned long long)pre->Rj[t];
+        h = h * 1099511628211ULL + bits;
+    }
+    return h;
+}
+
+// Bounds of row i expressed on its reduced row. Infinite bounds are
+// recognized before the scaling, which swaps them if s is negative.
+static void presolve_row_bounds(c_float l, c_float u, c_float s,
+                                c_float *lo, c_float *hi) {
+    c_int l_inf = l < -OSQP_INFTY * MIN_SCALING;
+    c_int u_inf = u > OSQP_INFTY * MIN_SCALING;
+
+    if (s < 0.) {
+        *lo = u_inf ? -OSQP_INFTY : u / s;
+        *hi = l_inf ? OSQP_INFTY : l / s;
+    } else {
+        *lo = l_inf ? -OSQP_INFTY : l / s;
+        *hi = u_inf ? OSQP_INFTY : u / s;
+    }
+}
+
+
+/* Bounds of the reduced problem */
+
+// Merge the bounds of the rows of each reduced row
+static void presolve_merge_bounds(OSQPPresolve *pre, const c_float *l,
+                                  const c_float *u) {
+    c_float *lr = pre->data->l, *ur = pre->data->u;
+    c_float lo, hi;
+    c_int i, r;
+
+    for (r = 0; r < pre->mr; r++) {
+        lr[r] = -OSQP_INFTY;
+        ur[r] = OSQP_INFTY;
+        pre->lsrc[r] = pre->rows[r];
+        pre->usrc[r] = pre->rows[r];
+        for (i = pre->rows[r]; i >= 0; i = pre->next[i]) {
+            presolve_row_bounds(l[i], u[i], pre->rscale[i], &lo, &hi);
+            if (lo > lr[r]) {
+                lr[r] = lo;
+                pre->lsrc[r] = i;
+            }
+            if (hi < ur[r]) {
+                ur[r] = hi;
+                pre->usrc[r] = i;
+            }
+        }
+    }
+}
+
+/*
+ * Validate the bounds and compute the bounds of the reduced problem. The
+ * bounds are rejected if they change the dropped rows or if the merged
+ * bounds are inconsistent.
+ */
+static c_int presolve_bounds(OSQPPresolve *pre, const c_float *l,
+                             const c_float *u) {
+    c_int i, r;
+
+    for (i = 0; i < pre->m; i++) {
+        if ((pre->rowmap[i] < 0) != presolve_is_dropped(pre, i, l[i], u[i])) {
+            return 1;
+        }
+    }
+
+    presolve_merge_bounds(pre, l, u);
+    for (r = 0; r < pre->mr; r++) {
+        if (pre->data->l[r] > pre->data->u[r]) {
+            presolve_merge_bounds(pre, pre->l, pre->u);
+            return 1;
+        }
+    }
+
+    for (i = 0; i < pre->m; i++) {
+        pre->l[i] = l[i];
+        pre->u[i] = u[i];
+    }
+    return 0;
+}
+
+
+/* Setup */
+
+/*
+ * Compute the reductions of the problem and the reduced problem data.
+ * Returns OSQP_NULL if the memory allocation fails.
+ */
+static OSQPPresolve *presolve_setup(const OSQPData *data) {
+    const csc *P = data->P;
+    c_int n = data->n;
+    c_int m = data->m;
+    c_int Anz = data->A->p[n];
+    c_int i, j, k, p, r, H, nr, Arnz;
+    c_int *head, *hnext, *count;
+    unsigned long long *hash;
+    c_float s, lo, hi, *lr, *ur;
+    OSQPPresolve *pre;
+    csc *A, *Pr, *Ar;
+
+    pre = (OSQPPresolve *)c_calloc(1, sizeof(OSQPPresolve));
+    if (!pre) return OSQP_NULL;
+    pre->n = n;
+    pre->m = m;
+    pre->colmap = (c_int *)c_malloc(c_max(n, 1) * sizeof(c_int));
+    pre->cols   = (c_int *)c_malloc(c_max(n, 1) * sizeof(c_int));
+    pre->rowmap = (c_int *)c_malloc(c_max(m, 1) * sizeof(c_int));
+    pre->rscale = (c_float *)c_malloc(c_max(m, 1) * sizeof(c_float));
+    pre->rows   = (c_int *)c_malloc(c_max(m, 1) * sizeof(c_int));
+    pre->next   = (c_int *)c_malloc(c_max(m, 1) * sizeof(c_int));
+    pre->lsrc   = (c_int *)c_malloc(c_max(m, 1) * sizeof(c_int));
+    pre->usrc   = (c_int *)c_malloc(c_max(m, 1) * sizeof(c_int));
+    pre->Rp     = (c_int *)c_calloc(m + 1, sizeof(c_int));
+    pre->Rj     = (c_int *)c_malloc(c_max(Anz, 1) * sizeof(c_int));
+    pre->Rx     = (c_int *)c_malloc(c_max(Anz, 1) * sizeof(c_int));
+    pre->Apos   = (c_int *)c_malloc(c_max(Anz, 1) * sizeof(c_int));
+    pre->l      = (c_float *)c_malloc(c_max(m, 1) * sizeof(c_float));
+    pre->u      = (c_float *)c_malloc(c_max(m, 1) * sizeof(c_float));
+    pre->Ax     = (c_float *)c_malloc(c_max(Anz, 1) * sizeof(c_float));
+    pre->x      = (c_float *)c_malloc(c_max(n, 1) * sizeof(c_float));
+    pre->y      = (c_float *)c_malloc(c_max(m, 1) * sizeof(c_float));
+    pre->data   = (OSQPData *)c_calloc(1, sizeof(OSQPData));
+    pre->A      = copy_csc_mat(data->A);
+    head  = (c_int *)c_malloc((2 * m + 1) * sizeof(c_int));
+    hnext = (c_int *)c_malloc(c_max(m, 1) * sizeof(c_int));
+    hash  = (unsigned long long *)c_malloc(c_max(m, 1) * sizeof(unsigned long long));
+    count = (c_int *)c_calloc(c_max(n, 1), sizeof(c_int));
+    if (!pre->colmap || !pre->cols || !pre->rowmap || !pre->rscale ||
+        !pre->rows || !pre->next || !pre->lsrc || !pre->usrc || !pre->Rp ||
+        !pre->Rj || !pre->Rx || !pre->Apos || !pre->l || !pre->u || !pre->Ax ||
+        !pre->x || !pre->y || !pre->data || !pre->A ||
+        !head || !hnext || !hash || !count) {
+        presolve_free(pre);
+        pre = OSQP_NULL;
+        goto cleanup;
+    }
+    A = pre->A;
+
+    // Rows of A with increasing column indices
+    for (p = 0; p < Anz; p++) pre->Rp[A->i[p] + 1]++;
+    for (i = 0; i < m; i++) pre->Rp[i + 1] += pre->Rp[i];
+    for (i = 0; i < m; i++) hnext[i] = pre->Rp[i];
+    for (j = 0; j < n; j++) {
+        for (p = A->p[j]; p < A->p[j + 1]; p++) {
+            k = hnext[A->i[p]]++;
+            pre->Rj[k] = j;
+            pre->Rx[k] = p;
+        }
+    }
+
+    // Drop loose and empty rows and merge duplicate rows
+    H = 2 * m + 1;
+    for (k = 0; k < H; k++) head[k] = -1;
+    lr = pre->l;    // Bounds of the reduced rows while they are merged
+    ur = pre->u;
+    r = 0;
+    for (i = 0; i < m; i++) {
+        pre->next[i] = -1;
+        pre->rscale[i] = 1.;
+        if (presolve_is_dropped(pre, i, data->l[i], data->u[i])) {
+            pre->rowmap[i] = -1;
+            continue;
+        }
+
+        hash[i] = presolve_row_hash(pre, i);
+        presolve_row_bounds(data->l[i], data->u[i], 1., &lo, &hi);
+        for (k = head[hash[i] % H]; k >= 0; k = hnext[k]) {
+            if (hash[k] != hash[i] || !presolve_parallel(pre, A->x, k, i, &s)) {
+                continue;
+            }
+            presolve_row_bounds(data->l[i], data->u[i], s, &lo, &hi);
+            j = pre->rowmap[k];
+            if (c_max(lo, lr[j]) <= c_min(hi, ur[j])) break;
+        }
+        if (k >= 0) {
+            // Append the row to the reduced row of row k
+            j = pre->rowmap[k];
+            pre->rowmap[i] = j;
+            pre->rscale[i] = s;
+            lr[j] = c_max(lo, lr[j]);
+            ur[j] = c_min(hi, ur[j]);
+            for (k = pre->rows[j]; pre->next[k] >= 0; k = pre->next[k]);
+            pre->next[k] = i;
+        } else {
+            // New reduced row
+            presolve_row_bounds(data->l[i], data->u[i], 1., &lo, &hi);
+            pre->rowmap[i] = r;
+            pre->rows[r] = i;
+            lr[r] = lo;
+            ur[r] = hi;
+            hnext[i] = head[hash[i] % H];
+            head[hash[i] % H] = i;
+            r++;
+        }
+    }
+    pre->mr = r;
+
+    // Drop variables appearing neither in P nor in the reduced rows
+    for (j = 0; j < n; j++) {
+        for (p = P->p[j]; p < P->p[j + 1]; p++) {
+            count[j]++;
+            count[P->i[p]]++;
+        }
+    }
+    Arnz = 0;
+    for (j = 0; j < n; j++) {
+        for (p = A->p[j]; p < A->p[j + 1]; p++) {
+            i = A->i[p];
+            if (pre->rowmap[i] >= 0 && pre->rows[pre->rowmap[i]] == i) {
+                count[j]++;
+                Arnz++;
+            }
+        }
+    }
+    nr = 0;
+    for (j = 0; j < n; j++) {
+        if (count[j] == 0 && data->q[j] == 0. && (nr > 0 || j < n - 1)) {
+            pre->colmap[j] = -1;
+        } else {
+            pre->colmap[j] = nr;
+            pre->cols[nr++] = j;
+        }
+    }
+    pre->nr = nr;
+
+    // Reduced problem data
+    pre->data->n = nr;
+    pre->data->m = pre->mr;
+    pre->data->P = Pr = csc_spalloc(nr, nr, P->p[n], 1, 0);
+    pre->data->A = Ar = csc_spalloc(pre->mr, nr, Arnz, 1, 0);
+    pre->data->q = (c_float *)c_malloc(c_max(nr, 1) * sizeof(c_float));
+    pre->data->l = (c_float *)c_malloc(c_max(pre->mr, 1) * sizeof(c_float));
+    pre->data->u = (c_float *)c_malloc(c_max(pre->mr, 1) * sizeof(c_float));
+    if (!Pr || !Ar || !pre->data->q || !pre->data->l || !pre->data->u) {
+        presolve_free(pre);
+        pre = OSQP_NULL;
+        goto cleanup;
+    }
+
+    // The dropped variables have no entries in P, which keeps its ordering
+    k = 0;
+    for (j = 0; j < nr; j++) {
+        Pr->p[j] = k;
+        for (p = P->p[pre->cols[j]]; p < P->p[pre->cols[j] + 1]; p++) {
+            Pr->i[k] = pre->colmap[P->i[p]];
+            Pr->x[k++] = P->x[p];
+        }
+        pre->data->q[j] = data->q[pre->cols[j]];
+    }
+    Pr->p[nr] = k;
+
+    k = 0;
+    for (j = 0; j < nr; j++) {
+        Ar->p[j] = k;
+        for (p = A->p[pre->cols[j]]; p < A->p[pre->cols[j] + 1]; p++) {
+            i = A->i[p];
+            if (pre->rowmap[i] >= 0 && pre->rows[pre->rowmap[i]] == i) {
+                Ar->i[k] = pre->rowmap[i];
+                Ar->x[k] = A->x[p];
+                pre->Apos[k++] = p;
+            }
+        }
+    }
+    Ar->p[nr] = k;
+
+    // Inconsistent bounds are left to the validation of osqp_setup
+    for (i = 0; i < m; i++) {
+        pre->l[i] = data->l[i];
+        pre->u[i] = data->u[i];
+    }
+    presolve_merge_bounds(pre, pre->l, pre->u);
+
+cleanup:
+    if (head) c_free(head);
+    if (hnext) c_free(hnext);
+    if (hash) c_free(hash);
+    if (count) c_free(count);
+    return pre;
+}
+
+
+/* Updates */
+
+// Reduced linear cost. Fails if a dropped variable gets a nonzero cost.
+static c_int presolve_update_lin_cost(OSQPPresolve *pre, const c_float *q) {
+    c_int j;
+
+    for (j = 0; j < pre->n; j++) {
+        if (pre->colmap[j] < 0 && q[j] != 0.) return 1;
+    }
+    for (j = 0; j < pre->nr; j++) pre->data->q[j] = q[pre->cols[j]];
+    return 0;
+}
+
+/*
+ * Reduced indexed linear cost, stored in qr and idxr without the entries of
+ * the dropped variables. Fails if a dropped variable gets a nonzero cost.
+ */
+static c_int presolve_update_lin_cost_idx(OSQPPresolve *pre, const c_float *q,
+                                          const c_int *idx, c_int k,
+                                          c_float *qr, c_int *idxr, c_int *kr) {
+    c_int t, j;
+
+    for (t = 0; t < k; t++) {
+        if (pre->colmap[idx[t]] < 0 && q[t] != 0.) return 1;
+    }
+    *kr = 0;
+    for (t = 0; t < k; t++) {
+        j = pre->colmap[idx[t]];
+        if (j < 0) continue;
+        pre->data->q[j] = q[t];
+        qr[*kr] = q[t];
+        idxr[(*kr)++] = j;
+    }
+    return 0;
+}
+
+// Reduced bounds. The bounds that are not given are kept.
+static c_int presolve_update_bounds(OSQPPresolve *pre, const c_float *l,
+                                    const c_float *u) {
+    return presolve_bounds(pre, l ? l : pre->l, u ? u : pre->u);
+}
+
+/*
+ * Reduced values of A. Fails if the update changes the multiples of the
+ * merged rows.
+ */
+static c_int presolve_update_A(OSQPPresolve *pre, const c_float *Ax,
+                               const c_int *Ax_idx, c_int Ax_n) {
+    c_int Anz = pre->A->p[pre->n];
+    c_int i, k, r;
+    c_float s;
+
+    if (Ax_n > Anz) return 1;
+    memcpy(pre->Ax, pre->A->x, Anz * sizeof(c_float));
+    if (Ax_idx) {
+        for (k = 0; k < Ax_n; k++) pre->Ax[Ax_idx[k]] = Ax[k];
+    } else {
+        memcpy(pre->Ax, Ax, Anz * sizeof(c_float));
+    }
+
+    for (r = 0; r < pre->mr; r++) {
+        for (i = pre->next[pre->rows[r]]; i >= 0; i = pre->next[i]) {
+            if (!presolve_parallel(pre, pre->Ax, pre->rows[r], i, &s) ||
+                s != pre->rscale[i]) {
+                return 1;
+            }
+        }
+    }
+
+    memcpy(pre->A->x, pre->Ax, Anz * sizeof(c_float));
+    for (k = 0; k < pre->data->A->p[pre->nr]; k++) {
+        pre->data->A->x[k] = pre->A->x[pre->Apos[k]];
+    }
+    return 0;
+}
+
+
+/* Warm start */
+
+static void presolve_warm_start_x(OSQPPresolve *pre, const c_float *x) {
+    c_int j;
+
+    for (j = 0; j < pre->nr; j++) pre->x[j] = x[pre->cols[j]];
+}
+
+// The reduced dual gives the same A' y as the duals of the merged rows
+static void presolve_warm_start_y(OSQPPresolve *pre, const c_float *y) {
+    c_int i, r;
+
+    for (r = 0; r < pre->mr; r++) {
+        pre->y[r] = 0.;
+        for (i = pre->rows[r]; i >= 0; i = pre->next[i]) {
+            pre->y[r] += pre->rscale[i] * y[i];
+        }
+    }
+}
+
+
+/* Postsolve */
+
+static c_float *presolve_postsolve_x(OSQPPresolve *pre, const c_float *xr) {
+    c_int j;
+
+    for (j = 0; j < pre->n; j++) {
+        pre->x[j] = pre->colmap[j] >= 0 ? xr[pre->colmap[j]] : 0.;
+    }
+    return pre->x;
+}
+
+static c_float *presolve_postsolve_y(OSQPPresolve *pre, const c_float *yr) {
+    c_int i, r;
+
+    for (i = 0; i < pre->m; i++) pre->y[i] = 0.;
+    for (r = 0; r < pre->mr; r++) {
+        if (yr[r] > 0.) {
+            i = pre->usrc[r];
+        } else if (yr[r] < 0.) {
+            i = pre->lsrc[r];
+        } else {
+            continue;
+        }
+        pre->y[i] = yr[r] / pre->rscale[i];
+    }
+    return pre->y;
+}
+
+#endif
@@ -0,0 +1,561 @@
+#ifndef OSQPSUPERNODALPY_H
+#define OSQPSUPERNODALPY_H
+
+#include "qdldl_interface.h"
+#include "qdldl.h"
+#include "kkt.h"
+
+/*****************************************************
+ * Supernodal LDL' linear system solver              *
+ *****************************************************/
+
+/*
+ * Linear system solver type handled by the extension rather than by the
+ * OSQP library. The solver is set up on top of QDLDL: the QDLDL solver
+ * assembles and permutes the KKT matrix and computes the pattern of L,
+ * while this solver groups the columns of L into supernodes and performs
+ * the numerical factorization and the solves with dense kernels.
+ *
+ * The pattern of L is taken from the factorization done by osqp_setup,
+ * whose values are then dropped: a setup with this solver factors the KKT
+ * matrix twice. The time of the second factorization is part of the setup
+ * time reported in the info.
+ *
+ * The blocks of columns of a large update between two supernodes are split
+ * among nthreads threads, each with its own dense buffers.
+ */
+#define SUPERNODAL_SOLVER (MKL_PARDISO_SOLVER + 1)
+
+// Number of columns of the dense update computed at once
+#define SUPERNODAL_BLOCK (32)
+
+// Smallest update, in multiply-adds, split among several threads
+#define SUPERNODAL_PARALLEL_WORK (1 << 18)
+
+
+typedef struct supernodal supernodal_solver;
+
+struct supernodal {
+    enum linsys_solver_type type;
+
+    c_int (*solve)(struct supernodal * self, c_float * b);
+    void (*free)(struct supernodal * self);
+    c_int (*update_matrices)(struct supernodal * self, const csc *P, const csc *A);
+    c_int (*update_rho_vec)(struct supernodal * self, const c_float * rho_vec);
+
+    c_int nthreads;
+
+    qdldl_solver * kkt;     // KKT matrix, permutation and pattern of L
+    c_int n;                // Dimension of the KKT matrix
+
+    c_int nsuper;           // Number of supernodes
+    c_int *super;           // First column of each supernode (nsuper + 1)
+    c_int *col2sup;         // Supernode of each column
+    c_int *Lpi;             // Offsets of the row indices of each supernode
+    c_int *Ls;              // Row indices of each supernode
+    c_int *Lpx;             // Offsets of the dense panel of each supernode
+    c_float *Lx;            // Dense column-major panels of L
+
+    c_int *Up;              // Rows of the upper triangular KKT matrix
+    c_int *Uj;              // Column index of each entry of the rows
+    c_int *Ux;              // Position of each entry in KKT->x
+
+    c_int *map;             // Row positions in the current panel
+    c_int *head;            // Supernodes waiting to update each supernode
+    c_int *next;            // Linked list of waiting supernodes
+    c_int *pos;             // Next row of each supernode to be used in updates
+    c_float *W;             // D-scaled rows of the updating supernode, per thread
+    c_float *C;             // Dense update block, per thread
+    c_int Wlen;             // Length of the buffer W of a thread
+    c_int Clen;             // Length of the buffer C of a thread
+};
+
+
+/* Dense kernels */
+
+// C(:, jj) = L(jj:, :) * W(:, jj) for the lower part of a block of columns
+static void supernodal_syrk(c_int nrow, c_int ncol, c_int width,
+                            const c_float *L, c_int ldl,
+                            const c_float *W, c_float *C) {
+    c_int i, jj, k;
+    c_float wkj;
+    c_float *Cj;
+    const c_float *Lk;
+
+    for (jj = 0; jj < ncol; jj++) {
+        Cj = C + jj * nrow;
+        for (i = jj; i < nrow; i++) Cj[i] = 0.0;
+
+        for (k = 0; k < width; k++) {
+            wkj = W[k + jj * width];
+            if (wkj == 0.0) continue;
+            Lk = L + k * ldl;
+            for (i = jj; i < nrow; i++) {
+                Cj[i] += Lk[i] * wkj;
+            }
+        }
+    }
+}
+
+// Dense LDL' factorization of a panel. Returns the number of positive
+// pivots or -1 if a zero pivot is found.
+static c_int supernodal_panel_factor(c_int nrow, c_int width, c_float *L,
+                                     c_float *D, c_float *Dinv) {
+    c_int i, j, k, npos = 0;
+    c_float d, dinv, t;
+    c_float *Lk, *Lj;
+
+    for (k = 0; k < width; k++) {
+        Lk = L + k * nrow;
+        d = Lk[k];
+
+        if (d == 0.0) return -1;
+        if (d > 0.0) npos++;
+
+        dinv = 1.0 / d;
+        D[k] = d;
+        Dinv[k] = dinv;
+
+        // Column of L below the pivot
+        Lk[k] = 1.0;
+        for (i = k + 1; i < nrow; i++) {
+            Lk[i] *= dinv;
+        }
+
+        // Rank-1 update of the remaining columns of the panel
+        for (j = k + 1; j < width; j++) {
+            Lj = L + j * nrow;
+            t = d * Lk[j];
+            for (i = j; i < nrow; i++) {
+                Lj[i] -= Lk[i] * t;
+            }
+        }
+    }
+
+    return npos;
+}
+
+
+/* Symbolic analysis */
+
+// Free the arrays of the symbolic analysis
+static void supernodal_free_symbolic(supernodal_solver *s) {
+    if (s->super) c_free(s->super);
+    if (s->col2sup) c_free(s->col2sup);
+    if (s->Lpi) c_free(s->Lpi);
+    if (s->Ls) c_free(s->Ls);
+    if (s->Lpx) c_free(s->Lpx);
+    if (s->Lx) c_free(s->Lx);
+    if (s->Up) c_free(s->Up);
+    if (s->Uj) c_free(s->Uj);
+    if (s->Ux) c_free(s->Ux);
+    if (s->map) c_free(s->map);
+    if (s->head) c_free(s->head);
+    if (s->next) c_free(s->next);
+    if (s->pos) c_free(s->pos);
+    if (s->W) c_free(s->W);
+    if (s->C) c_free(s->C);
+    s->super = s->col2sup = s->Lpi = s->Ls = s->Lpx = OSQP_NULL;
+    s->Up = s->Uj = s->Ux = s->map = s->head = s->next = s->pos = OSQP_NULL;
+    s->Lx = s->W = s->C = OSQP_NULL;
+}
+
+// Find supernodes from the elimination tree and the column counts of L
+static c_int supernodal_symbolic(supernodal_solver *s) {
+    qdldl_solver *q = s->kkt;
+    csc *KKT = q->KKT;
+    c_int n = s->n;
+    c_int j, k, p, sn, nrow, width, first, last;
+    c_int maxrow = 0, maxwidth = 0;
+    c_int *count;
+
+    // Fundamental supernodes: j + 1 is the parent of j and the pattern of
+    // column j is the pattern of column j + 1 plus row j + 1
+    s->super = (c_int *)c_malloc((n + 1) * sizeof(c_int));
+    s->col2sup = (c_int *)c_malloc(n * sizeof(c_int));
+    if (!s->super || !s->col2sup) {
+        supernodal_free_symbolic(s);
+        return 1;
+    }
+    s->nsuper = 0;
+    for (j = 0; j < n; j++) {
+        if (j == 0 || !(q->etree[j - 1] == j && q->Lnz[j - 1] == q->Lnz[j] + 1)) {
+            s->super[s->nsuper++] = j;
+        }
+        s->col2sup[j] = s->nsuper - 1;
+    }
+    s->super[s->nsuper] = n;
+
+    // Row indices: the diagonal block followed by the pattern of the last
+    // column of the supernode, taken from the QDLDL factor
+    s->Lpi = (c_int *)c_malloc((s->nsuper + 1) * sizeof(c_int));
+    s->Lpx = (c_int *)c_malloc((s->nsuper + 1) * sizeof(c_int));
+    if (!s->Lpi || !s->Lpx) {
+        supernodal_free_symbolic(s);
+        return 1;
+    }
+    s->Lpi[0] = 0;
+    s->Lpx[0] = 0;
+    for (sn = 0; sn < s->nsuper; sn++) {
+        first = s->super[sn];
+        last  = s->super[sn + 1] - 1;
+        width = last - first + 1;
+        nrow  = width + q->Lnz[last];
+        s->Lpi[sn + 1] = s->Lpi[sn] + nrow;
+        s->Lpx[sn + 1] = s->Lpx[sn] + nrow * width;
+        if (nrow > maxrow) maxrow = nrow;
+        if (width > maxwidth) maxwidth = width;
+    }
+
+    s->Ls = (c_int *)c_malloc(c_max(s->Lpi[s->nsuper], 1) * sizeof(c_int));
+    s->Lx = (c_float *)c_malloc(c_max(s->Lpx[s->nsuper], 1) * sizeof(c_float));
+    if (!s->Ls || !s->Lx) {
+        supernodal_free_symbolic(s);
+        return 1;
+    }
+    for (sn = 0; sn < s->nsuper; sn++) {
+        first = s->super[sn];
+        last  = s->super[sn + 1] - 1;
+        k = s->Lpi[sn];
+        for (j = first; j <= last; j++) s->Ls[k++] = j;
+        for (p = q->L->p[last]; p < q->L->p[last + 1]; p++) s->Ls[k++] = q->L->i[p];
+    }
+
+    // Row-wise access to the upper triangular KKT matrix, i.e. column-wise
+    // access to its lower triangular part
+    count = (c_int *)c_calloc(n + 1, sizeof(c_int));
+    s->Up = (c_int *)c_malloc((n + 1) * sizeof(c_int));
+    s->Uj = (c_int *)c_malloc(c_max(KKT->p[n], 1) * sizeof(c_int));
+    s->Ux = (c_int *)c_malloc(c_max(KKT->p[n], 1) * sizeof(c_int));
+    if (!count || !s->Up || !s->Uj || !s->Ux) {
+        if (count) c_free(count);
+        supernodal_free_symbolic(s);
+        return 1;
+    }
+    for (p = 0; p < KKT->p[n]; p++) count[KKT->i[p]]++;
+    s->Up[0] = 0;
+    for (j = 0; j < n; j++) {
+        s->Up[j + 1] = s->Up[j] + count[j];
+        count[j] = s->Up[j];
+    }
+    for (j = 0; j < n; j++) {
+        for (p = KKT->p[j]; p < KKT->p[j + 1]; p++) {
+            k = count[KKT->i[p]]++;
+            s->Uj[k] = j;
+            s->Ux[k] = p;
+        }
+    }
+    c_free(count);
+
+    // Workspace
+    s->map  = (c_int *)c_malloc(n * sizeof(c_int));
+    s->head = (c_int *)c_malloc(s->nsuper * sizeof(c_int));
+    s->next = (c_int *)c_malloc(s->nsuper * sizeof(c_int));
+    s->pos  = (c_int *)c_malloc(s->nsuper * sizeof(c_int));
+    s->Wlen = c_max(maxwidth * SUPERNODAL_BLOCK, 1);
+    s->Clen = c_max(maxrow * SUPERNODAL_BLOCK, 1);
+    s->W    = (c_float *)c_malloc(s->nthreads * s->Wlen * sizeof(c_float));
+    s->C    = (c_float *)c_malloc(s->nthreads * s->Clen * sizeof(c_float));
+
+    if (!s->map || !s->head || !s->next || !s->pos || !s->W || !s->C) {
+        supernodal_free_symbolic(s);
+        return 1;
+    }
+
+    return 0;
+}
+
+
+/* Numerical factorization */
+
+// Subtract the update of supernode K from supernode J for the blocks of
+// rows pk, pk + stride, ... before pk2, with the buffers W and C. Each block
+// updates its own columns of J.
+static void supernodal_update(supernodal_solver *s, c_int K, c_int J,
+                              c_int pk, c_int pk2, c_int stride,
+                              c_float *W, c_float *C) {
+    c_int first = s->super[J];
+    c_int ldj = s->Lpi[J + 1] - s->Lpi[J];
+    c_int ldk = s->Lpi[K + 1] - s->Lpi[K];
+    c_int width = s->super[K + 1] - s->super[K];
+    c_int *rows = s->Ls + s->Lpi[K];
+    c_float *LK = s->Lx + s->Lpx[K];
+    c_float *LJ = s->Lx + s->Lpx[J];
+    c_float *D = s->kkt->D + s->super[K];
+    c_int j0, ncol, i, jj, k, cj;
+    c_float *Cj, *LJj;
+
+    for (j0 = pk; j0 < pk2; j0 += stride) {
+        ncol = c_min(SUPERNODAL_BLOCK, pk2 - j0);
+
+        // W = D_K * L(rows j0:j0+ncol, :)'
+        for (jj = 0; jj < ncol; jj++) {
+            for (k = 0; k < width; k++) {
+                W[k + jj * width] = D[k] * LK[j0 + jj + k * ldk];
+            }
+        }
+
+        // C = L(rows j0:end, :) * W
+        supernodal_syrk(ldk - j0, ncol, width, LK + j0, ldk, W, C);
+
+        // Scatter C into the panel of J
+        for (jj = 0; jj < ncol; jj++) {
+            cj = rows[j0 + jj] - first;
+            Cj = C + jj * (ldk - j0);
+            LJj = LJ + cj * ldj;
+            for (i = jj; i < ldk - j0; i++) {
+                LJj[s->map[rows[j0 + i]]] -= Cj[i];
+            }
+        }
+    }
+}
+
+typedef struct {
+    supernodal_solver *s;
+    c_int K, J, pk, pk2;
+    c_int nslots;           // Threads sharing the update
+} supernodal_update_job;
+
+// Blocks slot, slot + nslots, ... of an update
+static c_int supernodal_update_task(void *ctx, c_int slot) {
+    supernodal_update_job *u = (supernodal_update_job *) ctx;
+    supernodal_solver *s = u->s;
+
+    supernodal_update(s, u->K, u->J, u->pk + slot * SUPERNODAL_BLOCK, u->pk2,
+                      u->nslots * SUPERNODAL_BLOCK, s->W + slot * s->Wlen,
+                      s->C + slot * s->Clen);
+    return 0;
+}
+
+// Update of supernode J by supernode K, split among the threads if large
+static void supernodal_update_split(supernodal_solver *s, c_int K, c_int J,
+                                    c_int pk, c_int pk2) {
+    supernodal_update_job u;
+    c_int nblocks = (pk2 - pk + SUPERNODAL_BLOCK - 1) / SUPERNODAL_BLOCK;
+    c_float work = (c_float)(s->Lpi[K + 1] - s->Lpi[K] - pk) *
+                   (c_float)(s->super[K + 1] - s->super[K]) * (c_float)(pk2 - pk);
+
+    if (s->nthreads < 2 || nblocks < 2 || work < SUPERNODAL_PARALLEL_WORK) {
+        supernodal_update(s, K, J, pk, pk2, SUPERNODAL_BLOCK, s->W, s->C);
+        return;
+    }
+    u.s = s;
+    u.K = K;
+    u.J = J;
+    u.pk = pk;
+    u.pk2 = pk2;
+    u.nslots = c_min(s->nthreads, nblocks);
+    parallel_for(u.nslots, u.nslots, supernodal_update_task, &u);
+}
+
+static c_int supernodal_factor(supernodal_solver *s) {
+    csc *KKT = s->kkt->KKT;
+    c_int J, K, Knext, j, p, k, i, pk, pk2, first, last, ld, npos, nposJ;
+    c_int *rows;
+    c_float *LJ;
+
+    for (J = 0; J < s->nsuper; J++) s->head[J] = -1;
+    npos = 0;
+
+    for (J = 0; J < s->nsuper; J++) {
+        first = s->super[J];
+        last  = s->super[J + 1] - 1;
+        ld    = s->Lpi[J + 1] - s->Lpi[J];
+        rows  = s->Ls + s->Lpi[J];
+        LJ    = s->Lx + s->Lpx[J];
+
+        // Scatter the lower triangular part of the KKT columns into the panel
+        for (i = 0; i < ld; i++) s->map[rows[i]] = i;
+        for (k = 0; k < ld * (last - first + 1); k++) LJ[k] = 0.0;
+        for (j = first; j <= last; j++) {
+            for (p = s->Up[j]; p < s->Up[j + 1]; p++) {
+                LJ[s->map[s->Uj[p]] + (j - first) * ld] = KKT->x[s->Ux[p]];
+            }
+        }
+
+        // Updates from the descendants of J
+        for (K = s->head[J]; K != -1; K = Knext) {
+            Knext = s->next[K];
+            pk = s->pos[K];
+            pk2 = pk;
+            while (pk2 < s->Lpi[K + 1] - s->Lpi[K] &&
+                   s->Ls[s->Lpi[K] + pk2] <= last) pk2++;
+
+            supernodal_update_split(s, K, J, pk, pk2);
+
+            // Move K to the supernode of its next row
+            s->pos[K] = pk2;
+            if (pk2 < s->Lpi[K + 1] - s->Lpi[K]) {
+                i = s->col2sup[s->Ls[s->Lpi[K] + pk2]];
+                s->next[K] = s->head[i];
+                s->head[i] = K;
+            }
+        }
+
+        // Dense factorization of the panel
+        nposJ = supernodal_panel_factor(ld, last - first + 1, LJ,
+                                        s->kkt->D + first, s->kkt->Dinv + first);
+        if (nposJ < 0) {
+#ifdef PRINTING
+            c_eprint("Error in KKT matrix LDL factorization when computing the nonzero elements. There are zeros in the diagonal matrix");
+#endif
+            return -1;
+        }
+        npos += nposJ;
+
+        // J updates the supernode of its first off-diagonal row
+        pk = last - first + 1;
+        if (pk < ld) {
+            s->pos[J] = pk;
+            i = s->col2sup[rows[pk]];
+            s->next[J] = s->head[i];
+            s->head[i] = J;
+        }
+    }
+
+    // The KKT matrix is quasidefinite: n positive and m negative pivots
+    if (npos < s->kkt->n) {
+#ifdef PRINTING
+        c_eprint("KKT matrix is not quasidefinite");
+#endif
+        return -2;
+    }
+
+    return 0;
+}
+
+
+/* Solve */
+
+static void supernodal_ldlsolve(supernodal_solver *s, c_float *x) {
+    c_int J, i, j, first, width, ld;
+    c_int *rows;
+    c_float *LJ, *Lj;
+    c_float xj;
+
+    // Forward substitution with L
+    for (J = 0; J < s->nsuper; J++) {
+        first = s->super[J];
+        width = s->super[J + 1] - first;
+        ld    = s->Lpi[J + 1] - s->Lpi[J];
+        rows  = s->Ls + s->Lpi[J];
+        LJ    = s->Lx + s->Lpx[J];
+        for (j = 0; j < width; j++) {
+            Lj = LJ + j * ld;
+            xj = x[first + j];
+            for (i = j + 1; i < width; i++) x[first + i] -= Lj[i] * xj;
+            for (i = width; i < ld; i++) x[rows[i]] -= Lj[i] * xj;
+        }
+    }
+
+    // Diagonal
+    for (j = 0; j < s->n; j++) x[j] *= s->kkt->Dinv[j];
+
+    // Backward substitution with L'
+    for (J = s->nsuper - 1; J >= 0; J--) {
+        first = s->super[J];
+        width = s->super[J + 1] - first;
+        ld    = s->Lpi[J + 1] - s->Lpi[J];
+        rows  = s->Ls + s->Lpi[J];
+        LJ    = s->Lx + s->Lpx[J];
+        for (j = width - 1; j >= 0; j--) {
+            Lj = LJ + j * ld;
+            xj = x[first + j];
+            for (i = width; i < ld; i++) xj -= Lj[i] * x[rows[i]];
+            for (i = j + 1; i < width; i++) xj -= Lj[i] * x[first + i];
+            x[first + j] = xj;
+        }
+    }
+}
+
+static c_int solve_linsys_supernodal(supernodal_solver *s, c_float *b) {
+    qdldl_solver *q = s->kkt;
+    c_int j;
+
+    // bp = P b
+    for (j = 0; j < s->n; j++) q->bp[j] = b[q->P[j]];
+    supernodal_ldlsolve(s, q->bp);
+    for (j = 0; j < s->n; j++) q->sol[q->P[j]] = q->bp[j];
+
+    // x_tilde and z_tilde
+    for (j = 0; j < q->n; j++) b[j] = q->sol[j];
+    for (j = 0; j < q->m; j++) b[j + q->n] += q->rho_inv_vec[j] * q->sol[j + q->n];
+
+    return 0;
+}
+
+
+/* Updates */
+
+static c_int update_linsys_solver_matrices_supernodal(supernodal_solver *s,
+                                                      const csc *P, const csc *A) {
+    qdldl_solver *q = s->kkt;
+
+    update_KKT_P(q->KKT, P, q->PtoKKT, q->sigma, q->Pdiag_idx, q->Pdiag_n);
+    update_KKT_A(q->KKT, A, q->AtoKKT);
+
+    return supernodal_factor(s);
+}
+
+static c_int update_linsys_solver_rho_vec_supernodal(supernodal_solver *s,
+                                                     const c_float *rho_vec) {
+    qdldl_solver *q = s->kkt;
+    c_int i;
+
+    for (i = 0; i < q->m; i++) q->rho_inv_vec[i] = 1. / rho_vec[i];
+    update_KKT_param2(q->KKT, q->rho_inv_vec, q->rhotoKKT, q->m);
+
+    return supernodal_factor(s);
+}
+
+
+static void free_linsys_solver_supernodal(supernodal_solver *s) {
+    if (s) {
+        if (s->kkt) s->kkt->free(s->kkt);
+        supernodal_free_symbolic(s);
+        c_free(s);
+    }
+}
+
+
+/*
+ * Replace a QDLDL solver, as created by osqp_setup, with the supernodal
+ * solver factoring on nthreads threads (all processors if nthreads <= 0).
+ * The QDLDL solver is kept to own the KKT matrix and the permutation, but
+ * its numerical factor is released.
+ */
+static c_int supernodal_install(LinSysSolver **solver, c_int nthreads) {
+    qdldl_solver *q = (qdldl_solver *) *solver;
+    supernodal_solver *s;
+
+    if (q->type != QDLDL_SOLVER) return 1;
+
+    s = (supernodal_solver *)c_calloc(1, sizeof(supernodal_solver));
+    if (!s) return 1;
+
+    s->type = SUPERNODAL_SOLVER;
+    s->solve = &solve_linsys_supernodal;
+    s->free = &free_linsys_solver_supernodal;
+    s->update_matrices = &update_linsys_solver_matrices_supernodal;
+    s->update_rho_vec = &update_linsys_solver_rho_vec_supernodal;
+    s->nthreads = nthreads > 0 ? nthreads : parallel_nprocs();
+    s->kkt = q;
+    s->n = q->KKT->n;
+
+    if (supernodal_symbolic(s) || supernodal_factor(s)) {
+        // Leave the QDLDL solver in place
+        s->kkt = OSQP_NULL;
+        free_linsys_solver_supernodal(s);
+        return 1;
+    }
+
+    // The values of the QDLDL factor are no longer needed
+    c_free(q->L->x);
+    q->L->x = OSQP_NULL;
+
+    *solver = (LinSysSolver *) s;
+
+    return 0;
+}
+
+#endif
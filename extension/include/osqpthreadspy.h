@@ -0,0 +1,251 @@
+#ifndef OSQPTHREADSPY_H
+#define OSQPTHREADSPY_H
+
+/*****************************************************
+ * Parallel execution of independent tasks           *
+ *****************************************************/
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+/*
+ * The tasks of a call to parallel_for form a job, posted to a pool of
+ * threads started by the first call and kept for the following ones. The
+ * calling thread takes part in its own job and waits for the tasks taken by
+ * the pool to finish. Several jobs can be posted at once, from different
+ * threads or from a task of another job. The tasks run without the GIL and
+ * must not call the Python API.
+ */
+typedef c_int (*parallel_task)(void *ctx, c_int task);
+
+typedef struct parallel_job {
+    struct parallel_job *next;  // Next job with tasks left
+    parallel_task task;     // Function run for each task
+    void *ctx;              // Context passed to the function
+    c_int ntasks;           // Number of tasks
+    c_int next_task;        // Next task to run
+    c_int ndone;            // Number of finished tasks
+    c_int nhelpers;         // Pool threads working on the job
+    c_int maxhelpers;       // Maximum number of pool threads on the job
+    c_int exitflag;         // Nonzero if a task failed
+} parallel_job;
+
+typedef struct {
+#ifdef _WIN32
+    SRWLOCK lock;
+    CONDITION_VARIABLE work;    // Signalled when a job is posted
+    CONDITION_VARIABLE done;    // Signalled when a job is finished
+#else
+    pthread_mutex_t lock;
+    pthread_cond_t work;
+    pthread_cond_t done;
+#endif
+    parallel_job *jobs, *jobs_tail; // Jobs with tasks left
+    int started;            // Whether the threads were started
+    c_int nthreads;         // Number of threads running
+} parallel_pool_t;
+
+#ifdef _WIN32
+static parallel_pool_t parallel_pool = {SRWLOCK_INIT, CONDITION_VARIABLE_INIT,
+                                        CONDITION_VARIABLE_INIT,
+                                        OSQP_NULL, OSQP_NULL, 0, 0};
+
+static void parallel_lock(void) { AcquireSRWLockExclusive(&parallel_pool.lock); }
+static void parallel_unlock(void) { ReleaseSRWLockExclusive(&parallel_pool.lock); }
+static void parallel_wait(CONDITION_VARIABLE *cond) {
+    SleepConditionVariableSRW(cond, &parallel_pool.lock, INFINITE, 0);
+}
+static void parallel_wake(CONDITION_VARIABLE *cond) { WakeAllConditionVariable(cond); }
+#else
+static parallel_pool_t parallel_pool = {PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER,
+                                        PTHREAD_COND_INITIALIZER,
+                                        OSQP_NULL, OSQP_NULL, 0, 0};
+
+static void parallel_lock(void) { pthread_mutex_lock(&parallel_pool.lock); }
+static void parallel_unlock(void) { pthread_mutex_unlock(&parallel_pool.lock); }
+static void parallel_wait(pthread_cond_t *cond) {
+    pthread_cond_wait(cond, &parallel_pool.lock);
+}
+static void parallel_wake(pthread_cond_t *cond) { pthread_cond_broadcast(cond); }
+#endif
+
+
+// Number of processors available to run threads
+static c_int parallel_nprocs(void) {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+
+    GetSystemInfo(&info);
+    return (c_int) info.dwNumberOfProcessors;
+#else
+    long nprocs = sysconf(_SC_NPROCESSORS_ONLN);
+
+    return nprocs > 0 ? (c_int) nprocs : 1;
+#endif
+}
+
+// Remove a job whose tasks have all been taken. Called with the lock held.
+static void parallel_unlink(parallel_job *job) {
+    parallel_job **prev = &parallel_pool.jobs, *last = OSQP_NULL;
+
+    while (*prev != job) {
+        last = *prev;
+        prev = &(*prev)->next;
+    }
+    *prev = job->next;
+    if (parallel_pool.jobs_tail == job) parallel_pool.jobs_tail = last;
+}
+
+// Run the tasks left in a job. Called with the lock held.
+static void parallel_run(parallel_job *job) {
+    c_int task, failed;
+
+    while (job->next_task < job->ntasks) {
+        task = job->next_task++;
+        if (job->next_task == job->ntasks) parallel_unlink(job);
+
+        parallel_unlock();
+        failed = job->task(job->ctx, task);
+        parallel_lock();
+
+        if (failed) job->exitflag = 1;
+        if (++job->ndone == job->ntasks) parallel_wake(&parallel_pool.done);
+    }
+}
+
+#ifdef _WIN32
+static DWORD WINAPI parallel_worker(LPVOID arg) {
+#else
+static void *parallel_worker(void *arg) {
+#endif
+    parallel_job *job;
+
+    (void)arg;
+    parallel_lock();
+    for (;;) {
+        for (job = parallel_pool.jobs; job && job->nhelpers >= job->maxhelpers;
+             job = job->next);
+        if (!job) {
+            parallel_wait(&parallel_pool.work);
+            continue;
+        }
+        // The job is not touched once its last task is done, as its owner
+        // returns as soon as it gets the lock
+        job->nhelpers++;
+        parallel_run(job);
+        job->nhelpers--;
+    }
+#ifdef _WIN32
+    return 0;
+#else
+    return NULL;
+#endif
+}
+
+// Start the threads, one per processor besides the calling one. Called
+// with the lock held.
+static void parallel_start(void) {
+    c_int k, nthreads = parallel_nprocs() - 1;
+#ifdef _WIN32
+    HANDLE thread;
+#else
+    pthread_t thread;
+#endif
+
+    parallel_pool.started = 1;
+    for (k = 0; k < nthreads; k++) {
+#ifdef _WIN32
+        thread = CreateThread(NULL, 0, parallel_worker, NULL, 0, NULL);
+        if (!thread) break;
+        CloseHandle(thread);
+#else
+        if (pthread_create(&thread, NULL, parallel_worker, NULL)) break;
+        pthread_detach(thread);
+#endif
+        parallel_pool.nthreads++;
+    }
+}
+
+/*
+ * Flag written by one thread and read by the others, like a request to stop
+ * a solve running without the GIL.
+ */
+#ifdef _WIN32
+typedef volatile LONG parallel_flag;
+
+static void parallel_flag_set(parallel_flag *flag, c_int value) {
+    InterlockedExchange(flag, (LONG) value);
+}
+
+static c_int parallel_flag_get(parallel_flag *flag) {
+    return (c_int) InterlockedCompareExchange(flag, 0, 0);
+}
+#else
+typedef int parallel_flag;
+
+static void parallel_flag_set(parallel_flag *flag, c_int value) {
+    __atomic_store_n(flag, (int) value, __ATOMIC_RELEASE);
+}
+
+static c_int parallel_flag_get(parallel_flag *flag) {
+    return (c_int) __atomic_load_n(flag, __ATOMIC_ACQUIRE);
+}
+#endif
+
+/*
+ * Run task(ctx, k) for k = 0, ..., ntasks - 1 on at most nthreads threads
+ * (all available processors if nthreads <= 0). Returns nonzero if a task
+ * failed. Tasks run serially on the calling thread if the pool has no
+ * threads.
+ */
+static c_int parallel_for(c_int nthreads, c_int ntasks,
+                          parallel_task task, void *ctx) {
+    parallel_job job;
+
+    if (ntasks <= 0) return 0;
+    if (nthreads <= 0) nthreads = parallel_nprocs();
+    nthreads = c_min(nthreads, ntasks);
+
+    job.next = OSQP_NULL;
+    job.task = task;
+    job.ctx = ctx;
+    job.ntasks = ntasks;
+    job.next_task = 0;
+    job.ndone = 0;
+    job.nhelpers = 0;
+    job.maxhelpers = nthreads - 1;
+    job.exitflag = 0;
+
+    parallel_lock();
+    if (nthreads > 1 && !parallel_pool.started) parallel_start();
+    if (job.maxhelpers == 0 || parallel_pool.nthreads == 0) {
+        parallel_unlock();
+        for (; job.next_task < ntasks; job.next_task++) {
+            if (task(ctx, job.next_task)) job.exitflag = 1;
+        }
+        return job.exitflag;
+    }
+
+    if (parallel_pool.jobs_tail) {
+        parallel_pool.jobs_tail->next = &job;
+    } else {
+        parallel_pool.jobs = &job;
+    }
+    parallel_pool.jobs_tail = &job;
+    parallel_wake(&parallel_pool.work);
+
+    // The calling thread takes part in the work. Once no task is left, the
+    // job is off the list and only the tasks taken by the pool are waited
+    // for, so that a task can itself call parallel_for.
+    parallel_run(&job);
+    while (job.ndone < job.ntasks) parallel_wait(&parallel_pool.done);
+    parallel_unlock();
+
+    return job.exitflag;
+}
+
+#endif
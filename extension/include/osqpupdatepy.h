@@ -0,0 +1,124 @@
+#ifndef OSQPUPDATEPY_H
+#define OSQPUPDATEPY_H
+
+#include "auxil.h"
+#include "util.h"
+
+/*****************************************************
+ * Indexed updates of the problem vectors            *
+ *****************************************************/
+
+/*
+ * Updates of a few entries of q, l and u. Only the given entries are scaled
+ * and only the given constraints are reclassified as loose, inequality or
+ * equality constraints, so an update of k entries costs O(k). As in
+ * osqp_update_bounds, the KKT matrix is refactored only if a constraint
+ * changes type.
+ */
+
+// Start an update, as the osqp_update functions do
+static void update_idx_start(OSQPWorkspace *work) {
+#ifdef PROFILING
+    if (work->clear_update_time == 1) {
+        work->clear_update_time = 0;
+        work->info->update_time = 0.0;
+    }
+    osqp_tic(work->timer);
+#endif
+}
+
+// End an update, refactoring the KKT matrix if a constraint changed type
+static c_int update_idx_finish(OSQPWorkspace *work, c_int type_changed) {
+    c_int exitflag = 0;
+
+    reset_info(work->info);
+    if (type_changed) {
+        exitflag = work->linsys_solver->update_rho_vec(work->linsys_solver,
+                                                       work->rho_vec);
+    }
+#ifdef PROFILING
+    work->info->update_time += osqp_toc(work->timer);
+#endif
+    return exitflag;
+}
+
+static void update_idx_lin_cost(OSQPWorkspace *work, c_int j, c_float q) {
+    if (work->settings->scaling) {
+        q *= work->scaling->D[j];
+        q *= work->scaling->c;
+    }
+    work->data->q[j] = q;
+}
+
+// Scaled value of a bound of constraint i
+static c_float update_idx_scale_bound(OSQPWorkspace *work, c_int i, c_float b) {
+    return work->settings->scaling ? b * work->scaling->E[i] : b;
+}
+
+/*
+ * Set the scaled bounds of constraint i and reclassify it as update_rho_vec
+ * does. Returns 1 if the type of the constraint changed.
+ */
+static c_int update_idx_bounds(OSQPWorkspace *work, c_int i, c_float l, c_float u) {
+    c_int type;
+
+    work->data->l[i] = l;
+    work->data->u[i] = u;
+    if (l < -OSQP_INFTY * MIN_SCALING && u > OSQP_INFTY * MIN_SCALING) {
+        type = -1;
+    } else if (u - l < RHO_TOL) {
+        type = 1;
+    } else {
+        type = 0;
+    }
+    if (work->constr_type[i] == type) return 0;
+
+    work->constr_type[i] = type;
+    if (type == -1) {
+        work->rho_vec[i] = RHO_MIN;
+    } else if (type == 1) {
+        work->rho_vec[i] = RHO_EQ_OVER_RHO_INEQ * work->settings->rho;
+    } else {
+        work->rho_vec[i] = work->settings->rho;
+    }
+    work->rho_inv_vec[i] = 1.0 / work->rho_vec[i];
+    return 1;
+}
+
+
+/* Updates of a workspace */
+
+static c_int update_lin_cost_idx(OSQPWorkspace *work, const c_float *q,
+                                 const c_int *idx, c_int k) {
+    c_int t;
+
+    update_idx_start(work);
+    for (t = 0; t < k; t++) update_idx_lin_cost(work, idx[t], q[t]);
+    return update_idx_finish(work, 0);
+}
+
+// Bounds that are not given are kept. Invalid bounds leave the workspace unchanged.
+static c_int update_bounds_idx(OSQPWorkspace *work, const c_float *l,
+                               const c_float *u, const c_int *idx, c_int k) {
+    c_int t, i, type_changed = 0;
+    c_float lo, hi;
+
+    // The scaling preserves the order of the bounds
+    for (t = 0; t < k; t++) {
+        i = idx[t];
+        lo = l ? update_idx_scale_bound(work, i, l[t]) : work->data->l[i];
+        hi = u ? update_idx_scale_bound(work, i, u[t]) : work->data->u[i];
+        if (lo > hi) return 1;
+    }
+
+    update_idx_start(work);
+    for (t = 0; t < k; t++) {
+        i = idx[t];
+        lo = l ? update_idx_scale_bound(work, i, l[t]) : work->data->l[i];
+        hi = u ? update_idx_scale_bound(work, i, u[t]) : work->data->u[i];
+        type_changed |= update_idx_bounds(work, i, lo, hi);
+    }
+    return update_idx_finish(work, type_changed);
+}
+
+#endif
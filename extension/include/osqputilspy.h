@@ -108,12 +108,81 @@ static PyArrayObject *get_contiguous(PyArrayObject *array, int typenum) {
     PyArrayObject *tmp_arr;
     PyArrayObject *new_owner;
     tmp_arr = PyArray_GETCONTIGUOUS(array);
+    if (!tmp_arr) return (PyArrayObject *) NULL;
     new_owner = (PyArrayObject *) PyArray_Cast(tmp_arr, typenum);
     Py_DECREF(tmp_arr);
     return new_owner;
 }
 
 
+/*
+ * Arguments of the methods called at high rates (solves, updates and warm
+ * starts). They are passed as a C array (METH_FASTCALL) and their types are
+ * checked directly, without building a tuple and parsing a format string.
+ * Before Python 3.7 the methods get the items of the argument tuple.
+ */
+#if PY_VERSION_HEX >= 0x03070000
+#define METH_OSQP_FASTCALL METH_FASTCALL
+#define OSQP_FASTCALL(f) (PyCFunction)(void (*)(void))f
+#define OSQP_FASTCALL_VARARGS(f)
+#else
+#define METH_OSQP_FASTCALL METH_VARARGS
+#define OSQP_FASTCALL(f) (PyCFunction)f##_varargs
+#define OSQP_FASTCALL_VARARGS(f)                                             \
+    static PyObject *f##_varargs(OSQP *self, PyObject *args) {               \
+        return f(self, &PyTuple_GET_ITEM(args, 0), PyTuple_GET_SIZE(args));  \
+    }
+#endif
+
+static int fastcall_nargs(const char *name, Py_ssize_t nargs,
+                          Py_ssize_t min, Py_ssize_t max) {
+    if (nargs < min || nargs > max) {
+        if (min == max) {
+            PyErr_Format(PyExc_TypeError,
+                         "%s() takes exactly %zd arguments (%zd given)",
+                         name, min, nargs);
+        } else {
+            PyErr_Format(PyExc_TypeError,
+                         "%s() takes from %zd to %zd arguments (%zd given)",
+                         name, min, max, nargs);
+        }
+        return 1;
+    }
+    return 0;
+}
+
+static PyArrayObject *fastcall_array(const char *name, PyObject *const *args,
+                                     Py_ssize_t k) {
+    if (!PyArray_Check(args[k])) {
+        PyErr_Format(PyExc_TypeError,
+                     "%s() argument %zd must be numpy.ndarray, not %.50s",
+                     name, k + 1, Py_TYPE(args[k])->tp_name);
+        return (PyArrayObject *) NULL;
+    }
+    return (PyArrayObject *)args[k];
+}
+
+static int fastcall_float(PyObject *arg, c_float *val) {
+    double v = PyFloat_AsDouble(arg);
+
+    if (v == -1.0 && PyErr_Occurred()) return 1;
+    *val = (c_float)v;
+    return 0;
+}
+
+static int fastcall_int(PyObject *arg, c_int *val) {
+    long long v = PyLong_AsLongLong(arg);
+
+    if (v == -1 && PyErr_Occurred()) return 1;
+    if ((long long)(c_int)v != v) {
+        PyErr_SetString(PyExc_OverflowError, "Python int too large to convert to c_int");
+        return 1;
+    }
+    *val = (c_int)v;
+    return 0;
+}
+
+
 static PyOSQPData * create_pydata(c_int n, c_int m,
                      PyArrayObject *Px, PyArrayObject *Pi, PyArrayObject *Pp,
                      PyArrayObject *q, PyArrayObject *Ax, PyArrayObject *Ai,
@@ -265,6 +265,16 @@ static PyObject *OSQP_get_workspace(OSQP *self){
         return (PyObject *) NULL;
     }
 
+    if(self->presolve) {
+        PyErr_SetString(PyExc_ValueError, "OSQP setup was performed with presolve! Run setup without presolve");
+        return (PyObject *) NULL;
+    }
+
+    if(self->decomposition) {
+        PyErr_SetString(PyExc_ValueError, "OSQP setup was performed with decompose! Run setup without decompose");
+        return (PyObject *) NULL;
+    }
+
      rho_vectors_py   = OSQP_get_rho_vectors(self);
      data_py          = OSQP_get_data(self);
      linsys_solver_py = OSQP_get_linsys_solver(self);
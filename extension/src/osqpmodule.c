@@ -6,12 +6,29 @@
 #include "numpy/npy_math.h"         // For infinity values
 #include "structmember.h"           // Python members structure (to store results)
 #include "osqp.h"                   // OSQP API
+#include "osqppresolvepy.h"         // Presolve and postsolve of the problem data
+#include "osqpthreadspy.h"          // Parallel execution of independent tasks
+#include "osqpandersonpy.h"         // Anderson acceleration of the ADMM iteration
+#include "osqpiterationpy.h"        // ADMM solve loop of the extension
+#include "osqpupdatepy.h"           // Indexed updates of the problem vectors
+#include "osqpderivativepy.h"       // Derivatives of the solution
+#include "osqpbatchpy.h"            // Batched solves and derivatives of many instances
+#include "osqpdecompositionpy.h"    // Decomposition of block-separable problems
 
 
 // OSQP Object type
 typedef struct {
     PyObject_HEAD
     OSQPWorkspace * workspace;  // Pointer to C workspace structure
+    OSQPPresolve * presolve;    // Reductions of the problem (or NULL)
+    OSQPDecomposition * decomposition;  // Independent blocks of the problem (or NULL)
+    OSQPIteration * iteration;  // Solve loop of the extension (or NULL)
+    OSQPDerivative * derivative;    // Derivative system of the last solution (or NULL)
+    parallel_flag cancel;       // Ticket of the solve stopped by cancel()
+    c_int ticket;               // Ticket of the last solve started
+    int cancellable;            // Whether cancel() stops the synchronous solves
+    parallel_flag busy;         // Whether a solve runs on the worker pool
+    c_float ordering_time;      // Time spent computing the KKT ordering
 } OSQP;
 
 static PyTypeObject OSQP_Type;
@@ -20,7 +37,13 @@ static PyTypeObject OSQP_Type;
 #include "osqputilspy.h"        // Utilities functions
 #include "osqpinfopy.h"         // Info object
 #include "osqpresultspy.h"      // Results object
+#include "osqpsupernodalpy.h"   // Supernodal linear system solver
+#include "osqpdensepy.h"        // Dense linear system solver for small problems
+#include "osqpbandedpy.h"       // Banded linear system solver for staged problems
+#include "osqpboxpy.h"          // Elimination of box constraints
+#include "osqporderingpy.h"     // Fill-reducing orderings of the KKT matrix
 #include "osqpworkspacepy.h"    // OSQP workspace
+#include "osqpasyncpy.h"        // Worker pool of the asynchronous solves
 #include "osqpobjectpy.h"       // OSQP object
 #include "osqpmodulemethods.h"  // OSQP module methods independently from any OSQP object
 
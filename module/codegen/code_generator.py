@@ -13,7 +13,8 @@ from . import utils
 
 
 def codegen(work, target_dir, python_ext_name, project_type, embedded,
-            force_rewrite, float_flag, long_flag):
+            force_rewrite, float_flag, long_flag, binary_data=False,
+            rho_policy=None, specialize_kernels=False, trim_unused=False):
     """
     Generate code
     """
@@ -88,6 +89,9 @@ def codegen(work, target_dir, python_ext_name, project_type, embedded,
                                       'src', 'kkt.c'))
     for source in c_sources:
         sh.copy(source, os.path.join(target_src_dir, 'osqp'))
+    if specialize_kernels:
+        # The generated kernels dispatch to the generic ones
+        utils.rename_generic_kernels(os.path.join(target_src_dir, 'osqp'))
 
     # Copy header files
     c_headers = glob(os.path.join(osqp_path, 'codegen', 'sources',
@@ -116,7 +120,13 @@ def codegen(work, target_dir, python_ext_name, project_type, embedded,
                      'linsys_solver':   work['linsys_solver'],
                      'scaling':         work['scaling'],
                      'embedded_flag':   embedded,
-                     'python_ext_name': python_ext_name}
+                     'python_ext_name': python_ext_name,
+                     'float_flag':      float_flag,
+                     'long_flag':       long_flag,
+                     'binary_data':     binary_data,
+                     'rho_policy':      rho_policy,
+                     'specialize_kernels': specialize_kernels,
+                     'trim_unused':     trim_unused}
 
     # Add cmake args
     cmake_args = '-DEMBEDDED:INT=%d -DDFLOAT:BOOL=%s -DDLONG:BOOL=%s' % \
@@ -127,6 +137,10 @@ def codegen(work, target_dir, python_ext_name, project_type, embedded,
                            os.path.join(target_include_dir, 'workspace.h'),
                            os.path.join(target_src_dir, 'osqp', 'workspace.c'))
 
+    # Write footprint report
+    utils.render_footprint(template_vars,
+                           os.path.join(target_dir, 'footprint.json'))
+
     # Render setup.py
     utils.render_setuppy(template_vars,
                          os.path.join(target_src_dir, 'setup.py'))
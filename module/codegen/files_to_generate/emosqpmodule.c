@@ -211,9 +211,20 @@ static PyArrayObject *get_contiguous(PyArrayObject *array, int typenum) {
 ************************/
 
 
-// Solve Optimization Problem
-static PyObject * OSQP_solve(PyObject *self, PyObject *args)
+// Solve with the rho policy generated in the workspace, if any
+static c_int work_osqp_solve(OSQPWorkspace *work) {
+#ifdef RHO_POLICY
+    return rho_policy_solve(work);
+#else
+    return osqp_solve(work);
+#endif
+}
+
+// Solve the problem of a workspace
+static PyObject * work_solve(OSQPWorkspace *work, int release_gil)
 {
+    c_int exitflag;
+
     // Allocate timer
     PyTimer * timer;
     c_float solve_time;
@@ -222,8 +233,8 @@ static PyObject * OSQP_solve(PyObject *self, PyObject *args)
     PyObject * x, *y;
 
     // Temporary solution
-    npy_intp nd[] = {(npy_intp)(&workspace)->data->n}; // Dimensions in R^n
-    npy_intp md[] = {(npy_intp)(&workspace)->data->m}; // Dimensions in R^m
+    npy_intp nd[] = {(npy_intp)work->data->n}; // Dimensions in R^n
+    npy_intp md[] = {(npy_intp)work->data->m}; // Dimensions in R^m
 
 
     // Initialize timer
@@ -233,7 +244,14 @@ static PyObject * OSQP_solve(PyObject *self, PyObject *args)
     /**
      *  Solve QP Problem
      */
-    if (osqp_solve((&workspace)) == -1){
+    if (release_gil) {
+        Py_BEGIN_ALLOW_THREADS
+        exitflag = work_osqp_solve(work);
+        Py_END_ALLOW_THREADS
+    } else {
+        exitflag = work_osqp_solve(work);
+    }
+    if (exitflag == -1){
 		PySys_WriteStdout("Error: Workspace not initialized!\n");
 	}
 
@@ -241,14 +259,14 @@ static PyObject * OSQP_solve(PyObject *self, PyObject *args)
     solve_time = toc(timer);
 
     // If problem is not primal or dual infeasible store it
-    if (((&workspace)->info->status_val != OSQP_PRIMAL_INFEASIBLE) &&
-		    ((&workspace)->info->status_val != OSQP_PRIMAL_INFEASIBLE_INACCURATE) &&
-            ((&workspace)->info->status_val != OSQP_DUAL_INFEASIBLE) &&
-    		((&workspace)->info->status_val != OSQP_DUAL_INFEASIBLE_INACCURATE)) {
+    if ((work->info->status_val != OSQP_PRIMAL_INFEASIBLE) &&
+		    (work->info->status_val != OSQP_PRIMAL_INFEASIBLE_INACCURATE) &&
+            (work->info->status_val != OSQP_DUAL_INFEASIBLE) &&
+    		(work->info->status_val != OSQP_DUAL_INFEASIBLE_INACCURATE)) {
 
         // Construct primal and dual solution arrays
-        x = (PyObject *)PyArrayFromCArray((&workspace)->solution->x, nd);
-        y = (PyObject *)PyArrayFromCArray((&workspace)->solution->y, md);
+        x = (PyObject *)PyArrayFromCArray(work->solution->x, nd);
+        y = (PyObject *)PyArrayFromCArray(work->solution->y, md);
 
     } else { // Problem primal or dual infeasible -> None values for x,y
         x = PyArray_EMPTY(1, nd, NPY_OBJECT, 0);
@@ -259,14 +277,14 @@ static PyObject * OSQP_solve(PyObject *self, PyObject *args)
     PyMem_Free(timer);
 
     // Return struct
-    return Py_BuildValue("OOiid", x, y, (&workspace)->info->status_val,
-                         (&workspace)->info->iter, solve_time);
+    return Py_BuildValue("NNiid", x, y, work->info->status_val,
+                         work->info->iter, solve_time);
 
 }
 
 
 
-static PyObject *OSQP_update_lin_cost(PyObject *self, PyObject *args){
+static PyObject *work_update_lin_cost(OSQPWorkspace *work, PyObject *args){
     PyArrayObject *q, *q_cont;
     c_float * q_arr;
     int float_type = get_float_type();
@@ -280,7 +298,7 @@ static PyObject *OSQP_update_lin_cost(PyObject *self, PyObject *args){
     }
 
     // Check dimension
-    if (PyArray_DIM(q, 0) != (&workspace)->data->n){
+    if (PyArray_DIM(q, 0) != work->data->n){
         PySys_WriteStdout("Error in linear cost dimension!\n");
         return NULL;
     }
@@ -292,7 +310,7 @@ static PyObject *OSQP_update_lin_cost(PyObject *self, PyObject *args){
     q_arr = (c_float *)PyArray_DATA(q_cont);
 
     // Update linear cost
-    osqp_update_lin_cost((&workspace), q_arr);
+    osqp_update_lin_cost(work, q_arr);
 
     // Free data
     Py_DECREF(q_cont);
@@ -303,7 +321,7 @@ static PyObject *OSQP_update_lin_cost(PyObject *self, PyObject *args){
 
 }
 
-static PyObject *OSQP_update_lower_bound(PyObject *self, PyObject *args){
+static PyObject *work_update_lower_bound(OSQPWorkspace *work, PyObject *args){
     PyArrayObject *l, *l_cont;
     c_float * l_arr;
     int float_type = get_float_type();
@@ -317,7 +335,7 @@ static PyObject *OSQP_update_lower_bound(PyObject *self, PyObject *args){
     }
 
     // Check dimension
-    if (PyArray_DIM(l, 0) != (&workspace)->data->m){
+    if (PyArray_DIM(l, 0) != work->data->m){
         PySys_WriteStdout("Error in lower bound dimension!\n");
         return NULL;
     }
@@ -329,7 +347,7 @@ static PyObject *OSQP_update_lower_bound(PyObject *self, PyObject *args){
     l_arr = (c_float *)PyArray_DATA(l_cont);
 
     // Update linear cost
-    osqp_update_lower_bound((&workspace), l_arr);
+    osqp_update_lower_bound(work, l_arr);
 
     // Free data
     Py_DECREF(l_cont);
@@ -340,7 +358,7 @@ static PyObject *OSQP_update_lower_bound(PyObject *self, PyObject *args){
 
 }
 
-static PyObject *OSQP_update_upper_bound(PyObject *self, PyObject *args){
+static PyObject *work_update_upper_bound(OSQPWorkspace *work, PyObject *args){
     PyArrayObject *u, *u_cont;
     c_float * u_arr;
     int float_type = get_float_type();
@@ -354,7 +372,7 @@ static PyObject *OSQP_update_upper_bound(PyObject *self, PyObject *args){
     }
 
     // Check dimension
-    if (PyArray_DIM(u, 0) != (&workspace)->data->m){
+    if (PyArray_DIM(u, 0) != work->data->m){
         PySys_WriteStdout("Error in upper bound dimension!\n");
         return NULL;
     }
@@ -366,7 +384,7 @@ static PyObject *OSQP_update_upper_bound(PyObject *self, PyObject *args){
     u_arr = (c_float *)PyArray_DATA(u_cont);
 
     // Update linear cost
-    osqp_update_upper_bound((&workspace), u_arr);
+    osqp_update_upper_bound(work, u_arr);
 
     // Free data
     Py_DECREF(u_cont);
@@ -378,7 +396,7 @@ static PyObject *OSQP_update_upper_bound(PyObject *self, PyObject *args){
 }
 
 
-static PyObject *OSQP_update_bounds(PyObject *self, PyObject *args){
+static PyObject *work_update_bounds(OSQPWorkspace *work, PyObject *args){
     PyArrayObject *l, *l_cont, *u, *u_cont;
     c_float * l_arr, * u_arr;
     int float_type = get_float_type();
@@ -394,13 +412,13 @@ static PyObject *OSQP_update_bounds(PyObject *self, PyObject *args){
     }
 
     // Check dimension
-    if (PyArray_DIM(u, 0) != (&workspace)->data->m){
+    if (PyArray_DIM(u, 0) != work->data->m){
         PySys_WriteStdout("Error in upper bound dimension!\n");
         return NULL;
     }
 
     // Check dimension
-    if (PyArray_DIM(l, 0) != (&workspace)->data->m){
+    if (PyArray_DIM(l, 0) != work->data->m){
         PySys_WriteStdout("Error in lower bound dimension!\n");
         return NULL;
     }
@@ -419,7 +437,7 @@ static PyObject *OSQP_update_bounds(PyObject *self, PyObject *args){
     l_arr = (c_float *)PyArray_DATA(l_cont);
 
     // Update linear cost
-    osqp_update_bounds((&workspace), l_arr, u_arr);
+    osqp_update_bounds(work, l_arr, u_arr);
 
     // Free data
     Py_DECREF(u_cont);
@@ -432,6 +450,150 @@ static PyObject *OSQP_update_bounds(PyObject *self, PyObject *args){
 }
 
 
+
+// Solve Optimization Problem
+static PyObject * OSQP_solve(PyObject *self, PyObject *args)
+{
+    return work_solve((&workspace), 0);
+}
+
+static PyObject *OSQP_update_lin_cost(PyObject *self, PyObject *args){
+    return work_update_lin_cost((&workspace), args);
+}
+
+static PyObject *OSQP_update_lower_bound(PyObject *self, PyObject *args){
+    return work_update_lower_bound((&workspace), args);
+}
+
+static PyObject *OSQP_update_upper_bound(PyObject *self, PyObject *args){
+    return work_update_upper_bound((&workspace), args);
+}
+
+static PyObject *OSQP_update_bounds(PyObject *self, PyObject *args){
+    return work_update_bounds((&workspace), args);
+}
+
+
+#if EMBEDDED == 1
+
+/************************
+* Instances            *
+************************/
+
+/*
+ * Instances of the problem own their vectors and iterates and share the
+ * matrices and the factorization of the workspace, which never change with
+ * EMBEDDED = 1. solve releases the GIL, so different instances can be
+ * solved concurrently.
+ */
+typedef struct {
+    PyObject_HEAD
+    int busy;               // Whether the instance is being solved
+    OSQPInstance instance;
+} Instance;
+
+static int Instance_check(Instance *self) {
+    if (self->busy) {
+        PyErr_SetString(PyExc_ValueError, "Instance is being solved!");
+        return 0;
+    }
+    return 1;
+}
+
+static int Instance_init(Instance *self, PyObject *args, PyObject *kwds) {
+    static char *kwlist[] = {NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "", kwlist)) {
+        return -1;
+    }
+    if (!Instance_check(self)) return -1;
+    init_instance(&self->instance);
+    return 0;
+}
+
+static PyObject *Instance_solve(Instance *self, PyObject *args) {
+    PyObject *res;
+
+    if (!Instance_check(self)) return NULL;
+    self->busy = 1;
+    res = work_solve(&self->instance.work, 1);
+    self->busy = 0;
+    return res;
+}
+
+static PyObject *Instance_update_lin_cost(Instance *self, PyObject *args) {
+    if (!Instance_check(self)) return NULL;
+    return work_update_lin_cost(&self->instance.work, args);
+}
+
+static PyObject *Instance_update_lower_bound(Instance *self, PyObject *args) {
+    if (!Instance_check(self)) return NULL;
+    return work_update_lower_bound(&self->instance.work, args);
+}
+
+static PyObject *Instance_update_upper_bound(Instance *self, PyObject *args) {
+    if (!Instance_check(self)) return NULL;
+    return work_update_upper_bound(&self->instance.work, args);
+}
+
+static PyObject *Instance_update_bounds(Instance *self, PyObject *args) {
+    if (!Instance_check(self)) return NULL;
+    return work_update_bounds(&self->instance.work, args);
+}
+
+static PyMethodDef Instance_methods[] = {
+	{"solve", (PyCFunction)Instance_solve, METH_NOARGS, "Solve QP"},
+	{"update_lin_cost", (PyCFunction)Instance_update_lin_cost, METH_VARARGS, "Update linear cost"},
+	{"update_lower_bound", (PyCFunction)Instance_update_lower_bound, METH_VARARGS, "Update lower bound"},
+	{"update_upper_bound", (PyCFunction)Instance_update_upper_bound, METH_VARARGS, "Update upper bound"},
+	{"update_bounds", (PyCFunction)Instance_update_bounds, METH_VARARGS, "Update bounds"},
+	{NULL, NULL, 0, NULL}
+};
+
+static PyTypeObject Instance_Type = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    "PYTHON_EXT_NAME.Instance",             /* tp_name */
+    sizeof(Instance),                       /* tp_basicsize */
+    0,                                      /* tp_itemsize */
+    0,                                      /* tp_dealloc */
+    0,                                      /* tp_print */
+    0,                                      /* tp_getattr */
+    0,                                      /* tp_setattr */
+    0,                                      /* tp_as_async */
+    0,                                      /* tp_repr */
+    0,                                      /* tp_as_number */
+    0,                                      /* tp_as_sequence */
+    0,                                      /* tp_as_mapping */
+    0,                                      /* tp_hash */
+    0,                                      /* tp_call */
+    0,                                      /* tp_str */
+    0,                                      /* tp_getattro */
+    0,                                      /* tp_setattro */
+    0,                                      /* tp_as_buffer */
+    Py_TPFLAGS_DEFAULT,                     /* tp_flags */
+    "Instance of the embedded problem with its own vectors", /* tp_doc */
+    0,                                      /* tp_traverse */
+    0,                                      /* tp_clear */
+    0,                                      /* tp_richcompare */
+    0,                                      /* tp_weaklistoffset */
+    0,                                      /* tp_iter */
+    0,                                      /* tp_iternext */
+    Instance_methods,                       /* tp_methods */
+    0,                                      /* tp_members */
+    0,                                      /* tp_getset */
+    0,                                      /* tp_base */
+    0,                                      /* tp_dict */
+    0,                                      /* tp_descr_get */
+    0,                                      /* tp_descr_set */
+    0,                                      /* tp_dictoffset */
+    (initproc)Instance_init,                /* tp_init */
+    0,                                      /* tp_alloc */
+    PyType_GenericNew,                      /* tp_new */
+};
+
+#endif	// end EMBEDDED == 1
+
+
 #if EMBEDDED != 1
 
 // Get integer type from OSQP setup
@@ -703,6 +865,13 @@ static PyObject * moduleinit(void){
     if (m == NULL)
     		return NULL;
 
+#if EMBEDDED == 1
+    if (PyType_Ready(&Instance_Type) < 0)
+        return NULL;
+    Py_INCREF(&Instance_Type);
+    PyModule_AddObject(m, "Instance", (PyObject *)&Instance_Type);
+#endif
+
     return m;
 }
 
@@ -26,6 +26,9 @@ cmake_args = []
 embedded_flag = EMBEDDED_FLAG
 cmake_args += ['-DEMBEDDED:INT=%i' % embedded_flag]
 
+# The types have to match the ones of the generated workspace
+cmake_args += ['-DDFLOAT:BOOL=FLOAT_FLAG', '-DDLONG:BOOL=LONG_FLAG']
+
 # Pass Python flag to compile interface
 define_macros = []
 define_macros += [('PYTHON', None)]
@@ -45,6 +48,9 @@ Define compiler flags
 '''
 if system() != 'Windows':
     compile_args = ["-O3"]
+    # The assembler embeds the binary workspace, if any, from the osqp
+    # directory
+    compile_args += ["-Wa,-I" + os.path.abspath('osqp')]
 else:
     compile_args = []
 
@@ -57,6 +63,7 @@ if system() == 'Linux':
 Include directory
 '''
 include_dirs = [os.path.join('..', 'include')]  # OSQP includes
+include_dirs += ['osqp']                         # Binary workspace
 
 '''
 Source files
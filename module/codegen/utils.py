@@ -13,12 +13,109 @@ files_to_generate_path = os.path.join(osqp.__path__[0],
 
 # Timestamp
 import datetime
+import json
+import re
 
+import numpy as np
 
-def write_vec(f, vec, name, vec_type):
+
+# Number of features of a constraint given to the rho policy
+rho_policy_features = 7
+
+
+class WorkspaceBlob(object):
+    """
+    Binary file with the arrays of the workspace, in the native byte order.
+    The C sources define the arrays as pointers into the file, which the
+    assembler embeds in the data section with .incbin
+    """
+
+    # Alignment of the arrays in bytes
+    align = 8
+
+    def __init__(self, fname, float_flag, long_flag):
+        self.fname = fname
+        self.float_type = np.float32 if float_flag == 'ON' else np.float64
+        self.int_type = np.int64 if long_flag == 'ON' else np.int32
+        self.offsets = {}
+        self.size = 0
+        self.f = open(fname, 'wb')
+
+    def add(self, vec, name, vec_type):
+        """
+        Append vector to the blob and return its offset
+        """
+        if vec_type in ('c_float', 'QDLDL_float'):
+            arr = np.ascontiguousarray(vec, dtype=self.float_type)
+        else:
+            arr = np.ascontiguousarray(vec, dtype=self.int_type)
+
+        pad = -self.size % self.align
+        self.f.write(b'\0' * pad)
+        arr.tofile(self.f)
+        self.offsets[name] = self.size + pad
+        self.size += pad + arr.nbytes
+        return self.offsets[name]
+
+    def close(self):
+        self.f.close()
+
+
+def write_blob_vec(f, name, vec_type, offset):
+    """
+    Write vector defined as a pointer into the blob to file
+    """
+    f.write('#define %s ((%s *)(workspace_blob + %d))\n' %
+            (name, vec_type, offset))
+
+
+def write_blob_src(f, blob):
+    """
+    Embed the blob in the data section, where the arrays can be updated
+    """
+    f.write("// Arrays of the workspace, stored in workspace.bin. The assembler\n")
+    f.write("// looks for the file in the directories given with -Wa,-I (GCC)\n")
+    f.write("// or -I (Clang), which the build files set to this directory.\n")
+    f.write("#ifndef WORKSPACE_BLOB_FILE\n")
+    f.write("#define WORKSPACE_BLOB_FILE \"%s\"\n" %
+            os.path.basename(blob.fname))
+    f.write("#endif\n\n")
+    f.write("#if !defined(__GNUC__)\n")
+    f.write("#error \"The binary workspace requires the .incbin directive of GCC or Clang\"\n")
+    f.write("#endif\n\n")
+    f.write("typedef char workspace_blob_types[(sizeof(c_float) == %d && "
+            "sizeof(c_int) == %d) ? 1 : -1];\n\n" %
+            (np.dtype(blob.float_type).itemsize,
+             np.dtype(blob.int_type).itemsize))
+    f.write("#define WORKSPACE_BLOB_STR_(x) #x\n")
+    f.write("#define WORKSPACE_BLOB_STR(x) WORKSPACE_BLOB_STR_(x)\n")
+    f.write("#define WORKSPACE_BLOB_SYMBOL "
+            "WORKSPACE_BLOB_STR(__USER_LABEL_PREFIX__) \"workspace_blob\"\n\n")
+    f.write("__asm__(\".data\\n\"\n")
+    f.write("        \".balign 16\\n\"\n")
+    f.write("        \".globl \" WORKSPACE_BLOB_SYMBOL \"\\n\"\n")
+    f.write("        WORKSPACE_BLOB_SYMBOL \":\\n\"\n")
+    f.write("        \".incbin \\\"\" WORKSPACE_BLOB_FILE \"\\\"\\n\"\n")
+    f.write("        \".text\\n\");\n\n")
+    f.write("extern unsigned char workspace_blob[];\n\n")
+
+
+def write_blob_inc(f, blob):
+    """
+    Write blob prototype to file
+    """
+    f.write("// Arrays of the workspace, stored in workspace.bin\n")
+    f.write("extern unsigned char workspace_blob[];\n\n")
+
+
+def write_vec(f, vec, name, vec_type, blob=None):
     """
     Write vector to file
     """
+    if blob is not None:
+        write_blob_vec(f, name, vec_type, blob.add(vec, name, vec_type))
+        return
+
     f.write('%s %s[%d] = {\n' % (vec_type, name, len(vec)))
 
     # Write vector elements
@@ -31,20 +128,24 @@ def write_vec(f, vec, name, vec_type):
     f.write('};\n')
 
 
-def write_vec_extern(f, vec, name, vec_type):
+def write_vec_extern(f, vec, name, vec_type, blob=None):
     """
     Write vector prototype to file
     """
+    if blob is not None:
+        write_blob_vec(f, name, vec_type, blob.offsets[name])
+        return
+
     f.write("extern %s %s[%d];\n" % (vec_type, name, len(vec)))
 
 
-def write_mat(f, mat, name):
+def write_mat(f, mat, name, blob=None):
     """
     Write scipy sparse matrix in CSC form to file
     """
-    write_vec(f, mat['i'], name + '_i', 'c_int')
-    write_vec(f, mat['p'], name + '_p', 'c_int')
-    write_vec(f, mat['x'], name + '_x', 'c_float')
+    write_vec(f, mat['i'], name + '_i', 'c_int', blob)
+    write_vec(f, mat['p'], name + '_p', 'c_int', blob)
+    write_vec(f, mat['x'], name + '_x', 'c_float', blob)
 
     f.write("csc %s = {" % name)
     f.write("%d, " % mat['nzmax'])
@@ -56,29 +157,33 @@ def write_mat(f, mat, name):
     f.write("%d};\n" % mat['nz'])
 
 
-def write_mat_extern(f, mat, name):
+def write_mat_extern(f, mat, name, blob=None):
     """
     Write matrix prototype to file
     """
+    if blob is not None:
+        write_vec_extern(f, mat['i'], name + '_i', 'c_int', blob)
+        write_vec_extern(f, mat['p'], name + '_p', 'c_int', blob)
+        write_vec_extern(f, mat['x'], name + '_x', 'c_float', blob)
     f.write("extern csc %s;\n" % name)
 
 
-def write_data_src(f, data):
+def write_data_src(f, data, blob=None):
     """
     Write data structure to file
     """
     f.write("// Define data structure\n")
 
     # Define matrix P
-    write_mat(f, data['P'], 'Pdata')
+    write_mat(f, data['P'], 'Pdata', blob)
 
     # Define matrix A
-    write_mat(f, data['A'], 'Adata')
+    write_mat(f, data['A'], 'Adata', blob)
 
     # Define other data vectors
-    write_vec(f, data['q'], 'qdata', 'c_float')
-    write_vec(f, data['l'], 'ldata', 'c_float')
-    write_vec(f, data['u'], 'udata', 'c_float')
+    write_vec(f, data['q'], 'qdata', 'c_float', blob)
+    write_vec(f, data['l'], 'ldata', 'c_float', blob)
+    write_vec(f, data['u'], 'udata', 'c_float', blob)
 
     # Define data structure
     f.write("OSQPData data = {")
@@ -88,22 +193,22 @@ def write_data_src(f, data):
     f.write("};\n\n")
 
 
-def write_data_inc(f, data):
+def write_data_inc(f, data, blob=None):
     """
     Write data structure prototypes to file
     """
     f.write("// Data structure prototypes\n")
 
     # Define matrix P
-    write_mat_extern(f, data['P'], 'Pdata')
+    write_mat_extern(f, data['P'], 'Pdata', blob)
 
     # Define matrix A
-    write_mat_extern(f, data['A'], 'Adata')
+    write_mat_extern(f, data['A'], 'Adata', blob)
 
     # Define other data vectors
-    write_vec_extern(f, data['q'], 'qdata', 'c_float')
-    write_vec_extern(f, data['l'], 'ldata', 'c_float')
-    write_vec_extern(f, data['u'], 'udata', 'c_float')
+    write_vec_extern(f, data['q'], 'qdata', 'c_float', blob)
+    write_vec_extern(f, data['l'], 'ldata', 'c_float', blob)
+    write_vec_extern(f, data['u'], 'udata', 'c_float', blob)
 
     # Define data structure
     f.write("extern OSQPData data;\n\n")
@@ -147,16 +252,16 @@ def write_settings_inc(f, settings, embedded_flag):
     f.write("extern OSQPSettings settings;\n\n")
 
 
-def write_scaling_src(f, scaling):
+def write_scaling_src(f, scaling, blob=None):
     """
     Write scaling structure to file
     """
     f.write("// Define scaling structure\n")
     if scaling is not None:
-        write_vec(f, scaling['D'],    'Dscaling',    'c_float')
-        write_vec(f, scaling['Dinv'], 'Dinvscaling', 'c_float')
-        write_vec(f, scaling['E'],    'Escaling',    'c_float')
-        write_vec(f, scaling['Einv'], 'Einvscaling', 'c_float')
+        write_vec(f, scaling['D'],    'Dscaling',    'c_float', blob)
+        write_vec(f, scaling['Dinv'], 'Dinvscaling', 'c_float', blob)
+        write_vec(f, scaling['E'],    'Escaling',    'c_float', blob)
+        write_vec(f, scaling['Einv'], 'Einvscaling', 'c_float', blob)
         f.write("OSQPScaling scaling = {")
         f.write("(c_float)%.20f, " % scaling['c'])
         f.write("Dscaling, Escaling, ")
@@ -166,43 +271,43 @@ def write_scaling_src(f, scaling):
         f.write("OSQPScaling scaling;\n\n")
 
 
-def write_scaling_inc(f, scaling):
+def write_scaling_inc(f, scaling, blob=None):
     """
     Write prototypes for the scaling structure to file
     """
     f.write("// Scaling structure prototypes\n")
 
     if scaling is not None:
-        write_vec_extern(f, scaling['D'],    'Dscaling',    'c_float')
-        write_vec_extern(f, scaling['Dinv'], 'Dinvscaling', 'c_float')
-        write_vec_extern(f, scaling['E'],    'Escaling',    'c_float')
-        write_vec_extern(f, scaling['Einv'], 'Einvscaling', 'c_float')
+        write_vec_extern(f, scaling['D'],    'Dscaling',    'c_float', blob)
+        write_vec_extern(f, scaling['Dinv'], 'Dinvscaling', 'c_float', blob)
+        write_vec_extern(f, scaling['E'],    'Escaling',    'c_float', blob)
+        write_vec_extern(f, scaling['Einv'], 'Einvscaling', 'c_float', blob)
 
     f.write("extern OSQPScaling scaling;\n\n")
 
 
-def write_linsys_solver_src(f, linsys_solver, embedded_flag):
+def write_linsys_solver_src(f, linsys_solver, embedded_flag, blob=None):
     """
     Write linsys_solver structure to file
     """
 
     f.write("// Define linsys_solver structure\n")
-    write_mat(f, linsys_solver['L'],            'linsys_solver_L')
-    write_vec(f, linsys_solver['Dinv'],         'linsys_solver_Dinv',           'c_float')
-    write_vec(f, linsys_solver['P'],            'linsys_solver_P',              'c_int')
+    write_mat(f, linsys_solver['L'],            'linsys_solver_L', blob)
+    write_vec(f, linsys_solver['Dinv'],         'linsys_solver_Dinv',           'c_float', blob)
+    write_vec(f, linsys_solver['P'],            'linsys_solver_P',              'c_int', blob)
     f.write("c_float linsys_solver_bp[%d];\n"  % (len(linsys_solver['bp'])))
     f.write("c_float linsys_solver_sol[%d];\n" % (len(linsys_solver['sol'])))
-    write_vec(f, linsys_solver['rho_inv_vec'],  'linsys_solver_rho_inv_vec',    'c_float')
+    write_vec(f, linsys_solver['rho_inv_vec'],  'linsys_solver_rho_inv_vec',    'c_float', blob)
 
     if embedded_flag != 1:
-        write_vec(f, linsys_solver['Pdiag_idx'], 'linsys_solver_Pdiag_idx', 'c_int')
-        write_mat(f, linsys_solver['KKT'],       'linsys_solver_KKT')
-        write_vec(f, linsys_solver['PtoKKT'],    'linsys_solver_PtoKKT',    'c_int')
-        write_vec(f, linsys_solver['AtoKKT'],    'linsys_solver_AtoKKT',    'c_int')
-        write_vec(f, linsys_solver['rhotoKKT'],  'linsys_solver_rhotoKKT',  'c_int')
-        write_vec(f, linsys_solver['D'],         'linsys_solver_D',         'QDLDL_float')
-        write_vec(f, linsys_solver['etree'],     'linsys_solver_etree',     'QDLDL_int')
-        write_vec(f, linsys_solver['Lnz'],       'linsys_solver_Lnz',       'QDLDL_int')
+        write_vec(f, linsys_solver['Pdiag_idx'], 'linsys_solver_Pdiag_idx', 'c_int', blob)
+        write_mat(f, linsys_solver['KKT'],       'linsys_solver_KKT', blob)
+        write_vec(f, linsys_solver['PtoKKT'],    'linsys_solver_PtoKKT',    'c_int', blob)
+        write_vec(f, linsys_solver['AtoKKT'],    'linsys_solver_AtoKKT',    'c_int', blob)
+        write_vec(f, linsys_solver['rhotoKKT'],  'linsys_solver_rhotoKKT',  'c_int', blob)
+        write_vec(f, linsys_solver['D'],         'linsys_solver_D',         'QDLDL_float', blob)
+        write_vec(f, linsys_solver['etree'],     'linsys_solver_etree',     'QDLDL_int', blob)
+        write_vec(f, linsys_solver['Lnz'],       'linsys_solver_Lnz',       'QDLDL_int', blob)
         f.write("QDLDL_int   linsys_solver_iwork[%d];\n" % len(linsys_solver['iwork']))
         f.write("QDLDL_bool  linsys_solver_bwork[%d];\n" % len(linsys_solver['bwork']))
         f.write("QDLDL_float linsys_solver_fwork[%d];\n" % len(linsys_solver['fwork']))
@@ -228,27 +333,27 @@ def write_linsys_solver_src(f, linsys_solver, embedded_flag):
     f.write("};\n\n")
 
 
-def write_linsys_solver_inc(f, linsys_solver, embedded_flag):
+def write_linsys_solver_inc(f, linsys_solver, embedded_flag, blob=None):
     """
     Write prototypes for linsys_solver structure to file
     """
     f.write("// Prototypes for linsys_solver structure\n")
-    write_mat_extern(f, linsys_solver['L'],    'linsys_solver_L')
-    write_vec_extern(f, linsys_solver['Dinv'], 'linsys_solver_Dinv', 'c_float')
-    write_vec_extern(f, linsys_solver['P'],    'linsys_solver_P',    'c_int')
+    write_mat_extern(f, linsys_solver['L'],    'linsys_solver_L', blob)
+    write_vec_extern(f, linsys_solver['Dinv'], 'linsys_solver_Dinv', 'c_float', blob)
+    write_vec_extern(f, linsys_solver['P'],    'linsys_solver_P',    'c_int', blob)
     f.write("extern c_float linsys_solver_bp[%d];\n"  % len(linsys_solver['bp']))
     f.write("extern c_float linsys_solver_sol[%d];\n" % len(linsys_solver['sol']))
-    write_vec_extern(f, linsys_solver['rho_inv_vec'], 'linsys_solver_rho_inv_vec', 'c_float')
+    write_vec_extern(f, linsys_solver['rho_inv_vec'], 'linsys_solver_rho_inv_vec', 'c_float', blob)
 
     if embedded_flag != 1:
-        write_vec_extern(f, linsys_solver['Pdiag_idx'], 'linsys_solver_Pdiag_idx', 'c_int')
-        write_mat_extern(f, linsys_solver['KKT'],       'linsys_solver_KKT')
-        write_vec_extern(f, linsys_solver['PtoKKT'],    'linsys_solver_PtoKKT',    'c_int')
-        write_vec_extern(f, linsys_solver['AtoKKT'],    'linsys_solver_AtoKKT',    'c_int')
-        write_vec_extern(f, linsys_solver['rhotoKKT'],  'linsys_solver_rhotoKKT',  'c_int')
-        write_vec_extern(f, linsys_solver['D'],         'linsys_solver_D',         'QDLDL_float')
-        write_vec_extern(f, linsys_solver['etree'],     'linsys_solver_etree',     'QDLDL_int')
-        write_vec_extern(f, linsys_solver['Lnz'],       'linsys_solver_Lnz',       'QDLDL_int')
+        write_vec_extern(f, linsys_solver['Pdiag_idx'], 'linsys_solver_Pdiag_idx', 'c_int', blob)
+        write_mat_extern(f, linsys_solver['KKT'],       'linsys_solver_KKT', blob)
+        write_vec_extern(f, linsys_solver['PtoKKT'],    'linsys_solver_PtoKKT',    'c_int', blob)
+        write_vec_extern(f, linsys_solver['AtoKKT'],    'linsys_solver_AtoKKT',    'c_int', blob)
+        write_vec_extern(f, linsys_solver['rhotoKKT'],  'linsys_solver_rhotoKKT',  'c_int', blob)
+        write_vec_extern(f, linsys_solver['D'],         'linsys_solver_D',         'QDLDL_float', blob)
+        write_vec_extern(f, linsys_solver['etree'],     'linsys_solver_etree',     'QDLDL_int', blob)
+        write_vec_extern(f, linsys_solver['Lnz'],       'linsys_solver_Lnz',       'QDLDL_int', blob)
         f.write("extern QDLDL_int   linsys_solver_iwork[%d];\n" % len(linsys_solver['iwork']))
         f.write("extern QDLDL_bool  linsys_solver_bwork[%d];\n" % len(linsys_solver['bwork']))
         f.write("extern QDLDL_float linsys_solver_fwork[%d];\n" % len(linsys_solver['fwork']))
@@ -292,17 +397,18 @@ def write_info_inc(f):
     f.write("extern OSQPInfo info;\n\n")
 
 
-def write_workspace_src(f, n, m, rho_vectors, embedded_flag):
+def write_workspace_src(f, n, m, rho_vectors, embedded_flag, blob=None,
+                        trim=False):
     """
     Preallocate workspace structure and populate rho vectors
     """
 
     f.write("// Define workspace\n")
 
-    write_vec(f, rho_vectors['rho_vec'],     'work_rho_vec',     'c_float')
-    write_vec(f, rho_vectors['rho_inv_vec'], 'work_rho_inv_vec', 'c_float')
+    write_vec(f, rho_vectors['rho_vec'],     'work_rho_vec',     'c_float', blob)
+    write_vec(f, rho_vectors['rho_inv_vec'], 'work_rho_inv_vec', 'c_float', blob)
     if embedded_flag != 1:
-        write_vec(f, rho_vectors['constr_type'], 'work_constr_type', 'c_int')
+        write_vec(f, rho_vectors['constr_type'], 'work_constr_type', 'c_int', blob)
 
     f.write("c_float work_x[%d];\n" % n)
     f.write("c_float work_y[%d];\n" % m)
@@ -318,9 +424,12 @@ def write_workspace_src(f, n, m, rho_vectors, embedded_flag):
     f.write("c_float work_delta_x[%d];\n" % n)
     f.write("c_float work_Pdelta_x[%d];\n" % n)
     f.write("c_float work_Adelta_x[%d];\n" % m)
-    f.write("c_float work_D_temp[%d];\n" % n)
-    f.write("c_float work_D_temp_A[%d];\n" % n)
-    f.write("c_float work_E_temp[%d];\n\n" % m)
+    if not trim:
+        # Only used to scale the data
+        f.write("c_float work_D_temp[%d];\n" % n)
+        f.write("c_float work_D_temp_A[%d];\n" % n)
+        f.write("c_float work_E_temp[%d];\n" % m)
+    f.write("\n")
 
     f.write("OSQPWorkspace workspace = {\n")
     f.write("&data, (LinSysSolver *)&linsys_solver,\n")
@@ -333,19 +442,23 @@ def write_workspace_src(f, n, m, rho_vectors, embedded_flag):
     f.write("work_Ax, work_Px, work_Aty,\n")
     f.write("work_delta_y, work_Atdelta_y,\n")
     f.write("work_delta_x, work_Pdelta_x, work_Adelta_x,\n")
-    f.write("work_D_temp, work_D_temp_A, work_E_temp,\n")
+    if not trim:
+        f.write("work_D_temp, work_D_temp_A, work_E_temp,\n")
+    else:
+        f.write("OSQP_NULL, OSQP_NULL, OSQP_NULL,\n")
     f.write("&settings, &scaling, &solution, &info};\n\n")
 
 
-def write_workspace_inc(f, n, m, rho_vectors, embedded_flag):
+def write_workspace_inc(f, n, m, rho_vectors, embedded_flag, blob=None,
+                        trim=False):
     """
     Prototypes for the workspace structure and rho_vectors
     """
     f.write("// Prototypes for the workspace\n")
-    write_vec_extern(f, rho_vectors['rho_vec'],     'work_rho_vec',     'c_float')
-    write_vec_extern(f, rho_vectors['rho_inv_vec'], 'work_rho_inv_vec', 'c_float')
+    write_vec_extern(f, rho_vectors['rho_vec'],     'work_rho_vec',     'c_float', blob)
+    write_vec_extern(f, rho_vectors['rho_inv_vec'], 'work_rho_inv_vec', 'c_float', blob)
     if embedded_flag != 1:
-        write_vec_extern(f, rho_vectors['constr_type'], 'work_constr_type', 'c_int')
+        write_vec_extern(f, rho_vectors['constr_type'], 'work_constr_type', 'c_int', blob)
 
     f.write("extern c_float work_x[%d];\n" % n)
     f.write("extern c_float work_y[%d];\n" % m)
@@ -361,13 +474,399 @@ def write_workspace_inc(f, n, m, rho_vectors, embedded_flag):
     f.write("extern c_float work_delta_x[%d];\n" % n)
     f.write("extern c_float work_Pdelta_x[%d];\n" % n)
     f.write("extern c_float work_Adelta_x[%d];\n" % m)
-    f.write("extern c_float work_D_temp[%d];\n" % n)
-    f.write("extern c_float work_D_temp_A[%d];\n" % n)
-    f.write("extern c_float work_E_temp[%d];\n\n" % m)
+    if not trim:
+        f.write("extern c_float work_D_temp[%d];\n" % n)
+        f.write("extern c_float work_D_temp_A[%d];\n" % n)
+        f.write("extern c_float work_E_temp[%d];\n" % m)
+    f.write("\n")
 
     f.write("extern OSQPWorkspace workspace;\n\n")
 
 
+def write_const_vec(f, vec, name):
+    """
+    Write read-only float vector to file
+    """
+    f.write('static const c_float %s[%d] = {\n' % (name, max(len(vec), 1)))
+    for v in vec:
+        f.write('(c_float)%.20f,\n' % v)
+    f.write('};\n')
+
+
+def write_rho_policy_src(f, rho_policy):
+    """
+    Write the weights of the rho policy and its inference routines to file
+    """
+    dims = [rho_policy[0][0].shape[1]] + [W.shape[0] for (W, _) in rho_policy]
+
+    f.write("// Define rho policy\n")
+    for k, (W, b) in enumerate(rho_policy):
+        write_const_vec(f, W.ravel(), 'rho_policy_W%d' % k)
+        write_const_vec(f, b, 'rho_policy_b%d' % k)
+    f.write("static const c_float *const rho_policy_W[%d] = {%s};\n" %
+            (len(rho_policy), ', '.join('rho_policy_W%d' % k
+                                        for k in range(len(rho_policy)))))
+    f.write("static const c_float *const rho_policy_b[%d] = {%s};\n" %
+            (len(rho_policy), ', '.join('rho_policy_b%d' % k
+                                        for k in range(len(rho_policy)))))
+    f.write("static const c_int rho_policy_dims[%d] = {%s};\n\n" %
+            (len(dims), ', '.join('%d' % d for d in dims)))
+
+    f.write("""c_float rho_policy_eval(const c_float *features) {
+    c_float buf[2][RHO_POLICY_WIDTH];
+    const c_float *in = features;
+    c_float *out, s;
+    c_int k, i, j, n_in, n_out;
+
+    for (k = 0; k < RHO_POLICY_NLAYERS; k++) {
+        n_in = rho_policy_dims[k];
+        n_out = rho_policy_dims[k + 1];
+        out = buf[k % 2];
+        for (i = 0; i < n_out; i++) {
+            s = rho_policy_b[k][i];
+            for (j = 0; j < n_in; j++) {
+                s += rho_policy_W[k][i * n_in + j] * in[j];
+            }
+            // ReLU on the hidden layers
+            out[i] = (k < RHO_POLICY_NLAYERS - 1 && s < 0.0) ? 0.0 : s;
+        }
+        in = out;
+    }
+    return in[0];
+}
+
+static void rho_policy_features(OSQPWorkspace *work, c_int i, c_float *f) {
+    c_float z = work->z[i];
+
+    f[0] = work->info->pri_res;
+    f[1] = work->info->dua_res;
+    f[2] = work->Ax[i] - z;
+    f[3] = work->y[i];
+    f[4] = c_min(z - work->data->l[i], OSQP_INFTY);
+    f[5] = c_min(work->data->u[i] - z, OSQP_INFTY);
+    f[6] = work->rho_vec[i];
+}
+
+c_int rho_policy_update(OSQPWorkspace *work) {
+    c_float features[RHO_POLICY_NFEATURES], rho;
+    c_int i;
+
+    // Equality and loose constraints keep their rho
+    for (i = 0; i < work->data->m; i++) {
+        if (work->constr_type[i] != 0) continue;
+        rho_policy_features(work, i, features);
+        rho = rho_policy_eval(features);
+        rho = c_min(c_max(rho, RHO_MIN), RHO_MAX);
+        work->rho_vec[i] = rho;
+        work->rho_inv_vec[i] = 1.0 / rho;
+    }
+    return work->linsys_solver->update_rho_vec(work->linsys_solver,
+                                               work->rho_vec);
+}
+
+/*
+ * osqp_solve with the rho of the inequality constraints set by the policy
+ * every adaptive_rho_interval iterations, in place of the adaptive rho of
+ * the solver. The loop follows the one of osqp_solve, so that the
+ * termination checks are the ones of a single solve.
+ */
+c_int rho_policy_solve(OSQPWorkspace *work) {
+    OSQPSettings *settings = work->settings;
+    c_int interval = settings->adaptive_rho_interval;
+    c_int can_check_termination = 0;
+    c_int iter, exitflag = 0;
+
+    if (interval <= 0) interval = RHO_POLICY_INTERVAL;
+    if (!settings->warm_start) cold_start(work);
+
+    for (iter = 1; iter <= settings->max_iter; iter++) {
+        swap_vectors(&(work->x), &(work->x_prev));
+        swap_vectors(&(work->z), &(work->z_prev));
+        update_xz_tilde(work);
+        update_x(work);
+        update_z(work);
+        update_y(work);
+
+        can_check_termination = settings->check_termination &&
+                                (iter % settings->check_termination == 0);
+        if (can_check_termination) {
+            update_info(work, iter, 0, 0);
+            if (check_termination(work, 0)) break;
+        }
+
+        if (iter % interval == 0 && iter < settings->max_iter) {
+            // The features use the residuals of the current iterate
+            if (!can_check_termination) update_info(work, iter, 0, 0);
+            exitflag = rho_policy_update(work);
+            if (exitflag) return exitflag;
+        }
+    }
+
+    if (!can_check_termination) {
+        update_info(work, iter - 1, 0, 0);
+        check_termination(work, 0);
+    }
+    if (has_solution(work->info)) {
+        work->info->obj_val = compute_obj_val(work, work->x);
+    }
+    if (work->info->status_val == OSQP_UNSOLVED) {
+        if (!check_termination(work, 1)) {
+            update_status(work->info, OSQP_MAX_ITER_REACHED);
+        }
+    }
+    work->info->rho_estimate = compute_rho_estimate(work);
+    store_solution(work);
+    return exitflag;
+}
+
+""")
+
+
+def write_rho_policy_inc(f, rho_policy):
+    """
+    Write prototypes of the rho policy to file
+    """
+    width = max(W.shape[0] for (W, _) in rho_policy)
+
+    f.write("// Rho policy, a ReLU network evaluated on the features of each\n")
+    f.write("// inequality constraint every adaptive_rho_interval iterations\n")
+    f.write("#define RHO_POLICY\n")
+    f.write("#define RHO_POLICY_NLAYERS %d\n" % len(rho_policy))
+    f.write("#define RHO_POLICY_NFEATURES %d\n" % rho_policy_features)
+    f.write("#define RHO_POLICY_WIDTH %d\n" % width)
+    f.write("#define RHO_POLICY_INTERVAL 25\n\n")
+    f.write("// Output of the network for the given features\n")
+    f.write("extern c_float rho_policy_eval(const c_float *features);\n")
+    f.write("// Set the rho of the inequality constraints and refactor\n")
+    f.write("extern c_int rho_policy_update(OSQPWorkspace *work);\n")
+    f.write("// Solve updating rho with the policy\n")
+    f.write("extern c_int rho_policy_solve(OSQPWorkspace *work);\n\n")
+
+
+# Generic kernels replaced by the specialized ones, with their sources
+specialized_kernels = [('lin_alg.c', 'void', 'mat_vec'),
+                       ('lin_alg.c', 'void', 'mat_tpose_vec'),
+                       ('qdldl.c', 'void', 'QDLDL_Lsolve'),
+                       ('qdldl.c', 'void', 'QDLDL_Ltsolve')]
+
+
+def rename_generic_kernels(src_dir):
+    """
+    Rename the definitions of the generic kernels in the copied sources, so
+    that the specialized ones can dispatch to them
+    """
+    for (fname, ret, name) in specialized_kernels:
+        path = os.path.join(src_dir, fname)
+        f = open(path)
+        filedata = f.read()
+        f.close()
+
+        pattern = re.compile(r'^(%s\s+)%s(\s*\()' % (ret, name), re.M)
+        filedata, count = pattern.subn(r'\g<1>%s_generic\g<2>' % name,
+                                       filedata)
+        if count != 1:
+            raise ValueError("Cannot find the definition of %s in %s." %
+                             (name, fname))
+
+        f = open(path, 'w')
+        f.write(filedata)
+        f.close()
+
+
+def kernel_sum(terms):
+    return ' + '.join(terms) if terms else '0.0'
+
+
+def write_kernel_update(f, y, s):
+    f.write("    %s = plus_eq ? %s + sign * (%s) : %s;\n" % (y, y, s, s))
+
+
+def write_mat_kernels(f, mat, name):
+    """
+    Write straight-line y (+/-)= A x and y (+/-)= A' x for the pattern of mat
+    """
+    m, n = mat['m'], mat['n']
+    Ap, Ai = mat['p'], mat['i']
+
+    # Nonzeros by row
+    rows = [[] for _ in range(m)]
+    for j in range(n):
+        for k in range(Ap[j], Ap[j + 1]):
+            rows[Ai[k]].append('Ax[%d] * x[%d]' % (k, j))
+
+    f.write("static void kernel_%s_vec(const c_float *Ax, const c_float *x,\n" % name)
+    f.write("                          c_float *y, c_int plus_eq) {\n")
+    f.write("    c_float sign = plus_eq == -1 ? -1.0 : 1.0;\n\n")
+    for i in range(m):
+        write_kernel_update(f, 'y[%d]' % i, kernel_sum(rows[i]))
+    f.write("}\n\n")
+
+    f.write("static void kernel_%s_tpose_vec(const c_float *Ax, const c_float *x,\n" % name)
+    f.write("                                c_float *y, c_int plus_eq, c_int skip_diag) {\n")
+    f.write("    c_float sign = plus_eq == -1 ? -1.0 : 1.0;\n\n")
+    for j in range(n):
+        offdiag = ['Ax[%d] * x[%d]' % (k, Ai[k])
+                   for k in range(Ap[j], Ap[j + 1]) if Ai[k] != j]
+        diag = ['Ax[%d] * x[%d]' % (k, j)
+                for k in range(Ap[j], Ap[j + 1]) if Ai[k] == j]
+        if diag:
+            offdiag.append('(skip_diag ? 0.0 : %s)' % kernel_sum(diag))
+        write_kernel_update(f, 'y[%d]' % j, kernel_sum(offdiag))
+    f.write("}\n\n")
+
+
+def write_kernels_src(f, data, linsys_solver):
+    """
+    Write kernels specialized to the sparsity patterns of P, A and L, which
+    replace the generic ones for these matrices
+    """
+    L = linsys_solver['L']
+    Lp, Li = L['p'], L['i']
+
+    f.write("// Define kernels specialized to the sparsity patterns\n")
+    f.write("extern void mat_vec_generic(const csc *A, const c_float *x, "
+            "c_float *y, c_int plus_eq);\n")
+    f.write("extern void mat_tpose_vec_generic(const csc *A, const c_float *x, "
+            "c_float *y, c_int plus_eq, c_int skip_diag);\n")
+    f.write("extern void QDLDL_Lsolve_generic(const QDLDL_int n, const QDLDL_int* Lp, "
+            "const QDLDL_int* Li, const QDLDL_float* Lx, QDLDL_float* x);\n")
+    f.write("extern void QDLDL_Ltsolve_generic(const QDLDL_int n, const QDLDL_int* Lp, "
+            "const QDLDL_int* Li, const QDLDL_float* Lx, QDLDL_float* x);\n\n")
+
+    write_mat_kernels(f, data['P'], 'Pdata')
+    write_mat_kernels(f, data['A'], 'Adata')
+
+    f.write("void mat_vec(const csc *A, const c_float *x, c_float *y, c_int plus_eq) {\n")
+    f.write("    if (A == &Adata) kernel_Adata_vec(A->x, x, y, plus_eq);\n")
+    f.write("    else if (A == &Pdata) kernel_Pdata_vec(A->x, x, y, plus_eq);\n")
+    f.write("    else mat_vec_generic(A, x, y, plus_eq);\n")
+    f.write("}\n\n")
+
+    f.write("void mat_tpose_vec(const csc *A, const c_float *x, c_float *y,\n")
+    f.write("                   c_int plus_eq, c_int skip_diag) {\n")
+    f.write("    if (A == &Adata) kernel_Adata_tpose_vec(A->x, x, y, plus_eq, skip_diag);\n")
+    f.write("    else if (A == &Pdata) kernel_Pdata_tpose_vec(A->x, x, y, plus_eq, skip_diag);\n")
+    f.write("    else mat_tpose_vec_generic(A, x, y, plus_eq, skip_diag);\n")
+    f.write("}\n\n")
+
+    # The pattern of L does not change when the KKT matrix is refactored
+    f.write("void QDLDL_Lsolve(const QDLDL_int n, const QDLDL_int* Lp, "
+            "const QDLDL_int* Li, const QDLDL_float* Lx, QDLDL_float* x) {\n")
+    f.write("    if ((const c_int *)Lp != linsys_solver_L.p) {\n")
+    f.write("        QDLDL_Lsolve_generic(n, Lp, Li, Lx, x);\n")
+    f.write("        return;\n")
+    f.write("    }\n")
+    for i in range(L['n']):
+        for k in range(Lp[i], Lp[i + 1]):
+            f.write("    x[%d] -= Lx[%d] * x[%d];\n" % (Li[k], k, i))
+    f.write("}\n\n")
+
+    f.write("void QDLDL_Ltsolve(const QDLDL_int n, const QDLDL_int* Lp, "
+            "const QDLDL_int* Li, const QDLDL_float* Lx, QDLDL_float* x) {\n")
+    f.write("    if ((const c_int *)Lp != linsys_solver_L.p) {\n")
+    f.write("        QDLDL_Ltsolve_generic(n, Lp, Li, Lx, x);\n")
+    f.write("        return;\n")
+    f.write("    }\n")
+    for i in reversed(range(L['n'])):
+        for k in range(Lp[i], Lp[i + 1]):
+            f.write("    x[%d] -= Lx[%d] * x[%d];\n" % (i, k, Li[k]))
+    f.write("}\n\n")
+
+
+# Vectors of an instance, with their lengths, that are iterates of the
+# workspace and other buffers
+instance_work_vecs = [('x', 'n'), ('y', 'm'), ('z', 'm'),
+                      ('xz_tilde', 'n + m'), ('x_prev', 'n'), ('z_prev', 'm'),
+                      ('Ax', 'm'), ('Px', 'n'), ('Aty', 'n'),
+                      ('delta_y', 'm'), ('Atdelta_y', 'n'),
+                      ('delta_x', 'n'), ('Pdelta_x', 'n'), ('Adelta_x', 'm'),
+                      ('D_temp', 'n'), ('D_temp_A', 'n'), ('E_temp', 'm')]
+instance_scaling_vecs = ['D_temp', 'D_temp_A', 'E_temp']
+instance_buffers = [('bp', 'n + m'), ('sol', 'n + m'),
+                    ('xsolution', 'n'), ('ysolution', 'm')]
+
+
+def instance_len(dim, n, m):
+    return {'n': n, 'm': m, 'n + m': n + m}[dim]
+
+
+def instance_vecs(vecs, trim):
+    return [(name, dim) for (name, dim) in vecs
+            if not trim or name not in instance_scaling_vecs]
+
+
+def write_instance_src(f, n, m, trim=False):
+    """
+    Define the initialization of an instance from the workspace
+    """
+    f.write("// Define instances\n")
+    f.write("static void instance_copy(c_float *a, const c_float *b, c_int len) {\n")
+    f.write("    c_int i;\n")
+    f.write("    for (i = 0; i < len; i++) a[i] = b ? b[i] : 0.0;\n")
+    f.write("}\n\n")
+
+    f.write("void init_instance(OSQPInstance *instance) {\n")
+    f.write("    OSQPWorkspace *work = &instance->work;\n\n")
+
+    # Vectors of the problem, iterates and buffers
+    f.write("    instance_copy(instance->q, qdata, %d);\n" % n)
+    f.write("    instance_copy(instance->l, ldata, %d);\n" % m)
+    f.write("    instance_copy(instance->u, udata, %d);\n" % m)
+    for (name, dim) in instance_vecs(instance_work_vecs + instance_buffers,
+                                     trim):
+        f.write("    instance_copy(instance->%s, OSQP_NULL, %d);\n" %
+                (name, instance_len(dim, n, m)))
+    f.write("\n")
+
+    # Structures pointing to them
+    f.write("    instance->data = data;\n")
+    f.write("    instance->data.q = instance->q;\n")
+    f.write("    instance->data.l = instance->l;\n")
+    f.write("    instance->data.u = instance->u;\n")
+    f.write("    instance->linsys_solver = linsys_solver;\n")
+    f.write("    instance->linsys_solver.bp = instance->bp;\n")
+    f.write("    instance->linsys_solver.sol = instance->sol;\n")
+    f.write("    instance->settings = settings;\n")
+    f.write("    instance->solution.x = instance->xsolution;\n")
+    f.write("    instance->solution.y = instance->ysolution;\n")
+    f.write("    instance->info = info;\n\n")
+
+    f.write("    *work = workspace;\n")
+    f.write("    work->data = &instance->data;\n")
+    f.write("    work->linsys_solver = (LinSysSolver *)&instance->linsys_solver;\n")
+    for (name, dim) in instance_vecs(instance_work_vecs, trim):
+        f.write("    work->%s = instance->%s;\n" % (name, name))
+    f.write("    work->settings = &instance->settings;\n")
+    f.write("    work->solution = &instance->solution;\n")
+    f.write("    work->info = &instance->info;\n")
+    f.write("}\n\n")
+
+
+def write_instance_inc(f, n, m, trim=False):
+    """
+    Define the instance type
+    """
+    f.write("// Instance of the problem. It owns its vectors, iterates and solver\n")
+    f.write("// buffers and shares the matrices, the scaling, the rho vectors and\n")
+    f.write("// the factorization, which are read-only, with the workspace.\n")
+    f.write("typedef struct {\n")
+    f.write("    OSQPWorkspace work;\n")
+    f.write("    OSQPData      data;\n")
+    f.write("    qdldl_solver  linsys_solver;\n")
+    f.write("    OSQPSettings  settings;\n")
+    f.write("    OSQPSolution  solution;\n")
+    f.write("    OSQPInfo      info;\n")
+    vecs = [('q', 'n'), ('l', 'm'), ('u', 'm')] + \
+        instance_vecs(instance_work_vecs + instance_buffers, trim)
+    for (name, dim) in vecs:
+        # Arrays of length zero are not valid C
+        f.write("    c_float %s[%d];\n" %
+                (name, max(instance_len(dim, n, m), 1)))
+    f.write("} OSQPInstance;\n\n")
+    f.write("// Initialize an instance with the vectors of the workspace\n")
+    f.write("extern void init_instance(OSQPInstance *instance);\n\n")
+
+
 def render_workspace(variables, hfname, cfname):
     """
     Print workspace dimensions
@@ -382,6 +881,10 @@ def render_workspace(variables, hfname, cfname):
     n = data['n']
     m = data['m']
 
+    # The scaling vectors are not used with embedded_flag = 1, which does not
+    # scale the data. The factorization work vectors are not generated then.
+    trim = variables['trim_unused'] and embedded_flag == 1
+
     # Open output file
     incFile = open(hfname, 'w')
     srcFile = open(cfname, 'w')
@@ -414,23 +917,39 @@ def render_workspace(variables, hfname, cfname):
     incFile.write("#include \"qdldl_interface.h\"\n\n")
 
     srcFile.write("#include \"types.h\"\n")
-    srcFile.write("#include \"qdldl_interface.h\"\n\n")
+    srcFile.write("#include \"qdldl_interface.h\"\n")
+    if variables['rho_policy'] is not None:
+        srcFile.write("#include \"osqp.h\"\n")
+        srcFile.write("#include \"auxil.h\"\n")
+    if variables['specialize_kernels']:
+        srcFile.write("#include \"lin_alg.h\"\n")
+    srcFile.write("#include \"%s\"\n\n" % os.path.basename(hfname))
+
+    # Write the arrays to a binary blob next to the source file
+    if variables['binary_data']:
+        blob = WorkspaceBlob(os.path.join(os.path.dirname(cfname),
+                                          'workspace.bin'),
+                             variables['float_flag'], variables['long_flag'])
+        write_blob_src(srcFile, blob)
+        write_blob_inc(incFile, blob)
+    else:
+        blob = None
 
     # Write data structure
-    write_data_src(srcFile, data)
-    write_data_inc(incFile, data)
+    write_data_src(srcFile, data, blob)
+    write_data_inc(incFile, data, blob)
 
     # Write settings structure
     write_settings_src(srcFile, settings, embedded_flag)
     write_settings_inc(incFile, settings, embedded_flag)
 
     # Write scaling structure
-    write_scaling_src(srcFile, scaling)
-    write_scaling_inc(incFile, scaling)
+    write_scaling_src(srcFile, scaling, blob)
+    write_scaling_inc(incFile, scaling, blob)
 
     # Write linsys_solver structure
-    write_linsys_solver_src(srcFile, linsys_solver, embedded_flag)
-    write_linsys_solver_inc(incFile, linsys_solver, embedded_flag)
+    write_linsys_solver_src(srcFile, linsys_solver, embedded_flag, blob)
+    write_linsys_solver_inc(incFile, linsys_solver, embedded_flag, blob)
 
     # Define empty solution structure
     write_solution_src(srcFile, data)
@@ -441,14 +960,156 @@ def render_workspace(variables, hfname, cfname):
     write_info_inc(incFile)
 
     # Define workspace structure
-    write_workspace_src(srcFile, n, m, rho_vectors, embedded_flag)
-    write_workspace_inc(incFile, n, m, rho_vectors, embedded_flag)
+    write_workspace_src(srcFile, n, m, rho_vectors, embedded_flag, blob,
+                        trim)
+    write_workspace_inc(incFile, n, m, rho_vectors, embedded_flag, blob,
+                        trim)
+
+    # Define specialized kernels
+    if variables['specialize_kernels']:
+        write_kernels_src(srcFile, data, linsys_solver)
+
+    # Define rho policy
+    if variables['rho_policy'] is not None:
+        write_rho_policy_src(srcFile, variables['rho_policy'])
+        write_rho_policy_inc(incFile, variables['rho_policy'])
+
+    # Define instances. With embedded_flag = 1 the matrices and the
+    # factorization never change and can be shared.
+    if embedded_flag == 1:
+        write_instance_src(srcFile, n, m, trim)
+        write_instance_inc(incFile, n, m, trim)
 
     # The endif for the include-guard
     incFile.write("#endif // ifndef %s\n" % incGuard)
 
     incFile.close()
     srcFile.close()
+    if blob is not None:
+        blob.close()
+
+
+# Sizes in bytes of the C types for the float/double and int/long choices
+footprint_type_sizes = {'c_float':     {'float': 4, 'double': 8},
+                        'QDLDL_float': {'float': 4, 'double': 8},
+                        'c_int':       {'int': 4, 'long': 8},
+                        'QDLDL_int':   {'int': 4, 'long': 8},
+                        'QDLDL_bool':  {'bool': 1}}
+
+
+def footprint_array(length, vec_type, initialized):
+    sizes = footprint_type_sizes[vec_type]
+    return {'type': vec_type,
+            'length': int(length),
+            'initialized': initialized,
+            'bytes': {k: int(length) * v for (k, v) in sizes.items()}}
+
+
+def footprint(variables):
+    """
+    Static memory of the arrays of the generated workspace by structure
+    """
+    data = variables['data']
+    linsys_solver = variables['linsys_solver']
+    scaling = variables['scaling']
+    embedded_flag = variables['embedded_flag']
+    trim = variables['trim_unused'] and embedded_flag == 1
+    n = data['n']
+    m = data['m']
+
+    def vec(name, v, vec_type):
+        return (name, footprint_array(len(v), vec_type, True))
+
+    def buf(name, length, vec_type):
+        return (name, footprint_array(length, vec_type, False))
+
+    def mat(name, M):
+        return [vec(name + '_i', M['i'], 'c_int'),
+                vec(name + '_p', M['p'], 'c_int'),
+                vec(name + '_x', M['x'], 'c_float')]
+
+    structures = {}
+    structures['data'] = mat('Pdata', data['P']) + mat('Adata', data['A']) + \
+        [vec('qdata', data['q'], 'c_float'),
+         vec('ldata', data['l'], 'c_float'),
+         vec('udata', data['u'], 'c_float')]
+
+    structures['scaling'] = []
+    if scaling is not None:
+        structures['scaling'] = [vec(name + 'scaling', scaling[name], 'c_float')
+                                 for name in ['D', 'Dinv', 'E', 'Einv']]
+
+    structures['factor'] = mat('linsys_solver_L', linsys_solver['L']) + \
+        [vec('linsys_solver_Dinv', linsys_solver['Dinv'], 'c_float'),
+         vec('linsys_solver_P', linsys_solver['P'], 'c_int')]
+    structures['kkt'] = []
+    if embedded_flag != 1:
+        structures['factor'] += [
+            vec('linsys_solver_D', linsys_solver['D'], 'QDLDL_float'),
+            vec('linsys_solver_etree', linsys_solver['etree'], 'QDLDL_int'),
+            vec('linsys_solver_Lnz', linsys_solver['Lnz'], 'QDLDL_int')]
+        structures['kkt'] = mat('linsys_solver_KKT', linsys_solver['KKT']) + \
+            [vec('linsys_solver_' + name, linsys_solver[name], 'c_int')
+             for name in ['Pdiag_idx', 'PtoKKT', 'AtoKKT', 'rhotoKKT']]
+
+    rho_vectors = variables['rho_vectors']
+    structures['rho'] = [
+        vec('work_rho_vec', rho_vectors['rho_vec'], 'c_float'),
+        vec('work_rho_inv_vec', rho_vectors['rho_inv_vec'], 'c_float'),
+        vec('linsys_solver_rho_inv_vec', linsys_solver['rho_inv_vec'],
+            'c_float')]
+    if embedded_flag != 1:
+        structures['rho'].append(vec('work_constr_type',
+                                     rho_vectors['constr_type'], 'c_int'))
+
+    structures['iterates'] = [
+        buf('work_' + name, instance_len(dim, n, m), 'c_float')
+        for (name, dim) in instance_work_vecs[:6]] + \
+        [buf('xsolution', n, 'c_float'), buf('ysolution', m, 'c_float')]
+
+    structures['work'] = [
+        buf('work_' + name, instance_len(dim, n, m), 'c_float')
+        for (name, dim) in instance_vecs(instance_work_vecs[6:], trim)] + \
+        [buf('linsys_solver_bp', n + m, 'c_float'),
+         buf('linsys_solver_sol', n + m, 'c_float')]
+    if embedded_flag != 1:
+        structures['work'] += [
+            buf('linsys_solver_iwork', len(linsys_solver['iwork']), 'QDLDL_int'),
+            buf('linsys_solver_bwork', len(linsys_solver['bwork']), 'QDLDL_bool'),
+            buf('linsys_solver_fwork', len(linsys_solver['fwork']), 'QDLDL_float')]
+
+    rho_policy = variables['rho_policy']
+    if rho_policy is not None:
+        structures['rho_policy'] = []
+        for k, (W, b) in enumerate(rho_policy):
+            structures['rho_policy'] += [
+                vec('rho_policy_W%d' % k, W.ravel(), 'c_float'),
+                vec('rho_policy_b%d' % k, b, 'c_float')]
+
+    # Totals for each combination of the float and int types
+    report = {'n': n, 'm': m, 'embedded': embedded_flag, 'structures': {},
+              'total': {}}
+    for (struct_name, arrays) in structures.items():
+        report['structures'][struct_name] = dict(arrays)
+    for float_type in ['float', 'double']:
+        for int_type in ['int', 'long']:
+            total = 0
+            for arrays in structures.values():
+                for (_, a) in arrays:
+                    b = a['bytes']
+                    total += b.get(float_type, 0) + b.get(int_type, 0) + \
+                        b.get('bool', 0)
+            report['total']['%s_%s' % (float_type, int_type)] = total
+    return report
+
+
+def render_footprint(variables, output):
+    """
+    Write the footprint report as JSON
+    """
+    f = open(output, 'w')
+    json.dump(footprint(variables), f, indent=2, sort_keys=True)
+    f.close()
 
 
 def render_setuppy(variables, output):
@@ -465,6 +1126,8 @@ def render_setuppy(variables, output):
 
     filedata = filedata.replace("EMBEDDED_FLAG", str(embedded_flag))
     filedata = filedata.replace("PYTHON_EXT_NAME", str(python_ext_name))
+    filedata = filedata.replace("FLOAT_FLAG", variables['float_flag'])
+    filedata = filedata.replace("LONG_FLAG", variables['long_flag'])
 
     f = open(output, 'w')
     f.write(filedata)
@@ -11,7 +11,82 @@ from platform import system
 import rlqp.codegen as cg
 import rlqp.utils as utils
 import sys
-import qdldl
+import time
+import threading
+import asyncio
+
+# Looked up once, the bounds are clamped at every update
+_OSQP_INFTY = _osqp.constant('OSQP_INFTY')
+
+
+def _pattern(M):
+    """
+    Row and column indices of the nonzeros of a matrix given to setup
+    """
+    if M is None:
+        return (np.zeros(0, dtype=int), np.zeros(0, dtype=int))
+    return M.nonzero()
+
+
+class _AsyncSolves(object):
+    """
+    Futures of the solves running on the worker pool of the extension.
+    Every event loop awaiting a solve watches the file descriptor signalling
+    the finished solves, and completes the futures of all loops.
+    """
+    lock = threading.Lock()
+    pending = {}                # Job id -> (loop, future, model)
+    watchers = {}               # Loop -> number of solves it awaits
+
+    @classmethod
+    async def solve(cls, model, time_budget):
+        loop = asyncio.get_running_loop()
+        with cls.lock:
+            if loop not in cls.watchers:
+                loop.add_reader(_osqp.async_fd(), cls.complete)
+                cls.watchers[loop] = 0
+            cls.watchers[loop] += 1
+        try:
+            return await cls.submit(loop, model, time_budget)
+        finally:
+            with cls.lock:
+                cls.watchers[loop] -= 1
+                if not cls.watchers[loop]:
+                    del cls.watchers[loop]
+                    loop.remove_reader(_osqp.async_fd())
+
+    @classmethod
+    def submit(cls, loop, model, time_budget):
+        future = loop.create_future()
+        with cls.lock:
+            if time_budget is None:
+                job = model._model.solve_submit()
+            else:
+                job = model._model.solve_submit(time_budget)
+            cls.pending[job] = (loop, future, model)
+
+        # Stop the native solve when the awaiting task is cancelled
+        future.add_done_callback(
+            lambda f: f.cancelled() and model._model.cancel())
+        return future
+
+    @classmethod
+    def complete(cls):
+        for job, results, error in _osqp.async_poll():
+            with cls.lock:
+                loop, future, model = cls.pending.pop(job)
+            loop.call_soon_threadsafe(cls.set_result, future, model,
+                                      results, error)
+
+    @staticmethod
+    def set_result(future, model, results, error):
+        if future.cancelled():
+            return
+        if error is not None:
+            future.set_exception(error)
+        else:
+            model._derivative_cache['results'] = results
+            future.set_result(results)
 
 
 class OSQP(object):
@@ -29,41 +104,63 @@ class OSQP(object):
         subject to   l <= A * x <= u
 
         solver settings can be specified as additional keyword arguments
+
+        The default P_idx and A_idx of the derivatives are the patterns of
+        P and A as given. They are built from the workspace at the first
+        derivative. With derivative_cache=True, P and A are kept as given,
+        and their patterns follow the updates of their values.
         """
-        # TODO(bart): this will be unnecessary when the derivative will be in C
-        self._derivative_cache = {'P': P, 'q': q, 'A': A, 'l': l, 'u': u}
+        if settings.pop('derivative_cache', False):
+            self._derivative_cache = {'P': P, 'A': A}
+        else:
+            # Only whether P was given as its upper triangular part is kept
+            self._derivative_cache = {
+                'P_triu': P is None or spa.tril(P, -1).count_nonzero() == 0}
 
         unpacked_data, settings = utils.prepare_data(P, q, A, l, u, **settings)
         self._model.setup(*unpacked_data, **settings)
 
     def update(self, q=None, l=None, u=None,
-               Px=None, Px_idx=np.array([]), Ax=None, Ax_idx=np.array([])):
+               Px=None, Px_idx=np.array([]), Ax=None, Ax_idx=np.array([]),
+               q_idx=np.array([]), lu_idx=np.array([])):
         """
         Update OSQP problem arguments
+
+        If q_idx (lu_idx) is given, q (l and u) holds the new values of these
+        entries only, and the other entries are kept.
         """
 
         # get problem dimensions
         (n, m) = self._model.dimensions()
 
         # check consistency of the input arguments
-        if q is not None and len(q) != n:
+        if q is None:
+            if len(q_idx) > 0:
+                raise ValueError("Vector q has not been specified")
+        elif len(q_idx) > 0:
+            if len(q) != len(q_idx):
+                raise ValueError("q and q_idx must have the same lengths")
+        elif len(q) != n:
             raise ValueError("q must have length n")
+        if l is None and u is None and len(lu_idx) > 0:
+            raise ValueError("Vectors l and u have not been specified")
+        m_lu = len(lu_idx) if len(lu_idx) > 0 else m
         if l is not None:
             if not isinstance(l, np.ndarray):
                 raise TypeError("l must be numpy.ndarray, not %s" %
                                 type(l).__name__)
-            elif len(l) != m:
+            elif len(l) != m_lu:
                 raise ValueError("l must have length m")
             # Convert values to -OSQP_INFTY
-            l = np.maximum(l, -_osqp.constant('OSQP_INFTY'))
+            l = np.maximum(l, -_OSQP_INFTY)
         if u is not None:
             if not isinstance(u, np.ndarray):
                 raise TypeError("u must be numpy.ndarray, not %s" %
                                 type(u).__name__)
-            elif len(u) != m:
+            elif len(u) != m_lu:
                 raise ValueError("u must have length m")
             # Convert values to OSQP_INFTY
-            u = np.minimum(u, _osqp.constant('OSQP_INFTY'))
+            u = np.minimum(u, _OSQP_INFTY)
         if Ax is None:
             if len(Ax_idx) > 0:
                 raise ValueError("Vector Ax has not been specified")
@@ -80,19 +177,25 @@ class OSQP(object):
             raise ValueError("No updatable data has been specified")
 
         # update linear cost
-        if q is not None:
+        if q is not None and len(q_idx) > 0:
+            self._model.update_lin_cost_idx(q, q_idx)
+        elif q is not None:
             self._model.update_lin_cost(q)
 
+        # update entries of the bounds
+        if (l is not None or u is not None) and len(lu_idx) > 0:
+            self._model.update_bounds_idx(l, u, lu_idx)
+
         # update lower bound
-        if l is not None and u is None:
+        elif l is not None and u is None:
             self._model.update_lower_bound(l)
 
         # update upper bound
-        if u is not None and l is None:
+        elif u is not None and l is None:
             self._model.update_upper_bound(u)
 
         # update bounds
-        if l is not None and u is not None:
+        elif l is not None and u is not None:
             self._model.update_bounds(l, u)
 
         # update matrix P
@@ -108,24 +211,14 @@ class OSQP(object):
             self._model.update_P_A(Px, Px_idx, len(Px), Ax, Ax_idx, len(Ax))
 
 
-        # TODO(bart): this will be unnecessary when the derivative will be in C
-        # update problem data in self._derivative_cache
-        if q is not None:
-            self._derivative_cache["q"] = q
-
-        if l is not None:
-            self._derivative_cache["l"] = l
-
-        if u is not None:
-            self._derivative_cache["u"] = u
-
-        if Px is not None:
+        # update the copy of the matrices kept with derivative_cache=True
+        if Px is not None and 'P' in self._derivative_cache:
             if Px_idx.size == 0:
                 self._derivative_cache["P"].data = Px
             else:
                 self._derivative_cache["P"].data[Px_idx] = Px
 
-        if Ax is not None:
+        if Ax is not None and 'A' in self._derivative_cache:
             if Ax_idx.size == 0:
                 self._derivative_cache["A"].data = Ax
             else:
@@ -227,18 +320,78 @@ class OSQP(object):
            warm_start is None:
             raise ValueError("No updatable settings has been specified!")
 
-    def solve(self):
+    def solve(self, deadline=None):
         """
         Solve QP Problem
+
+        If a deadline is given, as a time.monotonic() value, the solve stops
+        at the deadline and returns the best iterate found so far. Only the
+        iterates of the termination checks, every check_termination
+        iterations, and the last one are compared, since the residuals of
+        the other ones are not computed. Deadlines need an extension built
+        with PROFILING.
         """
         # Solve QP
-        results = self._model.solve()
+        if deadline is None:
+            results = self._model.solve()
+        else:
+            results = self._model.solve(max(deadline - time.monotonic(), 0.))
 
-        # TODO(bart): this will be unnecessary when the derivative will be in C
+        # The derivatives are taken at the last results
         self._derivative_cache['results'] = results
 
         return results
 
+    def update_solve(self, q=None, l=None, u=None, x0=None, y0=None,
+                     deadline=None):
+        """
+        Update the vectors, warm start and solve QP Problem in one call
+
+        Equivalent to update(q=q, l=l, u=u), warm_start(x=x0, y=y0) and
+        solve(deadline=deadline), with the checks and the clamping of the
+        bounds done in the extension. Arguments that are None are kept.
+        """
+        if deadline is None:
+            results = self._model.update_solve(q, l, u, x0, y0)
+        else:
+            results = self._model.update_solve(
+                q, l, u, x0, y0, max(deadline - time.monotonic(), 0.))
+
+        self._derivative_cache['results'] = results
+
+        return results
+
+    async def solve_async(self, deadline=None):
+        """
+        Solve QP Problem on the worker pool of the extension
+
+        The solve runs without the GIL on a native thread and the event loop
+        is woken up when it finishes. Cancelling the awaiting task cancels
+        the solve. The deadline is as in solve.
+        """
+        time_budget = None
+        if deadline is not None:
+            time_budget = max(deadline - time.monotonic(), 0.)
+
+        if system() == 'Windows':
+            # No worker pool: solve on the default executor
+            loop = asyncio.get_running_loop()
+            return await loop.run_in_executor(None, self.solve, deadline)
+
+        return await _AsyncSolves.solve(self, time_budget)
+
+    def cancel(self):
+        """
+        Cancel the solve running in another thread, or the next solve if
+        none runs. The solve returns the current iterate with the status
+        OSQP_CANCELLED.
+
+        The solves started with solve_async can always be cancelled. The
+        other ones only with the setting cancellable=True, since they run
+        osqp_solve of the library otherwise.
+        """
+        self._model.cancel()
+
     def warm_start(self, x=None, y=None):
         """
         Warm start primal or dual variables
@@ -268,9 +421,30 @@ class OSQP(object):
 
     def codegen(self, folder, project_type='', parameters='vectors',
                 python_ext_name='emosqp', force_rewrite=False,
-                FLOAT=False, LONG=True):
+                FLOAT=False, LONG=True, binary_data=False, rho_policy=None,
+                specialize_kernels=False, trim_unused=False):
         """
         Generate embeddable C code for the problem
+
+        With binary_data=True the arrays of the workspace are written to a
+        binary file embedded with .incbin instead of C initializers, which
+        makes generating and compiling large problems much faster.
+
+        rho_policy is a list of (W, b) layers of a ReLU network mapping the
+        7 features of an inequality constraint (primal and dual residuals,
+        Ax - z, y, z - l, u - z and rho, in the scaled problem) to its rho.
+        Its weights are generated as constants, and the generated solve
+        updates rho with it every adaptive_rho_interval iterations. The
+        policy requires parameters='matrices', which can refactor the KKT
+        matrix.
+
+        With specialize_kernels=True the products with P and A and the
+        solves with the factor L are generated as straight-line code for
+        their sparsity patterns, which suits small problems.
+
+        The static memory of the generated arrays is reported by structure
+        in footprint.json. With trim_unused=True and parameters='vectors',
+        the scaling work vectors, which are then unused, are not generated.
         """
 
         # Check parameters arguments
@@ -297,6 +471,23 @@ class OSQP(object):
         if project_type not in expectedProject:
             raise ValueError("Unknown value of 'project_type' argument.")
 
+        # Check rho_policy argument
+        if rho_policy is not None:
+            if embedded != 2:
+                raise ValueError("The rho policy requires "
+                                 "parameters='matrices'.")
+            rho_policy = [(np.atleast_2d(np.asarray(W, dtype=float)),
+                           np.atleast_1d(np.asarray(b, dtype=float)))
+                          for (W, b) in rho_policy]
+            dims = [cg.utils.rho_policy_features]
+            for (W, b) in rho_policy:
+                if W.ndim != 2 or W.shape[1] != dims[-1] or \
+                        b.shape != (W.shape[0],):
+                    raise ValueError("Wrong dimensions of the rho policy.")
+                dims.append(W.shape[0])
+            if not rho_policy or dims[-1] != 1:
+                raise ValueError("The rho policy must have one output.")
+
         if project_type == 'Makefile':
             if system() == 'Windows':
                 project_type = 'MinGW Makefiles'
@@ -306,31 +497,38 @@ class OSQP(object):
         # Convert workspace to Python
         sys.stdout.write("Getting workspace from OSQP object... \t\t\t\t")
         sys.stdout.flush()
+        # The generated code factors the KKT matrix with QDLDL
+        self._model.use_qdldl()
         work = self._model._get_workspace()
         print("[done]")
 
         # Generate code with codegen module
         cg.codegen(work, folder, python_ext_name, project_type,
-                   embedded, force_rewrite, float_flag, long_flag)
-
-    def derivative_iterative_refinement(self, rhs, max_iter=20, tol=1e-12):
-        M = self._derivative_cache['M']
-
-        # Prefactor
-        solver = self._derivative_cache['solver']
-
-        sol = solver.solve(rhs)
-        for k in range(max_iter):
-            delta_sol = solver.solve(rhs - M @ sol)
-            sol = sol + delta_sol
+                   embedded, force_rewrite, float_flag, long_flag,
+                   binary_data, rho_policy, specialize_kernels,
+                   trim_unused)
 
-            if np.linalg.norm(M @ sol - rhs) < tol:
-                break
-
-        if k == max_iter - 1:
-            warn("max_iter iterative refinement reached.")
-
-        return sol
+    def _derivative_patterns(self):
+        """
+        Default P_idx and A_idx, the patterns of P and A as given to setup
+        """
+        cache = self._derivative_cache
+        if 'P' in cache:
+            return _pattern(cache['P']), _pattern(cache['A'])
+
+        if 'P_idx' not in cache:
+            # Patterns of the workspace matrices, with P upper triangular
+            _, Pi, Pp, _, Ai, Ap = self._model.unscaled_matrices()
+            rows = Pi.astype(int)
+            cols = np.repeat(np.arange(len(Pp) - 1), np.diff(Pp))
+            if not cache['P_triu']:
+                off = rows != cols
+                rows, cols = (np.concatenate((rows, cols[off])),
+                              np.concatenate((cols, rows[off])))
+            cache['P_idx'] = (rows, cols)
+            cache['A_idx'] = (Ai.astype(int),
+                              np.repeat(np.arange(len(Ap) - 1), np.diff(Ap)))
+        return cache['P_idx'], cache['A_idx']
 
     def adjoint_derivative(self, dx=None, dy_u=None, dy_l=None,
                            P_idx=None, A_idx=None, eps_iter_ref=1e-04):
@@ -338,10 +536,6 @@ class OSQP(object):
         Compute adjoint derivative after solve.
         """
 
-        P, q = self._derivative_cache['P'], self._derivative_cache['q']
-        A = self._derivative_cache['A']
-        l, u = self._derivative_cache['l'], self._derivative_cache['u']
-
         try:
             results = self._derivative_cache['results']
         except KeyError:
@@ -353,58 +547,131 @@ class OSQP(object):
             raise ValueError("Problem has not been solved to optimality. "
                              "You cannot take derivatives")
 
-        m, n = A.shape
+        (n, m) = self._model.dimensions()
         x = results.x
         y = results.y
         y_u = np.maximum(y, 0)
         y_l = -np.minimum(y, 0)
 
-        if A_idx is None:
-            A_idx = A.nonzero()
-
-        if P_idx is None:
-            P_idx = P.nonzero()
+        if P_idx is None or A_idx is None:
+            P_pattern, A_pattern = self._derivative_patterns()
+            if A_idx is None:
+                A_idx = A_pattern
+            if P_idx is None:
+                P_idx = P_pattern
 
         if dy_u is None:
             dy_u = np.zeros(m)
         if dy_l is None:
             dy_l = np.zeros(m)
 
-        # Make sure M matrix exists
-        if 'M' not in self._derivative_cache:
-            # Multiply second-third row by diag(y_u)^-1 and diag(y_l)^-1
-            # to make the matrix symmetric
-            inv_dia_y_u = spa.diags(np.reciprocal(y_u + 1e-20))
-            inv_dia_y_l = spa.diags(np.reciprocal(y_l + 1e-20))
-            M = spa.bmat([
-                [P,            A.T,                  -A.T],
-                [A, spa.diags(A @ x - u) @ inv_dia_y_u, None],
-                [-A, None, spa.diags(l - A @ x) @ inv_dia_y_l]
-            ], format='csc')
-            delta = spa.bmat([[eps_iter_ref * spa.eye(n), None],
-                              [None, -eps_iter_ref * spa.eye(2 * m)]],
-                             format='csc')
-            self._derivative_cache['M'] = M
-            self._derivative_cache['solver'] = qdldl.Solver(M + delta)
-
-        rhs = - np.concatenate([dx, dy_u, dy_l])
-
-        r_sol = self.derivative_iterative_refinement(rhs)
-
-        r_x, r_yu, r_yl = np.split(r_sol, [n, n+m])
+        # Reduced KKT system factored and refined in the extension
+        dq, dl, du = self._model.adjoint_derivative(
+            np.asarray(dx, dtype=np.float64),
+            np.asarray(dy_u, dtype=np.float64),
+            np.asarray(dy_l, dtype=np.float64), eps_iter_ref)
+        r_x = dq
+        r_yu, r_yl = -du, dl
 
         # Extract derivatives for the constraints
         rows, cols = A_idx
         dA_vals = (y_u[rows] - y_l[rows]) * r_x[cols] + \
             (r_yu[rows] - r_yl[rows]) * x[cols]
-        dA = spa.csc_matrix((dA_vals, (rows, cols)), shape=A.shape)
-        du = - r_yu
-        dl = r_yl
+        dA = spa.csc_matrix((dA_vals, (rows, cols)), shape=(m, n))
 
         # Extract derivatives for the cost (P, q)
         rows, cols = P_idx
         dP_vals = .5 * (r_x[rows] * x[cols] + r_x[cols] * x[rows])
-        dP = spa.csc_matrix((dP_vals, P_idx), shape=P.shape)
-        dq = r_x
+        dP = spa.csc_matrix((dP_vals, P_idx), shape=(n, n))
 
         return (dP, dq, dA, dl, du)
+
+    def adjoint_derivative_batch(self, dx=None, dy_u=None, dy_l=None,
+                                 eps_iter_ref=1e-04):
+        """
+        Compute the adjoint derivatives of a batch of gradients after solve.
+
+        The rows of dx, dy_u and dy_l are the gradients of the losses. All of
+        them are solved together with the factorization of the reduced KKT
+        matrix. Returns (dPx, dq, dAx, dl, du) stacked by rows, where dPx and
+        dAx are the gradients with respect to the values of the upper
+        triangular part of P and of A, in the order of update(Px=..., Ax=...).
+        """
+        if 'results' not in self._derivative_cache:
+            raise ValueError("Problem has not been solved. "
+                             "You cannot take derivatives. "
+                             "Please call the solve function.")
+
+        (n, m) = self._model.dimensions()
+        seeds = [s for s in (dx, dy_u, dy_l) if s is not None]
+        if not seeds:
+            raise ValueError("No gradients given")
+        k = np.shape(seeds[0])[0]
+
+        def stacked(s, size):
+            if s is None:
+                return np.zeros((k, size))
+            return np.ascontiguousarray(s, dtype=np.float64)
+
+        return self._model.adjoint_derivative_batch(
+            stacked(dx, n), stacked(dy_u, m), stacked(dy_l, m), eps_iter_ref)
+
+    def forward_derivative(self, dq=None, dl=None, du=None, dPx=None,
+                           dAx=None, eps_iter_ref=1e-04):
+        """
+        Compute forward derivatives (Jacobian-vector products) after solve.
+
+        The perturbations are vectors for a single direction, or arrays with
+        one direction per row. dPx and dAx perturb the values of the upper
+        triangular part of P and of A, in the order of update(Px=..., Ax=...).
+        Returns (dx, dy) with the same number of directions.
+        """
+        if 'results' not in self._derivative_cache:
+            raise ValueError("Problem has not been solved. "
+                             "You cannot take derivatives. "
+                             "Please call the solve function.")
+
+        dirs = [d for d in (dq, dl, du, dPx, dAx) if d is not None]
+        if not dirs:
+            raise ValueError("No perturbations given")
+        single = np.ndim(dirs[0]) == 1
+
+        def stacked(d):
+            if d is None:
+                return None
+            return np.ascontiguousarray(np.atleast_2d(d), dtype=np.float64)
+
+        dx, dy = self._model.forward_derivative(
+            stacked(dPx), stacked(dq), stacked(dAx), stacked(dl), stacked(du),
+            eps_iter_ref)
+        if single:
+            return dx[0], dy[0]
+        return dx, dy
+
+    def solve_batch(self, q, l, u, Px=None, Ax=None, dx=None, dy_u=None,
+                    dy_l=None, nthreads=0, eps_iter_ref=1e-04):
+        """
+        Solve a batch of problem instances with the sparsity and settings of
+        this problem, and differentiate them if gradients are given.
+
+        q, l and u have one instance per row. Px and Ax hold the values of
+        the upper triangular part of P and of A of each instance, in the
+        order of update(Px=..., Ax=...); the values of the setup are used
+        when they are None. The instances run on nthreads native threads
+        (all processors if 0), each setting up a single workspace. Every
+        instance is cold started, so the outputs do not depend on nthreads.
+
+        Returns (x, y, status, grads) stacked by rows, where grads is None
+        without gradients and (dPx, dq, dAx, dl, du) otherwise. The outputs
+        of instances that were not solved are NaN.
+        """
+        def stacked(v):
+            if v is None:
+                return None
+            return np.ascontiguousarray(np.atleast_2d(v), dtype=np.float64)
+
+        l = np.maximum(stacked(l), -_OSQP_INFTY)
+        u = np.minimum(stacked(u), _OSQP_INFTY)
+        return self._model.solve_batch(
+            stacked(Px), stacked(q), stacked(Ax), l, u, stacked(dx),
+            stacked(dy_u), stacked(dy_l), nthreads, eps_iter_ref)
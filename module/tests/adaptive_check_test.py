@@ -0,0 +1,68 @@
+# Test osqp python module
+import rlqp as osqp
+import numpy as np
+from scipy import sparse
+
+# Unit Test
+import unittest
+import numpy.testing as nptest
+
+
+class adaptive_check_tests(unittest.TestCase):
+
+    def setUp(self):
+        np.random.seed(1)
+
+        self.n = 50
+        self.m = 80
+        P = sparse.random(self.n, self.n, density=0.2)
+        self.P = sparse.triu(P.dot(P.T) + 0.1 * sparse.eye(self.n),
+                             format='csc')
+        self.q = np.random.randn(self.n)
+        self.A = sparse.random(self.m, self.n, density=0.2, format='csc')
+        self.l = -1. - np.random.rand(self.m)
+        self.u = 1. + np.random.rand(self.m)
+        self.opts = {'verbose': False,
+                     'eps_abs': 1e-06,
+                     'eps_rel': 1e-06,
+                     'polish': False}
+
+    def test_adaptive_check_QP(self):
+        model = osqp.OSQP()
+        model.setup(self.P, self.q, self.A, self.l, self.u, **self.opts)
+        res_fixed = model.solve()
+
+        model = osqp.OSQP()
+        model.setup(self.P, self.q, self.A, self.l, self.u,
+                    check_termination='adaptive', **self.opts)
+        res = model.solve()
+
+        self.assertEqual(res.info.status_val, osqp.constant('OSQP_SOLVED'))
+        nptest.assert_allclose(res.x, res_fixed.x, rtol=1e-4, atol=1e-4)
+        nptest.assert_allclose(res.y, res_fixed.y, rtol=1e-4, atol=1e-4)
+
+        # Warm started solve after an update of the linear cost
+        q_new = self.q + 0.1 * np.random.randn(self.n)
+        model.update(q=q_new)
+        res = model.solve()
+
+        model_fixed = osqp.OSQP()
+        model_fixed.setup(self.P, q_new, self.A, self.l, self.u, **self.opts)
+        res_fixed = model_fixed.solve()
+        nptest.assert_allclose(res.x, res_fixed.x, rtol=1e-4, atol=1e-4)
+
+    def test_adaptive_check_infeasible(self):
+        # Infeasibility is detected by the periodic checks
+        l = self.l.copy()
+        u = self.u.copy()
+        A = sparse.vstack([self.A, self.A[0]], format='csc')
+        l = np.hstack([l, u[0] + 1.])
+        u = np.hstack([u, u[0] + 2.])
+
+        model = osqp.OSQP()
+        model.setup(self.P, self.q, A, l, u,
+                    check_termination='adaptive', **self.opts)
+        res = model.solve()
+
+        self.assertEqual(res.info.status_val,
+                         osqp.constant('OSQP_PRIMAL_INFEASIBLE'))
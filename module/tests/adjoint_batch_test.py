@@ -0,0 +1,71 @@
+# Test osqp python module
+import rlqp as osqp
+import numpy as np
+from scipy import sparse
+
+# Unit Test
+import unittest
+import numpy.testing as nptest
+
+
+class adjoint_batch_tests(unittest.TestCase):
+
+    def setUp(self):
+        np.random.seed(1)
+
+        self.n = 20
+        self.m = 15
+        L = np.random.randn(self.n, self.n)
+        self.P = sparse.csc_matrix(L.dot(L.T) + 5. * np.eye(self.n))
+        self.q = np.random.randn(self.n)
+        self.A = sparse.random(self.m, self.n, density=0.5, format='csc')
+        x_0 = np.random.randn(self.n)
+        self.l = self.A.dot(x_0) - np.random.rand(self.m)
+        self.u = self.A.dot(x_0) + np.random.rand(self.m)
+        self.opts = {'verbose': False,
+                     'eps_abs': 1e-10,
+                     'eps_rel': 1e-10,
+                     'max_iter': 10000}
+
+    def test_adjoint_batch(self):
+        model = osqp.OSQP()
+        model.setup(self.P, self.q, self.A, self.l, self.u, **self.opts)
+        res = model.solve()
+
+        k = 5
+        dx = np.random.randn(k, self.n)
+        dy_u = np.random.randn(k, self.m)
+        dy_l = np.random.randn(k, self.m)
+        dPx, dq, dAx, dl, du = model.adjoint_derivative_batch(dx, dy_u, dy_l)
+        self.assertEqual(dq.shape, (k, self.n))
+        self.assertEqual(dl.shape, (k, self.m))
+
+        # Same gradients as one by one, aligned to the patterns of the setup
+        P_triu = sparse.triu(self.P, format='csc')
+        P_triu.sort_indices()
+        P_rows = P_triu.indices
+        P_cols = np.repeat(np.arange(self.n), np.diff(P_triu.indptr))
+        A_rows = self.A.indices
+        A_cols = np.repeat(np.arange(self.n), np.diff(self.A.indptr))
+        for r in range(k):
+            _, dq_r, _, dl_r, du_r = model.adjoint_derivative(
+                dx=dx[r], dy_u=dy_u[r], dy_l=dy_l[r])
+            nptest.assert_allclose(dq[r], dq_r, rtol=1e-6, atol=1e-8)
+            nptest.assert_allclose(dl[r], dl_r, rtol=1e-6, atol=1e-8)
+            nptest.assert_allclose(du[r], du_r, rtol=1e-6, atol=1e-8)
+
+            w = -(dl_r + du_r)
+            dAx_r = res.y[A_rows] * dq_r[A_cols] + w[A_rows] * res.x[A_cols]
+            nptest.assert_allclose(dAx[r], dAx_r, rtol=1e-6, atol=1e-8)
+            dPx_r = dq_r[P_rows] * res.x[P_cols] + dq_r[P_cols] * res.x[P_rows]
+            dPx_r[P_rows == P_cols] *= .5
+            nptest.assert_allclose(dPx[r], dPx_r, rtol=1e-6, atol=1e-8)
+
+    def test_adjoint_batch_dimensions(self):
+        model = osqp.OSQP()
+        model.setup(self.P, self.q, self.A, self.l, self.u, **self.opts)
+        model.solve()
+        with self.assertRaises(ValueError):
+            model.adjoint_derivative_batch(dx=np.zeros((3, self.n + 1)))
+        with self.assertRaises(ValueError):
+            model.adjoint_derivative_batch()
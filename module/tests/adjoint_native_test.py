@@ -0,0 +1,82 @@
+# Test osqp python module
+import rlqp as osqp
+import numpy as np
+from scipy import sparse
+
+# Unit Test
+import unittest
+import numpy.testing as nptest
+
+
+class adjoint_native_tests(unittest.TestCase):
+
+    def setUp(self):
+        np.random.seed(1)
+
+        self.n = 20
+        self.m = 15
+        L = np.random.randn(self.n, self.n)
+        self.P = sparse.csc_matrix(L.dot(L.T) + 5. * np.eye(self.n))
+        self.q = np.random.randn(self.n)
+        self.A = sparse.random(self.m, self.n, density=0.5, format='csc')
+        x_0 = np.random.randn(self.n)
+        self.l = self.A.dot(x_0) - np.random.rand(self.m)
+        self.u = self.A.dot(x_0) + np.random.rand(self.m)
+        self.opts = {'verbose': False,
+                     'eps_abs': 1e-10,
+                     'eps_rel': 1e-10,
+                     'max_iter': 10000}
+
+    def reference(self, x, y, dx):
+        # Dense solve of the reduced KKT system on the active constraints
+        Ax = self.A.dot(x)
+        upper = (y > 0) & (self.u - Ax < y)
+        lower = (y < 0) & (Ax - self.l < -y)
+        S = np.where(upper | lower)[0]
+        A_S = self.A.toarray()[S]
+        K = np.block([[self.P.toarray(), A_S.T],
+                      [A_S, np.zeros((len(S), len(S)))]])
+        sol = np.linalg.solve(K, np.concatenate([-dx, np.zeros(len(S))]))
+        w = np.zeros(self.m)
+        w[S] = sol[self.n:]
+        return sol[:self.n], np.where(lower, -w, 0.), np.where(upper, -w, 0.)
+
+    def test_adjoint_native(self):
+        model = osqp.OSQP()
+        model.setup(self.P, self.q, self.A, self.l, self.u, **self.opts)
+        res = model.solve()
+        self.assertEqual(res.info.status_val, osqp.constant('OSQP_SOLVED'))
+
+        dx = np.random.randn(self.n)
+        dP, dq, dA, dl, du = model.adjoint_derivative(dx=dx)
+        dq_ref, dl_ref, du_ref = self.reference(res.x, res.y, dx)
+        nptest.assert_allclose(dq, dq_ref, rtol=1e-6, atol=1e-8)
+        nptest.assert_allclose(dl, dl_ref, rtol=1e-6, atol=1e-8)
+        nptest.assert_allclose(du, du_ref, rtol=1e-6, atol=1e-8)
+
+        # The factorization is reused for other gradients
+        dx2 = np.random.randn(self.n)
+        dq2 = model.adjoint_derivative(dx=dx2)[1]
+        nptest.assert_allclose(dq2, self.reference(res.x, res.y, dx2)[0],
+                               rtol=1e-6, atol=1e-8)
+
+        # And refactored at a new solution
+        q = np.random.randn(self.n)
+        model.update(q=q)
+        res = model.solve()
+        dq = model.adjoint_derivative(dx=dx)[1]
+        nptest.assert_allclose(dq, self.reference(res.x, res.y, dx)[0],
+                               rtol=1e-6, atol=1e-8)
+
+    def test_adjoint_native_unsolved(self):
+        model = osqp.OSQP()
+        model.setup(self.P, self.q, self.A, self.l, self.u, **self.opts)
+        with self.assertRaises(ValueError):
+            model._model.adjoint_derivative(np.zeros(self.n), np.zeros(self.m),
+                                            np.zeros(self.m), 1e-4)
+
+        model.solve()
+        with self.assertRaises(ValueError):
+            model._model.adjoint_derivative(np.zeros(self.n - 1),
+                                            np.zeros(self.m),
+                                            np.zeros(self.m), 1e-4)
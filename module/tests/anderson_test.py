@@ -0,0 +1,67 @@
+# Test osqp python module
+import rlqp as osqp
+import numpy as np
+from scipy import sparse
+
+# Unit Test
+import unittest
+import numpy.testing as nptest
+
+
+class anderson_tests(unittest.TestCase):
+
+    def setUp(self):
+        np.random.seed(1)
+
+        # Ill-conditioned problem, slow for plain ADMM
+        self.n = 30
+        self.m = 40
+        d = np.logspace(-3, 3, self.n)
+        Q, _ = np.linalg.qr(np.random.randn(self.n, self.n))
+        self.P = sparse.triu(Q.dot(np.diag(d)).dot(Q.T), format='csc')
+        self.q = np.random.randn(self.n)
+        self.A = sparse.random(self.m, self.n, density=0.3, format='csc')
+        self.l = -1. - np.random.rand(self.m)
+        self.u = 1. + np.random.rand(self.m)
+        self.opts = {'verbose': False,
+                     'eps_abs': 1e-06,
+                     'eps_rel': 1e-06,
+                     'max_iter': 20000,
+                     'adaptive_rho': False,
+                     'polish': False}
+
+    def test_anderson_QP(self):
+        model = osqp.OSQP()
+        model.setup(self.P, self.q, self.A, self.l, self.u, **self.opts)
+        res_plain = model.solve()
+        self.assertEqual(res_plain.info.aa_accepted, 0)
+
+        for anderson in [True, 'type1']:
+            model = osqp.OSQP()
+            model.setup(self.P, self.q, self.A, self.l, self.u,
+                        anderson=anderson, anderson_mem=10, **self.opts)
+            res = model.solve()
+
+            self.assertEqual(res.info.status_val,
+                             osqp.constant('OSQP_SOLVED'))
+            self.assertGreater(res.info.aa_accepted, 0)
+            nptest.assert_allclose(res.x, res_plain.x, rtol=1e-3, atol=1e-3)
+            nptest.assert_allclose(res.y, res_plain.y, rtol=1e-3, atol=1e-3)
+
+        # Type II acceleration needs fewer iterations
+        model = osqp.OSQP()
+        model.setup(self.P, self.q, self.A, self.l, self.u,
+                    anderson=True, anderson_mem=10, **self.opts)
+        res = model.solve()
+        self.assertLess(res.info.iter, res_plain.info.iter)
+
+    def test_anderson_settings(self):
+        model = osqp.OSQP()
+        with self.assertRaises(ValueError):
+            model.setup(self.P, self.q, self.A, self.l, self.u,
+                        anderson=True, anderson_mem=0, **self.opts)
+
+        model = osqp.OSQP()
+        with self.assertRaises(ValueError):
+            model.setup(self.P, self.q, self.A, self.l, self.u,
+                        anderson='type3', **self.opts)
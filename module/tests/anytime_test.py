@@ -0,0 +1,65 @@
+# Test osqp python module
+import rlqp as osqp
+import numpy as np
+from scipy import sparse
+import time
+
+# Unit Test
+import unittest
+import numpy.testing as nptest
+
+
+class anytime_tests(unittest.TestCase):
+
+    def setUp(self):
+        np.random.seed(1)
+
+        self.n = 50
+        self.m = 80
+        P = sparse.random(self.n, self.n, density=0.2)
+        self.P = sparse.csc_matrix(P.dot(P.T) + 0.1 * sparse.eye(self.n))
+        self.q = np.random.randn(self.n)
+        self.A = sparse.random(self.m, self.n, density=0.2, format='csc')
+        self.l = -1. - np.random.rand(self.m)
+        self.u = 1. + np.random.rand(self.m)
+        self.opts = {'verbose': False,
+                     'eps_abs': 1e-06,
+                     'eps_rel': 1e-06,
+                     'polish': False}
+
+    def test_anytime_deadline(self):
+        # Tolerances that cannot be met before the deadline
+        model = osqp.OSQP()
+        model.setup(self.P, self.q, self.A, self.l, self.u,
+                    max_iter=1000000000, eps_abs=1e-15, eps_rel=1e-15,
+                    verbose=False, polish=False)
+        res = model.solve(deadline=time.monotonic() + 0.05)
+
+        self.assertEqual(res.info.status_val,
+                         osqp.constant('OSQP_TIME_LIMIT_REACHED'))
+
+        # The info reports the residuals of the returned iterate
+        dua_res = self.P.dot(res.x) + self.q + self.A.T.dot(res.y)
+        nptest.assert_allclose(res.info.dua_res,
+                               np.linalg.norm(dua_res, np.inf),
+                               rtol=1e-6, atol=1e-9)
+
+        # A deadline already passed runs a single iteration
+        res = model.solve(deadline=time.monotonic() - 1.)
+        self.assertEqual(res.info.status_val,
+                         osqp.constant('OSQP_TIME_LIMIT_REACHED'))
+        self.assertEqual(res.info.iter, 1)
+
+    def test_anytime_converged(self):
+        model = osqp.OSQP()
+        model.setup(self.P, self.q, self.A, self.l, self.u, **self.opts)
+        res_plain = model.solve()
+
+        # A distant deadline does not change the solve
+        res = model.solve(deadline=time.monotonic() + 60.)
+        self.assertEqual(res.info.status_val, osqp.constant('OSQP_SOLVED'))
+        nptest.assert_allclose(res.x, res_plain.x, rtol=1e-5, atol=1e-5)
+
+        # Solves without a deadline are not limited by the previous one
+        res = model.solve()
+        self.assertEqual(res.info.status_val, osqp.constant('OSQP_SOLVED'))
@@ -0,0 +1,86 @@
+# Test osqp python module
+import rlqp as osqp
+import numpy as np
+from scipy import sparse
+import asyncio
+import time
+from platform import system
+from rlqp._osqp import async_fd
+
+# Unit Test
+import unittest
+import numpy.testing as nptest
+
+
+@unittest.skipIf(system() == 'Windows', "No worker pool on Windows")
+class async_tests(unittest.TestCase):
+
+    def setUp(self):
+        np.random.seed(1)
+
+        self.n = 30
+        self.m = 50
+        P = sparse.random(self.n, self.n, density=0.2)
+        self.P = sparse.csc_matrix(P.dot(P.T) + 0.1 * sparse.eye(self.n))
+        self.A = sparse.random(self.m, self.n, density=0.2, format='csc')
+        self.l = -1. - np.random.rand(self.m)
+        self.u = 1. + np.random.rand(self.m)
+        self.opts = {'verbose': False,
+                     'eps_abs': 1e-06,
+                     'eps_rel': 1e-06,
+                     'polish': False}
+
+    def test_solve_async(self):
+        qs = [np.random.randn(self.n) for _ in range(100)]
+        models = []
+        for q in qs:
+            model = osqp.OSQP()
+            model.setup(self.P, q, self.A, self.l, self.u, **self.opts)
+            models.append(model)
+
+        async def solve_all():
+            results = await asyncio.gather(*[m.solve_async() for m in models])
+            # The loop stops watching the finished solves
+            self.assertFalse(asyncio.get_running_loop().remove_reader(
+                async_fd()))
+            return results
+
+        loop = asyncio.new_event_loop()
+        try:
+            results = loop.run_until_complete(solve_all())
+        finally:
+            loop.close()
+
+        for q, res in zip(qs, results):
+            model = osqp.OSQP()
+            model.setup(self.P, q, self.A, self.l, self.u, **self.opts)
+            res_sync = model.solve()
+            self.assertEqual(res.info.status_val, osqp.constant('OSQP_SOLVED'))
+            nptest.assert_allclose(res.x, res_sync.x, rtol=1e-5, atol=1e-5)
+
+    def test_solve_async_cancel(self):
+        model = osqp.OSQP()
+        model.setup(self.P, np.random.randn(self.n), self.A, self.l, self.u,
+                    max_iter=1000000000, eps_abs=1e-15, eps_rel=1e-15,
+                    verbose=False, polish=False)
+
+        async def solve_timeout():
+            with self.assertRaises(asyncio.TimeoutError):
+                await asyncio.wait_for(model.solve_async(), 0.1)
+            # The cancelled native solve frees the model
+            for _ in range(100):
+                await asyncio.sleep(0.05)
+                try:
+                    return await model.solve_async(
+                        deadline=time.monotonic() + 0.05)
+                except ValueError:
+                    pass
+
+        loop = asyncio.new_event_loop()
+        try:
+            res = loop.run_until_complete(solve_timeout())
+        finally:
+            loop.close()
+
+        self.assertEqual(res.info.status_val,
+                         osqp.constant('OSQP_TIME_LIMIT_REACHED'))
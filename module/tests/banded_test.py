@@ -0,0 +1,86 @@
+# Test osqp python module
+import rlqp as osqp
+import numpy as np
+from scipy import sparse
+
+# Unit Test
+import unittest
+import numpy.testing as nptest
+
+
+class banded_tests(unittest.TestCase):
+
+    def setUp(self):
+        np.random.seed(1)
+
+        # MPC of a double integrator: x_{t+1} = Ad x_t + Bd u_t
+        self.T = 30
+        nx, nu = 2, 1
+        Ad = sparse.csc_matrix([[1., 0.1], [0., 1.]])
+        Bd = sparse.csc_matrix([[0.005], [0.1]])
+        x0 = np.array([1., 0.])
+
+        # Variables (x_0, ..., x_T, u_0, ..., u_{T-1})
+        Nx = (self.T + 1) * nx
+        Nu = self.T * nu
+        self.P = sparse.block_diag([sparse.eye(Nx), 0.1 * sparse.eye(Nu)],
+                                   format='csc')
+        self.q = np.zeros(Nx + Nu)
+        Ax = sparse.kron(sparse.eye(self.T + 1), -sparse.eye(nx)) + \
+            sparse.kron(sparse.eye(self.T + 1, k=-1), Ad)
+        Bu = sparse.kron(sparse.vstack([sparse.csc_matrix((1, self.T)),
+                                        sparse.eye(self.T)]), Bd)
+        Aeq = sparse.hstack([Ax, Bu])
+        Aineq = sparse.eye(Nx + Nu)
+        self.A = sparse.vstack([Aeq, Aineq], format='csc')
+        leq = np.hstack([-x0, np.zeros(self.T * nx)])
+        self.l = np.hstack([leq, -2. * np.ones(Nx), -1. * np.ones(Nu)])
+        self.u = np.hstack([leq, 2. * np.ones(Nx), 1. * np.ones(Nu)])
+
+        # Stage of each variable and constraint
+        self.stages = np.hstack([np.repeat(np.arange(self.T + 1), nx),
+                                 np.arange(self.T),
+                                 np.repeat(np.arange(self.T + 1), nx),
+                                 np.repeat(np.arange(self.T + 1), nx),
+                                 np.arange(self.T)])
+        self.opts = {'verbose': False,
+                     'eps_abs': 1e-06,
+                     'eps_rel': 1e-06,
+                     'polish': False}
+
+    def test_banded_QP(self):
+        model = osqp.OSQP()
+        model.setup(self.P, self.q, self.A, self.l, self.u,
+                    linsys_solver='qdldl', **self.opts)
+        res_qdldl = model.solve()
+
+        # Given stages and band detected by the RCM ordering
+        for settings in [{'stages': self.stages}, {}]:
+            model = osqp.OSQP()
+            model.setup(self.P, self.q, self.A, self.l, self.u,
+                        linsys_solver='banded', **settings, **self.opts)
+            res = model.solve()
+
+            self.assertEqual(res.info.status_val,
+                             osqp.constant('OSQP_SOLVED'))
+            nptest.assert_allclose(res.x, res_qdldl.x, rtol=1e-4, atol=1e-4)
+            nptest.assert_allclose(res.y, res_qdldl.y, rtol=1e-4, atol=1e-4)
+
+    def test_banded_update(self):
+        model = osqp.OSQP()
+        model.setup(self.P, self.q, self.A, self.l, self.u,
+                    linsys_solver='banded', stages=self.stages, **self.opts)
+        model.solve()
+
+        # Update P and rho, which trigger a numerical refactorization
+        P_new = 2. * self.P
+        model.update(Px=sparse.triu(P_new).data)
+        model.update_settings(rho=1.0)
+        res = model.solve()
+
+        model_qdldl = osqp.OSQP()
+        model_qdldl.setup(P_new, self.q, self.A, self.l, self.u,
+                          linsys_solver='qdldl', **self.opts)
+        res_qdldl = model_qdldl.solve()
+
+        nptest.assert_allclose(res.x, res_qdldl.x, rtol=1e-4, atol=1e-4)
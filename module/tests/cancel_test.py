@@ -0,0 +1,81 @@
+# Test osqp python module
+import rlqp as osqp
+import numpy as np
+from scipy import sparse
+import threading
+import time
+
+# Unit Test
+import unittest
+
+
+class cancel_tests(unittest.TestCase):
+
+    def setUp(self):
+        np.random.seed(1)
+
+        self.n = 50
+        self.m = 80
+        P = sparse.random(self.n, self.n, density=0.2)
+        self.P = sparse.csc_matrix(P.dot(P.T) + 0.1 * sparse.eye(self.n))
+        self.q = np.random.randn(self.n)
+        self.A = sparse.random(self.m, self.n, density=0.2, format='csc')
+        self.l = -1. - np.random.rand(self.m)
+        self.u = 1. + np.random.rand(self.m)
+
+        # Tolerances that are never met
+        self.opts = {'verbose': False,
+                     'eps_abs': 1e-15,
+                     'eps_rel': 1e-15,
+                     'max_iter': 1000000000,
+                     'polish': False,
+                     'cancellable': True}
+
+    def solve_cancelled(self, **settings):
+        model = osqp.OSQP()
+        model.setup(self.P, self.q, self.A, self.l, self.u,
+                    **settings, **self.opts)
+
+        results = []
+        thread = threading.Thread(target=lambda: results.append(model.solve()))
+        thread.start()
+        time.sleep(0.1)
+        model.cancel()
+        thread.join(10.)
+        self.assertFalse(thread.is_alive())
+        return results[0]
+
+    def test_cancel(self):
+        res = self.solve_cancelled()
+
+        self.assertEqual(res.info.status_val, osqp.constant('OSQP_CANCELLED'))
+        self.assertEqual(res.info.status, 'cancelled')
+        self.assertGreater(res.info.iter, 0)
+        self.assertTrue(np.all(np.isfinite(res.x)))
+
+    def test_cancel_before_solve(self):
+        model = osqp.OSQP()
+        model.setup(self.P, self.q, self.A, self.l, self.u, **self.opts)
+
+        # The request is kept for the next solve only
+        model.cancel()
+        res = model.solve()
+        self.assertEqual(res.info.status_val, osqp.constant('OSQP_CANCELLED'))
+
+        model.update_max_iter(10)
+        res = model.solve()
+        self.assertEqual(res.info.status_val,
+                         osqp.constant('OSQP_MAX_ITER_REACHED'))
+
+    def test_cancel_decomposed(self):
+        # Two independent copies of the problem
+        P = sparse.block_diag([self.P, self.P], format='csc')
+        A = sparse.block_diag([self.A, self.A], format='csc')
+        self.P, self.A = P, A
+        self.q = np.hstack([self.q, self.q])
+        self.l = np.hstack([self.l, self.l])
+        self.u = np.hstack([self.u, self.u])
+
+        res = self.solve_cancelled(decompose=True, threads=2)
+
+        self.assertEqual(res.info.status_val, osqp.constant('OSQP_CANCELLED'))
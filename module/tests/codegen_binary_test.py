@@ -0,0 +1,60 @@
+# Test osqp python module
+import rlqp as osqp
+import numpy as np
+from scipy import sparse
+from platform import system
+
+# Unit Test
+import unittest
+import numpy.testing as nptest
+import shutil as sh
+
+
+@unittest.skipIf(system() == 'Windows', "No .incbin with MSVC")
+class codegen_binary_tests(unittest.TestCase):
+
+    def setUp(self):
+        # Simple QP problem
+        self.P = sparse.diags([11., 0.1], format='csc')
+        self.P_new = sparse.eye(2, format='csc')
+        self.q = np.array([3, 4])
+        self.A = sparse.csc_matrix([[-1, 0], [0, -1], [-1, -3],
+                                    [2, 5], [3, 4]])
+        self.u = np.array([0, 0, -15, 100, 80])
+        self.l = -np.inf * np.ones(len(self.u))
+        self.opts = {'verbose': False,
+                     'eps_abs': 1e-08,
+                     'eps_rel': 1e-08,
+                     'alpha': 1.6,
+                     'max_iter': 3000,
+                     'warm_start': True}
+        self.model = osqp.OSQP()
+        self.model.setup(P=self.P, q=self.q, A=self.A, l=self.l, u=self.u,
+                         **self.opts)
+
+    def test_solve(self):
+        # The binary workspace gives the same solution as the text one
+        self.model.codegen('code_bin', python_ext_name='bin_emosqp',
+                           force_rewrite=True, binary_data=True)
+        sh.rmtree('code_bin')
+        import bin_emosqp
+
+        x, y, _, _, _ = bin_emosqp.solve()
+        nptest.assert_array_almost_equal(x, np.array([0., 5.]), decimal=5)
+        nptest.assert_array_almost_equal(
+            y, np.array([1.5, 0., 1.5, 0., 0.]), decimal=5)
+
+    def test_update_P(self):
+        # The arrays in the blob can be updated
+        self.model.codegen('code_bin2', python_ext_name='bin_mat_emosqp',
+                           force_rewrite=True, parameters='matrices',
+                           binary_data=True)
+        sh.rmtree('code_bin2')
+        import bin_mat_emosqp
+
+        Px = self.P_new.data
+        bin_mat_emosqp.update_P(Px, np.arange(len(Px)), len(Px))
+        x, y, _, _, _ = bin_mat_emosqp.solve()
+        nptest.assert_array_almost_equal(x, np.array([0., 5.]), decimal=5)
+        nptest.assert_array_almost_equal(
+            y, np.array([0., 0., 3., 0., 0.]), decimal=5)
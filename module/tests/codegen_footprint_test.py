@@ -0,0 +1,69 @@
+# Test osqp python module
+import rlqp as osqp
+import numpy as np
+from scipy import sparse
+
+# Unit Test
+import unittest
+import numpy.testing as nptest
+import shutil as sh
+import json
+import os
+
+
+class codegen_footprint_tests(unittest.TestCase):
+
+    def setUp(self):
+        # Simple QP problem
+        self.P = sparse.diags([11., 0.], format='csc')
+        self.q = np.array([3, 4])
+        self.A = sparse.csc_matrix(
+            [[-1, 0], [0, -1], [-1, -3], [2, 5], [3, 4]])
+        self.u = np.array([0, 0, -15, 100, 80])
+        self.l = -np.inf * np.ones(len(self.u))
+        self.opts = {'verbose': False,
+                     'eps_abs': 1e-08,
+                     'eps_rel': 1e-08,
+                     'rho': 0.01,
+                     'alpha': 1.6,
+                     'max_iter': 10000,
+                     'warm_start': True}
+        self.model = osqp.OSQP()
+        self.model.setup(P=self.P, q=self.q, A=self.A, l=self.l, u=self.u,
+                         **self.opts)
+
+    def footprint(self, **kwargs):
+        self.model.codegen('code_fp', force_rewrite=True, **kwargs)
+        with open(os.path.join('code_fp', 'footprint.json')) as f:
+            report = json.load(f)
+        sh.rmtree('code_fp')
+        return report
+
+    def test_footprint(self):
+        report = self.footprint(python_ext_name='fp_emosqp')
+        structures = report['structures']
+
+        self.assertEqual(structures['data']['Adata_x'],
+                         {'type': 'c_float', 'length': self.A.nnz,
+                          'initialized': True,
+                          'bytes': {'float': 4 * self.A.nnz,
+                                    'double': 8 * self.A.nnz}})
+        self.assertEqual(structures['data']['Adata_i']['bytes'],
+                         {'int': 4 * self.A.nnz, 'long': 8 * self.A.nnz})
+        self.assertEqual(structures['kkt'], {})
+
+        total = sum(a['bytes']['double'] for s in structures.values()
+                    for a in s.values() if 'double' in a['bytes'])
+        total += sum(a['bytes']['long'] for s in structures.values()
+                     for a in s.values() if 'long' in a['bytes'])
+        self.assertEqual(report['total']['double_long'], total)
+
+    def test_trim(self):
+        report = self.footprint(python_ext_name='fp_trim_emosqp',
+                                trim_unused=True)
+        self.assertNotIn('work_D_temp', report['structures']['work'])
+
+        # The trimmed solver gives the same solution
+        import fp_trim_emosqp
+        x, y, _, _, _ = fp_trim_emosqp.solve()
+        nptest.assert_array_almost_equal(x, np.array([0., 5.]), decimal=5)
@@ -0,0 +1,73 @@
+# Test osqp python module
+import rlqp as osqp
+import numpy as np
+from scipy import sparse
+from concurrent.futures import ThreadPoolExecutor
+
+# Unit Test
+import unittest
+import numpy.testing as nptest
+import shutil as sh
+
+
+class codegen_instance_tests(unittest.TestCase):
+
+    def setUp(self):
+        np.random.seed(1)
+
+        self.n = 10
+        self.m = 20
+        P = sparse.random(self.n, self.n, density=0.3)
+        self.P = sparse.csc_matrix(P.dot(P.T) + 0.1 * sparse.eye(self.n))
+        self.q = np.random.randn(self.n)
+        self.A = sparse.random(self.m, self.n, density=0.3, format='csc')
+        self.l = -1. - np.random.rand(self.m)
+        self.u = 1. + np.random.rand(self.m)
+        self.opts = {'verbose': False,
+                     'eps_abs': 1e-08,
+                     'eps_rel': 1e-08,
+                     'polish': False,
+                     'max_iter': 10000}
+        self.model = osqp.OSQP()
+        self.model.setup(P=self.P, q=self.q, A=self.A, l=self.l, u=self.u,
+                         **self.opts)
+
+    def reference(self, q):
+        model = osqp.OSQP()
+        model.setup(P=self.P, q=q, A=self.A, l=self.l, u=self.u,
+                    **self.opts)
+        return model.solve().x
+
+    def test_instances(self):
+        self.model.codegen('code_inst', python_ext_name='inst_emosqp',
+                           force_rewrite=True)
+        sh.rmtree('code_inst')
+        import inst_emosqp
+
+        # Instances start from the workspace and are updated separately
+        a = inst_emosqp.Instance()
+        b = inst_emosqp.Instance()
+        q = np.random.randn(self.n)
+        b.update_lin_cost(q)
+
+        x_a = a.solve()[0]
+        x_b = b.solve()[0]
+        nptest.assert_allclose(x_a, self.reference(self.q), atol=1e-5)
+        nptest.assert_allclose(x_b, self.reference(q), atol=1e-5)
+
+        # The module workspace is not affected
+        nptest.assert_allclose(inst_emosqp.solve()[0], x_a, atol=1e-5)
+
+    def test_instances_threads(self):
+        import inst_emosqp
+
+        qs = [np.random.randn(self.n) for _ in range(8)]
+        instances = [inst_emosqp.Instance() for _ in qs]
+        for inst, q in zip(instances, qs):
+            inst.update_lin_cost(q)
+
+        with ThreadPoolExecutor(4) as pool:
+            results = list(pool.map(lambda inst: inst.solve(), instances))
+
+        for q, res in zip(qs, results):
+            nptest.assert_allclose(res[0], self.reference(q), atol=1e-5)
@@ -0,0 +1,58 @@
+# Test osqp python module
+import rlqp as osqp
+import numpy as np
+from scipy import sparse
+
+# Unit Test
+import unittest
+import numpy.testing as nptest
+import shutil as sh
+
+
+class codegen_kernels_tests(unittest.TestCase):
+
+    def setUp(self):
+        np.random.seed(1)
+
+        self.n = 6
+        self.m = 8
+        P = sparse.random(self.n, self.n, density=0.4)
+        self.P = sparse.csc_matrix(P.dot(P.T) + 0.1 * sparse.eye(self.n))
+        self.q = np.random.randn(self.n)
+        self.A = sparse.random(self.m, self.n, density=0.4, format='csc')
+        self.l = -1. - np.random.rand(self.m)
+        self.u = 1. + np.random.rand(self.m)
+        self.opts = {'verbose': False,
+                     'eps_abs': 1e-08,
+                     'eps_rel': 1e-08,
+                     'polish': False,
+                     'max_iter': 10000}
+        self.model = osqp.OSQP()
+        self.model.setup(P=self.P, q=self.q, A=self.A, l=self.l, u=self.u,
+                         **self.opts)
+
+    def test_solve(self):
+        self.model.codegen('code_kern', python_ext_name='kern_emosqp',
+                           force_rewrite=True, parameters='matrices',
+                           specialize_kernels=True)
+        sh.rmtree('code_kern')
+        import kern_emosqp
+
+        x, y, _, _, _ = kern_emosqp.solve()
+        res = self.model.solve()
+        nptest.assert_allclose(x, res.x, atol=1e-5)
+        nptest.assert_allclose(y, res.y, atol=1e-5)
+
+    def test_update_A(self):
+        # The kernels keep the pattern and read the updated values
+        import kern_emosqp
+
+        Ax = 2. * self.A.data
+        kern_emosqp.update_A(Ax, None, 0)
+        x, y, _, _, _ = kern_emosqp.solve()
+
+        self.model.update(Ax=Ax)
+        res = self.model.solve()
+        nptest.assert_allclose(x, res.x, atol=1e-5)
+        nptest.assert_allclose(y, res.y, atol=1e-5)
+        kern_emosqp.update_A(self.A.data, None, 0)
@@ -0,0 +1,53 @@
+# Test osqp python module
+import rlqp as osqp
+import numpy as np
+from scipy import sparse
+
+# Unit Test
+import unittest
+import numpy.testing as nptest
+import shutil as sh
+
+
+class codegen_policy_tests(unittest.TestCase):
+
+    def setUp(self):
+        # Simple QP problem
+        self.P = sparse.diags([11., 0.1], format='csc')
+        self.q = np.array([3, 4])
+        self.A = sparse.csc_matrix([[-1, 0], [0, -1], [-1, -3],
+                                    [2, 5], [3, 4]])
+        self.u = np.array([0, 0, -15, 100, 80])
+        self.l = -np.inf * np.ones(len(self.u))
+        self.opts = {'verbose': False,
+                     'eps_abs': 1e-08,
+                     'eps_rel': 1e-08,
+                     'alpha': 1.6,
+                     'max_iter': 3000,
+                     'adaptive_rho_interval': 10}
+        self.model = osqp.OSQP()
+        self.model.setup(P=self.P, q=self.q, A=self.A, l=self.l, u=self.u,
+                         **self.opts)
+
+    def test_solve(self):
+        # Policy giving rho = 0.5 + relu(rho - 1)
+        policy = [(np.eye(7)[[6]], -np.ones(1)),
+                  (np.ones((1, 1)), 0.5 * np.ones(1))]
+        self.model.codegen('code_pol', python_ext_name='pol_emosqp',
+                           force_rewrite=True, parameters='matrices',
+                           rho_policy=policy)
+        sh.rmtree('code_pol')
+        import pol_emosqp
+
+        x, y, status, _, _ = pol_emosqp.solve()
+        self.assertEqual(status, osqp.constant('OSQP_SOLVED'))
+        nptest.assert_array_almost_equal(x, np.array([0., 5.]), decimal=5)
+        nptest.assert_array_almost_equal(
+            y, np.array([1.5, 0., 1.5, 0., 0.]), decimal=5)
+
+    def test_invalid_policy(self):
+        with self.assertRaises(ValueError):
+            self.model.codegen('code_pol', rho_policy=[(np.ones((1, 7)), [0.])])
+        with self.assertRaises(ValueError):
+            self.model.codegen('code_pol', parameters='matrices',
+                               rho_policy=[(np.ones((2, 7)), np.zeros(2))])
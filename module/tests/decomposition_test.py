@@ -0,0 +1,96 @@
+# Test osqp python module
+import rlqp as osqp
+import numpy as np
+from scipy import sparse
+
+# Unit Test
+import unittest
+import numpy.testing as nptest
+
+
+class decomposition_tests(unittest.TestCase):
+
+    def setUp(self):
+        np.random.seed(1)
+
+        # Independent problems stacked in block diagonal form
+        self.nblocks = 4
+        self.nb = 10
+        self.mb = 8
+        Ps, As = [], []
+        for _ in range(self.nblocks):
+            P = sparse.random(self.nb, self.nb, density=0.4)
+            Ps.append(P.dot(P.T) + 0.1 * sparse.eye(self.nb))
+            As.append(sparse.random(self.mb, self.nb, density=0.5))
+        self.P = sparse.block_diag(Ps, format='csc')
+        self.A = sparse.block_diag(As, format='csc')
+        self.n = self.nblocks * self.nb
+        self.m = self.nblocks * self.mb
+        self.q = np.random.randn(self.n)
+        self.l = -1. - np.random.rand(self.m)
+        self.u = 1. + np.random.rand(self.m)
+        self.opts = {'verbose': False,
+                     'eps_abs': 1e-07,
+                     'eps_rel': 1e-07,
+                     'polish': False}
+
+    def solve(self, decompose, **kwargs):
+        model = osqp.OSQP()
+        model.setup(self.P, self.q, self.A, self.l, self.u,
+                    decompose=decompose, **self.opts, **kwargs)
+        return model, model.solve()
+
+    def test_decomposition(self):
+        _, res_full = self.solve(False)
+        model, res = self.solve(True, threads=2)
+
+        self.assertEqual(res.info.status_val,
+                         osqp.constant('OSQP_SOLVED'))
+        self.assertEqual(model._model.dimensions(), (self.n, self.m))
+        nptest.assert_allclose(res.x, res_full.x, rtol=1e-4, atol=1e-4)
+        nptest.assert_allclose(res.y, res_full.y, rtol=1e-4, atol=1e-4)
+        nptest.assert_allclose(res.info.obj_val, res_full.info.obj_val,
+                               rtol=1e-4, atol=1e-4)
+
+    def test_decomposition_update(self):
+        model, _ = self.solve(True)
+
+        q_new = np.random.randn(self.n)
+        u_new = self.u + 0.5
+        Px_new = self.P.data * 2.
+        Ax_idx = np.arange(0, self.A.nnz, 3)
+        Ax_new = self.A.data[Ax_idx] * 0.5
+        model.update(q=q_new, u=u_new, Px=Px_new, Ax=Ax_new, Ax_idx=Ax_idx)
+        model.update_settings(rho=0.5)
+        res = model.solve()
+
+        A_new = self.A.copy()
+        A_new.data[Ax_idx] = Ax_new
+        model_full = osqp.OSQP()
+        model_full.setup(2. * self.P, q_new, A_new, self.l, u_new,
+                         **self.opts)
+        res_full = model_full.solve()
+
+        nptest.assert_allclose(res.x, res_full.x, rtol=1e-4, atol=1e-4)
+        nptest.assert_allclose(res.y, res_full.y, rtol=1e-4, atol=1e-4)
+
+        # Invalid bounds are rejected for every block
+        l_bad = self.l.copy()
+        l_bad[-1] = u_new[-1] + 1.
+        with self.assertRaises(ValueError):
+            model.update(l=l_bad)
+
+    def test_decomposition_infeasible(self):
+        # Make the last block primal infeasible
+        self.A = sparse.vstack([self.A, self.A[-1:]], format='csc')
+        self.l = np.hstack([self.l, self.u[-1] + 1.])
+        self.u = np.hstack([self.u, self.u[-1] + 2.])
+        self.m += 1
+        _, res = self.solve(True)
+
+        self.assertEqual(res.info.status_val,
+                         osqp.constant('OSQP_PRIMAL_INFEASIBLE'))
+        self.assertEqual(res.prim_inf_cert.shape, (self.m,))
+        # The certificate only involves the constraints of the last block
+        nptest.assert_array_equal(
+            res.prim_inf_cert[:(self.nblocks - 1) * self.mb], 0.)
@@ -0,0 +1,70 @@
+# Test osqp python module
+import rlqp as osqp
+import numpy as np
+from scipy import sparse
+
+# Unit Test
+import unittest
+import numpy.testing as nptest
+
+
+class dense_tests(unittest.TestCase):
+
+    def setUp(self):
+        np.random.seed(1)
+
+        # Small MPC-sized problem with a dense KKT matrix
+        self.n = 10
+        self.m = 15
+        P = sparse.random(self.n, self.n, density=0.5)
+        self.P = sparse.csc_matrix(P.dot(P.T) + 0.1 * sparse.eye(self.n))
+        self.q = np.random.randn(self.n)
+        self.A = sparse.random(self.m, self.n, density=0.6, format='csc')
+        self.l = -1. - np.random.rand(self.m)
+        self.u = 1. + np.random.rand(self.m)
+        self.opts = {'verbose': False,
+                     'eps_abs': 1e-07,
+                     'eps_rel': 1e-07,
+                     'polish': False}
+
+    def test_dense_QP(self):
+        model = osqp.OSQP()
+        model.setup(self.P, self.q, self.A, self.l, self.u,
+                    linsys_solver='qdldl', **self.opts)
+        res_qdldl = model.solve()
+
+        # Explicit selection of the dense solver, and automatic selection
+        # of small problems
+        for settings in [{'linsys_solver': 'dense'}, {}]:
+            model = osqp.OSQP()
+            model.setup(self.P, self.q, self.A, self.l, self.u,
+                        **settings, **self.opts)
+            res = model.solve()
+
+            self.assertEqual(res.info.status_val,
+                             osqp.constant('OSQP_SOLVED'))
+            nptest.assert_allclose(res.x, res_qdldl.x, rtol=1e-5, atol=1e-5)
+            nptest.assert_allclose(res.y, res_qdldl.y, rtol=1e-5, atol=1e-5)
+
+    def test_dense_update_matrices(self):
+        model = osqp.OSQP()
+        model.setup(self.P, self.q, self.A, self.l, self.u,
+                    linsys_solver='dense', **self.opts)
+        model.solve()
+
+        # Update P, A and rho, which trigger a numerical refactorization
+        P_new = 2. * self.P
+        A_new = self.A.copy()
+        A_new.data *= 0.5
+        model.update(Px=sparse.triu(P_new).data, Ax=A_new.data)
+        model.update_settings(rho=1.0)
+        res = model.solve()
+
+        model_qdldl = osqp.OSQP()
+        model_qdldl.setup(P_new, self.q, A_new, self.l, self.u,
+                          linsys_solver='qdldl', **self.opts)
+        res_qdldl = model_qdldl.solve()
+
+        nptest.assert_allclose(res.x, res_qdldl.x, rtol=1e-5, atol=1e-5)
+        nptest.assert_allclose(res.y, res_qdldl.y, rtol=1e-5, atol=1e-5)
+
@@ -0,0 +1,78 @@
+# Test osqp python module
+import rlqp as osqp
+import numpy as np
+from scipy import sparse
+
+# Unit Test
+import unittest
+import numpy.testing as nptest
+
+
+class derivative_cache_tests(unittest.TestCase):
+
+    def setUp(self):
+        np.random.seed(1)
+
+        self.n = 20
+        self.m = 15
+        L = np.random.randn(self.n, self.n)
+        self.P = sparse.csc_matrix(L.dot(L.T) + 5. * np.eye(self.n))
+        self.q = np.random.randn(self.n)
+        self.A = sparse.random(self.m, self.n, density=0.5, format='csc')
+        x_0 = np.random.randn(self.n)
+        self.l = self.A.dot(x_0) - np.random.rand(self.m)
+        self.u = self.A.dot(x_0) + np.random.rand(self.m)
+        self.opts = {'verbose': False,
+                     'eps_abs': 1e-10,
+                     'eps_rel': 1e-10,
+                     'max_iter': 10000}
+
+    def models(self):
+        cached = osqp.OSQP()
+        cached.setup(self.P, self.q, self.A, self.l, self.u,
+                     derivative_cache=True, **self.opts)
+        rebuilt = osqp.OSQP()
+        rebuilt.setup(self.P, self.q, self.A, self.l, self.u, **self.opts)
+        return cached, rebuilt
+
+    def assert_same_grads(self, cached, rebuilt):
+        dx = np.ones(self.n)
+        cached.solve()
+        rebuilt.solve()
+        for g_c, g_r in zip(cached.adjoint_derivative(dx=dx),
+                            rebuilt.adjoint_derivative(dx=dx)):
+            if sparse.issparse(g_c):
+                g_c, g_r = g_c.toarray(), g_r.toarray()
+            nptest.assert_allclose(g_c, g_r, rtol=1e-6, atol=1e-8)
+
+    def test_derivative_rebuilt(self):
+        cached, rebuilt = self.models()
+        self.assertNotIn('P', rebuilt._derivative_cache)
+        # The patterns are only built by the first derivative
+        self.assertNotIn('P_idx', rebuilt._derivative_cache)
+        self.assert_same_grads(cached, rebuilt)
+
+        # The reconstructed matrices are the unscaled ones
+        Px, _, _, Ax, _, _ = rebuilt._model.unscaled_matrices()
+        nptest.assert_allclose(Px, sparse.triu(self.P, format='csc').data,
+                               rtol=1e-10)
+        nptest.assert_allclose(Ax, self.A.data, rtol=1e-10)
+
+    def test_derivative_rebuilt_update(self):
+        cached, rebuilt = self.models()
+        q = np.random.randn(self.n)
+        Ax = 2. * self.A.data
+        Px_idx = np.array([0, 2])
+        Px = np.array([6., 7.])
+        for model in (cached, rebuilt):
+            model.update(q=q, Ax=Ax.copy(), Px=Px, Px_idx=Px_idx)
+        self.assert_same_grads(cached, rebuilt)
+
+    def test_derivative_pattern_triu(self):
+        # The default pattern is the one of P as given
+        self.P = sparse.triu(self.P, format='csc')
+        cached, rebuilt = self.models()
+        self.assert_same_grads(cached, rebuilt)
+
+        dP = rebuilt.adjoint_derivative(dx=np.ones(self.n))[0]
+        self.assertEqual(sparse.tril(dP, -1).nnz, 0)
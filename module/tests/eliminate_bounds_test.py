@@ -0,0 +1,72 @@
+# Test osqp python module
+import rlqp as osqp
+import numpy as np
+from scipy import sparse
+
+# Unit Test
+import unittest
+import numpy.testing as nptest
+
+
+class eliminate_bounds_tests(unittest.TestCase):
+
+    def setUp(self):
+        np.random.seed(1)
+
+        # Regression with bounded residuals and variable bounds
+        self.n = 40
+        self.m = 30
+        Ad = sparse.random(self.m, self.n, density=0.3, format='csc')
+        self.P = sparse.block_diag([sparse.csc_matrix((self.n, self.n)),
+                                    sparse.eye(self.m)], format='csc')
+        self.q = np.zeros(self.n + self.m)
+        self.A = sparse.vstack([
+            sparse.hstack([Ad, -sparse.eye(self.m)]),
+            sparse.hstack([2. * sparse.eye(self.n),
+                           sparse.csc_matrix((self.n, self.m))])],
+            format='csc')
+        b = np.random.randn(self.m)
+        self.l = np.hstack([b, -np.ones(self.n)])
+        self.u = np.hstack([b, np.ones(self.n)])
+        self.opts = {'verbose': False,
+                     'eps_abs': 1e-06,
+                     'eps_rel': 1e-06,
+                     'polish': False}
+
+    def test_eliminate_bounds(self):
+        model = osqp.OSQP()
+        model.setup(self.P, self.q, self.A, self.l, self.u, **self.opts)
+        res_full = model.solve()
+
+        model = osqp.OSQP()
+        model.setup(self.P, self.q, self.A, self.l, self.u,
+                    eliminate_bounds=True, **self.opts)
+        res = model.solve()
+
+        self.assertEqual(res.info.status_val,
+                         osqp.constant('OSQP_SOLVED'))
+        self.assertLess(res.info.L_nnz, res_full.info.L_nnz)
+        self.assertEqual(res.y.shape, res_full.y.shape)
+        nptest.assert_allclose(res.x, res_full.x, rtol=1e-4, atol=1e-4)
+        nptest.assert_allclose(res.y, res_full.y, rtol=1e-4, atol=1e-4)
+
+    def test_eliminate_bounds_update(self):
+        model = osqp.OSQP()
+        model.setup(self.P, self.q, self.A, self.l, self.u,
+                    eliminate_bounds=True, linsys_solver='supernodal',
+                    ordering='nested_dissection', **self.opts)
+        model.solve()
+
+        # Update A (including the bounds rows) and rho
+        A_new = self.A.copy()
+        A_new.data *= 1.5
+        model.update(Ax=A_new.data)
+        model.update_settings(rho=0.5)
+        res = model.solve()
+
+        model_full = osqp.OSQP()
+        model_full.setup(self.P, self.q, A_new, self.l, self.u, **self.opts)
+        res_full = model_full.solve()
+
+        nptest.assert_allclose(res.x, res_full.x, rtol=1e-4, atol=1e-4)
+        nptest.assert_allclose(res.y, res_full.y, rtol=1e-4, atol=1e-4)
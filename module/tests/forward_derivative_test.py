@@ -0,0 +1,72 @@
+# Test osqp python module
+import rlqp as osqp
+import numpy as np
+from scipy import sparse
+
+# Unit Test
+import unittest
+import numpy.testing as nptest
+
+
+class forward_derivative_tests(unittest.TestCase):
+
+    def setUp(self):
+        np.random.seed(1)
+
+        self.n = 20
+        self.m = 15
+        L = np.random.randn(self.n, self.n)
+        self.P = sparse.csc_matrix(L.dot(L.T) + 5. * np.eye(self.n))
+        self.q = np.random.randn(self.n)
+        self.A = sparse.random(self.m, self.n, density=0.5, format='csc')
+        x_0 = np.random.randn(self.n)
+        self.l = self.A.dot(x_0) - np.random.rand(self.m)
+        self.u = self.A.dot(x_0) + np.random.rand(self.m)
+        self.opts = {'verbose': False,
+                     'eps_abs': 1e-10,
+                     'eps_rel': 1e-10,
+                     'max_iter': 10000}
+
+    def test_forward_finite_difference(self):
+        model = osqp.OSQP()
+        model.setup(self.P, self.q, self.A, self.l, self.u, **self.opts)
+        res = model.solve()
+
+        k = 3
+        dq = np.random.randn(k, self.n)
+        dx, dy = model.forward_derivative(dq=dq)
+        self.assertEqual(dx.shape, (k, self.n))
+        self.assertEqual(dy.shape, (k, self.m))
+
+        # A small step keeps the active set
+        h = 1e-6
+        for r in range(k):
+            pert = osqp.OSQP()
+            pert.setup(self.P, self.q + h * dq[r], self.A, self.l, self.u,
+                       **self.opts)
+            res_h = pert.solve()
+            nptest.assert_allclose(dx[r], (res_h.x - res.x) / h,
+                                   rtol=1e-3, atol=1e-3)
+            nptest.assert_allclose(dy[r], (res_h.y - res.y) / h,
+                                   rtol=1e-3, atol=1e-3)
+
+    def test_forward_adjoint_duality(self):
+        model = osqp.OSQP()
+        model.setup(self.P, self.q, self.A, self.l, self.u, **self.opts)
+        model.solve()
+
+        # <g, J v> from the forward derivative equals <J' g, v> from the
+        # adjoint derivative for every parameter
+        g = np.random.randn(1, self.n)
+        dPx, dq, dAx, dl, du = model.adjoint_derivative_batch(dx=g)
+        v = {'dq': np.random.randn(self.n),
+             'dl': np.random.randn(self.m),
+             'du': np.random.randn(self.m),
+             'dPx': np.random.randn(dPx.shape[1]),
+             'dAx': np.random.randn(dAx.shape[1])}
+        adjoint = {'dq': dq[0], 'dl': dl[0], 'du': du[0],
+                   'dPx': dPx[0], 'dAx': dAx[0]}
+        for name in v:
+            dx, _ = model.forward_derivative(**{name: v[name]})
+            nptest.assert_allclose(g[0].dot(dx), adjoint[name].dot(v[name]),
+                                   rtol=1e-6, atol=1e-8)
@@ -0,0 +1,64 @@
+# Test osqp python module
+import rlqp as osqp
+import numpy as np
+from scipy import sparse
+
+# Unit Test
+import unittest
+import numpy.testing as nptest
+
+
+class ordering_tests(unittest.TestCase):
+
+    def setUp(self):
+        np.random.seed(1)
+
+        # Grid Laplacian objective with box constraints
+        k = 12
+        T = sparse.diags([-1., 2., -1.], [-1, 0, 1], shape=(k, k))
+        self.P = (sparse.kron(T, sparse.eye(k)) +
+                  sparse.kron(sparse.eye(k), T)).tocsc()
+        self.n = k * k
+        self.q = np.random.randn(self.n)
+        self.A = sparse.vstack([sparse.eye(self.n),
+                                sparse.random(10, self.n, density=0.1)],
+                               format='csc')
+        self.m = self.A.shape[0]
+        self.l = -np.ones(self.m)
+        self.u = np.ones(self.m)
+        self.opts = {'verbose': False,
+                     'eps_abs': 1e-06,
+                     'eps_rel': 1e-06,
+                     'polish': False}
+
+    def solve(self, **kwargs):
+        model = osqp.OSQP()
+        model.setup(self.P, self.q, self.A, self.l, self.u,
+                    **self.opts, **kwargs)
+        return model.solve()
+
+    def test_orderings(self):
+        res_amd = self.solve(ordering='amd')
+        self.assertGreater(res_amd.info.L_nnz, 0)
+        self.assertTrue(np.isnan(res_amd.info.ordering_time))
+
+        perm = np.random.permutation(self.n + self.m)
+        for ordering in ['nested_dissection', 'natural', perm]:
+            res = self.solve(ordering=ordering)
+            self.assertEqual(res.info.status_val,
+                             osqp.constant('OSQP_SOLVED'))
+            self.assertGreater(res.info.L_nnz, 0)
+            self.assertGreaterEqual(res.info.ordering_time, 0.)
+            nptest.assert_allclose(res.x, res_amd.x, rtol=1e-4, atol=1e-4)
+            nptest.assert_allclose(res.y, res_amd.y, rtol=1e-4, atol=1e-4)
+
+    def test_supernodal_ordering(self):
+        res_amd = self.solve(ordering='amd')
+        res = self.solve(ordering='nested_dissection',
+                         linsys_solver='supernodal')
+        nptest.assert_allclose(res.x, res_amd.x, rtol=1e-4, atol=1e-4)
+
+    def test_invalid_permutation(self):
+        perm = np.zeros(self.n + self.m, dtype=int)
+        with self.assertRaises(ValueError):
+            self.solve(ordering=perm)
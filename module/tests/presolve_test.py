@@ -0,0 +1,132 @@
+# Test osqp python module
+import rlqp as osqp
+import numpy as np
+from scipy import sparse
+
+# Unit Test
+import unittest
+import numpy.testing as nptest
+
+
+class presolve_tests(unittest.TestCase):
+
+    def setUp(self):
+        np.random.seed(1)
+
+        self.n = 20
+        Ad = sparse.random(10, self.n, density=0.4, format='csr').toarray()
+        Ad[:, -1] = 0.      # Last variable only appears in the loose rows
+        b = np.random.randn(10)
+        # Duplicate rows (scaled), loose rows and empty rows
+        A = np.vstack([Ad, 2. * Ad[:3], -0.5 * Ad[3:5],
+                       np.random.randn(4, self.n), np.zeros((2, self.n))])
+        l = np.hstack([b - 1., 2. * b[:3] - 1., -0.5 * b[3:5] - 1.,
+                       -np.inf * np.ones(4), [-1., 0.]])
+        u = np.hstack([b + 1., 2. * b[:3] + 0.5, -0.5 * b[3:5] + 0.2,
+                       np.inf * np.ones(4), [1., 0.]])
+        self.A = sparse.csc_matrix(A)
+        self.l = l
+        self.u = u
+        self.m = A.shape[0]
+        P = sparse.random(self.n, self.n, density=0.3)
+        P = P.dot(P.T) + 0.1 * sparse.eye(self.n)
+        P = P.tolil()
+        P[-1, :] = 0.
+        P[:, -1] = 0.
+        self.P = sparse.csc_matrix(P)
+        self.P.eliminate_zeros()
+        self.q = np.hstack([np.random.randn(self.n - 1), 0.])
+        self.opts = {'verbose': False,
+                     'eps_abs': 1e-07,
+                     'eps_rel': 1e-07,
+                     'polish': False}
+
+    def check_solution(self, res, res_full):
+        self.assertEqual(res.info.status_val,
+                         osqp.constant('OSQP_SOLVED'))
+        self.assertEqual(res.x.shape, (self.n,))
+        self.assertEqual(res.y.shape, (self.m,))
+        nptest.assert_allclose(res.x, res_full.x, rtol=1e-4, atol=1e-4)
+        # The dual of duplicate rows is only unique up to A' y
+        nptest.assert_allclose(self.A.T.dot(res.y),
+                               self.A.T.dot(res_full.y),
+                               rtol=1e-4, atol=1e-4)
+        nptest.assert_allclose(res.info.obj_val, res_full.info.obj_val,
+                               rtol=1e-4, atol=1e-4)
+
+    def test_presolve(self):
+        model = osqp.OSQP()
+        model.setup(self.P, self.q, self.A, self.l, self.u, **self.opts)
+        res_full = model.solve()
+
+        model = osqp.OSQP()
+        model.setup(self.P, self.q, self.A, self.l, self.u,
+                    presolve=True, **self.opts)
+        res = model.solve()
+
+        self.check_solution(res, res_full)
+        self.assertEqual(model._model.dimensions(), (self.n, self.m))
+        self.assertLess(res.info.L_nnz, res_full.info.L_nnz)
+
+        # Complementarity of the original constraints
+        Ax = self.A.dot(res.x)
+        nptest.assert_allclose(np.minimum(res.y, 0) * (Ax - self.l), 0.,
+                               atol=1e-4)
+        nptest.assert_allclose(np.maximum(res.y, 0) * (Ax - self.u), 0.,
+                               atol=1e-4)
+
+    def test_presolve_update(self):
+        model = osqp.OSQP()
+        model.setup(self.P, self.q, self.A, self.l, self.u,
+                    presolve=True, **self.opts)
+        model.solve()
+
+        q_new = np.hstack([np.random.randn(self.n - 1), 0.])
+        l_new = self.l - 0.5
+        model.update(q=q_new, l=l_new)
+        res = model.solve()
+
+        model_full = osqp.OSQP()
+        model_full.setup(self.P, q_new, self.A, l_new, self.u, **self.opts)
+        res_full = model_full.solve()
+        self.check_solution(res, res_full)
+
+        # Updates removing a reduction are rejected
+        q_bad = q_new.copy()
+        q_bad[-1] = 1.
+        with self.assertRaises(ValueError):
+            model.update(q=q_bad)
+        u_bad = self.u.copy()
+        u_bad[-3] = 1.
+        with self.assertRaises(ValueError):
+            model.update(u=u_bad)
+
+    def test_presolve_negative_one_sided(self):
+        # x0 >= 0 given twice, the second time by a row with a negative
+        # scaling and only an upper bound
+        P = sparse.diags([0., 1.], format='csc')
+        A = sparse.csc_matrix([[1., 0.], [-1e5, 0.], [0., 1.]])
+        l = np.array([0., -np.inf, -1.])
+        u = np.array([np.inf, 0., 1.])
+
+        # Unbounded along x0: the merged upper bound must stay infinite
+        for presolve in (False, True):
+            model = osqp.OSQP()
+            model.setup(P, np.array([-1., 0.]), A, l, u,
+                        presolve=presolve, **self.opts)
+            res = model.solve()
+            self.assertEqual(res.info.status_val,
+                             osqp.constant('OSQP_DUAL_INFEASIBLE'))
+
+        # Bounded: both setups give the same primal and A' y
+        q = np.array([1., 0.5])
+        model = osqp.OSQP()
+        model.setup(P, q, A, l, u, **self.opts)
+        res_full = model.solve()
+        model = osqp.OSQP()
+        model.setup(P, q, A, l, u, presolve=True, **self.opts)
+        res = model.solve()
+        self.assertEqual(res.info.status_val, osqp.constant('OSQP_SOLVED'))
+        nptest.assert_allclose(res.x, res_full.x, rtol=1e-4, atol=1e-4)
+        nptest.assert_allclose(A.T.dot(res.y), A.T.dot(res_full.y),
+                               rtol=1e-4, atol=1e-4)
@@ -0,0 +1,105 @@
+# Test osqp python module
+import rlqp as osqp
+import numpy as np
+from scipy import sparse
+
+# Unit Test
+import unittest
+import numpy.testing as nptest
+
+
+class solve_batch_tests(unittest.TestCase):
+
+    def setUp(self):
+        np.random.seed(1)
+
+        self.n = 15
+        self.m = 10
+        self.count = 8
+        L = np.random.randn(self.n, self.n)
+        self.P = sparse.csc_matrix(L.dot(L.T) + 5. * np.eye(self.n))
+        self.A = sparse.random(self.m, self.n, density=0.5, format='csc')
+        self.q = np.random.randn(self.count, self.n)
+        x_0 = np.random.randn(self.n)
+        self.l = self.A.dot(x_0) - np.random.rand(self.count, self.m)
+        self.u = self.A.dot(x_0) + np.random.rand(self.count, self.m)
+        self.opts = {'verbose': False,
+                     'eps_abs': 1e-10,
+                     'eps_rel': 1e-10,
+                     'max_iter': 10000}
+
+    def test_solve_batch(self):
+        model = osqp.OSQP()
+        model.setup(self.P, self.q[0], self.A, self.l[0], self.u[0],
+                    **self.opts)
+
+        # Scaled values of P and A for every instance
+        P_triu = sparse.triu(self.P, format='csc')
+        P_triu.sort_indices()
+        scale = 1. + np.random.rand(self.count, 1)
+        Px = scale * P_triu.data
+        Ax = scale * self.A.data
+        dx = np.random.randn(self.count, self.n)
+
+        x, y, status, grads = model.solve_batch(
+            self.q, self.l, self.u, Px=Px, Ax=Ax, dx=dx, nthreads=3)
+        dPx, dq, dAx, dl, du = grads
+        nptest.assert_array_equal(status, osqp.constant('OSQP_SOLVED'))
+
+        for r in range(self.count):
+            P = sparse.csc_matrix((Px[r], P_triu.indices, P_triu.indptr),
+                                  shape=P_triu.shape)
+            A = sparse.csc_matrix((Ax[r], self.A.indices, self.A.indptr),
+                                  shape=self.A.shape)
+            single = osqp.OSQP()
+            single.setup(P, self.q[r], A, self.l[r], self.u[r], **self.opts)
+            res = single.solve()
+            nptest.assert_allclose(x[r], res.x, rtol=1e-5, atol=1e-5)
+            nptest.assert_allclose(y[r], res.y, rtol=1e-5, atol=1e-5)
+
+            g = single.adjoint_derivative_batch(dx=dx[r:r + 1])
+            for batch, ref in zip((dPx, dq, dAx, dl, du), g):
+                nptest.assert_allclose(batch[r], ref[0], rtol=1e-4,
+                                       atol=1e-4)
+
+    def test_solve_batch_deterministic(self):
+        model = osqp.OSQP()
+        model.setup(self.P, self.q[0], self.A, self.l[0], self.u[0],
+                    verbose=False)
+
+        # Outputs independent of the threads and of the other instances
+        P_triu = sparse.triu(self.P, format='csc')
+        P_triu.sort_indices()
+        Px = (1. + np.random.rand(self.count, 1)) * P_triu.data
+        dx = np.random.randn(self.count, self.n)
+        order = np.arange(self.count)[::-1]
+        x, y, status, grads = model.solve_batch(
+            self.q, self.l, self.u, Px=Px, dx=dx, nthreads=1)
+        for nthreads in (2, 3):
+            x_t, y_t, status_t, grads_t = model.solve_batch(
+                self.q[order], self.l[order], self.u[order], Px=Px[order],
+                dx=dx[order], nthreads=nthreads)
+            nptest.assert_array_equal(x_t, x[order])
+            nptest.assert_array_equal(y_t, y[order])
+            nptest.assert_array_equal(status_t, status[order])
+            for batch, ref in zip(grads_t, grads):
+                nptest.assert_array_equal(batch, ref[order])
+
+    def test_solve_batch_invalid(self):
+        model = osqp.OSQP()
+        model.setup(self.P, self.q[0], self.A, self.l[0], self.u[0],
+                    **self.opts)
+
+        # Solves only, with an instance whose bounds cross
+        l = self.l.copy()
+        l[2] = self.u[2] + 1.
+        x, y, status, grads = model.solve_batch(self.q, l, self.u)
+        self.assertIsNone(grads)
+        self.assertEqual(status[2], osqp.constant('OSQP_UNSOLVED'))
+        self.assertTrue(np.all(np.isnan(x[2])))
+        solved = np.delete(np.arange(self.count), 2)
+        nptest.assert_array_equal(status[solved],
+                                  osqp.constant('OSQP_SOLVED'))
+
+        with self.assertRaises(ValueError):
+            model.solve_batch(self.q[:, 1:], self.l, self.u)
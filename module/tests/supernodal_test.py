@@ -0,0 +1,69 @@
+# Test osqp python module
+import rlqp as osqp
+import numpy as np
+from scipy import sparse
+
+# Unit Test
+import unittest
+import numpy.testing as nptest
+
+
+class supernodal_tests(unittest.TestCase):
+
+    def setUp(self):
+        np.random.seed(1)
+
+        # Lasso-like problem with dense columns in A
+        self.n = 30
+        self.m = 60
+        Ad = sparse.random(self.m, self.n, density=0.8, format='csc')
+        self.P = sparse.block_diag([sparse.eye(self.n),
+                                    sparse.eye(self.m)], format='csc')
+        self.q = np.random.randn(self.n + self.m)
+        self.A = sparse.vstack([
+            sparse.hstack([Ad, -sparse.eye(self.m)]),
+            sparse.hstack([sparse.eye(self.n),
+                           sparse.csc_matrix((self.n, self.m))])],
+            format='csc')
+        b = np.random.randn(self.m)
+        self.l = np.hstack([b, -np.ones(self.n)])
+        self.u = np.hstack([b, np.ones(self.n)])
+        self.opts = {'verbose': False,
+                     'eps_abs': 1e-06,
+                     'eps_rel': 1e-06,
+                     'polish': False}
+
+    def test_supernodal_QP(self):
+        model = osqp.OSQP()
+        model.setup(self.P, self.q, self.A, self.l, self.u,
+                    linsys_solver='qdldl', **self.opts)
+        res_qdldl = model.solve()
+
+        model = osqp.OSQP()
+        model.setup(self.P, self.q, self.A, self.l, self.u,
+                    linsys_solver='supernodal', **self.opts)
+        res = model.solve()
+
+        self.assertEqual(res.info.status_val,
+                         osqp.constant('OSQP_SOLVED'))
+        nptest.assert_allclose(res.x, res_qdldl.x, rtol=1e-4, atol=1e-4)
+        nptest.assert_allclose(res.y, res_qdldl.y, rtol=1e-4, atol=1e-4)
+
+    def test_supernodal_update_matrices(self):
+        model = osqp.OSQP()
+        model.setup(self.P, self.q, self.A, self.l, self.u,
+                    linsys_solver='supernodal', **self.opts)
+        model.solve()
+
+        # Update P and rho, which triggers a numerical refactorization
+        P_new = 2. * self.P
+        model.update(Px=sparse.triu(P_new).data)
+        model.update_settings(rho=1.0)
+        res = model.solve()
+
+        model_qdldl = osqp.OSQP()
+        model_qdldl.setup(P_new, self.q, self.A, self.l, self.u,
+                          **self.opts)
+        res_qdldl = model_qdldl.solve()
+
+        nptest.assert_allclose(res.x, res_qdldl.x, rtol=1e-4, atol=1e-4)
@@ -0,0 +1,78 @@
+# Test osqp python module
+import rlqp as osqp
+import numpy as np
+from scipy import sparse
+
+# Unit Test
+import unittest
+import numpy.testing as nptest
+
+
+class update_idx_tests(unittest.TestCase):
+
+    def setUp(self):
+        np.random.seed(1)
+
+        self.n = 30
+        self.m = 50
+        P = sparse.random(self.n, self.n, density=0.2)
+        self.P = sparse.csc_matrix(P.dot(P.T) + 0.1 * sparse.eye(self.n))
+        self.q = np.random.randn(self.n)
+        self.A = sparse.random(self.m, self.n, density=0.2, format='csc')
+        self.l = -1. - np.random.rand(self.m)
+        self.u = 1. + np.random.rand(self.m)
+        self.opts = {'verbose': False,
+                     'eps_abs': 1e-08,
+                     'eps_rel': 1e-08,
+                     'polish': False}
+
+    def check_update_idx(self, **opts):
+        model = osqp.OSQP()
+        model.setup(self.P, self.q, self.A, self.l, self.u, **opts)
+
+        q_idx = np.array([0, 3, 7])
+        lu_idx = np.array([1, 2, 5, 8])
+        q_new = np.random.randn(len(q_idx))
+        # Loose, equality and inequality constraints
+        l_new = np.array([-np.inf, 0.5, -0.5, -2.])
+        u_new = np.array([np.inf, 0.5, 0.5, 2.])
+        model.update(q=q_new, q_idx=q_idx, l=l_new, u=u_new, lu_idx=lu_idx)
+        res = model.solve()
+
+        q, l, u = self.q.copy(), self.l.copy(), self.u.copy()
+        q[q_idx] = q_new
+        l[lu_idx] = l_new
+        u[lu_idx] = u_new
+        model_ref = osqp.OSQP()
+        model_ref.setup(self.P, q, self.A, l, u, **opts)
+        res_ref = model_ref.solve()
+
+        self.assertEqual(res.info.status_val, osqp.constant('OSQP_SOLVED'))
+        nptest.assert_allclose(res.x, res_ref.x, rtol=1e-5, atol=1e-5)
+        nptest.assert_allclose(res.y, res_ref.y, rtol=1e-5, atol=1e-5)
+
+        # Only the upper bounds
+        model.update(u=np.array([1., 1.]), lu_idx=np.array([2, 3]))
+        u[[2, 3]] = 1.
+        model_ref.update(u=u)
+        nptest.assert_allclose(model.solve().x, model_ref.solve().x,
+                               rtol=1e-5, atol=1e-5)
+
+        # Invalid bounds are rejected
+        with self.assertRaises(ValueError):
+            model.update(l=np.array([3.]), lu_idx=np.array([2]))
+        with self.assertRaises(ValueError):
+            model.update(q=np.array([1.]), q_idx=np.array([self.n]))
+
+    def test_update_idx(self):
+        self.check_update_idx(**self.opts)
+
+    def test_update_idx_decompose(self):
+        # Block diagonal problem, updated through the blocks
+        self.P = sparse.block_diag([self.P, self.P], format='csc')
+        self.A = sparse.block_diag([self.A, self.A], format='csc')
+        self.q = np.concatenate([self.q, self.q])
+        self.l = np.concatenate([self.l, self.l])
+        self.u = np.concatenate([self.u, self.u])
+        self.n, self.m = 2 * self.n, 2 * self.m
+        self.check_update_idx(decompose=True, **self.opts)
@@ -0,0 +1,71 @@
+# Test osqp python module
+import rlqp as osqp
+import numpy as np
+from scipy import sparse
+
+# Unit Test
+import unittest
+import numpy.testing as nptest
+
+
+class update_solve_tests(unittest.TestCase):
+
+    def setUp(self):
+        np.random.seed(1)
+
+        self.n = 30
+        self.m = 50
+        P = sparse.random(self.n, self.n, density=0.2)
+        self.P = sparse.csc_matrix(P.dot(P.T) + 0.1 * sparse.eye(self.n))
+        self.q = np.random.randn(self.n)
+        self.A = sparse.random(self.m, self.n, density=0.2, format='csc')
+        self.l = -1. - np.random.rand(self.m)
+        self.u = 1. + np.random.rand(self.m)
+        self.opts = {'verbose': False,
+                     'eps_abs': 1e-08,
+                     'eps_rel': 1e-08,
+                     'polish': False}
+
+    def test_update_solve(self):
+        model = osqp.OSQP()
+        model.setup(self.P, self.q, self.A, self.l, self.u, **self.opts)
+        model_ref = osqp.OSQP()
+        model_ref.setup(self.P, self.q, self.A, self.l, self.u, **self.opts)
+        res = model.solve()
+
+        # MPC loop: new data, warm started at the previous solution
+        for k in range(5):
+            q = self.q + 0.1 * np.random.randn(self.n)
+            l = self.l + 0.1 * np.random.randn(self.m)
+            u = self.u + 0.1 * np.random.randn(self.m)
+            l[0] = -np.inf
+            u[1] = np.inf
+            res = model.update_solve(q=q, l=l, u=u, x0=res.x, y0=res.y)
+
+            model_ref.update(q=q, l=l, u=u)
+            res_ref = model_ref.solve()
+
+            self.assertEqual(res.info.status_val,
+                             osqp.constant('OSQP_SOLVED'))
+            nptest.assert_allclose(res.x, res_ref.x, rtol=1e-5, atol=1e-5)
+            nptest.assert_allclose(res.y, res_ref.y, rtol=1e-5, atol=1e-5)
+
+        # Only the linear cost
+        res = model.update_solve(q=self.q)
+        model_ref.update(q=self.q)
+        res_ref = model_ref.solve()
+        nptest.assert_allclose(res.x, res_ref.x, rtol=1e-5, atol=1e-5)
+
+    def test_update_solve_errors(self):
+        model = osqp.OSQP()
+        model.setup(self.P, self.q, self.A, self.l, self.u, **self.opts)
+
+        with self.assertRaises(ValueError):
+            model.update_solve(q=np.zeros(self.n + 1))
+        with self.assertRaises(ValueError):
+            model.update_solve(y0=np.zeros(self.n))
+        with self.assertRaises(TypeError):
+            model.update_solve(l=list(self.l))
+        # Lower bound above the upper bound
+        with self.assertRaises(ValueError):
+            model.update_solve(l=self.u + 1.)
@@ -13,8 +13,16 @@ def linsys_solver_str_to_int(settings):
         linsys_solver_str = linsys_solver_str.lower()
         if linsys_solver_str == 'qdldl':
             settings['linsys_solver'] = _osqp.constant('QDLDL_SOLVER')
+            # Do not switch small problems to the dense solver
+            settings.setdefault('dense_max_dim', 0)
         elif linsys_solver_str == 'mkl pardiso':
             settings['linsys_solver'] = _osqp.constant('MKL_PARDISO_SOLVER')
+        elif linsys_solver_str == 'supernodal':
+            settings['linsys_solver'] = _osqp.constant('SUPERNODAL_SOLVER')
+        elif linsys_solver_str == 'dense':
+            settings['linsys_solver'] = _osqp.constant('DENSE_SOLVER')
+        elif linsys_solver_str == 'banded':
+            settings['linsys_solver'] = _osqp.constant('BANDED_SOLVER')
         # Default solver: QDLDL
         elif linsys_solver_str == '':
             settings['linsys_solver'] = _osqp.constant('QDLDL_SOLVER')
@@ -25,6 +33,67 @@ def linsys_solver_str_to_int(settings):
         return settings
 
 
+def ordering_to_int(settings):
+        stages = settings.pop('stages', None)
+        ordering = settings.pop('ordering', '')
+        if stages is not None:
+            # Order the variables and constraints stage by stage
+            if not isinstance(ordering, str) or ordering != '':
+                raise ValueError("Settings stages and ordering " +
+                                 "cannot be given together.")
+            ordering = np.argsort(np.asarray(stages).ravel(), kind='stable')
+        if not isinstance(ordering, str):
+            # User-provided permutation of the KKT matrix
+            settings['ordering'] = _osqp.constant('USER_ORDERING')
+            settings['ordering_perm'] = np.asarray(ordering).ravel()
+            return settings
+        ordering = ordering.lower()
+        if ordering == 'amd' or ordering == '':
+            settings['ordering'] = _osqp.constant('AMD_ORDERING')
+        elif ordering == 'nested_dissection':
+            settings['ordering'] = _osqp.constant('NESDIS_ORDERING')
+        elif ordering == 'natural':
+            settings['ordering'] = _osqp.constant('NATURAL_ORDERING')
+        elif ordering == 'rcm':
+            settings['ordering'] = _osqp.constant('RCM_ORDERING')
+        else:   # default ordering: AMD
+            warn("KKT ordering not recognized. " +
+                 "Using default ordering AMD.")
+            settings['ordering'] = _osqp.constant('AMD_ORDERING')
+        return settings
+
+
+def check_termination_to_int(settings):
+        check_termination = settings.get('check_termination')
+        if isinstance(check_termination, str):
+            if check_termination.lower() != 'adaptive':
+                raise ValueError("Setting check_termination is required " +
+                                 "to be an integer or 'adaptive'.")
+            # Adaptive checks based on the default interval
+            del settings['check_termination']
+            settings['adaptive_check'] = True
+        return settings
+
+
+def anderson_to_int(settings):
+        anderson = settings.pop('anderson', None)
+        if anderson is None or anderson is False:
+            return settings
+        if anderson is True:
+            anderson = 'type2'
+        if not isinstance(anderson, str):
+            raise TypeError("Setting anderson is required to be " +
+                            "a boolean or a string.")
+        anderson = anderson.lower()
+        if anderson == 'type1':
+            settings['anderson'] = _osqp.constant('ANDERSON_TYPE_I')
+        elif anderson == 'type2':
+            settings['anderson'] = _osqp.constant('ANDERSON_TYPE_II')
+        else:
+            raise ValueError("Anderson acceleration type not recognized.")
+        return settings
+
+
 def prepare_data(P=None, q=None, A=None, l=None, u=None, **settings):
         """
         Prepare problem data of the form
@@ -135,6 +204,9 @@ def prepare_data(P=None, q=None, A=None, l=None, u=None, **settings):
 
         # Convert linsys_solver string to integer
         settings = linsys_solver_str_to_int(settings)
+        settings = ordering_to_int(settings)
+        settings = anderson_to_int(settings)
+        settings = check_termination_to_int(settings)
 
         return ((n, m), P.data, P.indices, P.indptr, q,
                 A.data, A.indices, A.indptr,
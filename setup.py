@@ -125,7 +125,7 @@ if args.debug:
 library_dirs = []
 libraries = []
 if system() == 'Linux':
-    libraries += ['rt']
+    libraries += ['rt', 'pthread']
 if system() == 'Windows':
     # They moved the stdio library to another place.
     # We need to include this to fix the dependency
@@ -267,7 +267,7 @@ setup(name='rlqp',
       package_dir={'rlqp': 'module',
                    'rlqppurepy': 'modulepurepy'},
       include_package_data=True,  # Include package data from MANIFEST.in
-      setup_requires=["numpy >= 1.7", "qdldl"],
+      setup_requires=["numpy >= 1.7"],
       install_requires=requirements,
       license='Apache 2.0',
       url="https://berkeleyautomation.github.io/rlqp",